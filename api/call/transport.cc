@@ -11,6 +11,7 @@
 #include "api/call/transport.h"
 
 #include <cstdint>
+#include <vector>
 
 namespace webrtc {
 
@@ -20,4 +21,14 @@ PacketOptions::PacketOptions(const PacketOptions&) = default;
 
 PacketOptions::~PacketOptions() = default;
 
+bool Transport::SendRtpGathered(rtc::ArrayView<const uint8_t> head,
+                                rtc::ArrayView<const uint8_t> tail,
+                                const PacketOptions& options) {
+  std::vector<uint8_t> packet;
+  packet.reserve(head.size() + tail.size());
+  packet.insert(packet.end(), head.begin(), head.end());
+  packet.insert(packet.end(), tail.begin(), tail.end());
+  return SendRtp(packet, options);
+}
+
 }  // namespace webrtc
@@ -42,6 +42,13 @@ class Transport {
  public:
   virtual bool SendRtp(rtc::ArrayView<const uint8_t> packet,
                        const PacketOptions& options) = 0;
+  // Sends an RTP packet made of `head` followed by `tail`, e.g. a packet whose
+  // payload is not stored next to its header. Transports that copy packets
+  // anyway can override this to gather both parts while copying. The default
+  // implementation joins the parts and calls SendRtp().
+  virtual bool SendRtpGathered(rtc::ArrayView<const uint8_t> head,
+                               rtc::ArrayView<const uint8_t> tail,
+                               const PacketOptions& options);
   virtual bool SendRtcp(rtc::ArrayView<const uint8_t> packet) = 0;
 
  protected:
@@ -11,13 +11,22 @@
 #include "api/video/encoded_image.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <algorithm>
 
+#include "rtc_base/memory/frame_memory_pool.h"
+
 namespace webrtc {
 
+namespace {
+
+constexpr size_t kBufferAlignment = 16;
+
+}  // namespace
+
 EncodedImageBuffer::EncodedImageBuffer(size_t size) : size_(size) {
-  buffer_ = static_cast<uint8_t*>(malloc(size));
+  buffer_ = Allocate(size, &pooled_);
 }
 
 EncodedImageBuffer::EncodedImageBuffer(const uint8_t* data, size_t size)
@@ -26,7 +35,7 @@ EncodedImageBuffer::EncodedImageBuffer(const uint8_t* data, size_t size)
 }
 
 EncodedImageBuffer::~EncodedImageBuffer() {
-  free(buffer_);
+  Free(buffer_, pooled_);
 }
 
 // static
@@ -56,10 +65,46 @@ void EncodedImageBuffer::Realloc(size_t size) {
   // More specifically, it breaks expectations of
   // VCMSessionInfo::UpdateDataPointers.
   RTC_DCHECK(size > 0);
-  buffer_ = static_cast<uint8_t*>(realloc(buffer_, size));
+  if (pooled_ && size <= FrameMemoryPool::UsableSize(buffer_)) {
+    // The size class of the block already fits.
+    size_ = size;
+    return;
+  }
+  if (!pooled_ && !FrameMemoryPool::Global().Pools(size)) {
+    buffer_ = static_cast<uint8_t*>(realloc(buffer_, size));
+    size_ = size;
+    return;
+  }
+  bool pooled;
+  uint8_t* buffer = Allocate(size, &pooled);
+  if (size_ > 0) {
+    memcpy(buffer, buffer_, std::min(size, size_));
+  }
+  Free(buffer_, pooled_);
+  buffer_ = buffer;
+  pooled_ = pooled;
   size_ = size;
 }
 
+// static
+uint8_t* EncodedImageBuffer::Allocate(size_t size, bool* pooled) {
+  FrameMemoryPool& pool = FrameMemoryPool::Global();
+  *pooled = pool.Pools(size);
+  if (*pooled) {
+    return static_cast<uint8_t*>(pool.Allocate(size, kBufferAlignment));
+  }
+  return static_cast<uint8_t*>(malloc(size));
+}
+
+// static
+void EncodedImageBuffer::Free(uint8_t* buffer, bool pooled) {
+  if (pooled) {
+    FrameMemoryPool::Free(buffer);
+  } else {
+    free(buffer);
+  }
+}
+
 EncodedImage::EncodedImage() = default;
 
 EncodedImage::EncodedImage(EncodedImage&&) = default;
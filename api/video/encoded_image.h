@@ -44,7 +44,10 @@ class EncodedImageBufferInterface : public rtc::RefCountInterface {
   virtual size_t size() const = 0;
 };
 
-// Basic implementation of EncodedImageBufferInterface.
+// Basic implementation of EncodedImageBufferInterface. While FrameMemoryPool
+// is enabled, buffers of the sizes it pools come from it, so that encoders
+// creating a buffer per frame reuse the memory of frames already sent. Other
+// buffers are allocated with malloc().
 class RTC_EXPORT EncodedImageBuffer : public EncodedImageBufferInterface {
  public:
   static rtc::scoped_refptr<EncodedImageBuffer> Create() { return Create(0); }
@@ -64,6 +67,12 @@ class RTC_EXPORT EncodedImageBuffer : public EncodedImageBufferInterface {
 
   size_t size_;
   uint8_t* buffer_;
+  // Whether `buffer_` comes from FrameMemoryPool rather than malloc().
+  bool pooled_ = false;
+
+ private:
+  static uint8_t* Allocate(size_t size, bool* pooled);
+  static void Free(uint8_t* buffer, bool pooled);
 };
 
 // TODO(bug.webrtc.org/9378): This is a legacy api class, which is slowly being
@@ -0,0 +1,51 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef API_VIDEO_ENCODED_VIDEO_SOURCE_H_
+#define API_VIDEO_ENCODED_VIDEO_SOURCE_H_
+
+#include "api/units/data_rate.h"
+#include "api/video_codecs/video_encoder.h"
+
+namespace webrtc {
+
+// Source of already encoded video that a video send stream sends instead of
+// encoding frames itself, e.g. frames received from another peer and
+// assembled with RtpVideoFrameAssembler, to relay them without transcoding.
+//
+// Frames are delivered through EncodedImageCallback::OnEncodedImage, on any
+// thread. The CodecSpecificInfo, if given, is used for packetization like the
+// one of an encoder; its `generic_frame_info` and `template_structure` are
+// sent in the dependency descriptor, so the structure of SVC streams is kept.
+// The encoded image's RTP timestamp is sent with the stream's own offset, and
+// its simulcast index selects the RTP stream. The codec must match the payload
+// type the stream is configured with.
+class EncodedVideoSource {
+ public:
+  virtual ~EncodedVideoSource() = default;
+
+  // Starts delivering frames to `sink`, or stops if `sink` is null. Once it
+  // returns, no frames are delivered to a previous sink.
+  virtual void SetSink(EncodedImageCallback* sink) = 0;
+
+  // A receiver of the stream needs a key frame, e.g. after packet loss. The
+  // source should request one from where the frames come from, and deliver it
+  // once received. May be called on any thread.
+  virtual void RequestKeyFrame() = 0;
+
+  // The rate at which the stream can currently send. A relaying source may
+  // forward it upstream, or drop layers to fit. Zero when the stream is
+  // paused. May be called on any thread.
+  virtual void OnTargetBitrateChanged(DataRate target_bitrate) {}
+};
+
+}  // namespace webrtc
+
+#endif  // API_VIDEO_ENCODED_VIDEO_SOURCE_H_
@@ -12,8 +12,8 @@
 
 #include <algorithm>
 
-#include "absl/algorithm/container.h"
 #include "absl/container/inlined_vector.h"
+#include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/numerics/sequence_number_util.h"
 
@@ -57,6 +57,21 @@ template <typename FrameIteratorT>
 bool IsLastFrameInTemporalUnit(const FrameIteratorT& it) {
   return it->second.encoded_frame->is_last_spatial_layer;
 }
+
+static_assert(EncodedFrame::kMaxFrameReferences <= 8,
+              "References are tracked in 8 bit masks.");
+
+// Returns the bit of `reference` in the reference masks of `it`.
+template <typename FrameIteratorT>
+uint8_t ReferenceBit(const FrameIteratorT& it, int64_t reference) {
+  rtc::ArrayView<const int64_t> references = GetReferences(it);
+  for (size_t i = 0; i < references.size(); ++i) {
+    if (references[i] == reference) {
+      return 1 << i;
+    }
+  }
+  return 0;
+}
 }  // namespace
 
 FrameBuffer::FrameBuffer(int max_size,
@@ -111,7 +126,43 @@ bool FrameBuffer::InsertFrame(std::unique_ptr<EncodedFrame> frame) {
                          << " inserted, buffer is now full.";
   }
 
-  PropagateContinuity(insert_res.first);
+  const FrameIterator frame_it = insert_res.first;
+  FrameInfo& frame_info = frame_it->second;
+  rtc::ArrayView<const int64_t> references = GetReferences(frame_it);
+  for (size_t i = 0; i < references.size(); ++i) {
+    if (decoded_frame_history_.WasDecoded(references[i])) {
+      continue;
+    }
+
+    const uint8_t bit = 1 << i;
+    auto reference_it = frames_.find(references[i]);
+    if (reference_it == frames_.end() || !reference_it->second.continuous) {
+      frame_info.references_blocking_continuity |= bit;
+    }
+    if (reference_it == frames_.end() ||
+        GetTimestamp(reference_it) != GetTimestamp(frame_it)) {
+      frame_info.references_blocking_decoding |= bit;
+    }
+    dependent_frames_[references[i]].push_back(frame_id);
+  }
+
+  OnFrameInserted(frame_it);
+  if (frame_info.references_blocking_continuity == 0) {
+    PropagateContinuity(frame_it);
+  }
+
+  UpdateTemporalUnit(frame_it);
+  // A frame with another timestamp may split the temporal unit it was
+  // inserted into.
+  if (frame_it != frames_.begin() &&
+      GetTimestamp(std::prev(frame_it)) != GetTimestamp(frame_it)) {
+    UpdateTemporalUnit(std::prev(frame_it));
+  }
+  if (std::next(frame_it) != frames_.end() &&
+      GetTimestamp(std::next(frame_it)) != GetTimestamp(frame_it)) {
+    UpdateTemporalUnit(std::next(frame_it));
+  }
+
   FindNextAndLastDecodableTemporalUnit();
   return true;
 }
@@ -123,14 +174,26 @@ FrameBuffer::ExtractNextDecodableTemporalUnit() {
     return res;
   }
 
+  absl::InlinedVector<int64_t, 4> decoded_frame_ids;
   auto end_it = std::next(next_decodable_temporal_unit_->last_frame);
   for (auto it = next_decodable_temporal_unit_->first_frame; it != end_it;
        ++it) {
     decoded_frame_history_.InsertDecoded(GetFrameId(it), GetTimestamp(it));
+    decoded_frame_ids.push_back(GetFrameId(it));
     res.push_back(std::move(it->second.encoded_frame));
   }
 
-  DropNextDecodableTemporalUnit();
+  EraseFramesBefore(end_it);
+  for (int64_t frame_id : decoded_frame_ids) {
+    OnFrameDecoded(frame_id);
+  }
+  // Frames up to the last decoded one are either decoded or can no longer be
+  // inserted, so nothing will wait for them anymore.
+  dependent_frames_.erase(
+      dependent_frames_.begin(),
+      dependent_frames_.upper_bound(decoded_frame_ids.back()));
+
+  FindNextAndLastDecodableTemporalUnit();
   return res;
 }
 
@@ -139,12 +202,7 @@ void FrameBuffer::DropNextDecodableTemporalUnit() {
     return;
   }
 
-  auto end_it = std::next(next_decodable_temporal_unit_->last_frame);
-  num_dropped_frames_ += std::count_if(
-      frames_.begin(), end_it,
-      [](const auto& f) { return f.second.encoded_frame != nullptr; });
-
-  frames_.erase(frames_.begin(), end_it);
+  EraseFramesBefore(std::next(next_decodable_temporal_unit_->last_frame));
   FindNextAndLastDecodableTemporalUnit();
 }
 
@@ -172,104 +230,197 @@ size_t FrameBuffer::CurrentSize() const {
   return frames_.size();
 }
 
-bool FrameBuffer::IsContinuous(const FrameIterator& it) const {
-  for (int64_t reference : GetReferences(it)) {
-    if (decoded_frame_history_.WasDecoded(reference)) {
-      continue;
+void FrameBuffer::PropagateContinuity(const FrameIterator& frame_it) {
+  absl::InlinedVector<FrameIterator, 8> newly_continuous = {frame_it};
+  while (!newly_continuous.empty()) {
+    FrameIterator it = newly_continuous.back();
+    newly_continuous.pop_back();
+
+    it->second.continuous = true;
+    if (last_continuous_frame_id_ < GetFrameId(it)) {
+      last_continuous_frame_id_ = GetFrameId(it);
+    }
+    if (IsLastFrameInTemporalUnit(it)) {
+      num_continuous_temporal_units_++;
+      if (last_continuous_temporal_unit_frame_id_ < GetFrameId(it)) {
+        last_continuous_temporal_unit_frame_id_ = GetFrameId(it);
+      }
     }
 
-    auto reference_frame_it = frames_.find(reference);
-    if (reference_frame_it != frames_.end() &&
-        reference_frame_it->second.continuous) {
+    auto dependents_it = dependent_frames_.find(GetFrameId(it));
+    if (dependents_it == dependent_frames_.end()) {
       continue;
     }
+    for (int64_t dependent_id : dependents_it->second) {
+      auto dependent_it = frames_.find(dependent_id);
+      if (dependent_it == frames_.end() || dependent_it->second.continuous) {
+        continue;
+      }
+      uint8_t& blocking = dependent_it->second.references_blocking_continuity;
+      const uint8_t bit = ReferenceBit(dependent_it, GetFrameId(it));
+      if ((blocking & bit) != 0) {
+        blocking &= ~bit;
+        if (blocking == 0) {
+          newly_continuous.push_back(dependent_it);
+        }
+      }
+    }
+  }
+}
 
-    return false;
+void FrameBuffer::OnFrameInserted(const FrameIterator& frame_it) {
+  auto dependents_it = dependent_frames_.find(GetFrameId(frame_it));
+  if (dependents_it == dependent_frames_.end()) {
+    return;
   }
 
-  return true;
+  for (int64_t dependent_id : dependents_it->second) {
+    auto dependent_it = frames_.find(dependent_id);
+    if (dependent_it == frames_.end() ||
+        GetTimestamp(dependent_it) != GetTimestamp(frame_it)) {
+      continue;
+    }
+    dependent_it->second.references_blocking_decoding &=
+        ~ReferenceBit(dependent_it, GetFrameId(frame_it));
+    UpdateTemporalUnit(dependent_it);
+  }
 }
 
-void FrameBuffer::PropagateContinuity(const FrameIterator& frame_it) {
-  for (auto it = frame_it; it != frames_.end(); ++it) {
-    if (!it->second.continuous) {
-      if (IsContinuous(it)) {
-        it->second.continuous = true;
-        if (last_continuous_frame_id_ < GetFrameId(it)) {
-          last_continuous_frame_id_ = GetFrameId(it);
-        }
-        if (IsLastFrameInTemporalUnit(it)) {
-          num_continuous_temporal_units_++;
-          if (last_continuous_temporal_unit_frame_id_ < GetFrameId(it)) {
-            last_continuous_temporal_unit_frame_id_ = GetFrameId(it);
-          }
-        }
+void FrameBuffer::OnFrameDecoded(int64_t frame_id) {
+  auto dependents_it = dependent_frames_.find(frame_id);
+  if (dependents_it == dependent_frames_.end()) {
+    return;
+  }
+
+  for (int64_t dependent_id : dependents_it->second) {
+    auto dependent_it = frames_.find(dependent_id);
+    if (dependent_it == frames_.end()) {
+      continue;
+    }
+    FrameInfo& dependent = dependent_it->second;
+    const uint8_t bit = ReferenceBit(dependent_it, frame_id);
+    dependent.references_blocking_decoding &= ~bit;
+    if (!dependent.continuous &&
+        (dependent.references_blocking_continuity & bit) != 0) {
+      dependent.references_blocking_continuity &= ~bit;
+      if (dependent.references_blocking_continuity == 0) {
+        PropagateContinuity(dependent_it);
       }
     }
+    UpdateTemporalUnit(dependent_it);
   }
 }
 
-void FrameBuffer::FindNextAndLastDecodableTemporalUnit() {
-  next_decodable_temporal_unit_.reset();
-  decodable_temporal_units_info_.reset();
-
-  if (!last_continuous_temporal_unit_frame_id_) {
+void FrameBuffer::OnFrameDropped(int64_t frame_id, uint32_t rtp_timestamp) {
+  auto dependents_it = dependent_frames_.find(frame_id);
+  if (dependents_it == dependent_frames_.end()) {
     return;
   }
 
-  FrameIterator first_frame_it = frames_.begin();
-  FrameIterator last_frame_it = frames_.begin();
-  absl::InlinedVector<int64_t, 4> frames_in_temporal_unit;
-  uint32_t last_decodable_temporal_unit_timestamp;
-  for (auto frame_it = frames_.begin(); frame_it != frames_.end();) {
-    if (GetFrameId(frame_it) > *last_continuous_temporal_unit_frame_id_) {
-      break;
+  // Frames of the same temporal unit no longer find the dropped frame in the
+  // buffer. Frames of other temporal units were waiting for it to be decoded
+  // and keep doing so.
+  for (int64_t dependent_id : dependents_it->second) {
+    auto dependent_it = frames_.find(dependent_id);
+    if (dependent_it == frames_.end() ||
+        GetTimestamp(dependent_it) != rtp_timestamp) {
+      continue;
     }
+    dependent_it->second.references_blocking_decoding |=
+        ReferenceBit(dependent_it, frame_id);
+    UpdateTemporalUnit(dependent_it);
+  }
+}
 
-    if (GetTimestamp(frame_it) != GetTimestamp(first_frame_it)) {
-      frames_in_temporal_unit.clear();
-      first_frame_it = frame_it;
-    }
+FrameBuffer::FrameIterator FrameBuffer::FirstFrameInTemporalUnit(
+    FrameIterator frame_it) {
+  const uint32_t timestamp = GetTimestamp(frame_it);
+  while (frame_it != frames_.begin() &&
+         GetTimestamp(std::prev(frame_it)) == timestamp) {
+    --frame_it;
+  }
+  return frame_it;
+}
 
-    frames_in_temporal_unit.push_back(GetFrameId(frame_it));
-
-    last_frame_it = frame_it++;
-
-    if (IsLastFrameInTemporalUnit(last_frame_it)) {
-      bool temporal_unit_decodable = true;
-      for (auto it = first_frame_it; it != frame_it && temporal_unit_decodable;
-           ++it) {
-        for (int64_t reference : GetReferences(it)) {
-          if (!decoded_frame_history_.WasDecoded(reference) &&
-              !absl::c_linear_search(frames_in_temporal_unit, reference)) {
-            // A frame in the temporal unit has a non-decoded reference outside
-            // the temporal unit, so it's not yet ready to be decoded.
-            temporal_unit_decodable = false;
-            break;
-          }
-        }
-      }
+void FrameBuffer::UpdateTemporalUnit(FrameIterator frame_it) {
+  if (frame_it == frames_.end()) {
+    return;
+  }
 
+  // A temporal unit consists of all consecutive frames with the same
+  // timestamp up to and including a frame marked as the last one of the unit.
+  // It is decodable if none of its frames is waiting for a frame outside of
+  // it.
+  const uint32_t timestamp = GetTimestamp(frame_it);
+  bool temporal_unit_decodable = true;
+  for (auto it = FirstFrameInTemporalUnit(frame_it);
+       it != frames_.end() && GetTimestamp(it) == timestamp; ++it) {
+    temporal_unit_decodable = temporal_unit_decodable &&
+                              it->second.references_blocking_decoding == 0;
+    if (IsLastFrameInTemporalUnit(it)) {
       if (temporal_unit_decodable) {
-        if (!next_decodable_temporal_unit_) {
-          next_decodable_temporal_unit_ = {first_frame_it, last_frame_it};
-        }
-
-        last_decodable_temporal_unit_timestamp = GetTimestamp(first_frame_it);
+        decodable_temporal_units_.insert(GetFrameId(it));
+      } else {
+        decodable_temporal_units_.erase(GetFrameId(it));
       }
     }
   }
+}
 
-  if (next_decodable_temporal_unit_) {
-    decodable_temporal_units_info_ = {
-        .next_rtp_timestamp =
-            GetTimestamp(next_decodable_temporal_unit_->first_frame),
-        .last_rtp_timestamp = last_decodable_temporal_unit_timestamp};
+void FrameBuffer::EraseFramesBefore(FrameIterator end_it) {
+  absl::InlinedVector<std::pair<int64_t, uint32_t>, 4> dropped_frames;
+  for (auto it = frames_.begin(); it != end_it; ++it) {
+    if (it->second.encoded_frame != nullptr) {
+      dropped_frames.emplace_back(GetFrameId(it), GetTimestamp(it));
+    }
+  }
+  num_dropped_frames_ += static_cast<int>(dropped_frames.size());
+
+  frames_.erase(frames_.begin(), end_it);
+  decodable_temporal_units_.erase(
+      decodable_temporal_units_.begin(),
+      frames_.empty()
+          ? decodable_temporal_units_.end()
+          : decodable_temporal_units_.lower_bound(frames_.begin()->first));
+
+  for (const auto& [frame_id, rtp_timestamp] : dropped_frames) {
+    OnFrameDropped(frame_id, rtp_timestamp);
   }
+  // The remaining frames of a temporal unit that was cut off at its start now
+  // form a temporal unit of their own.
+  UpdateTemporalUnit(frames_.begin());
+}
+
+void FrameBuffer::FindNextAndLastDecodableTemporalUnit() {
+  next_decodable_temporal_unit_.reset();
+  decodable_temporal_units_info_.reset();
+
+  if (!last_continuous_temporal_unit_frame_id_ ||
+      decodable_temporal_units_.empty() ||
+      *decodable_temporal_units_.begin() >
+          *last_continuous_temporal_unit_frame_id_) {
+    return;
+  }
+
+  FrameIterator last_frame_it =
+      frames_.find(*decodable_temporal_units_.begin());
+  RTC_DCHECK(last_frame_it != frames_.end());
+  next_decodable_temporal_unit_ = {FirstFrameInTemporalUnit(last_frame_it),
+                                   last_frame_it};
+
+  const int64_t last_decodable_frame_id = *std::prev(
+      decodable_temporal_units_.upper_bound(
+          *last_continuous_temporal_unit_frame_id_));
+  decodable_temporal_units_info_ = {
+      .next_rtp_timestamp = GetTimestamp(last_frame_it),
+      .last_rtp_timestamp =
+          GetTimestamp(frames_.find(last_decodable_frame_id))};
 }
 
 void FrameBuffer::Clear() {
   frames_.clear();
+  dependent_frames_.clear();
+  decodable_temporal_units_.clear();
   next_decodable_temporal_unit_.reset();
   decodable_temporal_units_info_.reset();
   last_continuous_frame_id_.reset();
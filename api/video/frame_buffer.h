@@ -13,6 +13,7 @@
 
 #include <map>
 #include <memory>
+#include <set>
 #include <utility>
 
 #include "absl/container/inlined_vector.h"
@@ -72,6 +73,12 @@ class FrameBuffer {
   struct FrameInfo {
     std::unique_ptr<EncodedFrame> encoded_frame;
     bool continuous = false;
+    // Bit `i` is set while `references[i]` has neither been decoded nor become
+    // continuous.
+    uint8_t references_blocking_continuity = 0;
+    // Bit `i` is set while `references[i]` has neither been decoded nor is in
+    // the buffer as part of the same temporal unit.
+    uint8_t references_blocking_decoding = 0;
   };
 
   using FrameMap = std::map<int64_t, FrameInfo>;
@@ -83,14 +90,30 @@ class FrameBuffer {
     FrameIterator last_frame;
   };
 
-  bool IsContinuous(const FrameIterator& it) const;
+  // Continuity and decodability are tracked incrementally: every frame keeps
+  // track of which of its references are still missing, and frames waiting
+  // for a reference are notified when it arrives, becomes continuous, is
+  // decoded or is dropped. This keeps the work per frame proportional to the
+  // number of frames it affects rather than to the size of the buffer.
   void PropagateContinuity(const FrameIterator& frame_it);
+  void OnFrameInserted(const FrameIterator& frame_it);
+  void OnFrameDecoded(int64_t frame_id);
+  void OnFrameDropped(int64_t frame_id, uint32_t rtp_timestamp);
+  FrameIterator FirstFrameInTemporalUnit(FrameIterator frame_it);
+  void UpdateTemporalUnit(FrameIterator frame_it);
+  void EraseFramesBefore(FrameIterator end_it);
   void FindNextAndLastDecodableTemporalUnit();
   void Clear();
 
   const bool legacy_frame_id_jump_behavior_;
   const size_t max_size_;
   FrameMap frames_;
+  // Frames referencing a frame that has not been decoded yet, keyed by the id
+  // of the referenced frame.
+  std::map<int64_t, absl::InlinedVector<int64_t, 4>> dependent_frames_;
+  // Ids of the last frame of every temporal unit in which all frames only
+  // reference decoded frames or frames of the same temporal unit.
+  std::set<int64_t> decodable_temporal_units_;
   absl::optional<TemporalUnit> next_decodable_temporal_unit_;
   absl::optional<DecodabilityInfo> decodable_temporal_units_info_;
   absl::optional<int64_t> last_continuous_frame_id_;
@@ -0,0 +1,150 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "api/video/encoded_frame.h"
+#include "api/video/frame_buffer.h"
+#include "benchmark/benchmark.h"
+#include "rtc_base/random.h"
+#include "rtc_base/system/unused.h"
+#include "test/fake_encoded_frame.h"
+#include "test/scoped_key_value_config.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kNumSpatialLayers = 3;
+constexpr int kNumTemporalLayers = 3;
+constexpr int kNumTemporalUnits = 300;
+// 60 fps.
+constexpr uint32_t kRtpTicksPerTemporalUnit = 1500;
+
+struct FrameDescription {
+  int64_t id;
+  uint32_t rtp_timestamp;
+  int spatial_layer;
+  std::vector<int64_t> references;
+};
+
+// L3T3 with the temporal pattern 0-2-1-2. Every frame references the spatial
+// layer below it in the same temporal unit and its own spatial layer in the
+// most recent temporal unit of a lower temporal layer (or the same one for
+// the base layer).
+std::vector<FrameDescription> CreateL3T3Stream() {
+  static constexpr int kTemporalPattern[] = {0, 2, 1, 2};
+  std::vector<FrameDescription> frames;
+  // Id of the last frame per spatial and temporal layer, -1 if none.
+  int64_t last_frame_ids[kNumSpatialLayers][kNumTemporalLayers];
+  std::fill(&last_frame_ids[0][0],
+            &last_frame_ids[0][0] + kNumSpatialLayers * kNumTemporalLayers,
+            -1);
+
+  for (int unit = 0; unit < kNumTemporalUnits; ++unit) {
+    const int temporal_layer = kTemporalPattern[unit % 4];
+    for (int spatial_layer = 0; spatial_layer < kNumSpatialLayers;
+         ++spatial_layer) {
+      FrameDescription frame{
+          .id = int64_t{unit} * kNumSpatialLayers + spatial_layer,
+          .rtp_timestamp = unit * kRtpTicksPerTemporalUnit,
+          .spatial_layer = spatial_layer};
+      if (spatial_layer > 0) {
+        frame.references.push_back(frame.id - 1);
+      }
+      int64_t temporal_reference = -1;
+      for (int tid = 0; tid <= std::max(temporal_layer - 1, 0); ++tid) {
+        temporal_reference =
+            std::max(temporal_reference, last_frame_ids[spatial_layer][tid]);
+      }
+      if (temporal_reference >= 0) {
+        frame.references.push_back(temporal_reference);
+      }
+      last_frame_ids[spatial_layer][temporal_layer] = frame.id;
+      frames.push_back(std::move(frame));
+    }
+  }
+  return frames;
+}
+
+// Shuffles frames within consecutive windows of `window_size` frames.
+void Reorder(std::vector<FrameDescription>& frames, int window_size) {
+  Random random(/*seed=*/42);
+  for (size_t start = 0; window_size > 1 && start < frames.size();
+       start += window_size) {
+    const size_t end = std::min(frames.size(), start + window_size);
+    for (size_t i = end - 1; i > start; --i) {
+      std::swap(frames[i],
+                frames[start + random.Rand(static_cast<uint32_t>(i - start))]);
+    }
+  }
+}
+
+std::vector<std::unique_ptr<EncodedFrame>> BuildFrames(
+    const std::vector<FrameDescription>& descriptions) {
+  std::vector<std::unique_ptr<EncodedFrame>> frames;
+  frames.reserve(descriptions.size());
+  for (const FrameDescription& description : descriptions) {
+    test::FakeFrameBuilder builder;
+    builder.Id(description.id)
+        .Time(description.rtp_timestamp)
+        .SpatialLayer(description.spatial_layer)
+        .Refs(description.references);
+    if (description.spatial_layer == kNumSpatialLayers - 1) {
+      builder.AsLast();
+    }
+    frames.push_back(builder.Build());
+  }
+  return frames;
+}
+
+// Inserts an L3T3 stream reordered within windows of `state.range(0)` frames
+// and extracts decodable temporal units whenever more than `state.range(1)`
+// frames are buffered, i.e. while waiting for their render time.
+void BM_InsertAndExtractL3T3(benchmark::State& state) {
+  const int reorder_window = static_cast<int>(state.range(0));
+  const size_t buffered_frames = static_cast<size_t>(state.range(1));
+  std::vector<FrameDescription> stream = CreateL3T3Stream();
+  Reorder(stream, reorder_window);
+  test::ScopedKeyValueConfig field_trials;
+
+  for (auto s : state) {
+    RTC_UNUSED(s);
+    state.PauseTiming();
+    std::vector<std::unique_ptr<EncodedFrame>> frames = BuildFrames(stream);
+    FrameBuffer buffer(/*max_size=*/800, /*max_decode_history=*/1000,
+                       field_trials);
+    state.ResumeTiming();
+
+    for (std::unique_ptr<EncodedFrame>& frame : frames) {
+      buffer.InsertFrame(std::move(frame));
+      while (buffer.CurrentSize() > buffered_frames &&
+             buffer.DecodableTemporalUnitsInfo()) {
+        auto temporal_unit = buffer.ExtractNextDecodableTemporalUnit();
+        benchmark::DoNotOptimize(temporal_unit);
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(stream.size()));
+}
+
+BENCHMARK(BM_InsertAndExtractL3T3)
+    ->Args({/*reorder_window=*/0, /*buffered_frames=*/9})
+    ->Args({/*reorder_window=*/0, /*buffered_frames=*/90})
+    ->Args({/*reorder_window=*/8, /*buffered_frames=*/9})
+    ->Args({/*reorder_window=*/8, /*buffered_frames=*/90})
+    ->Args({/*reorder_window=*/32, /*buffered_frames=*/90})
+    ->Args({/*reorder_window=*/128, /*buffered_frames=*/270});
+
+}  // namespace
+}  // namespace webrtc
@@ -261,6 +261,51 @@ TEST(FrameBuffer3Test, ReturnFullTemporalUnitKSVC) {
               ElementsAre(FrameWithId(4)));
 }
 
+TEST(FrameBuffer3Test, ReturnFullTemporalUnitKSVCReordered) {
+  test::ScopedKeyValueConfig field_trials;
+  FrameBuffer buffer(/*max_frame_slots=*/10, /*max_decode_history=*/100,
+                     field_trials);
+  EXPECT_TRUE(buffer.InsertFrame(
+      test::FakeFrameBuilder().Time(10).Id(3).Refs({2}).AsLast().Build()));
+  EXPECT_TRUE(buffer.InsertFrame(
+      test::FakeFrameBuilder().Time(10).Id(2).Refs({1}).Build()));
+  EXPECT_THAT(buffer.DecodableTemporalUnitsInfo(), Eq(absl::nullopt));
+
+  EXPECT_TRUE(
+      buffer.InsertFrame(test::FakeFrameBuilder().Time(10).Id(1).Build()));
+  EXPECT_THAT(buffer.LastContinuousTemporalUnitFrameId(), Eq(3));
+  EXPECT_THAT(buffer.ExtractNextDecodableTemporalUnit(),
+              ElementsAre(FrameWithId(1), FrameWithId(2), FrameWithId(3)));
+}
+
+TEST(FrameBuffer3Test, ContinuityPropagatesThroughReorderedChain) {
+  test::ScopedKeyValueConfig field_trials;
+  FrameBuffer buffer(/*max_frame_slots=*/10, /*max_decode_history=*/100,
+                     field_trials);
+  for (int64_t id = 6; id > 1; --id) {
+    EXPECT_TRUE(buffer.InsertFrame(test::FakeFrameBuilder()
+                                       .Time(10 * id)
+                                       .Id(id)
+                                       .Refs({id - 1})
+                                       .AsLast()
+                                       .Build()));
+  }
+  EXPECT_THAT(buffer.LastContinuousFrameId(), Eq(absl::nullopt));
+
+  EXPECT_TRUE(buffer.InsertFrame(
+      test::FakeFrameBuilder().Time(10).Id(1).AsLast().Build()));
+  EXPECT_THAT(buffer.LastContinuousFrameId(), Eq(6));
+  EXPECT_THAT(buffer.GetTotalNumberOfContinuousTemporalUnits(), Eq(6));
+  EXPECT_THAT(buffer.DecodableTemporalUnitsInfo()->next_rtp_timestamp, Eq(10U));
+  EXPECT_THAT(buffer.DecodableTemporalUnitsInfo()->last_rtp_timestamp, Eq(10U));
+
+  for (int64_t id = 1; id <= 6; ++id) {
+    EXPECT_THAT(buffer.ExtractNextDecodableTemporalUnit(),
+                ElementsAre(FrameWithId(id)));
+  }
+  EXPECT_THAT(buffer.CurrentSize(), Eq(0U));
+}
+
 TEST(FrameBuffer3Test, InterleavedStream) {
   test::ScopedKeyValueConfig field_trials;
   FrameBuffer buffer(/*max_frame_slots=*/10, /*max_decode_history=*/100,
@@ -42,9 +42,9 @@ I010Buffer::I010Buffer(int width,
       stride_y_(stride_y),
       stride_u_(stride_u),
       stride_v_(stride_v),
-      data_(static_cast<uint16_t*>(
-          AlignedMalloc(I010DataSize(height, stride_y, stride_u, stride_v),
-                        kBufferAlignment))) {
+      data_(static_cast<uint16_t*>(FrameMemoryPool::Global().Allocate(
+          I010DataSize(height, stride_y, stride_u, stride_v),
+          kBufferAlignment))) {
   RTC_DCHECK_GT(width, 0);
   RTC_DCHECK_GT(height, 0);
   RTC_DCHECK_GE(stride_y, width);
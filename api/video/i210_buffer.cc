@@ -43,9 +43,9 @@ I210Buffer::I210Buffer(int width,
       stride_y_(stride_y),
       stride_u_(stride_u),
       stride_v_(stride_v),
-      data_(static_cast<uint16_t*>(
-          AlignedMalloc(I210DataSize(height, stride_y, stride_u, stride_v),
-                        kBufferAlignment))) {
+      data_(static_cast<uint16_t*>(FrameMemoryPool::Global().Allocate(
+          I210DataSize(height, stride_y, stride_u, stride_v),
+          kBufferAlignment))) {
   RTC_DCHECK_GT(width, 0);
   RTC_DCHECK_GT(height, 0);
   RTC_DCHECK_GE(stride_y, width);
@@ -18,7 +18,7 @@
 #include "api/scoped_refptr.h"
 #include "api/video/video_frame_buffer.h"
 #include "api/video/video_rotation.h"
-#include "rtc_base/memory/aligned_malloc.h"
+#include "rtc_base/memory/frame_memory_pool.h"
 
 namespace webrtc {
 
@@ -76,7 +76,7 @@ class I210Buffer : public I210BufferInterface {
   const int stride_y_;
   const int stride_u_;
   const int stride_v_;
-  const std::unique_ptr<uint16_t, AlignedFreeDeleter> data_;
+  const std::unique_ptr<uint16_t, FrameMemoryPoolDeleter> data_;
 };
 
 }  // namespace webrtc
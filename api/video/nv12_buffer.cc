@@ -36,9 +36,9 @@ NV12Buffer::NV12Buffer(int width, int height, int stride_y, int stride_uv)
       height_(height),
       stride_y_(stride_y),
       stride_uv_(stride_uv),
-      data_(static_cast<uint8_t*>(
-          AlignedMalloc(NV12DataSize(height_, stride_y_, stride_uv),
-                        kBufferAlignment))) {
+      data_(static_cast<uint8_t*>(FrameMemoryPool::Global().Allocate(
+          NV12DataSize(height_, stride_y_, stride_uv),
+          kBufferAlignment))) {
   RTC_DCHECK_GT(width, 0);
   RTC_DCHECK_GT(height, 0);
   RTC_DCHECK_GE(stride_y, width);
@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "api/video/encoded_image.h"
+
+#include <string.h>
+
+#include "rtc_base/memory/frame_memory_pool.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+TEST(EncodedImageBufferTest, ReallocPreservesData) {
+  const uint8_t kData[] = {1, 2, 3, 4, 5, 6, 7, 8};
+  auto buffer = EncodedImageBuffer::Create(kData, sizeof(kData));
+
+  buffer->Realloc(100'000);
+  EXPECT_EQ(buffer->size(), 100'000u);
+  EXPECT_EQ(memcmp(buffer->data(), kData, sizeof(kData)), 0);
+
+  buffer->Realloc(4);
+  EXPECT_EQ(buffer->size(), 4u);
+  EXPECT_EQ(memcmp(buffer->data(), kData, 4), 0);
+}
+
+TEST(EncodedImageBufferTest, ReusesMemoryOfReleasedBufferWhenPooling) {
+  FrameMemoryPool& pool = FrameMemoryPool::Global();
+  pool.SetMaxCachedBytes(16 * 1024 * 1024);
+
+  auto buffer = EncodedImageBuffer::Create(20'000);
+  const uint8_t* data = buffer->data();
+  buffer = nullptr;
+  // A slightly larger frame of the next encode falls into the same size
+  // class.
+  buffer = EncodedImageBuffer::Create(20'400);
+  EXPECT_EQ(buffer->data(), data);
+  buffer = nullptr;
+
+  pool.SetMaxCachedBytes(0);
+  pool.Trim();
+}
+
+TEST(EncodedImageBufferTest, ReallocKeepsPooledBlockWhileSizeClassFits) {
+  FrameMemoryPool& pool = FrameMemoryPool::Global();
+  pool.SetMaxCachedBytes(16 * 1024 * 1024);
+
+  auto buffer = EncodedImageBuffer::Create(20'000);
+  const uint8_t* data = buffer->data();
+  buffer->Realloc(20'400);
+  EXPECT_EQ(buffer->data(), data);
+  EXPECT_EQ(buffer->size(), 20'400u);
+  buffer->Realloc(1'000'000);
+  EXPECT_NE(buffer->data(), data);
+  buffer = nullptr;
+
+  pool.SetMaxCachedBytes(0);
+  pool.Trim();
+}
+
+TEST(EncodedImageBufferTest, DoesNotPoolWhilePoolingIsDisabled) {
+  FrameMemoryPool& pool = FrameMemoryPool::Global();
+  ASSERT_FALSE(pool.enabled());
+
+  auto buffer = EncodedImageBuffer::Create(20'000);
+  buffer->Realloc(40'000);
+  buffer = nullptr;
+  EncodedImageBuffer::Create(0);
+  EXPECT_EQ(pool.cached_bytes(), 0u);
+}
+
+}  // namespace
+}  // namespace webrtc
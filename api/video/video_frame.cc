@@ -166,7 +166,7 @@ VideoFrame VideoFrame::Builder::build() {
   return VideoFrame(id_, video_frame_buffer_, timestamp_us_,
                     capture_time_identifier_, reference_time_, timestamp_rtp_,
                     ntp_time_ms_, rotation_, color_space_, render_parameters_,
-                    update_rect_, packet_infos_);
+                    update_rect_, quality_regions_, packet_infos_);
 }
 
 VideoFrame::Builder& VideoFrame::Builder::set_video_frame_buffer(
@@ -245,6 +245,12 @@ VideoFrame::Builder& VideoFrame::Builder::set_update_rect(
   return *this;
 }
 
+VideoFrame::Builder& VideoFrame::Builder::set_quality_regions(
+    std::vector<QualityRegion> quality_regions) {
+  quality_regions_ = std::move(quality_regions);
+  return *this;
+}
+
 VideoFrame::Builder& VideoFrame::Builder::set_packet_infos(
     RtpPacketInfos packet_infos) {
   packet_infos_ = std::move(packet_infos);
@@ -283,6 +289,7 @@ VideoFrame::VideoFrame(uint16_t id,
                        const absl::optional<ColorSpace>& color_space,
                        const RenderParameters& render_parameters,
                        const absl::optional<UpdateRect>& update_rect,
+                       std::vector<QualityRegion> quality_regions,
                        RtpPacketInfos packet_infos)
     : id_(id),
       video_frame_buffer_(buffer),
@@ -295,6 +302,7 @@ VideoFrame::VideoFrame(uint16_t id,
       color_space_(color_space),
       render_parameters_(render_parameters),
       update_rect_(update_rect),
+      quality_regions_(std::move(quality_regions)),
       packet_infos_(std::move(packet_infos)) {
   if (update_rect_) {
     RTC_DCHECK_GE(update_rect_->offset_x, 0);
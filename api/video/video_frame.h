@@ -14,6 +14,7 @@
 #include <stdint.h>
 
 #include <utility>
+#include <vector>
 
 #include "absl/types/optional.h"
 #include "api/rtp_packet_infos.h"
@@ -75,6 +76,31 @@ class RTC_EXPORT VideoFrame {
                               int scaled_height) const;
   };
 
+  // Part of a frame the encoder should spend more or fewer bits on, e.g. a
+  // face or the background. Coordinates are fractions of the frame size, so
+  // that regions stay valid when the frame is scaled on its way to the
+  // encoder.
+  struct RTC_EXPORT QualityRegion {
+    bool operator==(const QualityRegion& other) const {
+      return x == other.x && y == other.y && width == other.width &&
+             height == other.height && qp_delta == other.qp_delta &&
+             skip == other.skip;
+    }
+    bool operator!=(const QualityRegion& other) const {
+      return !(*this == other);
+    }
+
+    double x = 0.0;
+    double y = 0.0;
+    double width = 0.0;
+    double height = 0.0;
+    // Added to the QP of the region, on the 0-63 scale of
+    // VideoCodec::qpMax. Negative values raise the quality.
+    int qp_delta = 0;
+    // The region is not coded and keeps the content of the previous frame.
+    bool skip = false;
+  };
+
   struct RTC_EXPORT ProcessingTime {
     TimeDelta Elapsed() const { return finish - start; }
     Timestamp start;
@@ -120,6 +146,7 @@ class RTC_EXPORT VideoFrame {
     Builder& set_color_space(const ColorSpace* color_space);
     Builder& set_id(uint16_t id);
     Builder& set_update_rect(const absl::optional<UpdateRect>& update_rect);
+    Builder& set_quality_regions(std::vector<QualityRegion> quality_regions);
     Builder& set_packet_infos(RtpPacketInfos packet_infos);
 
    private:
@@ -134,6 +161,7 @@ class RTC_EXPORT VideoFrame {
     absl::optional<ColorSpace> color_space_;
     RenderParameters render_parameters_;
     absl::optional<UpdateRect> update_rect_;
+    std::vector<QualityRegion> quality_regions_;
     RtpPacketInfos packet_infos_;
   };
 
@@ -273,6 +301,16 @@ class RTC_EXPORT VideoFrame {
 
   void clear_update_rect() { update_rect_ = absl::nullopt; }
 
+  // Regions the encoder should encode at a different quality. Where regions
+  // overlap, the later one applies. Encoders that do not support regions of
+  // interest ignore them.
+  const std::vector<QualityRegion>& quality_regions() const {
+    return quality_regions_;
+  }
+  void set_quality_regions(std::vector<QualityRegion> quality_regions) {
+    quality_regions_ = std::move(quality_regions);
+  }
+
   // Get information about packets used to assemble this video frame. Might be
   // empty if the information isn't available.
   const RtpPacketInfos& packet_infos() const { return packet_infos_; }
@@ -299,6 +337,7 @@ class RTC_EXPORT VideoFrame {
              const absl::optional<ColorSpace>& color_space,
              const RenderParameters& render_parameters,
              const absl::optional<UpdateRect>& update_rect,
+             std::vector<QualityRegion> quality_regions,
              RtpPacketInfos packet_infos);
 
   uint16_t id_;
@@ -322,6 +361,7 @@ class RTC_EXPORT VideoFrame {
   // If absent, it means that there's no information about the change at all and
   // update_rect() will return a rectangle corresponding to the entire frame.
   absl::optional<UpdateRect> update_rect_;
+  std::vector<QualityRegion> quality_regions_;
   // Information about packets used to assemble this video frame. This is needed
   // by `SourceTracker` when the frame is delivered to the RTCRtpReceiver's
   // MediaStreamTrack, in order to implement getContributingSources(). See:
@@ -62,4 +62,9 @@ void VideoDecoder::Settings::set_number_of_cores(int value) {
   number_of_cores_ = value;
 }
 
+void VideoDecoder::Settings::set_decode_threads(absl::optional<int> value) {
+  RTC_DCHECK(!value.has_value() || *value > 0);
+  decode_threads_ = value;
+}
+
 }  // namespace webrtc
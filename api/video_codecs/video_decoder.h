@@ -85,10 +85,19 @@ class RTC_EXPORT VideoDecoder {
     VideoCodecType codec_type() const { return codec_type_; }
     void set_codec_type(VideoCodecType value) { codec_type_ = value; }
 
+    // Number of threads the decoder should use, e.g. as granted from a core
+    // budget shared by all receive streams. Decoders supporting it spread the
+    // threads over frame, tile and row parallelism as they see fit. If not
+    // present the decoder picks its own threading based on
+    // `number_of_cores()` and `max_render_resolution()`. Must be positive.
+    absl::optional<int> decode_threads() const { return decode_threads_; }
+    void set_decode_threads(absl::optional<int> value);
+
    private:
     absl::optional<int> buffer_pool_size_;
     RenderResolution max_resolution_;
     int number_of_cores_ = 1;
+    absl::optional<int> decode_threads_;
     VideoCodecType codec_type_ = kVideoCodecGeneric;
   };
 
@@ -13,6 +13,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <iterator>
 #include <memory>
 #include <utility>
 
@@ -319,7 +320,8 @@ std::map<BitrateAllocatorObserver*, int> ZeroRateAllocation(
 
 std::map<BitrateAllocatorObserver*, int> AllocateBitrates(
     const std::vector<AllocatableTrack>& allocatable_tracks,
-    uint32_t bitrate) {
+    uint32_t bitrate,
+    BitrateAllocationPolicy* allocation_policy) {
   if (allocatable_tracks.empty())
     return std::map<BitrateAllocatorObserver*, int>();
 
@@ -342,8 +344,13 @@ std::map<BitrateAllocatorObserver*, int> AllocateBitrates(
 
   // All observers will get their min bitrate plus a share of the rest. This
   // share is allocated to each observer based on its bitrate_priority.
-  if (bitrate <= sum_max_bitrates)
+  if (bitrate <= sum_max_bitrates) {
+    if (allocation_policy) {
+      return allocation_policy->Allocate(allocatable_tracks, bitrate,
+                                         sum_min_bitrates);
+    }
     return NormalRateAllocation(allocatable_tracks, bitrate, sum_min_bitrates);
+  }
 
   // All observers will get up to transmission_max_bitrate_multiplier_ x max.
   return MaxRateAllocation(allocatable_tracks, bitrate, sum_max_bitrates);
@@ -352,7 +359,13 @@ std::map<BitrateAllocatorObserver*, int> AllocateBitrates(
 }  // namespace
 
 BitrateAllocator::BitrateAllocator(LimitObserver* limit_observer)
+    : BitrateAllocator(limit_observer, nullptr) {}
+
+BitrateAllocator::BitrateAllocator(
+    LimitObserver* limit_observer,
+    std::unique_ptr<BitrateAllocationPolicy> allocation_policy)
     : limit_observer_(limit_observer),
+      allocation_policy_(std::move(allocation_policy)),
       last_target_bps_(0),
       last_stable_target_bps_(0),
       last_non_zero_bitrate_bps_(kDefaultBitrateBps),
@@ -394,9 +407,11 @@ void BitrateAllocator::OnNetworkEstimateChanged(TargetTransferRate msg) {
     last_bwe_log_time_ = now;
   }
 
-  auto allocation = AllocateBitrates(allocatable_tracks_, last_target_bps_);
+  auto allocation = AllocateBitrates(allocatable_tracks_, last_target_bps_,
+                                     allocation_policy_.get());
   auto stable_bitrate_allocation =
-      AllocateBitrates(allocatable_tracks_, last_stable_target_bps_);
+      AllocateBitrates(allocatable_tracks_, last_stable_target_bps_,
+                       allocation_policy_.get());
 
   for (auto& config : allocatable_tracks_) {
     uint32_t allocated_bitrate = allocation[config.observer];
@@ -456,14 +471,19 @@ void BitrateAllocator::AddObserver(BitrateAllocatorObserver* observer,
     it->config = config;
   } else {
     allocatable_tracks_.push_back(AllocatableTrack(observer, config));
+    it = std::prev(allocatable_tracks_.end());
   }
+  if (allocation_policy_)
+    allocation_policy_->OnTrackChanged(*it);
 
   if (last_target_bps_ > 0) {
     // Calculate a new allocation and update all observers.
 
-    auto allocation = AllocateBitrates(allocatable_tracks_, last_target_bps_);
+    auto allocation = AllocateBitrates(allocatable_tracks_, last_target_bps_,
+                                       allocation_policy_.get());
     auto stable_bitrate_allocation =
-        AllocateBitrates(allocatable_tracks_, last_stable_target_bps_);
+        AllocateBitrates(allocatable_tracks_, last_stable_target_bps_,
+                         allocation_policy_.get());
     for (auto& config : allocatable_tracks_) {
       uint32_t allocated_bitrate = allocation[config.observer];
       uint32_t allocated_stable_bitrate =
@@ -535,6 +555,8 @@ void BitrateAllocator::RemoveObserver(BitrateAllocatorObserver* observer) {
        ++it) {
     if (it->observer == observer) {
       allocatable_tracks_.erase(it);
+      if (allocation_policy_)
+        allocation_policy_->OnTrackRemoved(observer);
       break;
     }
   }
@@ -42,6 +42,13 @@ class BitrateAllocatorObserver {
   virtual ~BitrateAllocatorObserver() {}
 };
 
+// A point on the utility curve of a media stream, i.e. the utility, such as an
+// estimate of the resulting quality, of allocating `bitrate_bps` to it.
+struct BitrateUtilityPoint {
+  uint32_t bitrate_bps;
+  double utility;
+};
+
 // Struct describing parameters for how a media stream should get bitrate
 // allocated to it.
 
@@ -61,6 +68,10 @@ struct MediaStreamAllocationConfig {
   // observers. If an observer has twice the bitrate_priority of other
   // observers, it should be allocated twice the bitrate above its min.
   double bitrate_priority;
+  // Optional utility curve sorted by increasing bitrate, e.g. with one point
+  // per simulcast layer. Only used if the BitrateAllocator is created with a
+  // UtilityBitrateAllocationPolicy, see kUtilityBitrateAllocationFieldTrial.
+  std::vector<BitrateUtilityPoint> utility_curve;
 };
 
 // Interface used for mocking
@@ -95,6 +106,32 @@ struct AllocatableTrack {
 };
 }  // namespace bitrate_allocator_impl
 
+// Decides how to split the bitrate between tracks when there is enough to
+// allocate the min bitrate to every track but not enough to allocate the max
+// bitrate to every track. Pausing tracks below their min bitrate and
+// distributing bitrate above the max of all tracks is handled by the
+// BitrateAllocator regardless of policy.
+class BitrateAllocationPolicy {
+ public:
+  virtual ~BitrateAllocationPolicy() = default;
+
+  // Called when a track is added or its config changes, and when a track is
+  // removed. Lets the policy maintain state derived from the track configs
+  // incrementally instead of rebuilding it on every allocation.
+  virtual void OnTrackChanged(
+      const bitrate_allocator_impl::AllocatableTrack& track) {}
+  virtual void OnTrackRemoved(BitrateAllocatorObserver* observer) {}
+
+  // Returns the bitrate allocated to the observer of each track in
+  // `allocatable_tracks`. `bitrate` is at least `sum_min_bitrates` and at most
+  // the sum of max bitrates of all tracks.
+  virtual std::map<BitrateAllocatorObserver*, int> Allocate(
+      const std::vector<bitrate_allocator_impl::AllocatableTrack>&
+          allocatable_tracks,
+      uint32_t bitrate,
+      uint32_t sum_min_bitrates) = 0;
+};
+
 // Usage: this class will register multiple RtcpBitrateObserver's one at each
 // RTCP module. It will aggregate the results and run one bandwidth estimation
 // and push the result to the encoders via BitrateAllocatorObserver(s).
@@ -111,6 +148,10 @@ class BitrateAllocator : public BitrateAllocatorInterface {
   };
 
   explicit BitrateAllocator(LimitObserver* limit_observer);
+  // If `allocation_policy` is null the bitrate is distributed according to
+  // the priority bitrate and bitrate priority of each track.
+  BitrateAllocator(LimitObserver* limit_observer,
+                   std::unique_ptr<BitrateAllocationPolicy> allocation_policy);
   ~BitrateAllocator() override;
 
   void UpdateStartRate(uint32_t start_rate_bps);
@@ -151,6 +192,8 @@ class BitrateAllocator : public BitrateAllocatorInterface {
 
   RTC_NO_UNIQUE_ADDRESS SequenceChecker sequenced_checker_;
   LimitObserver* const limit_observer_ RTC_GUARDED_BY(&sequenced_checker_);
+  const std::unique_ptr<BitrateAllocationPolicy> allocation_policy_
+      RTC_GUARDED_BY(&sequenced_checker_);
   // Stored in a list to keep track of the insertion order.
   std::vector<AllocatableTrack> allocatable_tracks_
       RTC_GUARDED_BY(&sequenced_checker_);
@@ -24,6 +24,7 @@
 #include "absl/functional/bind_front.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
+#include "api/field_trials_view.h"
 #include "api/media_types.h"
 #include "api/rtc_event_log/rtc_event_log.h"
 #include "api/sequence_checker.h"
@@ -40,6 +41,7 @@
 #include "call/rtp_stream_receiver_controller.h"
 #include "call/rtp_transport_controller_send.h"
 #include "call/rtp_transport_controller_send_factory.h"
+#include "call/utility_bitrate_allocation_policy.h"
 #include "call/version.h"
 #include "logging/rtc_event_log/events/rtc_event_audio_receive_stream_config.h"
 #include "logging/rtc_event_log/events/rtc_event_rtcp_packet_incoming.h"
@@ -48,6 +50,7 @@
 #include "logging/rtc_event_log/events/rtc_event_video_send_stream_config.h"
 #include "logging/rtc_event_log/rtc_stream_config.h"
 #include "modules/congestion_controller/include/receive_side_congestion_controller.h"
+#include "modules/remote_bitrate_estimator/batched_feedback_generator.h"
 #include "modules/rtp_rtcp/include/flexfec_receiver.h"
 #include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
 #include "modules/rtp_rtcp/source/byte_io.h"
@@ -76,6 +79,14 @@ namespace webrtc {
 
 namespace {
 
+std::unique_ptr<BitrateAllocationPolicy> CreateBitrateAllocationPolicy(
+    const FieldTrialsView& field_trials) {
+  if (field_trials.IsEnabled(kUtilityBitrateAllocationFieldTrial)) {
+    return std::make_unique<UtilityBitrateAllocationPolicy>();
+  }
+  return nullptr;
+}
+
 const int* FindKeyByValue(const std::map<int, int>& m, int v) {
   for (const auto& kv : m) {
     if (kv.second == v)
@@ -659,7 +670,9 @@ Call::Call(const CallConfig& config,
               : nullptr),
       num_cpu_cores_(CpuInfo::DetectNumberOfCores()),
       call_stats_(new CallStats(&env_.clock(), worker_thread_)),
-      bitrate_allocator_(new BitrateAllocator(this)),
+      bitrate_allocator_(new BitrateAllocator(
+          this,
+          CreateBitrateAllocationPolicy(config.env.field_trials()))),
       config_(config),
       audio_network_state_(kNetworkDown),
       video_network_state_(kNetworkDown),
@@ -690,6 +703,11 @@ Call::Call(const CallConfig& config,
   LoadWebRTCVersionInRegister();
 
   call_stats_->RegisterStatsObserver(&receive_side_cc_);
+  RTC_DCHECK(!config.transport_feedback_generator ||
+             config.transport_feedback_generator->task_queue() ==
+                 worker_thread_);
+  receive_side_cc_.SetBatchedFeedbackGenerator(
+      config.transport_feedback_generator);
 
   ReceiveSideCongestionController* receive_side_cc = &receive_side_cc_;
   receive_side_cc_periodic_task_ = RepeatingTaskHandle::Start(
@@ -708,6 +726,7 @@ Call::~Call() {
   RTC_CHECK(video_receive_streams_.empty());
 
   receive_side_cc_periodic_task_.Stop();
+  receive_side_cc_.SetBatchedFeedbackGenerator(nullptr);
   call_stats_->DeregisterStatsObserver(&receive_side_cc_);
   send_stats_.SetFirstPacketTime(transport_send_->GetFirstPacketTime());
 
@@ -24,6 +24,7 @@
 namespace webrtc {
 
 class AudioProcessing;
+class BatchedFeedbackGenerator;
 
 struct CallConfig {
   // If `network_task_queue` is set to nullptr, Call will assume that network
@@ -71,6 +72,12 @@ struct CallConfig {
   Metronome* decode_metronome = nullptr;
   Metronome* encode_metronome = nullptr;
 
+  // Optional generator, possibly shared between many calls, that sends the
+  // periodic transport feedback of this call's receive side congestion
+  // controller on a shared timer. Must outlive the call, and run on the
+  // call's worker thread.
+  BatchedFeedbackGenerator* transport_feedback_generator = nullptr;
+
   // The burst interval of the pacer, see TaskQueuePacedSender constructor.
   absl::optional<TimeDelta> pacer_burst_interval;
 
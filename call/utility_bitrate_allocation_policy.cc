@@ -0,0 +1,225 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "call/utility_bitrate_allocation_policy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/numerics/safe_conversions.h"
+
+namespace webrtc {
+
+namespace {
+using bitrate_allocator_impl::AllocatableTrack;
+
+// Number of linear pieces used to approximate the default logarithmic utility
+// of tracks without a utility curve.
+constexpr int kNumDefaultUtilitySegments = 8;
+// Offset keeping the default logarithmic utility finite at zero bitrate.
+constexpr double kDefaultUtilityOffsetBps = 10000;
+// Segments with marginal utilities this close, relative to their magnitude,
+// share the bitrate evenly, e.g. when several tracks have the same config.
+constexpr double kRelativeUtilityTolerance = 1e-9;
+
+struct UtilityPoint {
+  double bitrate_bps;
+  double utility;
+};
+
+// Returns the utility at `bitrate_bps`, interpolating linearly between the
+// points of `curve`. The utility is assumed to grow linearly from zero to the
+// first point and to stay constant after the last point.
+double InterpolateUtility(const std::vector<BitrateUtilityPoint>& curve,
+                          uint32_t bitrate_bps) {
+  RTC_DCHECK(!curve.empty());
+  if (bitrate_bps <= curve.front().bitrate_bps) {
+    if (curve.front().bitrate_bps == 0)
+      return curve.front().utility;
+    return curve.front().utility * bitrate_bps / curve.front().bitrate_bps;
+  }
+  for (size_t i = 1; i < curve.size(); ++i) {
+    if (bitrate_bps <= curve[i].bitrate_bps) {
+      const BitrateUtilityPoint& low = curve[i - 1];
+      const BitrateUtilityPoint& high = curve[i];
+      double fraction = static_cast<double>(bitrate_bps - low.bitrate_bps) /
+                        (high.bitrate_bps - low.bitrate_bps);
+      return low.utility + fraction * (high.utility - low.utility);
+    }
+  }
+  return curve.back().utility;
+}
+
+// Returns points on the utility curve of `config` between its min and max
+// bitrate, sorted by increasing bitrate.
+std::vector<UtilityPoint> UtilityPoints(
+    const MediaStreamAllocationConfig& config) {
+  const uint32_t min_bps = config.min_bitrate_bps;
+  const uint32_t max_bps = config.max_bitrate_bps;
+  std::vector<UtilityPoint> points;
+  if (config.utility_curve.empty()) {
+    // Maximizing the sum of logarithmic utilities gives each track a share of
+    // the bitrate proportional to its bitrate priority.
+    const double low = min_bps + kDefaultUtilityOffsetBps;
+    const double high = max_bps + kDefaultUtilityOffsetBps;
+    for (int i = 0; i <= kNumDefaultUtilitySegments; ++i) {
+      double bitrate =
+          low * std::pow(high / low,
+                         static_cast<double>(i) / kNumDefaultUtilitySegments);
+      points.push_back({bitrate - kDefaultUtilityOffsetBps, std::log(bitrate)});
+    }
+  } else {
+    points.push_back(
+        {static_cast<double>(min_bps),
+         InterpolateUtility(config.utility_curve, min_bps)});
+    for (const BitrateUtilityPoint& point : config.utility_curve) {
+      if (point.bitrate_bps > min_bps && point.bitrate_bps < max_bps)
+        points.push_back({static_cast<double>(point.bitrate_bps),
+                          point.utility});
+    }
+    points.push_back(
+        {static_cast<double>(max_bps),
+         InterpolateUtility(config.utility_curve, max_bps)});
+  }
+  for (UtilityPoint& point : points)
+    point.utility *= config.bitrate_priority;
+  return points;
+}
+
+double Slope(const UtilityPoint& from, const UtilityPoint& to) {
+  return (to.utility - from.utility) / (to.bitrate_bps - from.bitrate_bps);
+}
+
+bool SimilarUtility(double a, double b) {
+  return std::abs(a - b) <=
+         kRelativeUtilityTolerance * std::max(std::abs(a), std::abs(b));
+}
+
+}  // namespace
+
+UtilityBitrateAllocationPolicy::UtilityBitrateAllocationPolicy() = default;
+UtilityBitrateAllocationPolicy::~UtilityBitrateAllocationPolicy() = default;
+
+void UtilityBitrateAllocationPolicy::OnTrackChanged(
+    const AllocatableTrack& track) {
+  OnTrackRemoved(track.observer);
+  if (track.config.max_bitrate_bps <= track.config.min_bitrate_bps)
+    return;
+
+  // Upper concave hull of the utility points, with strictly decreasing slopes.
+  std::vector<UtilityPoint> hull;
+  for (const UtilityPoint& point : UtilityPoints(track.config)) {
+    if (!hull.empty() && point.bitrate_bps <= hull.back().bitrate_bps) {
+      hull.back().utility = std::max(hull.back().utility, point.utility);
+      continue;
+    }
+    while (hull.size() >= 2 &&
+           Slope(hull[hull.size() - 2], hull.back()) <=
+               Slope(hull.back(), point)) {
+      hull.pop_back();
+    }
+    hull.push_back(point);
+  }
+
+  for (size_t i = 1; i < hull.size(); ++i) {
+    Segment segment{track.observer,
+                    static_cast<uint32_t>(std::lround(hull[i - 1].bitrate_bps)),
+                    static_cast<uint32_t>(std::lround(hull[i].bitrate_bps)),
+                    Slope(hull[i - 1], hull[i])};
+    if (segment.end_bps <= segment.start_bps)
+      continue;
+    // Segments of the same track are inserted in order of decreasing marginal
+    // utility, so they stay ordered by bitrate.
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), segment,
+                               [](const Segment& a, const Segment& b) {
+                                 return a.marginal_utility > b.marginal_utility;
+                               });
+    segments_.insert(it, segment);
+  }
+}
+
+void UtilityBitrateAllocationPolicy::OnTrackRemoved(
+    BitrateAllocatorObserver* observer) {
+  segments_.erase(std::remove_if(segments_.begin(), segments_.end(),
+                                 [observer](const Segment& segment) {
+                                   return segment.observer == observer;
+                                 }),
+                  segments_.end());
+}
+
+std::map<BitrateAllocatorObserver*, int>
+UtilityBitrateAllocationPolicy::Allocate(
+    const std::vector<AllocatableTrack>& allocatable_tracks,
+    uint32_t bitrate,
+    uint32_t sum_min_bitrates) {
+  RTC_DCHECK_GE(bitrate, sum_min_bitrates);
+  std::map<BitrateAllocatorObserver*, int> allocation;
+  for (const auto& observer_config : allocatable_tracks) {
+    allocation[observer_config.observer] =
+        observer_config.config.min_bitrate_bps;
+  }
+  int64_t remaining_bitrate = bitrate - sum_min_bitrates;
+
+  // Priority bitrate is allocated first, as with the default allocation.
+  for (const auto& observer_config : allocatable_tracks) {
+    int64_t priority_margin = observer_config.config.priority_bitrate_bps -
+                              allocation[observer_config.observer];
+    if (priority_margin > 0 && remaining_bitrate > 0) {
+      int64_t extra_bitrate = std::min(priority_margin, remaining_bitrate);
+      allocation[observer_config.observer] +=
+          rtc::dchecked_cast<int>(extra_bitrate);
+      remaining_bitrate -= extra_bitrate;
+    }
+  }
+
+  // Fill the segments in order of decreasing marginal utility. Segments with
+  // the same marginal utility are filled together, in proportion to how much
+  // bitrate they still can take.
+  size_t group_begin = 0;
+  std::vector<std::pair<int*, int64_t>> group_needs;
+  while (remaining_bitrate > 0 && group_begin < segments_.size()) {
+    size_t group_end = group_begin;
+    int64_t group_need = 0;
+    group_needs.clear();
+    while (group_end < segments_.size() &&
+           SimilarUtility(segments_[group_begin].marginal_utility,
+                          segments_[group_end].marginal_utility)) {
+      const Segment& segment = segments_[group_end++];
+      auto it = allocation.find(segment.observer);
+      if (it == allocation.end()) {
+        RTC_DCHECK_NOTREACHED() << "Segment for unknown observer.";
+        continue;
+      }
+      int64_t need = static_cast<int64_t>(segment.end_bps) -
+                     std::max<int64_t>(segment.start_bps, it->second);
+      if (need > 0) {
+        group_needs.emplace_back(&it->second, need);
+        group_need += need;
+      }
+    }
+    if (group_need <= remaining_bitrate) {
+      for (auto& [allocated, need] : group_needs)
+        *allocated += rtc::dchecked_cast<int>(need);
+      remaining_bitrate -= group_need;
+    } else {
+      for (auto& [allocated, need] : group_needs) {
+        *allocated +=
+            rtc::dchecked_cast<int>(need * remaining_bitrate / group_need);
+      }
+      remaining_bitrate = 0;
+    }
+    group_begin = group_end;
+  }
+  return allocation;
+}
+
+}  // namespace webrtc
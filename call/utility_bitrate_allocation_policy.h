@@ -0,0 +1,70 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef CALL_UTILITY_BITRATE_ALLOCATION_POLICY_H_
+#define CALL_UTILITY_BITRATE_ALLOCATION_POLICY_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <vector>
+
+#include "call/bitrate_allocator.h"
+
+namespace webrtc {
+
+// Field trial that makes Call allocate bitrate with the
+// UtilityBitrateAllocationPolicy, and video send streams report a utility
+// curve with one point per simulcast stream.
+inline constexpr char kUtilityBitrateAllocationFieldTrial[] =
+    "WebRTC-Bwe-UtilityBasedAllocation";
+
+// Allocates bitrate so that the sum of the utility of all tracks, weighted by
+// their bitrate priority, is maximized. Each track's utility curve is replaced
+// by its upper concave hull, which makes greedily allocating bitrate to the
+// segment with the highest marginal utility per bps optimal. Tracks without a
+// utility curve get a logarithmic one, which shares bitrate between them in
+// proportion to their bitrate priority.
+//
+// The hull segments of all tracks are kept sorted by marginal utility and are
+// only recomputed for a track when its config changes, so each allocation is
+// a single pass over the segments.
+class UtilityBitrateAllocationPolicy : public BitrateAllocationPolicy {
+ public:
+  UtilityBitrateAllocationPolicy();
+  ~UtilityBitrateAllocationPolicy() override;
+
+  void OnTrackChanged(
+      const bitrate_allocator_impl::AllocatableTrack& track) override;
+  void OnTrackRemoved(BitrateAllocatorObserver* observer) override;
+  std::map<BitrateAllocatorObserver*, int> Allocate(
+      const std::vector<bitrate_allocator_impl::AllocatableTrack>&
+          allocatable_tracks,
+      uint32_t bitrate,
+      uint32_t sum_min_bitrates) override;
+
+ private:
+  // A linear piece of a track's utility curve, covering bitrates in the range
+  // [`start_bps`, `end_bps`].
+  struct Segment {
+    BitrateAllocatorObserver* observer;
+    uint32_t start_bps;
+    uint32_t end_bps;
+    // Weighted utility per bps.
+    double marginal_utility;
+  };
+
+  // Segments of all tracks, sorted by decreasing marginal utility.
+  std::vector<Segment> segments_;
+};
+
+}  // namespace webrtc
+
+#endif  // CALL_UTILITY_BITRATE_ALLOCATION_POLICY_H_
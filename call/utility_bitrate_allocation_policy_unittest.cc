@@ -0,0 +1,178 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "call/utility_bitrate_allocation_policy.h"
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using bitrate_allocator_impl::AllocatableTrack;
+using ::testing::NiceMock;
+
+class MockLimitObserver : public BitrateAllocator::LimitObserver {
+ public:
+  MOCK_METHOD(void,
+              OnAllocationLimitsChanged,
+              (BitrateAllocationLimits),
+              (override));
+};
+
+class TestBitrateObserver : public BitrateAllocatorObserver {
+ public:
+  uint32_t OnBitrateUpdated(BitrateAllocationUpdate update) override {
+    last_bitrate_bps = update.target_bitrate.bps();
+    return 0;
+  }
+  uint32_t last_bitrate_bps = 0;
+};
+
+MediaStreamAllocationConfig Config(
+    uint32_t min_bitrate_bps,
+    uint32_t max_bitrate_bps,
+    std::vector<BitrateUtilityPoint> utility_curve = {},
+    double bitrate_priority = 1.0) {
+  MediaStreamAllocationConfig config;
+  config.min_bitrate_bps = min_bitrate_bps;
+  config.max_bitrate_bps = max_bitrate_bps;
+  config.pad_up_bitrate_bps = 0;
+  config.priority_bitrate_bps = 0;
+  config.enforce_min_bitrate = true;
+  config.bitrate_priority = bitrate_priority;
+  config.utility_curve = std::move(utility_curve);
+  return config;
+}
+
+class UtilityBitrateAllocationPolicyTest : public ::testing::Test {
+ protected:
+  void AddTrack(BitrateAllocatorObserver* observer,
+                MediaStreamAllocationConfig config) {
+    tracks_.emplace_back(observer, config);
+    policy_.OnTrackChanged(tracks_.back());
+  }
+
+  std::map<BitrateAllocatorObserver*, int> Allocate(uint32_t bitrate) {
+    uint32_t sum_min_bitrates = 0;
+    for (const auto& track : tracks_)
+      sum_min_bitrates += track.config.min_bitrate_bps;
+    return policy_.Allocate(tracks_, bitrate, sum_min_bitrates);
+  }
+
+  UtilityBitrateAllocationPolicy policy_;
+  std::vector<AllocatableTrack> tracks_;
+  TestBitrateObserver observer_a_;
+  TestBitrateObserver observer_b_;
+};
+
+TEST_F(UtilityBitrateAllocationPolicyTest, SplitsEvenlyBetweenEqualTracks) {
+  AddTrack(&observer_a_, Config(0, 1000000));
+  AddTrack(&observer_b_, Config(0, 1000000));
+
+  auto allocation = Allocate(600000);
+  EXPECT_EQ(allocation[&observer_a_], 300000);
+  EXPECT_EQ(allocation[&observer_b_], 300000);
+}
+
+TEST_F(UtilityBitrateAllocationPolicyTest, FavorsHigherBitratePriority) {
+  AddTrack(&observer_a_, Config(50000, 1000000, {}, 2.0));
+  AddTrack(&observer_b_, Config(50000, 1000000, {}, 1.0));
+
+  auto allocation = Allocate(600000);
+  EXPECT_GT(allocation[&observer_a_], allocation[&observer_b_]);
+  EXPECT_GE(allocation[&observer_b_], 50000);
+  EXPECT_EQ(allocation[&observer_a_] + allocation[&observer_b_], 600000);
+}
+
+TEST_F(UtilityBitrateAllocationPolicyTest, AllocatesByMarginalUtility) {
+  // The first 200 kbps of stream A are worth more per bps than anything in
+  // stream B, but the remainder of stream A is worth less.
+  AddTrack(&observer_a_, Config(0, 1000000, {{200000, 10}, {1000000, 12}}));
+  AddTrack(&observer_b_, Config(0, 1000000, {{1000000, 5}}));
+
+  auto allocation = Allocate(300000);
+  EXPECT_EQ(allocation[&observer_a_], 200000);
+  EXPECT_EQ(allocation[&observer_b_], 100000);
+
+  allocation = Allocate(1200000);
+  EXPECT_EQ(allocation[&observer_a_], 200000);
+  EXPECT_EQ(allocation[&observer_b_], 1000000);
+}
+
+TEST_F(UtilityBitrateAllocationPolicyTest, UsesConcaveHullOfUtilityCurve) {
+  // A low utility first layer followed by a high utility second layer is only
+  // worth allocating as a whole, so it competes at the average slope.
+  AddTrack(&observer_a_, Config(0, 500000, {{100000, 0.1}, {500000, 10}}));
+  AddTrack(&observer_b_, Config(0, 1000000, {{1000000, 5}}));
+
+  auto allocation = Allocate(400000);
+  EXPECT_EQ(allocation[&observer_a_], 400000);
+  EXPECT_EQ(allocation[&observer_b_], 0);
+}
+
+TEST_F(UtilityBitrateAllocationPolicyTest, UpdatesSegmentsOfChangedTrack) {
+  AddTrack(&observer_a_, Config(0, 1000000, {{1000000, 5}}));
+  AddTrack(&observer_b_, Config(0, 1000000, {{1000000, 1}}));
+  EXPECT_EQ(Allocate(500000)[&observer_a_], 500000);
+
+  tracks_[1].config = Config(0, 1000000, {{1000000, 10}});
+  policy_.OnTrackChanged(tracks_[1]);
+  EXPECT_EQ(Allocate(500000)[&observer_b_], 500000);
+
+  tracks_.erase(tracks_.begin() + 1);
+  policy_.OnTrackRemoved(&observer_b_);
+  EXPECT_EQ(Allocate(500000)[&observer_a_], 500000);
+}
+
+TEST_F(UtilityBitrateAllocationPolicyTest, RespectsPriorityBitrate) {
+  MediaStreamAllocationConfig config_b = Config(0, 1000000, {{1000000, 1}});
+  config_b.priority_bitrate_bps = 100000;
+  AddTrack(&observer_a_, Config(0, 1000000, {{1000000, 5}}));
+  AddTrack(&observer_b_, config_b);
+
+  auto allocation = Allocate(500000);
+  EXPECT_EQ(allocation[&observer_a_], 400000);
+  EXPECT_EQ(allocation[&observer_b_], 100000);
+}
+
+TEST(BitrateAllocatorWithUtilityPolicyTest, AllocatesUsingPolicy) {
+  NiceMock<MockLimitObserver> limit_observer;
+  BitrateAllocator allocator(
+      &limit_observer, std::make_unique<UtilityBitrateAllocationPolicy>());
+  TestBitrateObserver observer_a;
+  TestBitrateObserver observer_b;
+  allocator.AddObserver(&observer_a,
+                        Config(30000, 1000000, {{200000, 10}, {1000000, 12}}));
+  allocator.AddObserver(&observer_b, Config(30000, 1000000, {{1000000, 5}}));
+
+  TargetTransferRate msg;
+  msg.at_time = Timestamp::Seconds(10000);
+  msg.target_rate = DataRate::BitsPerSec(300000);
+  msg.stable_target_rate = msg.target_rate;
+  allocator.OnNetworkEstimateChanged(msg);
+  EXPECT_EQ(observer_a.last_bitrate_bps, 200000u);
+  EXPECT_EQ(observer_b.last_bitrate_bps, 100000u);
+
+  // Above the sum of max bitrates the policy is not consulted.
+  msg.target_rate = DataRate::BitsPerSec(3000000);
+  msg.stable_target_rate = msg.target_rate;
+  allocator.OnNetworkEstimateChanged(msg);
+  EXPECT_EQ(observer_a.last_bitrate_bps, 1500000u);
+  EXPECT_EQ(observer_b.last_bitrate_bps, 1500000u);
+}
+
+}  // namespace
+}  // namespace webrtc
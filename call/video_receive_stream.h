@@ -21,6 +21,7 @@
 
 #include "api/call/transport.h"
 #include "api/crypto/crypto_options.h"
+#include "api/priority.h"
 #include "api/rtp_headers.h"
 #include "api/rtp_parameters.h"
 #include "api/video/recordable_encoded_frame.h"
@@ -263,6 +264,11 @@ class VideoReceiveStreamInterface : public MediaReceiveStreamInterface {
     // to one of the audio streams.
     std::string sync_group;
 
+    // Relative importance of decoding this stream when the decode load of the
+    // process is managed, see "WebRTC-Video-DecodeLoadManager". Streams with
+    // lower priority are thinned or paused first.
+    Priority decode_priority = Priority::kMedium;
+
     // An optional custom frame decryptor that allows the entire frame to be
     // decrypted in whatever way the caller choses. This is not required by
     // default.
@@ -25,6 +25,7 @@
 #include "api/rtp_parameters.h"
 #include "api/rtp_sender_interface.h"
 #include "api/scoped_refptr.h"
+#include "api/video/encoded_video_source.h"
 #include "api/video/video_content_type.h"
 #include "api/video/video_frame.h"
 #include "api/video/video_sink_interface.h"
@@ -201,6 +202,12 @@ class VideoSendStream {
     // Owned by RtpSenderBase.
     VideoEncoderFactory::EncoderSelectorInterface* encoder_selector = nullptr;
 
+    // An optional source of encoded frames, sent as they are instead of
+    // encoding the frames of the stream's source, e.g. to relay a received
+    // stream. Key frame requests and the target bitrate are passed to it.
+    // Must outlive the stream.
+    EncodedVideoSource* encoded_source = nullptr;
+
     // Per PeerConnection cryptography options.
     CryptoOptions crypto_options;
 
@@ -0,0 +1,161 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include "common_video/include/caching_scaled_i420_buffer.h"
+
+#include <utility>
+
+#include "api/make_ref_counted.h"
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+rtc::scoped_refptr<VideoFrameBuffer> CachingScaledI420Buffer::Wrap(
+    rtc::scoped_refptr<VideoFrameBuffer> buffer) {
+  if (buffer == nullptr || buffer->type() != VideoFrameBuffer::Type::kI420) {
+    return buffer;
+  }
+  return rtc::make_ref_counted<CachingScaledI420Buffer>(buffer->ToI420());
+}
+
+CachingScaledI420Buffer::CachingScaledI420Buffer(
+    rtc::scoped_refptr<I420BufferInterface> source)
+    : source_(std::move(source)) {
+  RTC_DCHECK(source_);
+}
+
+CachingScaledI420Buffer::~CachingScaledI420Buffer() = default;
+
+int CachingScaledI420Buffer::width() const {
+  return source_->width();
+}
+
+int CachingScaledI420Buffer::height() const {
+  return source_->height();
+}
+
+const uint8_t* CachingScaledI420Buffer::DataY() const {
+  return source_->DataY();
+}
+
+const uint8_t* CachingScaledI420Buffer::DataU() const {
+  return source_->DataU();
+}
+
+const uint8_t* CachingScaledI420Buffer::DataV() const {
+  return source_->DataV();
+}
+
+int CachingScaledI420Buffer::StrideY() const {
+  return source_->StrideY();
+}
+
+int CachingScaledI420Buffer::StrideU() const {
+  return source_->StrideU();
+}
+
+int CachingScaledI420Buffer::StrideV() const {
+  return source_->StrideV();
+}
+
+rtc::scoped_refptr<VideoFrameBuffer> CachingScaledI420Buffer::CropAndScale(
+    int offset_x,
+    int offset_y,
+    int crop_width,
+    int crop_height,
+    int scaled_width,
+    int scaled_height) {
+  if (scaled_width <= 0 || scaled_height <= 0 ||
+      scaled_width > crop_width || scaled_height > crop_height) {
+    // Upscales are not shared between consumers in practice.
+    return source_->CropAndScale(offset_x, offset_y, crop_width, crop_height,
+                                 scaled_width, scaled_height);
+  }
+
+  const bool full_frame = offset_x == 0 && offset_y == 0 &&
+                          crop_width == width() && crop_height == height();
+  if (full_frame) {
+    return ScaleFromPyramid(scaled_width, scaled_height);
+  }
+  return GetOrScale(
+      {offset_x, offset_y, crop_width, crop_height, scaled_width,
+       scaled_height},
+      [&] {
+        return source_->CropAndScale(offset_x, offset_y, crop_width,
+                                     crop_height, scaled_width, scaled_height);
+      });
+}
+
+size_t CachingScaledI420Buffer::cached_buffers() const {
+  MutexLock lock(&mutex_);
+  return cache_.size();
+}
+
+bool CachingScaledI420Buffer::Key::operator==(const Key& other) const {
+  return offset_x == other.offset_x && offset_y == other.offset_y &&
+         crop_width == other.crop_width && crop_height == other.crop_height &&
+         scaled_width == other.scaled_width &&
+         scaled_height == other.scaled_height;
+}
+
+rtc::scoped_refptr<VideoFrameBuffer> CachingScaledI420Buffer::ScaleFromPyramid(
+    int scaled_width,
+    int scaled_height) {
+  // Halve until the next level would be smaller than the target. Every level
+  // is cached, so lower resolutions cascade from the levels built for higher
+  // ones.
+  rtc::scoped_refptr<VideoFrameBuffer> base = source_;
+  while (base->width() / 2 >= scaled_width &&
+         base->height() / 2 >= scaled_height) {
+    const int level_width = base->width() / 2;
+    const int level_height = base->height() / 2;
+    rtc::scoped_refptr<VideoFrameBuffer> level = GetOrScale(
+        {0, 0, width(), height(), level_width, level_height},
+        [&] { return base->Scale(level_width, level_height); });
+    if (!level) {
+      return nullptr;
+    }
+    base = std::move(level);
+  }
+  if (base->width() == scaled_width && base->height() == scaled_height) {
+    return base;
+  }
+  return GetOrScale({0, 0, width(), height(), scaled_width, scaled_height},
+                    [&] { return base->Scale(scaled_width, scaled_height); });
+}
+
+rtc::scoped_refptr<VideoFrameBuffer> CachingScaledI420Buffer::GetOrScale(
+    const Key& key,
+    rtc::FunctionView<rtc::scoped_refptr<VideoFrameBuffer>()> scale) {
+  {
+    MutexLock lock(&mutex_);
+    for (const Entry& entry : cache_) {
+      if (entry.key == key) {
+        return entry.buffer;
+      }
+    }
+  }
+  rtc::scoped_refptr<VideoFrameBuffer> buffer = scale();
+  if (!buffer) {
+    return nullptr;
+  }
+  MutexLock lock(&mutex_);
+  // Another consumer may have cached the same scale meanwhile.
+  for (const Entry& entry : cache_) {
+    if (entry.key == key) {
+      return entry.buffer;
+    }
+  }
+  if (cache_.size() < kMaxCachedBuffers) {
+    cache_.push_back({key, buffer});
+  }
+  return buffer;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,186 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "common_video/include/caching_scaled_i420_buffer.h"
+
+#include <functional>
+#include <utility>
+
+#include "api/make_ref_counted.h"
+#include "api/scoped_refptr.h"
+#include "api/video/i420_buffer.h"
+#include "api/video/nv12_buffer.h"
+#include "api/video/video_frame_buffer.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+// Counts the scale operations that read the full resolution source.
+class CountingI420Buffer : public I420BufferInterface {
+ public:
+  CountingI420Buffer(int width, int height)
+      : buffer_(I420Buffer::Create(width, height)) {
+    I420Buffer::SetBlack(buffer_.get());
+  }
+
+  int width() const override { return buffer_->width(); }
+  int height() const override { return buffer_->height(); }
+  const uint8_t* DataY() const override { return buffer_->DataY(); }
+  const uint8_t* DataU() const override { return buffer_->DataU(); }
+  const uint8_t* DataV() const override { return buffer_->DataV(); }
+  int StrideY() const override { return buffer_->StrideY(); }
+  int StrideU() const override { return buffer_->StrideU(); }
+  int StrideV() const override { return buffer_->StrideV(); }
+
+  rtc::scoped_refptr<VideoFrameBuffer> CropAndScale(
+      int offset_x,
+      int offset_y,
+      int crop_width,
+      int crop_height,
+      int scaled_width,
+      int scaled_height) override {
+    ++scale_count_;
+    if (on_scale_) {
+      std::exchange(on_scale_, nullptr)();
+    }
+    return buffer_->CropAndScale(offset_x, offset_y, crop_width, crop_height,
+                                 scaled_width, scaled_height);
+  }
+
+  int scale_count() const { return scale_count_; }
+  // Runs `callback` while the next scale is in progress.
+  void OnNextScale(std::function<void()> callback) {
+    on_scale_ = std::move(callback);
+  }
+
+ private:
+  const rtc::scoped_refptr<I420Buffer> buffer_;
+  int scale_count_ = 0;
+  std::function<void()> on_scale_;
+};
+
+TEST(CachingScaledI420BufferTest, WrapsOnlyI420Buffers) {
+  rtc::scoped_refptr<VideoFrameBuffer> nv12 = NV12Buffer::Create(16, 16);
+  EXPECT_EQ(CachingScaledI420Buffer::Wrap(nv12), nv12);
+
+  rtc::scoped_refptr<VideoFrameBuffer> i420 = I420Buffer::Create(16, 16);
+  rtc::scoped_refptr<VideoFrameBuffer> wrapped =
+      CachingScaledI420Buffer::Wrap(i420);
+  EXPECT_NE(wrapped, i420);
+  EXPECT_EQ(wrapped->type(), VideoFrameBuffer::Type::kI420);
+  EXPECT_EQ(wrapped->GetI420()->DataY(), i420->GetI420()->DataY());
+}
+
+TEST(CachingScaledI420BufferTest, ReturnsSameBufferForSameResolution) {
+  auto source = rtc::make_ref_counted<CountingI420Buffer>(640, 360);
+  auto cache = rtc::make_ref_counted<CachingScaledI420Buffer>(source);
+
+  rtc::scoped_refptr<VideoFrameBuffer> first = cache->Scale(320, 180);
+  rtc::scoped_refptr<VideoFrameBuffer> second = cache->Scale(320, 180);
+  ASSERT_TRUE(first);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(first->width(), 320);
+  EXPECT_EQ(first->height(), 180);
+  EXPECT_EQ(source->scale_count(), 1);
+}
+
+TEST(CachingScaledI420BufferTest, CascadesLowerLevelsFromHalvedLevels) {
+  auto source = rtc::make_ref_counted<CountingI420Buffer>(1280, 720);
+  auto cache = rtc::make_ref_counted<CachingScaledI420Buffer>(source);
+
+  // The lowest layer is requested first, as SimulcastEncoderAdapter does.
+  rtc::scoped_refptr<VideoFrameBuffer> quarter = cache->Scale(320, 180);
+  rtc::scoped_refptr<VideoFrameBuffer> half = cache->Scale(640, 360);
+  ASSERT_TRUE(quarter);
+  ASSERT_TRUE(half);
+  EXPECT_EQ(quarter->width(), 320);
+  EXPECT_EQ(half->width(), 640);
+  // Only the first halving read the full resolution source.
+  EXPECT_EQ(source->scale_count(), 1);
+  EXPECT_EQ(cache->cached_buffers(), 2u);
+}
+
+TEST(CachingScaledI420BufferTest, ScalesNonPowerOfTwoFromClosestLevel) {
+  auto source = rtc::make_ref_counted<CountingI420Buffer>(1280, 720);
+  auto cache = rtc::make_ref_counted<CachingScaledI420Buffer>(source);
+
+  rtc::scoped_refptr<VideoFrameBuffer> scaled = cache->Scale(480, 270);
+  ASSERT_TRUE(scaled);
+  EXPECT_EQ(scaled->width(), 480);
+  EXPECT_EQ(scaled->height(), 270);
+  EXPECT_EQ(source->scale_count(), 1);
+  // The intermediate half resolution level is kept for later requests.
+  EXPECT_EQ(cache->cached_buffers(), 2u);
+  cache->Scale(640, 360);
+  EXPECT_EQ(source->scale_count(), 1);
+}
+
+TEST(CachingScaledI420BufferTest, CachesCroppedScalesByCropRect) {
+  auto source = rtc::make_ref_counted<CountingI420Buffer>(640, 480);
+  auto cache = rtc::make_ref_counted<CachingScaledI420Buffer>(source);
+
+  rtc::scoped_refptr<VideoFrameBuffer> first =
+      cache->CropAndScale(0, 60, 640, 360, 320, 180);
+  rtc::scoped_refptr<VideoFrameBuffer> second =
+      cache->CropAndScale(0, 60, 640, 360, 320, 180);
+  rtc::scoped_refptr<VideoFrameBuffer> other_crop =
+      cache->CropAndScale(0, 0, 640, 360, 320, 180);
+  EXPECT_EQ(first, second);
+  EXPECT_NE(first, other_crop);
+  EXPECT_EQ(source->scale_count(), 2);
+}
+
+TEST(CachingScaledI420BufferTest, DoesNotCacheUpscales) {
+  auto source = rtc::make_ref_counted<CountingI420Buffer>(320, 180);
+  auto cache = rtc::make_ref_counted<CachingScaledI420Buffer>(source);
+
+  cache->Scale(640, 360);
+  cache->Scale(640, 360);
+  EXPECT_EQ(source->scale_count(), 2);
+  EXPECT_EQ(cache->cached_buffers(), 0u);
+}
+
+TEST(CachingScaledI420BufferTest, ScalesOtherResolutionsWhileScaling) {
+  auto source = rtc::make_ref_counted<CountingI420Buffer>(640, 480);
+  auto cache = rtc::make_ref_counted<CachingScaledI420Buffer>(source);
+
+  // The cache lock is not held while scaling, so another resolution can be
+  // requested, and cached, before the first scale completes.
+  rtc::scoped_refptr<VideoFrameBuffer> nested;
+  source->OnNextScale(
+      [&] { nested = cache->CropAndScale(0, 0, 640, 360, 160, 90); });
+  rtc::scoped_refptr<VideoFrameBuffer> outer =
+      cache->CropAndScale(0, 60, 640, 360, 320, 180);
+  ASSERT_TRUE(nested);
+  ASSERT_TRUE(outer);
+  EXPECT_EQ(nested->width(), 160);
+  EXPECT_EQ(outer->width(), 320);
+  EXPECT_EQ(cache->cached_buffers(), 2u);
+  EXPECT_EQ(cache->CropAndScale(0, 0, 640, 360, 160, 90), nested);
+  EXPECT_EQ(source->scale_count(), 2);
+}
+
+TEST(CachingScaledI420BufferTest, SharesFirstOfConcurrentSameScales) {
+  auto source = rtc::make_ref_counted<CountingI420Buffer>(640, 480);
+  auto cache = rtc::make_ref_counted<CachingScaledI420Buffer>(source);
+
+  rtc::scoped_refptr<VideoFrameBuffer> nested;
+  source->OnNextScale(
+      [&] { nested = cache->CropAndScale(0, 60, 640, 360, 320, 180); });
+  rtc::scoped_refptr<VideoFrameBuffer> outer =
+      cache->CropAndScale(0, 60, 640, 360, 320, 180);
+  ASSERT_TRUE(nested);
+  EXPECT_EQ(outer, nested);
+  EXPECT_EQ(cache->cached_buffers(), 1u);
+}
+
+}  // namespace
+}  // namespace webrtc
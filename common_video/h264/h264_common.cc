@@ -11,6 +11,7 @@
 #include "common_video/h264/h264_common.h"
 
 #include <cstdint>
+#include <cstring>
 
 namespace webrtc {
 namespace H264 {
@@ -19,39 +20,36 @@ const uint8_t kNaluTypeMask = 0x1F;
 
 std::vector<NaluIndex> FindNaluIndices(const uint8_t* buffer,
                                        size_t buffer_size) {
-  // This is sorta like Boyer-Moore, but with only the first optimization step:
-  // given a 3-byte sequence we're looking at, if the 3rd byte isn't 1 or 0,
-  // skip ahead to the next 3-byte sequence. 0s and 1s are relatively rare, so
-  // this will skip the majority of reads/checks.
+  // Start sequences end with a 1, which is rare in the compressed data, so
+  // search for 1s with memchr, which is vectorized by the C library, and only
+  // check the two bytes before them.
   std::vector<NaluIndex> sequences;
   if (buffer_size < kNaluShortStartSequenceSize)
     return sequences;
 
   static_assert(kNaluShortStartSequenceSize >= 2,
                 "kNaluShortStartSequenceSize must be larger or equals to 2");
-  const size_t end = buffer_size - kNaluShortStartSequenceSize;
-  for (size_t i = 0; i < end;) {
-    if (buffer[i + 2] > 1) {
-      i += 3;
-    } else if (buffer[i + 2] == 1) {
-      if (buffer[i + 1] == 0 && buffer[i] == 0) {
-        // We found a start sequence, now check if it was a 3 of 4 byte one.
-        NaluIndex index = {i, i + 3, 0};
-        if (index.start_offset > 0 && buffer[index.start_offset - 1] == 0)
-          --index.start_offset;
-
-        // Update length of previous entry.
-        auto it = sequences.rbegin();
-        if (it != sequences.rend())
-          it->payload_size = index.start_offset - it->payload_start_offset;
-
-        sequences.push_back(index);
-      }
-
-      i += 3;
-    } else {
-      ++i;
+  // A start sequence ending in the last byte has no payload, skip it.
+  const size_t end = buffer_size - 1;
+  for (size_t i = kNaluShortStartSequenceSize - 1; i < end;) {
+    const void* one = std::memchr(buffer + i, 1, end - i);
+    if (one == nullptr)
+      break;
+    i = static_cast<const uint8_t*>(one) - buffer;
+    if (buffer[i - 1] == 0 && buffer[i - 2] == 0) {
+      // We found a start sequence, now check if it was a 3 of 4 byte one.
+      NaluIndex index = {i - 2, i + 1, 0};
+      if (index.start_offset > 0 && buffer[index.start_offset - 1] == 0)
+        --index.start_offset;
+
+      // Update length of previous entry.
+      auto it = sequences.rbegin();
+      if (it != sequences.rend())
+        it->payload_size = index.start_offset - it->payload_start_offset;
+
+      sequences.push_back(index);
     }
+    ++i;
   }
 
   // Update length of last entry, if any.
@@ -67,25 +65,29 @@ NaluType ParseNaluType(uint8_t data) {
 }
 
 std::vector<uint8_t> ParseRbsp(const uint8_t* data, size_t length) {
+  static constexpr uint8_t kEmulationByte = 0x03u;
   std::vector<uint8_t> out;
   out.reserve(length);
 
-  for (size_t i = 0; i < length;) {
-    // Be careful about over/underflow here. byte_length_ - 3 can underflow, and
-    // i + 3 can overflow, but byte_length_ - i can't, because i < byte_length_
-    // above, and that expression will produce the number of bytes left in
-    // the stream including the byte at i.
-    if (length - i >= 3 && !data[i] && !data[i + 1] && data[i + 2] == 3) {
-      // Two rbsp bytes.
-      out.push_back(data[i++]);
-      out.push_back(data[i++]);
-      // Skip the emulation byte.
-      i++;
+  // Emulation prevention bytes are 3s preceded by two 0s. Search for the 3s
+  // with memchr and copy the data between the emulation bytes in one go.
+  size_t copy_from = 0;
+  for (size_t i = 2; i < length;) {
+    const void* three = std::memchr(data + i, kEmulationByte, length - i);
+    if (three == nullptr)
+      break;
+    i = static_cast<const uint8_t*>(three) - data;
+    if (data[i - 1] == 0 && data[i - 2] == 0) {
+      // Copy the rbsp bytes up to the emulation byte and skip it. The next
+      // emulation byte needs two new 0s before it.
+      out.insert(out.end(), data + copy_from, data + i);
+      copy_from = i + 1;
+      i += 3;
     } else {
-      // Single rbsp byte.
-      out.push_back(data[i++]);
+      ++i;
     }
   }
+  out.insert(out.end(), data + copy_from, data + length);
   return out;
 }
 
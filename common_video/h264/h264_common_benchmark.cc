@@ -0,0 +1,95 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common_video/h264/h264_common.h"
+#include "rtc_base/bitstream_reader.h"
+#include "rtc_base/random.h"
+#include "rtc_base/system/unused.h"
+
+namespace webrtc {
+namespace {
+
+// Compressed data of `size` bytes, i.e. uniformly random bytes, split into
+// NAL units of `nalu_size` bytes. Emulation prevention is left out; in
+// uniformly random data 0 0 3 sequences are as rare as in real streams.
+std::vector<uint8_t> CreateStream(size_t size, size_t nalu_size) {
+  Random random(/*seed=*/42);
+  std::vector<uint8_t> stream(size);
+  for (uint8_t& byte : stream) {
+    byte = random.Rand<uint8_t>();
+  }
+  for (size_t i = 0; i + H264::kNaluLongStartSequenceSize < size;
+       i += nalu_size) {
+    stream[i] = 0;
+    stream[i + 1] = 0;
+    stream[i + 2] = 0;
+    stream[i + 3] = 1;
+  }
+  return stream;
+}
+
+// Scans a key frame of `state.range(0)` bytes for start sequences.
+void BM_FindNaluIndices(benchmark::State& state) {
+  const std::vector<uint8_t> stream =
+      CreateStream(state.range(0), /*nalu_size=*/64 * 1024);
+  for (auto s : state) {
+    RTC_UNUSED(s);
+    std::vector<H264::NaluIndex> indices =
+        H264::FindNaluIndices(stream.data(), stream.size());
+    benchmark::DoNotOptimize(indices);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+// Removes emulation prevention from a NAL unit of `state.range(0)` bytes.
+void BM_ParseRbsp(benchmark::State& state) {
+  const std::vector<uint8_t> nalu =
+      CreateStream(state.range(0), /*nalu_size=*/state.range(0));
+  for (auto s : state) {
+    RTC_UNUSED(s);
+    std::vector<uint8_t> rbsp = H264::ParseRbsp(nalu.data(), nalu.size());
+    benchmark::DoNotOptimize(rbsp);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+// Reads exponential golomb values, which make up most of the H.264 parameter
+// sets and slice headers, with `state.range(0)` leading zeros each.
+void BM_ReadExponentialGolomb(benchmark::State& state) {
+  const int zero_bit_count = static_cast<int>(state.range(0));
+  const int value_bits = 2 * zero_bit_count + 1;
+  constexpr int kNumValues = 1000;
+  std::vector<uint8_t> data((kNumValues * value_bits + 7) / 8, 0);
+  for (int i = 0; i < kNumValues; ++i) {
+    // Set the leading 1 of each value; the remaining bits are 0.
+    const int bit = i * value_bits + zero_bit_count;
+    data[bit / 8] |= 0x80 >> (bit % 8);
+  }
+  for (auto s : state) {
+    RTC_UNUSED(s);
+    BitstreamReader reader(data);
+    for (int i = 0; i < kNumValues; ++i) {
+      benchmark::DoNotOptimize(reader.ReadExponentialGolomb());
+    }
+    benchmark::DoNotOptimize(reader.Ok());
+  }
+  state.SetItemsProcessed(state.iterations() * kNumValues);
+}
+
+BENCHMARK(BM_FindNaluIndices)->Arg(10'000)->Arg(1'000'000)->Arg(4'000'000);
+BENCHMARK(BM_ParseRbsp)->Arg(100)->Arg(10'000)->Arg(1'000'000);
+BENCHMARK(BM_ReadExponentialGolomb)->Arg(0)->Arg(4)->Arg(12);
+
+}  // namespace
+}  // namespace webrtc
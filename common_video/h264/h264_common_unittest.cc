@@ -0,0 +1,109 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "common_video/h264/h264_common.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "rtc_base/random.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace H264 {
+
+// Found by argument dependent lookup, so outside the anonymous namespace.
+bool operator==(const NaluIndex& a, const NaluIndex& b) {
+  return a.start_offset == b.start_offset &&
+         a.payload_start_offset == b.payload_start_offset &&
+         a.payload_size == b.payload_size;
+}
+
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Byte by byte versions of FindNaluIndices and ParseRbsp.
+std::vector<NaluIndex> FindNaluIndicesSlow(const std::vector<uint8_t>& data) {
+  std::vector<NaluIndex> indices;
+  for (size_t i = 2; i + 1 < data.size(); ++i) {
+    if (data[i] == 1 && data[i - 1] == 0 && data[i - 2] == 0) {
+      size_t start = (i >= 3 && data[i - 3] == 0) ? i - 3 : i - 2;
+      if (!indices.empty()) {
+        indices.back().payload_size =
+            start - indices.back().payload_start_offset;
+      }
+      indices.push_back({start, i + 1, 0});
+    }
+  }
+  if (!indices.empty()) {
+    indices.back().payload_size =
+        data.size() - indices.back().payload_start_offset;
+  }
+  return indices;
+}
+
+std::vector<uint8_t> ParseRbspSlow(const std::vector<uint8_t>& data) {
+  std::vector<uint8_t> out;
+  int zeros = 0;
+  for (uint8_t byte : data) {
+    if (zeros >= 2 && byte == 3) {
+      zeros = 0;
+      continue;
+    }
+    out.push_back(byte);
+    zeros = byte == 0 ? zeros + 1 : 0;
+  }
+  return out;
+}
+
+// Random data where start sequences and emulation bytes are common.
+std::vector<uint8_t> CreateRandomData(Random& random, size_t size) {
+  std::vector<uint8_t> data(size);
+  for (uint8_t& byte : data) {
+    byte = random.Rand(0, 3) == 0 ? random.Rand<uint8_t>() : random.Rand(0, 3);
+  }
+  return data;
+}
+
+TEST(H264CommonTest, FindsShortAndLongStartSequences) {
+  const uint8_t data[] = {0, 0, 1, 0x67, 0xAA, 0, 0, 0, 1, 0x68, 0xBB, 0xCC};
+  EXPECT_THAT(FindNaluIndices(data, sizeof(data)),
+              ElementsAre(NaluIndex{0, 3, 2}, NaluIndex{5, 9, 3}));
+}
+
+TEST(H264CommonTest, IgnoresStartSequenceAtEnd) {
+  const uint8_t data[] = {0xAA, 0xBB, 0, 0, 1};
+  EXPECT_THAT(FindNaluIndices(data, sizeof(data)), IsEmpty());
+}
+
+TEST(H264CommonTest, RemovesEmulationPreventionBytes) {
+  const uint8_t data[] = {0xAA, 0, 0, 3, 1, 0, 0, 3, 0, 0, 3, 3, 0, 0, 3};
+  EXPECT_THAT(ParseRbsp(data, sizeof(data)),
+              ElementsAre(0xAA, 0, 0, 1, 0, 0, 0, 0, 3, 0, 0));
+}
+
+TEST(H264CommonTest, MatchesByteByByteParsing) {
+  Random random(/*seed=*/42);
+  for (size_t size = 0; size < 100; ++size) {
+    for (int i = 0; i < 20; ++i) {
+      std::vector<uint8_t> data = CreateRandomData(random, size);
+      ASSERT_EQ(FindNaluIndices(data.data(), data.size()),
+                FindNaluIndicesSlow(data));
+      ASSERT_EQ(ParseRbsp(data.data(), data.size()), ParseRbspSlow(data));
+    }
+  }
+}
+
+}  // namespace
+}  // namespace H264
+}  // namespace webrtc
@@ -0,0 +1,106 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef COMMON_VIDEO_INCLUDE_CACHING_SCALED_I420_BUFFER_H_
+#define COMMON_VIDEO_INCLUDE_CACHING_SCALED_I420_BUFFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "api/function_view.h"
+#include "api/scoped_refptr.h"
+#include "api/video/video_frame_buffer.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+// I420 buffer that remembers the scaled versions of itself it has produced, so
+// that consumers of the same frame asking for the same resolution (e.g. a
+// simulcast layer and a local preview sink) share a single scaled buffer.
+//
+// Downscales of the full frame are built as a cascaded pyramid: the source is
+// repeatedly halved while the result stays at least as large as the target,
+// and the target is then scaled from the smallest such level. Every level is
+// kept, so 1080p -> 540p -> 270p reads the full resolution plane only once.
+// Cropped scales are delegated to the source and cached by exact crop.
+//
+// Pixel accessors forward to the wrapped buffer. The cache is thread safe and
+// only allocated once a scaled buffer is cached. Its lock is not held while
+// scaling, so concurrent requests scale in parallel; if two of them scale the
+// same resolution, the first one to finish is cached and returned to both.
+class CachingScaledI420Buffer : public I420BufferInterface {
+ public:
+  // Returns `buffer` wrapped in a CachingScaledI420Buffer if it is an I420
+  // buffer, and `buffer` itself otherwise.
+  static rtc::scoped_refptr<VideoFrameBuffer> Wrap(
+      rtc::scoped_refptr<VideoFrameBuffer> buffer);
+
+  explicit CachingScaledI420Buffer(
+      rtc::scoped_refptr<I420BufferInterface> source);
+  ~CachingScaledI420Buffer() override;
+
+  int width() const override;
+  int height() const override;
+  const uint8_t* DataY() const override;
+  const uint8_t* DataU() const override;
+  const uint8_t* DataV() const override;
+  int StrideY() const override;
+  int StrideU() const override;
+  int StrideV() const override;
+
+  rtc::scoped_refptr<VideoFrameBuffer> CropAndScale(int offset_x,
+                                                    int offset_y,
+                                                    int crop_width,
+                                                    int crop_height,
+                                                    int scaled_width,
+                                                    int scaled_height) override;
+
+  // Number of scaled buffers currently held by the cache.
+  size_t cached_buffers() const;
+
+ private:
+  // Bounds the memory a single frame can pin. A simulcast encoder and a
+  // couple of sinks rarely need more than a handful of distinct resolutions.
+  static constexpr size_t kMaxCachedBuffers = 8;
+
+  struct Key {
+    int offset_x;
+    int offset_y;
+    int crop_width;
+    int crop_height;
+    int scaled_width;
+    int scaled_height;
+
+    bool operator==(const Key& other) const;
+  };
+  struct Entry {
+    Key key;
+    rtc::scoped_refptr<VideoFrameBuffer> buffer;
+  };
+
+  rtc::scoped_refptr<VideoFrameBuffer> ScaleFromPyramid(int scaled_width,
+                                                        int scaled_height);
+  // Returns the cached buffer for `key`, calling `scale` to create it if it is
+  // not cached yet.
+  rtc::scoped_refptr<VideoFrameBuffer> GetOrScale(
+      const Key& key,
+      rtc::FunctionView<rtc::scoped_refptr<VideoFrameBuffer>()> scale);
+
+  const rtc::scoped_refptr<I420BufferInterface> source_;
+  mutable Mutex mutex_;
+  std::vector<Entry> cache_ RTC_GUARDED_BY(mutex_);
+};
+
+}  // namespace webrtc
+
+#endif  // COMMON_VIDEO_INCLUDE_CACHING_SCALED_I420_BUFFER_H_
@@ -46,7 +46,8 @@ class RtcEventRtpPacketOutgoing final : public RtcEvent {
   size_t packet_length() const { return packet_.size(); }
 
   rtc::ArrayView<const uint8_t> RawHeader() const {
-    return rtc::MakeArrayView(packet_.data(), header_length());
+    // The header is always stored in the packet, even if the payload is not.
+    return packet_.stored_data().subview(0, header_length());
   }
   uint32_t Ssrc() const { return packet_.Ssrc(); }
   uint32_t Timestamp() const { return packet_.Timestamp(); }
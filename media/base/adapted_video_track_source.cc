@@ -24,6 +24,11 @@ AdaptedVideoTrackSource::AdaptedVideoTrackSource() = default;
 AdaptedVideoTrackSource::AdaptedVideoTrackSource(int required_alignment)
     : video_adapter_(required_alignment) {}
 
+AdaptedVideoTrackSource::AdaptedVideoTrackSource(
+    int required_alignment,
+    const VideoBroadcaster::FanOutConfig& fan_out_config)
+    : video_adapter_(required_alignment), broadcaster_(fan_out_config) {}
+
 AdaptedVideoTrackSource::~AdaptedVideoTrackSource() = default;
 
 bool AdaptedVideoTrackSource::GetStats(Stats* stats) {
@@ -41,6 +41,10 @@ class RTC_EXPORT AdaptedVideoTrackSource
   // Allows derived classes to initialize `video_adapter_` with a custom
   // alignment.
   explicit AdaptedVideoTrackSource(int required_alignment);
+  // Allows derived classes with several or slow sinks to opt in to the lock
+  // free fan out of frames, see VideoBroadcaster::FanOutConfig.
+  AdaptedVideoTrackSource(int required_alignment,
+                          const VideoBroadcaster::FanOutConfig& fan_out_config);
   // Checks the apply_rotation() flag. If the frame needs rotation, and it is a
   // plain memory frame, it is rotated. Subclasses producing native frames must
   // handle apply_rotation() themselves.
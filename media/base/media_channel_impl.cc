@@ -201,13 +201,31 @@ bool MediaChannelUtil::TransportForMediaChannels::SendRtcp(
 bool MediaChannelUtil::TransportForMediaChannels::SendRtp(
     rtc::ArrayView<const uint8_t> packet,
     const webrtc::PacketOptions& options) {
+  SendRtpBuffer(rtc::CopyOnWriteBuffer(packet, kMaxRtpPacketLen), options);
+  return true;
+}
+
+bool MediaChannelUtil::TransportForMediaChannels::SendRtpGathered(
+    rtc::ArrayView<const uint8_t> head,
+    rtc::ArrayView<const uint8_t> tail,
+    const webrtc::PacketOptions& options) {
+  rtc::CopyOnWriteBuffer packet(/*size=*/0, kMaxRtpPacketLen);
+  packet.AppendData(head.data(), head.size());
+  packet.AppendData(tail.data(), tail.size());
+  SendRtpBuffer(std::move(packet), options);
+  return true;
+}
+
+void MediaChannelUtil::TransportForMediaChannels::SendRtpBuffer(
+    rtc::CopyOnWriteBuffer packet,
+    const webrtc::PacketOptions& options) {
   auto send =
       [this, packet_id = options.packet_id,
        included_in_feedback = options.included_in_feedback,
        included_in_allocation = options.included_in_allocation,
        batchable = options.batchable,
        last_packet_in_batch = options.last_packet_in_batch,
-       packet = rtc::CopyOnWriteBuffer(packet, kMaxRtpPacketLen)]() mutable {
+       packet = std::move(packet)]() mutable {
         rtc::PacketOptions rtc_options;
         rtc_options.packet_id = packet_id;
         if (DscpEnabled()) {
@@ -231,7 +249,6 @@ bool MediaChannelUtil::TransportForMediaChannels::SendRtp(
   } else {
     network_thread_->PostTask(SafeTask(network_safety_, std::move(send)));
   }
-  return true;
 }
 
 void MediaChannelUtil::TransportForMediaChannels::SetInterface(
@@ -124,6 +124,9 @@ class MediaChannelUtil {
     // Implementation of webrtc::Transport
     bool SendRtp(rtc::ArrayView<const uint8_t> packet,
                  const webrtc::PacketOptions& options) override;
+    bool SendRtpGathered(rtc::ArrayView<const uint8_t> head,
+                         rtc::ArrayView<const uint8_t> tail,
+                         const webrtc::PacketOptions& options) override;
     bool SendRtcp(rtc::ArrayView<const uint8_t> packet) override;
 
     // Not implementation of webrtc::Transport
@@ -146,6 +149,11 @@ class MediaChannelUtil {
     void SetPreferredDscp(rtc::DiffServCodePoint new_dscp);
 
    private:
+    // Sends `packet`, which has room for SRTP protection, on the network
+    // thread.
+    void SendRtpBuffer(rtc::CopyOnWriteBuffer packet,
+                       const webrtc::PacketOptions& options);
+
     // This is the DSCP value used for both RTP and RTCP channels if DSCP is
     // enabled. It can be changed at any time via `SetPreferredDscp`.
     rtc::DiffServCodePoint PreferredDscp() const {
@@ -11,18 +11,207 @@
 #include "media/base/video_broadcaster.h"
 
 #include <algorithm>
+#include <memory>
+#include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/base/attributes.h"
 #include "absl/types/optional.h"
+#include "api/task_queue/task_queue_base.h"
 #include "api/video/i420_buffer.h"
 #include "api/video/video_rotation.h"
+#include "common_video/include/caching_scaled_i420_buffer.h"
 #include "media/base/video_common.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
 
 namespace rtc {
+namespace {
+
+// The broadcaster, or in the lock free fan out mode the sink delivery, that is
+// calling sinks on this thread. Removing a sink from within a call it makes
+// would wait for that call to return, so it is caught here instead.
+ABSL_CONST_INIT thread_local const void* current_delivery = nullptr;
+
+class ScopedDelivery {
+ public:
+  explicit ScopedDelivery(const void* delivery)
+      : previous_(std::exchange(current_delivery, delivery)) {}
+  ~ScopedDelivery() { current_delivery = previous_; }
+
+ private:
+  const void* const previous_;
+};
+
+// Whether a sink with `wants` is expected to scale the frame down, e.g. an
+// encoder with several simulcast layers or a sink with a pixel limit.
+bool WantsScaledFrame(const VideoSinkWants& wants,
+                      const webrtc::VideoFrame& frame) {
+  auto smaller_than_frame = [&](const VideoSinkWants::FrameSize& size) {
+    return size.width < frame.width() || size.height < frame.height();
+  };
+  return wants.max_pixel_count < frame.width() * frame.height() ||
+         (wants.requested_resolution &&
+          smaller_than_frame(*wants.requested_resolution)) ||
+         absl::c_any_of(wants.resolutions, smaller_than_frame);
+}
+
+}  // namespace
+
+// Delivers frames to a single sink for the lock free fan out mode. Either
+// calls the sink directly, or, if created with a task queue factory, keeps
+// the latest undelivered frame in a mailbox drained on a queue of its own.
+class VideoBroadcaster::SinkDelivery {
+ public:
+  SinkDelivery(VideoSinkInterface<webrtc::VideoFrame>* sink,
+               webrtc::TaskQueueFactory* queue_factory)
+      : sink_(sink), mailbox_(queue_factory != nullptr) {
+    if (mailbox_) {
+      queue_ = queue_factory->CreateTaskQueue(
+          "VideoSinkMailbox", webrtc::TaskQueueFactory::Priority::HIGH);
+    }
+  }
+  ~SinkDelivery() { Stop(); }
+
+  VideoSinkInterface<webrtc::VideoFrame>* sink() const { return sink_; }
+
+  void OnFrame(const webrtc::VideoFrame& frame) {
+    if (!mailbox_) {
+      webrtc::MutexLock lock(&delivery_lock_);
+      if (!stopped_) {
+        ScopedDelivery scoped_delivery(this);
+        DeliverFrame(frame);
+      }
+      return;
+    }
+    webrtc::MutexLock lock(&mailbox_lock_);
+    if (!queue_) {
+      return;
+    }
+    if (pending_frame_) {
+      // The sink has not caught up; the older frame is dropped.
+      superseded_frame_ = true;
+    }
+    pending_frame_ = frame;
+    MaybePostDrain();
+  }
+
+  void OnDiscardedFrame() {
+    if (!mailbox_) {
+      webrtc::MutexLock lock(&delivery_lock_);
+      if (!stopped_) {
+        ScopedDelivery scoped_delivery(this);
+        missed_frame_ = true;
+        sink_->OnDiscardedFrame();
+      }
+      return;
+    }
+    webrtc::MutexLock lock(&mailbox_lock_);
+    if (!queue_) {
+      return;
+    }
+    ++pending_discards_;
+    MaybePostDrain();
+  }
+
+  // After Stop returns the sink is not called again. Waits for a call to the
+  // sink that is in progress.
+  void Stop() {
+    RTC_DCHECK(current_delivery != this)
+        << "A sink must not be removed from within its own OnFrame.";
+    std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter> queue;
+    {
+      webrtc::MutexLock lock(&mailbox_lock_);
+      queue = std::move(queue_);
+      pending_frame_.reset();
+    }
+    {
+      webrtc::MutexLock lock(&delivery_lock_);
+      stopped_ = true;
+    }
+    // Deleting the queue waits for a running drain task, which sees
+    // `stopped_` and returns without calling the sink.
+    queue = nullptr;
+  }
+
+ private:
+  void MaybePostDrain() RTC_EXCLUSIVE_LOCKS_REQUIRED(mailbox_lock_) {
+    if (drain_pending_) {
+      return;
+    }
+    drain_pending_ = true;
+    queue_->PostTask([this] { Drain(); });
+  }
+
+  void Drain() {
+    absl::optional<webrtc::VideoFrame> frame;
+    int discards;
+    bool superseded;
+    {
+      webrtc::MutexLock lock(&mailbox_lock_);
+      drain_pending_ = false;
+      frame.swap(pending_frame_);
+      discards = std::exchange(pending_discards_, 0);
+      superseded = std::exchange(superseded_frame_, false);
+    }
+    webrtc::MutexLock lock(&delivery_lock_);
+    if (stopped_) {
+      return;
+    }
+    ScopedDelivery scoped_delivery(this);
+    for (int i = 0; i < discards; ++i) {
+      missed_frame_ = true;
+      sink_->OnDiscardedFrame();
+    }
+    if (superseded) {
+      missed_frame_ = true;
+    }
+    if (frame) {
+      DeliverFrame(*frame);
+    }
+  }
+
+  void DeliverFrame(const webrtc::VideoFrame& frame)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(delivery_lock_) {
+    if (missed_frame_ && frame.has_update_rect()) {
+      // The sink did not get the previous frame, so the update rect of this
+      // one does not describe what changed for it.
+      webrtc::VideoFrame copy = frame;
+      copy.clear_update_rect();
+      sink_->OnFrame(copy);
+    } else {
+      sink_->OnFrame(frame);
+    }
+    missed_frame_ = false;
+  }
+
+  VideoSinkInterface<webrtc::VideoFrame>* const sink_;
+  const bool mailbox_;
+
+  webrtc::Mutex mailbox_lock_;
+  std::unique_ptr<webrtc::TaskQueueBase, webrtc::TaskQueueDeleter> queue_
+      RTC_GUARDED_BY(mailbox_lock_);
+  absl::optional<webrtc::VideoFrame> pending_frame_
+      RTC_GUARDED_BY(mailbox_lock_);
+  int pending_discards_ RTC_GUARDED_BY(mailbox_lock_) = 0;
+  bool superseded_frame_ RTC_GUARDED_BY(mailbox_lock_) = false;
+  bool drain_pending_ RTC_GUARDED_BY(mailbox_lock_) = false;
+
+  // Held while the sink is called.
+  webrtc::Mutex delivery_lock_;
+  bool stopped_ RTC_GUARDED_BY(delivery_lock_) = false;
+  // A new sink has not received the previous frame either.
+  bool missed_frame_ RTC_GUARDED_BY(delivery_lock_) = true;
+};
 
 VideoBroadcaster::VideoBroadcaster() = default;
+
+VideoBroadcaster::VideoBroadcaster(const FanOutConfig& fan_out_config)
+    : fan_out_config_(fan_out_config) {
+  RTC_DCHECK(!fan_out_config_.sink_queue_factory || fan_out_config_.lock_free);
+}
+
 VideoBroadcaster::~VideoBroadcaster() = default;
 
 void VideoBroadcaster::AddOrUpdateSink(
@@ -43,14 +232,31 @@ void VideoBroadcaster::AddOrUpdateSink(
   }
   VideoSourceBase::AddOrUpdateSink(sink, wants);
   UpdateWants();
+  if (fan_out_config_.lock_free) {
+    std::vector<std::shared_ptr<SinkDelivery>> removed = UpdateSnapshot();
+    RTC_DCHECK(removed.empty());
+  }
 }
 
 void VideoBroadcaster::RemoveSink(
     VideoSinkInterface<webrtc::VideoFrame>* sink) {
   RTC_DCHECK(sink != nullptr);
-  webrtc::MutexLock lock(&sinks_and_wants_lock_);
-  VideoSourceBase::RemoveSink(sink);
-  UpdateWants();
+  RTC_DCHECK(current_delivery != this)
+      << "Sinks must not be removed from within OnFrame.";
+  std::vector<std::shared_ptr<SinkDelivery>> removed;
+  {
+    webrtc::MutexLock lock(&sinks_and_wants_lock_);
+    VideoSourceBase::RemoveSink(sink);
+    UpdateWants();
+    if (fan_out_config_.lock_free) {
+      removed = UpdateSnapshot();
+    }
+  }
+  // Stopping waits for a frame being delivered to the sink, so it is done
+  // without blocking the other sinks or OnFrame.
+  for (const auto& delivery : removed) {
+    delivery->Stop();
+  }
 }
 
 bool VideoBroadcaster::frame_wanted() const {
@@ -64,7 +270,22 @@ VideoSinkWants VideoBroadcaster::wants() const {
 }
 
 void VideoBroadcaster::OnFrame(const webrtc::VideoFrame& frame) {
+  if (fan_out_config_.lock_free) {
+    OnFrameFromSnapshot(frame);
+    return;
+  }
   webrtc::MutexLock lock(&sinks_and_wants_lock_);
+  ScopedDelivery scoped_delivery(this);
+  // When several sinks consume the frame, let the ones scaling it to the same
+  // resolution (e.g. a preview and an encoder layer) share the scaled buffer.
+  webrtc::VideoFrame shared_frame = frame;
+  if (sink_pairs().size() > 1 &&
+      absl::c_any_of(sink_pairs(), [&](const SinkPair& sink_pair) {
+        return WantsScaledFrame(sink_pair.wants, frame);
+      })) {
+    shared_frame.set_video_frame_buffer(
+        webrtc::CachingScaledI420Buffer::Wrap(frame.video_frame_buffer()));
+  }
   bool current_frame_was_discarded = false;
   for (auto& sink_pair : sink_pairs()) {
     if (sink_pair.wants.rotation_applied &&
@@ -91,18 +312,28 @@ void VideoBroadcaster::OnFrame(const webrtc::VideoFrame& frame) {
     } else if (!previous_frame_sent_to_all_sinks_ && frame.has_update_rect()) {
       // Since last frame was not sent to some sinks, no reliable update
       // information is available, so we need to clear the update rect.
-      webrtc::VideoFrame copy = frame;
+      webrtc::VideoFrame copy = shared_frame;
       copy.clear_update_rect();
       sink_pair.sink->OnFrame(copy);
     } else {
-      sink_pair.sink->OnFrame(frame);
+      sink_pair.sink->OnFrame(shared_frame);
     }
   }
   previous_frame_sent_to_all_sinks_ = !current_frame_was_discarded;
 }
 
 void VideoBroadcaster::OnDiscardedFrame() {
+  if (fan_out_config_.lock_free) {
+    std::shared_ptr<const SinkSnapshot> snapshot = GetSnapshot();
+    if (snapshot) {
+      for (const SnapshotEntry& entry : *snapshot) {
+        entry.delivery->OnDiscardedFrame();
+      }
+    }
+    return;
+  }
   webrtc::MutexLock lock(&sinks_and_wants_lock_);
+  ScopedDelivery scoped_delivery(this);
   for (auto& sink_pair : sink_pairs()) {
     sink_pair.sink->OnDiscardedFrame();
   }
@@ -211,4 +442,82 @@ VideoBroadcaster::GetBlackFrameBuffer(int width, int height) {
   return black_frame_buffer_;
 }
 
+std::shared_ptr<const VideoBroadcaster::SinkSnapshot>
+VideoBroadcaster::GetSnapshot() const {
+  webrtc::MutexLock lock(&snapshot_lock_);
+  return snapshot_;
+}
+
+std::vector<std::shared_ptr<VideoBroadcaster::SinkDelivery>>
+VideoBroadcaster::UpdateSnapshot() {
+  std::shared_ptr<const SinkSnapshot> old_snapshot = GetSnapshot();
+  std::vector<std::shared_ptr<SinkDelivery>> removed;
+  if (old_snapshot) {
+    for (const SnapshotEntry& entry : *old_snapshot) {
+      removed.push_back(entry.delivery);
+    }
+  }
+
+  auto snapshot = std::make_shared<SinkSnapshot>();
+  snapshot->reserve(sink_pairs().size());
+  for (const SinkPair& sink_pair : sink_pairs()) {
+    auto it = std::find_if(removed.begin(), removed.end(),
+                           [&](const std::shared_ptr<SinkDelivery>& delivery) {
+                             return delivery->sink() == sink_pair.sink;
+                           });
+    std::shared_ptr<SinkDelivery> delivery;
+    if (it != removed.end()) {
+      delivery = std::move(*it);
+      removed.erase(it);
+    } else {
+      delivery = std::make_shared<SinkDelivery>(
+          sink_pair.sink, fan_out_config_.sink_queue_factory);
+    }
+    snapshot->push_back({std::move(delivery), sink_pair.wants});
+  }
+
+  webrtc::MutexLock lock(&snapshot_lock_);
+  snapshot_ = std::move(snapshot);
+  return removed;
+}
+
+void VideoBroadcaster::OnFrameFromSnapshot(const webrtc::VideoFrame& frame) {
+  std::shared_ptr<const SinkSnapshot> snapshot = GetSnapshot();
+  if (!snapshot) {
+    return;
+  }
+  webrtc::VideoFrame shared_frame = frame;
+  if (snapshot->size() > 1 &&
+      absl::c_any_of(*snapshot, [&](const SnapshotEntry& entry) {
+        return WantsScaledFrame(entry.wants, frame);
+      })) {
+    shared_frame.set_video_frame_buffer(
+        webrtc::CachingScaledI420Buffer::Wrap(frame.video_frame_buffer()));
+  }
+  absl::optional<webrtc::VideoFrame> black_frame;
+  for (const SnapshotEntry& entry : *snapshot) {
+    if (entry.wants.rotation_applied &&
+        frame.rotation() != webrtc::kVideoRotation_0) {
+      RTC_LOG(LS_VERBOSE) << "Discarding frame with unexpected rotation.";
+      entry.delivery->OnDiscardedFrame();
+      continue;
+    }
+    if (entry.wants.black_frames) {
+      if (!black_frame) {
+        webrtc::MutexLock lock(&sinks_and_wants_lock_);
+        black_frame = webrtc::VideoFrame::Builder()
+                          .set_video_frame_buffer(GetBlackFrameBuffer(
+                              frame.width(), frame.height()))
+                          .set_rotation(frame.rotation())
+                          .set_timestamp_us(frame.timestamp_us())
+                          .set_id(frame.id())
+                          .build();
+      }
+      entry.delivery->OnFrame(*black_frame);
+    } else {
+      entry.delivery->OnFrame(shared_frame);
+    }
+  }
+}
+
 }  // namespace rtc
@@ -11,9 +11,13 @@
 #ifndef MEDIA_BASE_VIDEO_BROADCASTER_H_
 #define MEDIA_BASE_VIDEO_BROADCASTER_H_
 
+#include <memory>
+#include <vector>
+
 #include "api/media_stream_interface.h"
 #include "api/scoped_refptr.h"
 #include "api/sequence_checker.h"
+#include "api/task_queue/task_queue_factory.h"
 #include "api/video/video_frame_buffer.h"
 #include "api/video/video_source_interface.h"
 #include "media/base/video_source_base.h"
@@ -30,7 +34,22 @@ namespace rtc {
 class VideoBroadcaster : public VideoSourceBase,
                          public VideoSinkInterface<webrtc::VideoFrame> {
  public:
+  struct FanOutConfig {
+    // If true, frames are delivered from an immutable snapshot of the sinks
+    // and `sinks_and_wants_lock_` is not held while sinks run, so adding,
+    // updating or removing sinks never waits for a slow sink. RemoveSink
+    // still waits for a delivery to the removed sink that is in progress, so
+    // a sink may remove other sinks from within OnFrame, but not itself.
+    bool lock_free = false;
+    // Requires `lock_free`. If set, each sink gets a mailbox holding its
+    // latest undelivered frame, drained on a task queue of its own created by
+    // this factory. A slow sink then only drops its own frames instead of
+    // delaying the other sinks.
+    webrtc::TaskQueueFactory* sink_queue_factory = nullptr;
+  };
+
   VideoBroadcaster();
+  explicit VideoBroadcaster(const FanOutConfig& fan_out_config);
   ~VideoBroadcaster() override;
 
   // Adds a new, or updates an already existing sink. If the sink is new and
@@ -39,6 +58,9 @@ class VideoBroadcaster : public VideoSourceBase,
   // constraints.
   void AddOrUpdateSink(VideoSinkInterface<webrtc::VideoFrame>* sink,
                        const VideoSinkWants& wants) override;
+  // Must not be called from within the OnFrame or OnDiscardedFrame of a sink
+  // for the sink itself, nor for any sink unless `lock_free` is set, since it
+  // would wait for that call to return. This is DCHECKed.
   void RemoveSink(VideoSinkInterface<webrtc::VideoFrame>* sink) override;
 
   // Returns true if the next frame will be delivered to at least one sink.
@@ -68,6 +90,7 @@ class VideoBroadcaster : public VideoSourceBase,
       int height) RTC_EXCLUSIVE_LOCKS_REQUIRED(sinks_and_wants_lock_);
 
   mutable webrtc::Mutex sinks_and_wants_lock_;
+  const FanOutConfig fan_out_config_;
 
   VideoSinkWants current_wants_ RTC_GUARDED_BY(sinks_and_wants_lock_);
   rtc::scoped_refptr<webrtc::VideoFrameBuffer> black_frame_buffer_;
@@ -75,6 +98,26 @@ class VideoBroadcaster : public VideoSourceBase,
       true;
   absl::optional<webrtc::VideoTrackSourceConstraints> last_constraints_
       RTC_GUARDED_BY(sinks_and_wants_lock_);
+
+ private:
+  class SinkDelivery;
+  struct SnapshotEntry {
+    std::shared_ptr<SinkDelivery> delivery;
+    VideoSinkWants wants;
+  };
+  using SinkSnapshot = std::vector<SnapshotEntry>;
+
+  std::shared_ptr<const SinkSnapshot> GetSnapshot() const;
+  // Publishes a new snapshot matching sink_pairs(), reusing the deliveries of
+  // sinks already in the current one. Returns the deliveries of sinks that
+  // are no longer present; the caller must stop them.
+  std::vector<std::shared_ptr<SinkDelivery>> UpdateSnapshot()
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(sinks_and_wants_lock_);
+  void OnFrameFromSnapshot(const webrtc::VideoFrame& frame);
+
+  // Only held to read or replace `snapshot_`, never while sinks run.
+  mutable webrtc::Mutex snapshot_lock_;
+  std::shared_ptr<const SinkSnapshot> snapshot_ RTC_GUARDED_BY(snapshot_lock_);
 };
 
 }  // namespace rtc
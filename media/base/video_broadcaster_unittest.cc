@@ -11,13 +11,20 @@
 #include "media/base/video_broadcaster.h"
 
 #include <limits>
+#include <memory>
+#include <vector>
 
 #include "absl/types/optional.h"
+#include "api/task_queue/default_task_queue_factory.h"
+#include "api/task_queue/task_queue_factory.h"
+#include "api/units/time_delta.h"
 #include "api/video/i420_buffer.h"
 #include "api/video/video_frame.h"
 #include "api/video/video_rotation.h"
 #include "api/video/video_source_interface.h"
 #include "media/base/fake_video_renderer.h"
+#include "rtc_base/event.h"
+#include "rtc_base/synchronization/mutex.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
 
@@ -90,6 +97,57 @@ TEST(VideoBroadcasterTest, OnFrame) {
   EXPECT_EQ(3, sink2.num_rendered_frames());
 }
 
+class BufferRecordingSink : public rtc::VideoSinkInterface<webrtc::VideoFrame> {
+ public:
+  void OnFrame(const webrtc::VideoFrame& frame) override {
+    buffer_ = frame.video_frame_buffer();
+  }
+  const webrtc::VideoFrameBuffer* buffer() const { return buffer_.get(); }
+
+ private:
+  rtc::scoped_refptr<webrtc::VideoFrameBuffer> buffer_;
+};
+
+webrtc::VideoFrame CreateI420Frame(int width, int height) {
+  rtc::scoped_refptr<webrtc::I420Buffer> buffer =
+      webrtc::I420Buffer::Create(width, height);
+  webrtc::I420Buffer::SetBlack(buffer.get());
+  return webrtc::VideoFrame::Builder()
+      .set_video_frame_buffer(buffer)
+      .set_rotation(webrtc::kVideoRotation_0)
+      .set_timestamp_us(0)
+      .build();
+}
+
+TEST(VideoBroadcasterTest, PassesBufferThroughWhenNoSinkScales) {
+  VideoBroadcaster broadcaster;
+  BufferRecordingSink sink1;
+  BufferRecordingSink sink2;
+  broadcaster.AddOrUpdateSink(&sink1, VideoSinkWants());
+  broadcaster.AddOrUpdateSink(&sink2, VideoSinkWants());
+
+  webrtc::VideoFrame frame = CreateI420Frame(100, 50);
+  broadcaster.OnFrame(frame);
+  EXPECT_EQ(sink1.buffer(), frame.video_frame_buffer().get());
+  EXPECT_EQ(sink2.buffer(), frame.video_frame_buffer().get());
+}
+
+TEST(VideoBroadcasterTest, SharesScaledBuffersWhenASinkScales) {
+  VideoBroadcaster broadcaster;
+  BufferRecordingSink sink1;
+  BufferRecordingSink sink2;
+  VideoSinkWants scaling_wants;
+  scaling_wants.resolutions = {FrameSize(50, 25), FrameSize(100, 50)};
+  broadcaster.AddOrUpdateSink(&sink1, scaling_wants);
+  broadcaster.AddOrUpdateSink(&sink2, VideoSinkWants());
+
+  webrtc::VideoFrame frame = CreateI420Frame(100, 50);
+  broadcaster.OnFrame(frame);
+  ASSERT_NE(sink1.buffer(), nullptr);
+  EXPECT_NE(sink1.buffer(), frame.video_frame_buffer().get());
+  EXPECT_EQ(sink1.buffer(), sink2.buffer());
+}
+
 TEST(VideoBroadcasterTest, AppliesRotationIfAnySinkWantsRotationApplied) {
   VideoBroadcaster broadcaster;
   EXPECT_FALSE(broadcaster.wants().rotation_applied);
@@ -436,3 +494,165 @@ TEST(VideoBroadcasterTest, IgnoreInactiveSinkIfNewApiUsed) {
   broadcaster.RemoveSink(&sink2);
   EXPECT_EQ(broadcaster.wants().resolution_alignment, 1);
 }
+
+namespace {
+
+webrtc::VideoFrame CreateFrame(uint16_t id) {
+  rtc::scoped_refptr<webrtc::I420Buffer> buffer(
+      webrtc::I420Buffer::Create(/*width=*/16, /*height=*/16));
+  webrtc::I420Buffer::SetBlack(buffer.get());
+  return webrtc::VideoFrame::Builder()
+      .set_video_frame_buffer(buffer)
+      .set_rotation(webrtc::kVideoRotation_0)
+      .set_timestamp_us(0)
+      .set_id(id)
+      .build();
+}
+
+}  // namespace
+
+TEST(VideoBroadcasterTest, LockFreeFanOutDeliversToCurrentSinks) {
+  VideoBroadcaster::FanOutConfig config;
+  config.lock_free = true;
+  VideoBroadcaster broadcaster(config);
+
+  FakeVideoRenderer sink1;
+  FakeVideoRenderer sink2;
+  broadcaster.AddOrUpdateSink(&sink1, rtc::VideoSinkWants());
+  broadcaster.AddOrUpdateSink(&sink2, rtc::VideoSinkWants());
+  webrtc::VideoFrame frame = CreateFrame(1);
+
+  broadcaster.OnFrame(frame);
+  EXPECT_EQ(1, sink1.num_rendered_frames());
+  EXPECT_EQ(1, sink2.num_rendered_frames());
+
+  broadcaster.RemoveSink(&sink1);
+  broadcaster.OnFrame(frame);
+  EXPECT_EQ(1, sink1.num_rendered_frames());
+  EXPECT_EQ(2, sink2.num_rendered_frames());
+
+  broadcaster.AddOrUpdateSink(&sink1, rtc::VideoSinkWants());
+  broadcaster.OnFrame(frame);
+  EXPECT_EQ(2, sink1.num_rendered_frames());
+  EXPECT_EQ(3, sink2.num_rendered_frames());
+}
+
+TEST(VideoBroadcasterTest, LockFreeFanOutAllowsSinkToUpdateWantsFromOnFrame) {
+  VideoBroadcaster::FanOutConfig config;
+  config.lock_free = true;
+  VideoBroadcaster broadcaster(config);
+
+  // Like an encoder adapting its resolution when it sees a new frame. With the
+  // lock held during delivery this would deadlock.
+  class AdaptingSink : public rtc::VideoSinkInterface<webrtc::VideoFrame> {
+   public:
+    explicit AdaptingSink(VideoBroadcaster* broadcaster)
+        : broadcaster_(broadcaster) {}
+    void OnFrame(const webrtc::VideoFrame& frame) override {
+      VideoSinkWants wants;
+      wants.max_pixel_count = frame.size() / 2;
+      broadcaster_->AddOrUpdateSink(this, wants);
+    }
+
+   private:
+    VideoBroadcaster* const broadcaster_;
+  };
+  AdaptingSink sink(&broadcaster);
+  broadcaster.AddOrUpdateSink(&sink, VideoSinkWants());
+
+  webrtc::VideoFrame frame = CreateFrame(1);
+  broadcaster.OnFrame(frame);
+  EXPECT_EQ(broadcaster.wants().max_pixel_count, frame.size() / 2);
+}
+
+TEST(VideoBroadcasterTest, SinkMailboxOnlyDropsFramesForSlowSink) {
+  std::unique_ptr<webrtc::TaskQueueFactory> queue_factory =
+      webrtc::CreateDefaultTaskQueueFactory();
+  VideoBroadcaster::FanOutConfig config;
+  config.lock_free = true;
+  config.sink_queue_factory = queue_factory.get();
+  VideoBroadcaster broadcaster(config);
+
+  class RecordingSink : public rtc::VideoSinkInterface<webrtc::VideoFrame> {
+   public:
+    explicit RecordingSink(size_t expected_frames)
+        : expected_frames_(expected_frames) {}
+    void OnFrame(const webrtc::VideoFrame& frame) override {
+      entered_.Set();
+      release_.Wait(rtc::Event::kForever);
+      webrtc::MutexLock lock(&mutex_);
+      ids_.push_back(frame.id());
+      if (ids_.size() == expected_frames_) {
+        done_.Set();
+      }
+    }
+    std::vector<uint16_t> ids() {
+      webrtc::MutexLock lock(&mutex_);
+      return ids_;
+    }
+
+    const size_t expected_frames_;
+    rtc::Event entered_;
+    rtc::Event release_{/*manual_reset=*/true, /*initially_signaled=*/false};
+    rtc::Event done_;
+
+   private:
+    webrtc::Mutex mutex_;
+    std::vector<uint16_t> ids_;
+  };
+  RecordingSink slow_sink(/*expected_frames=*/2);
+  RecordingSink fast_sink(/*expected_frames=*/3);
+  fast_sink.release_.Set();
+  broadcaster.AddOrUpdateSink(&slow_sink, VideoSinkWants());
+  broadcaster.AddOrUpdateSink(&fast_sink, VideoSinkWants());
+
+  broadcaster.OnFrame(CreateFrame(1));
+  ASSERT_TRUE(slow_sink.entered_.Wait(webrtc::TimeDelta::Seconds(5)));
+  ASSERT_TRUE(fast_sink.entered_.Wait(webrtc::TimeDelta::Seconds(5)));
+  // The slow sink is stuck in frame 1; delivering more frames neither blocks
+  // nor delays the fast sink. The fast sink takes each frame from its mailbox
+  // before the next one is delivered, so none of its frames are coalesced.
+  broadcaster.OnFrame(CreateFrame(2));
+  ASSERT_TRUE(fast_sink.entered_.Wait(webrtc::TimeDelta::Seconds(5)));
+  broadcaster.OnFrame(CreateFrame(3));
+  ASSERT_TRUE(fast_sink.done_.Wait(webrtc::TimeDelta::Seconds(5)));
+  EXPECT_THAT(fast_sink.ids(), ::testing::ElementsAre(1, 2, 3));
+
+  slow_sink.release_.Set();
+  ASSERT_TRUE(slow_sink.done_.Wait(webrtc::TimeDelta::Seconds(5)));
+  EXPECT_THAT(slow_sink.ids(), ::testing::ElementsAre(1, 3));
+
+  broadcaster.RemoveSink(&slow_sink);
+  broadcaster.RemoveSink(&fast_sink);
+}
+
+TEST(VideoBroadcasterTest, LockFreeSinkCanRemoveOtherSinkFromOnFrame) {
+  VideoBroadcaster::FanOutConfig config;
+  config.lock_free = true;
+  VideoBroadcaster broadcaster(config);
+
+  FakeVideoRenderer other_sink;
+  class RemovingSink : public rtc::VideoSinkInterface<webrtc::VideoFrame> {
+   public:
+    RemovingSink(VideoBroadcaster* broadcaster,
+                 rtc::VideoSinkInterface<webrtc::VideoFrame>* sink)
+        : broadcaster_(broadcaster), sink_(sink) {}
+    void OnFrame(const webrtc::VideoFrame&) override {
+      broadcaster_->RemoveSink(sink_);
+    }
+
+   private:
+    VideoBroadcaster* const broadcaster_;
+    rtc::VideoSinkInterface<webrtc::VideoFrame>* const sink_;
+  };
+  RemovingSink removing_sink(&broadcaster, &other_sink);
+  broadcaster.AddOrUpdateSink(&removing_sink, VideoSinkWants());
+  broadcaster.AddOrUpdateSink(&other_sink, VideoSinkWants());
+
+  broadcaster.OnFrame(CreateFrame(1));
+  EXPECT_EQ(other_sink.num_rendered_frames(), 0);
+  broadcaster.OnFrame(CreateFrame(2));
+  EXPECT_EQ(other_sink.num_rendered_frames(), 0);
+
+  broadcaster.RemoveSink(&removing_sink);
+}
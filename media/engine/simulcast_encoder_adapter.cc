@@ -22,6 +22,8 @@
 #include "absl/types/optional.h"
 #include "api/field_trials_view.h"
 #include "api/scoped_refptr.h"
+#include "api/task_queue/task_queue_factory.h"
+#include "api/video/encoded_image.h"
 #include "api/video/i420_buffer.h"
 #include "api/video/video_codec_constants.h"
 #include "api/video/video_frame_buffer.h"
@@ -29,6 +31,7 @@
 #include "api/video_codecs/video_encoder.h"
 #include "api/video_codecs/video_encoder_factory.h"
 #include "api/video_codecs/video_encoder_software_fallback_wrapper.h"
+#include "common_video/include/caching_scaled_i420_buffer.h"
 #include "media/base/media_constants.h"
 #include "media/base/sdp_video_format_utils.h"
 #include "media/base/video_common.h"
@@ -36,6 +39,7 @@
 #include "modules/video_coding/include/video_error_codes_utils.h"
 #include "modules/video_coding/utility/simulcast_rate_allocator.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/event.h"
 #include "rtc_base/experiments/rate_control_settings.h"
 #include "rtc_base/logging.h"
 
@@ -197,7 +201,8 @@ SimulcastEncoderAdapter::StreamContext::StreamContext(StreamContext&& rhs)
       width_(rhs.width_),
       height_(rhs.height_),
       is_keyframe_needed_(rhs.is_keyframe_needed_),
-      is_paused_(rhs.is_paused_) {
+      is_paused_(rhs.is_paused_),
+      drop_next_frame_(rhs.drop_next_frame_) {
   if (parent_) {
     encoder_context_->encoder().RegisterEncodeCompleteCallback(this);
   }
@@ -217,6 +222,7 @@ SimulcastEncoderAdapter::StreamContext::ReleaseEncoderContext() && {
 
 void SimulcastEncoderAdapter::StreamContext::OnKeyframe(Timestamp timestamp) {
   is_keyframe_needed_ = false;
+  drop_next_frame_ = false;
   if (framerate_controller_) {
     framerate_controller_->KeepFrame(timestamp.us() * 1000);
   }
@@ -224,6 +230,10 @@ void SimulcastEncoderAdapter::StreamContext::OnKeyframe(Timestamp timestamp) {
 
 bool SimulcastEncoderAdapter::StreamContext::ShouldDropFrame(
     Timestamp timestamp) {
+  if (drop_next_frame_) {
+    drop_next_frame_ = false;
+    return true;
+  }
   if (!framerate_controller_) {
     return false;
   }
@@ -265,7 +275,9 @@ SimulcastEncoderAdapter::SimulcastEncoderAdapter(
               .Vp8BoostBaseLayerQuality()),
       prefer_temporal_support_on_base_layer_(env_.field_trials().IsEnabled(
           "WebRTC-Video-PreferTemporalSupportOnBaseLayer")),
-      per_layer_pli_(SupportsPerLayerPictureLossIndication(format.parameters)) {
+      per_layer_pli_(SupportsPerLayerPictureLossIndication(format.parameters)),
+      parallel_encode_(env_.field_trials().IsEnabled(
+          "WebRTC-SimulcastEncoderAdapter-ParallelEncode")) {
   RTC_DCHECK(primary_factory);
 
   // The adapter is typically created on the worker thread, but operated on
@@ -440,6 +452,13 @@ int SimulcastEncoderAdapter::InitEncode(
   // To save memory, don't store encoders that we don't use.
   DestroyStoredEncoders();
 
+  if (parallel_encode_) {
+    while (encode_workers_.size() + 1 < stream_contexts_.size()) {
+      encode_workers_.push_back(env_.task_queue_factory().CreateTaskQueue(
+          "SimulcastEncodeWorker", TaskQueueFactory::Priority::NORMAL));
+    }
+  }
+
   inited_.store(1);
   return WEBRTC_VIDEO_CODEC_OK;
 }
@@ -489,10 +508,12 @@ int SimulcastEncoderAdapter::Encode(
     }
   }
 
-  // Temporary thay may hold the result of texture to i420 buffer conversion.
-  rtc::scoped_refptr<VideoFrameBuffer> src_buffer;
-  int src_width = input_image.width();
-  int src_height = input_image.height();
+  struct LayerEncode {
+    StreamContext* layer;
+    std::vector<VideoFrameType> frame_types;
+  };
+  std::vector<LayerEncode> layer_encodes;
+  layer_encodes.reserve(stream_contexts_.size());
 
   for (auto& layer : stream_contexts_) {
     // Don't encode frames in resolutions that we don't intend to send.
@@ -542,52 +563,149 @@ int SimulcastEncoderAdapter::Encode(
       continue;
     }
 
-    // If scaling isn't required, because the input resolution
-    // matches the destination or the input image is empty (e.g.
-    // a keyframe request for encoders with internal camera
-    // sources) or the source image has a native handle, pass the image on
-    // directly. Otherwise, we'll scale it to match what the encoder expects
-    // (below).
-    // For texture frames, the underlying encoder is expected to be able to
-    // correctly sample/scale the source texture.
-    // TODO(perkj): ensure that works going forward, and figure out how this
-    // affects webrtc:5683.
-    if ((layer.width() == src_width && layer.height() == src_height) ||
-        (input_image.video_frame_buffer()->type() ==
-             VideoFrameBuffer::Type::kNative &&
-         layer.encoder().GetEncoderInfo().supports_native_handle)) {
-      int ret = layer.encoder().Encode(input_image, &stream_frame_types);
-      if (ret != WEBRTC_VIDEO_CODEC_OK) {
-        return ret;
-      }
-    } else {
-      if (src_buffer == nullptr) {
-        src_buffer = input_image.video_frame_buffer();
-      }
-      rtc::scoped_refptr<VideoFrameBuffer> dst_buffer =
-          src_buffer->Scale(layer.width(), layer.height());
-      if (!dst_buffer) {
-        RTC_LOG(LS_ERROR) << "Failed to scale video frame";
-        return WEBRTC_VIDEO_CODEC_ENCODER_FAILURE;
-      }
+    layer_encodes.push_back({&layer, std::move(stream_frame_types)});
+  }
 
-      // UpdateRect is not propagated to lower simulcast layers currently.
-      // TODO(ilnik): Consider scaling UpdateRect together with the buffer.
-      VideoFrame frame(input_image);
-      frame.set_video_frame_buffer(dst_buffer);
-      frame.set_rotation(webrtc::kVideoRotation_0);
-      frame.set_update_rect(
-          VideoFrame::UpdateRect{0, 0, frame.width(), frame.height()});
-      int ret = layer.encoder().Encode(frame, &stream_frame_types);
+  // Layers downscaled from the same input share a cascaded scaling pyramid
+  // instead of each reading the full resolution frame.
+  absl::optional<VideoFrame> cached_input;
+  if (layer_encodes.size() > 1 && !bypass_mode_ &&
+      input_image.video_frame_buffer()->type() ==
+          VideoFrameBuffer::Type::kI420) {
+    cached_input.emplace(input_image);
+    cached_input->set_video_frame_buffer(
+        CachingScaledI420Buffer::Wrap(input_image.video_frame_buffer()));
+  }
+  const VideoFrame& layer_input = cached_input ? *cached_input : input_image;
+
+  // Native buffers may only be accessible from the encoder queue, so they are
+  // always scaled and encoded sequentially.
+  const bool encode_in_parallel =
+      parallel_encode_ && !bypass_mode_ && layer_encodes.size() > 1 &&
+      layer_input.video_frame_buffer()->type() !=
+          VideoFrameBuffer::Type::kNative;
+  if (!encode_in_parallel) {
+    for (const LayerEncode& layer_encode : layer_encodes) {
+      int ret = EncodeLayer(*layer_encode.layer, layer_input,
+                            layer_encode.frame_types);
       if (ret != WEBRTC_VIDEO_CODEC_OK) {
         return ret;
       }
     }
+    return WEBRTC_VIDEO_CODEC_OK;
   }
 
+  {
+    MutexLock lock(&captured_images_mutex_);
+    capture_encoded_images_ = true;
+  }
+  // Layers are bound to queues by their position in `stream_contexts_` so that
+  // an encoder instance is always used from the same queue. Only the first
+  // stream context encodes on this queue; it may not be among the layers.
+  auto position = [&](const LayerEncode& layer_encode) {
+    return static_cast<size_t>(layer_encode.layer - stream_contexts_.data());
+  };
+  const bool first_layer_encodes = position(layer_encodes[0]) == 0;
+  std::vector<int> results(layer_encodes.size(), WEBRTC_VIDEO_CODEC_OK);
+  std::atomic<int> pending(static_cast<int>(layer_encodes.size()) -
+                           (first_layer_encodes ? 1 : 0));
+  rtc::Event done;
+  for (size_t i = first_layer_encodes ? 1 : 0; i < layer_encodes.size(); ++i) {
+    size_t worker_idx = position(layer_encodes[i]) - 1;
+    RTC_DCHECK_LT(worker_idx, encode_workers_.size());
+    encode_workers_[worker_idx]->PostTask([&, i] {
+      results[i] = EncodeLayer(*layer_encodes[i].layer, layer_input,
+                               layer_encodes[i].frame_types);
+      if (pending.fetch_sub(1) == 1) {
+        done.Set();
+      }
+    });
+  }
+  if (first_layer_encodes) {
+    results[0] = EncodeLayer(*layer_encodes[0].layer, layer_input,
+                             layer_encodes[0].frame_types);
+  }
+  done.Wait(rtc::Event::kForever);
+
+  DeliverCapturedEncodedImages();
+
+  for (int ret : results) {
+    if (ret != WEBRTC_VIDEO_CODEC_OK) {
+      return ret;
+    }
+  }
   return WEBRTC_VIDEO_CODEC_OK;
 }
 
+int SimulcastEncoderAdapter::EncodeLayer(
+    StreamContext& layer,
+    const VideoFrame& input_image,
+    const std::vector<VideoFrameType>& frame_types) {
+  // If scaling isn't required, because the input resolution
+  // matches the destination or the input image is empty (e.g.
+  // a keyframe request for encoders with internal camera
+  // sources) or the source image has a native handle, pass the image on
+  // directly. Otherwise, we'll scale it to match what the encoder expects
+  // (below).
+  // For texture frames, the underlying encoder is expected to be able to
+  // correctly sample/scale the source texture.
+  // TODO(perkj): ensure that works going forward, and figure out how this
+  // affects webrtc:5683.
+  if ((layer.width() == input_image.width() &&
+       layer.height() == input_image.height()) ||
+      (input_image.video_frame_buffer()->type() ==
+           VideoFrameBuffer::Type::kNative &&
+       layer.encoder().GetEncoderInfo().supports_native_handle)) {
+    return layer.encoder().Encode(input_image, &frame_types);
+  }
+
+  rtc::scoped_refptr<VideoFrameBuffer> dst_buffer =
+      input_image.video_frame_buffer()->Scale(layer.width(), layer.height());
+  if (!dst_buffer) {
+    RTC_LOG(LS_ERROR) << "Failed to scale video frame";
+    return WEBRTC_VIDEO_CODEC_ENCODER_FAILURE;
+  }
+
+  // UpdateRect is not propagated to lower simulcast layers currently.
+  // TODO(ilnik): Consider scaling UpdateRect together with the buffer.
+  VideoFrame frame(input_image);
+  frame.set_video_frame_buffer(dst_buffer);
+  frame.set_rotation(webrtc::kVideoRotation_0);
+  frame.set_update_rect(
+      VideoFrame::UpdateRect{0, 0, frame.width(), frame.height()});
+  return layer.encoder().Encode(frame, &frame_types);
+}
+
+void SimulcastEncoderAdapter::DeliverCapturedEncodedImages() {
+  std::vector<CapturedEncodedImage> captured_images;
+  {
+    MutexLock lock(&captured_images_mutex_);
+    capture_encoded_images_ = false;
+    captured_images.swap(captured_images_);
+  }
+  // Keep the order in which each layer produced its images, but deliver the
+  // layers in the same order as sequential encoding would.
+  absl::c_stable_sort(captured_images, [](const CapturedEncodedImage& a,
+                                          const CapturedEncodedImage& b) {
+    return a.stream_idx < b.stream_idx;
+  });
+  for (const CapturedEncodedImage& captured : captured_images) {
+    EncodedImageCallback::Result result =
+        encoded_complete_callback_->OnEncodedImage(
+            captured.encoded_image, &captured.codec_specific_info);
+    if (result.error == EncodedImageCallback::Result::OK &&
+        result.drop_next_frame) {
+      // The encoder was told OK when the image was captured, so drop the
+      // layer's next frame here instead.
+      for (StreamContext& layer : stream_contexts_) {
+        if (static_cast<size_t>(layer.stream_idx()) == captured.stream_idx) {
+          layer.set_drop_next_frame();
+        }
+      }
+    }
+  }
+}
+
 int SimulcastEncoderAdapter::RegisterEncodeCompleteCallback(
     EncodedImageCallback* callback) {
   RTC_DCHECK_RUN_ON(&encoder_queue_);
@@ -696,6 +814,20 @@ EncodedImageCallback::Result SimulcastEncoderAdapter::OnEncodedImage(
 
   stream_image.SetSimulcastIndex(stream_idx);
 
+  {
+    MutexLock lock(&captured_images_mutex_);
+    if (capture_encoded_images_) {
+      // The encoder may reuse its output buffer once the callback returns, so
+      // keep a copy until the image is delivered.
+      stream_image.SetEncodedData(EncodedImageBuffer::Create(
+          encodedImage.data(), encodedImage.size()));
+      captured_images_.push_back(
+          {stream_idx, std::move(stream_image), stream_codec_specific});
+      return EncodedImageCallback::Result(EncodedImageCallback::Result::OK,
+                                          encodedImage.RtpTimestamp());
+    }
+  }
+
   return encoded_complete_callback_->OnEncodedImage(stream_image,
                                                     &stream_codec_specific);
 }
@@ -26,14 +26,17 @@
 #include "api/fec_controller_override.h"
 #include "api/field_trials_view.h"
 #include "api/sequence_checker.h"
+#include "api/task_queue/task_queue_base.h"
 #include "api/video_codecs/sdp_video_format.h"
 #include "api/video_codecs/video_encoder.h"
 #include "api/video_codecs/video_encoder_factory.h"
 #include "common_video/framerate_controller.h"
 #include "modules/video_coding/include/video_codec_interface.h"
 #include "rtc_base/experiments/encoder_info_settings.h"
+#include "rtc_base/synchronization/mutex.h"
 #include "rtc_base/system/no_unique_address.h"
 #include "rtc_base/system/rtc_export.h"
+#include "rtc_base/thread_annotations.h"
 
 namespace webrtc {
 
@@ -41,6 +44,15 @@ namespace webrtc {
 // webrtc::VideoEncoder instances with the given VideoEncoderFactory.
 // The object is created and destroyed on the worker thread, but all public
 // interfaces should be called from the encoder task queue.
+//
+// With the "WebRTC-SimulcastEncoderAdapter-ParallelEncode" field trial
+// enabled, the per-layer encoders of a multi-encoder setup encode the same
+// input frame concurrently on dedicated worker task queues and Encode() joins
+// them before returning. Encoded images produced while the layers run in
+// parallel are delivered afterwards on the encoder task queue, in layer
+// order, so the EncodedImageCallback sees the same ordering as in sequential
+// mode. This is intended for software encoders that deliver their output
+// synchronously from Encode().
 class RTC_EXPORT SimulcastEncoderAdapter : public VideoEncoder {
  public:
   // `primary_factory` produces the first-choice encoders to use.
@@ -122,6 +134,10 @@ class RTC_EXPORT SimulcastEncoderAdapter : public VideoEncoder {
     void set_is_keyframe_needed() { is_keyframe_needed_ = true; }
     bool is_paused() const { return is_paused_; }
     void set_is_paused(bool is_paused) { is_paused_ = is_paused; }
+    // Drops the next frame that is not a keyframe. Used when the encoder
+    // could not be asked to, since its image was delivered after Encode
+    // returned.
+    void set_drop_next_frame() { drop_next_frame_ = true; }
     absl::optional<double> target_fps() const {
       return framerate_controller_ == nullptr
                  ? absl::nullopt
@@ -142,6 +158,7 @@ class RTC_EXPORT SimulcastEncoderAdapter : public VideoEncoder {
     const uint16_t height_;
     bool is_keyframe_needed_;
     bool is_paused_;
+    bool drop_next_frame_ = false;
   };
 
   bool Initialized() const;
@@ -167,6 +184,21 @@ class RTC_EXPORT SimulcastEncoderAdapter : public VideoEncoder {
 
   void OnDroppedFrame(size_t stream_idx);
 
+  // Scales `input_image` to the resolution of `layer`, if needed, and encodes
+  // it. Safe to call concurrently for different layers.
+  static int EncodeLayer(StreamContext& layer,
+                         const VideoFrame& input_image,
+                         const std::vector<VideoFrameType>& frame_types);
+
+  // Encoded image captured from a worker queue, to be delivered in layer
+  // order once all layers have finished encoding.
+  struct CapturedEncodedImage {
+    size_t stream_idx;
+    EncodedImage encoded_image;
+    CodecSpecificInfo codec_specific_info;
+  };
+  void DeliverCapturedEncodedImages();
+
   void OverrideFromFieldTrial(VideoEncoder::EncoderInfo* info) const;
 
   const Environment env_;
@@ -195,6 +227,17 @@ class RTC_EXPORT SimulcastEncoderAdapter : public VideoEncoder {
   const bool per_layer_pli_;
 
   const SimulcastEncoderAdapterEncoderInfoSettings encoder_info_override_;
+
+  const bool parallel_encode_;
+  // Worker queues used in parallel encode mode. `stream_contexts_[i]` always
+  // encodes on `encode_workers_[i - 1]`, and `stream_contexts_[0]` on the
+  // calling queue, whichever layers are paused or dropped.
+  std::vector<std::unique_ptr<TaskQueueBase, TaskQueueDeleter>>
+      encode_workers_ RTC_GUARDED_BY(encoder_queue_);
+  Mutex captured_images_mutex_;
+  bool capture_encoded_images_ RTC_GUARDED_BY(captured_images_mutex_) = false;
+  std::vector<CapturedEncodedImage> captured_images_
+      RTC_GUARDED_BY(captured_images_mutex_);
 };
 
 }  // namespace webrtc
@@ -21,6 +21,7 @@
 #include "api/test/simulcast_test_fixture.h"
 #include "api/test/video/function_video_decoder_factory.h"
 #include "api/test/video/function_video_encoder_factory.h"
+#include "api/task_queue/task_queue_base.h"
 #include "api/video/video_codec_constants.h"
 #include "api/video_codecs/sdp_video_format.h"
 #include "api/video_codecs/video_encoder.h"
@@ -32,6 +33,7 @@
 #include "modules/video_coding/include/video_codec_interface.h"
 #include "modules/video_coding/utility/simulcast_test_fixture_impl.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/event.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
 #include "test/scoped_key_value_config.h"
@@ -1899,5 +1901,172 @@ TEST_F(TestSimulcastEncoderAdapterFake, PopulatesScalabilityModeOfSubcodecs) {
             ScalabilityMode::kL1T3);
 }
 
+TEST_F(TestSimulcastEncoderAdapterFake,
+       ParallelEncodeDeliversEncodedImagesInLayerOrder) {
+  test::ScopedKeyValueConfig field_trials(
+      field_trials_, "WebRTC-SimulcastEncoderAdapter-ParallelEncode/Enabled/");
+  SetUp();
+  SetupCodec();
+  adapter_->SetRates(VideoEncoder::RateControlParameters(
+      rate_allocator_->Allocate(VideoBitrateAllocationParameters(3000, 30)),
+      30.0));
+
+  class OrderRecorder : public EncodedImageCallback {
+   public:
+    Result OnEncodedImage(
+        const EncodedImage& encoded_image,
+        const CodecSpecificInfo* codec_specific_info) override {
+      simulcast_indices.push_back(encoded_image.SimulcastIndex().value_or(0));
+      return Result(Result::OK);
+    }
+    std::vector<int> simulcast_indices;
+  } recorder;
+  adapter_->RegisterEncodeCompleteCallback(&recorder);
+
+  std::vector<MockVideoEncoder*> encoders = helper_->factory()->encoders();
+  ASSERT_EQ(3u, encoders.size());
+  // The middle layer only finishes once the top layer has produced its image,
+  // which is only possible if the layers are encoded concurrently.
+  rtc::Event top_layer_encoded;
+  bool middle_layer_unblocked = false;
+  EXPECT_CALL(*encoders[0], Encode)
+      .WillOnce([&](const VideoFrame& frame, const auto*) {
+        encoders[0]->SendEncodedImage(frame.width(), frame.height());
+        return WEBRTC_VIDEO_CODEC_OK;
+      });
+  EXPECT_CALL(*encoders[1], Encode)
+      .WillOnce([&](const VideoFrame& frame, const auto*) {
+        middle_layer_unblocked = top_layer_encoded.Wait(TimeDelta::Seconds(5));
+        encoders[1]->SendEncodedImage(frame.width(), frame.height());
+        return WEBRTC_VIDEO_CODEC_OK;
+      });
+  EXPECT_CALL(*encoders[2], Encode)
+      .WillOnce([&](const VideoFrame& frame, const auto*) {
+        encoders[2]->SendEncodedImage(frame.width(), frame.height());
+        top_layer_encoded.Set();
+        return WEBRTC_VIDEO_CODEC_OK;
+      });
+
+  rtc::scoped_refptr<I420Buffer> buffer =
+      I420Buffer::Create(kDefaultWidth, kDefaultHeight);
+  buffer->InitializeData();
+  VideoFrame input_frame = VideoFrame::Builder()
+                               .set_video_frame_buffer(buffer)
+                               .set_rtp_timestamp(100)
+                               .set_timestamp_ms(1000)
+                               .build();
+  std::vector<VideoFrameType> frame_types(3, VideoFrameType::kVideoFrameKey);
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, adapter_->Encode(input_frame, &frame_types));
+
+  EXPECT_TRUE(middle_layer_unblocked);
+  EXPECT_THAT(recorder.simulcast_indices, ::testing::ElementsAre(0, 1, 2));
+}
+
+TEST_F(TestSimulcastEncoderAdapterFake,
+       ParallelEncodeKeepsLayersOnTheirQueueWhenLowestLayerIsPaused) {
+  test::ScopedKeyValueConfig field_trials(
+      field_trials_, "WebRTC-SimulcastEncoderAdapter-ParallelEncode/Enabled/");
+  SetUp();
+  SetupCodec();
+  VideoBitrateAllocation allocation;
+  allocation.SetBitrate(0, 0, 100000);
+  allocation.SetBitrate(1, 0, 500000);
+  allocation.SetBitrate(2, 0, 1000000);
+  adapter_->SetRates(VideoEncoder::RateControlParameters(allocation, 30.0));
+
+  std::vector<MockVideoEncoder*> encoders = helper_->factory()->encoders();
+  ASSERT_EQ(3u, encoders.size());
+  std::vector<TaskQueueBase*> middle_layer_queues;
+  EXPECT_CALL(*encoders[1], Encode)
+      .Times(2)
+      .WillRepeatedly([&](const VideoFrame&, const auto*) {
+        middle_layer_queues.push_back(TaskQueueBase::Current());
+        return WEBRTC_VIDEO_CODEC_OK;
+      });
+
+  rtc::scoped_refptr<I420Buffer> buffer =
+      I420Buffer::Create(kDefaultWidth, kDefaultHeight);
+  buffer->InitializeData();
+  std::vector<VideoFrameType> frame_types(3, VideoFrameType::kVideoFrameKey);
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            adapter_->Encode(VideoFrame::Builder()
+                                 .set_video_frame_buffer(buffer)
+                                 .set_rtp_timestamp(100)
+                                 .set_timestamp_ms(1000)
+                                 .build(),
+                             &frame_types));
+
+  // With the lowest layer paused, the middle layer is the first one encoded,
+  // but still encodes on its own queue.
+  allocation.SetBitrate(0, 0, 0);
+  adapter_->SetRates(VideoEncoder::RateControlParameters(allocation, 30.0));
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            adapter_->Encode(VideoFrame::Builder()
+                                 .set_video_frame_buffer(buffer)
+                                 .set_rtp_timestamp(3100)
+                                 .set_timestamp_ms(1033)
+                                 .build(),
+                             &frame_types));
+
+  ASSERT_EQ(middle_layer_queues.size(), 2u);
+  EXPECT_NE(middle_layer_queues[0], nullptr);
+  EXPECT_EQ(middle_layer_queues[1], middle_layer_queues[0]);
+}
+
+TEST_F(TestSimulcastEncoderAdapterFake,
+       ParallelEncodeDropsNextFrameOfLayerWhenCallbackAsksTo) {
+  test::ScopedKeyValueConfig field_trials(
+      field_trials_, "WebRTC-SimulcastEncoderAdapter-ParallelEncode/Enabled/");
+  SetUp();
+  SetupCodec();
+  adapter_->SetRates(VideoEncoder::RateControlParameters(
+      rate_allocator_->Allocate(VideoBitrateAllocationParameters(3000, 30)),
+      30.0));
+
+  class DroppingCallback : public EncodedImageCallback {
+   public:
+    Result OnEncodedImage(
+        const EncodedImage& encoded_image,
+        const CodecSpecificInfo* codec_specific_info) override {
+      Result result(Result::OK);
+      result.drop_next_frame = encoded_image.SimulcastIndex() == 2;
+      return result;
+    }
+  } callback;
+  adapter_->RegisterEncodeCompleteCallback(&callback);
+
+  std::vector<MockVideoEncoder*> encoders = helper_->factory()->encoders();
+  ASSERT_EQ(3u, encoders.size());
+  for (MockVideoEncoder* encoder : encoders) {
+    EXPECT_CALL(*encoder, Encode)
+        .Times(encoder == encoders[2] ? 1 : 2)
+        .WillRepeatedly([encoder](const VideoFrame& frame, const auto*) {
+          encoder->SendEncodedImage(frame.width(), frame.height());
+          return WEBRTC_VIDEO_CODEC_OK;
+        });
+  }
+
+  rtc::scoped_refptr<I420Buffer> buffer =
+      I420Buffer::Create(kDefaultWidth, kDefaultHeight);
+  buffer->InitializeData();
+  std::vector<VideoFrameType> frame_types(3, VideoFrameType::kVideoFrameKey);
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            adapter_->Encode(VideoFrame::Builder()
+                                 .set_video_frame_buffer(buffer)
+                                 .set_rtp_timestamp(100)
+                                 .set_timestamp_ms(1000)
+                                 .build(),
+                             &frame_types));
+  // The top layer's image was delivered after its encoder returned, so the
+  // adapter drops its next frame instead.
+  EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            adapter_->Encode(VideoFrame::Builder()
+                                 .set_video_frame_buffer(buffer)
+                                 .set_rtp_timestamp(3100)
+                                 .set_timestamp_ms(1033)
+                                 .build(),
+                             /*frame_types=*/nullptr));
+}
+
 }  // namespace test
 }  // namespace webrtc
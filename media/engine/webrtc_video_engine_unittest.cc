@@ -2668,7 +2668,7 @@ class WebRtcVideoChannelTest : public WebRtcVideoEngineTest {
     return static_cast<cricket::WebRtcVideoSendChannel*>(send_channel_.get());
   }
 
-  // Casts a shim channel to a webrtc::Transport. Used once.
+  // Casts a shim channel to a webrtc::Transport.
   webrtc::Transport* ChannelImplAsTransport(
       cricket::VideoMediaSendChannelInterface* channel) {
     return static_cast<cricket::WebRtcVideoSendChannel*>(channel)->transport();
@@ -5588,6 +5588,25 @@ TEST_F(WebRtcVideoChannelTest, SetSend) {
       << "Send stream created after SetSend(true) not sending initially.";
 }
 
+TEST_F(WebRtcVideoChannelTest, GathersRtpPacketIntoBufferWithSrtpRoom) {
+  cricket::FakeNetworkInterface network_interface;
+  send_channel_->SetInterface(&network_interface);
+
+  const uint8_t kHead[] = {0x80, 0x60, 0x00, 0x01, 0x00, 0x00,
+                           0x00, 0x02, 0x00, 0x00, 0x00, 0x03};
+  const uint8_t kTail[] = {0x05, 0x25, 0x52};
+  EXPECT_TRUE(ChannelImplAsTransport(send_channel_.get())
+                  ->SendRtpGathered(kHead, kTail, webrtc::PacketOptions()));
+
+  ASSERT_EQ(network_interface.NumRtpPackets(), 1);
+  rtc::CopyOnWriteBuffer packet = network_interface.GetRtpPacket(0);
+  EXPECT_THAT(rtc::MakeArrayView(packet.cdata(), packet.size()),
+              ElementsAre(0x80, 0x60, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02,
+                          0x00, 0x00, 0x00, 0x03, 0x05, 0x25, 0x52));
+  EXPECT_GE(packet.capacity(), kMaxRtpPacketLen);
+  send_channel_->SetInterface(nullptr);
+}
+
 // This test verifies DSCP settings are properly applied on video media channel.
 TEST_F(WebRtcVideoChannelTest, TestSetDscpOptions) {
   std::unique_ptr<cricket::FakeNetworkInterface> network_interface(
@@ -25,6 +25,7 @@
 #include "rtc_base/thread_annotations.h"
 
 namespace webrtc {
+class BatchedFeedbackGenerator;
 class RemoteBitrateEstimator;
 
 // This class represents the congestion control state for receive
@@ -40,7 +41,7 @@ class ReceiveSideCongestionController : public CallStatsObserver {
       RembThrottler::RembSender remb_sender,
       NetworkStateEstimator* network_state_estimator);
 
-  ~ReceiveSideCongestionController() override {}
+  ~ReceiveSideCongestionController() override;
 
   void OnReceivedPacket(const RtpPacketReceived& packet, MediaType media_type);
 
@@ -64,6 +65,13 @@ class ReceiveSideCongestionController : public CallStatsObserver {
   // Noop if receive side bwe is not used or stream doesn't participate in it.
   void RemoveStream(uint32_t ssrc);
 
+  // Hands periodic transport feedback over to `generator`, which sends it
+  // together with the feedback of other controllers on a shared timer.
+  // `MaybeProcess` then only runs receive side estimation. `generator` must
+  // outlive this controller. Passing nullptr returns to per-controller
+  // feedback.
+  void SetBatchedFeedbackGenerator(BatchedFeedbackGenerator* generator);
+
   // Runs periodic tasks if it is time to run them, returns time until next
   // call to `MaybeProcess` should be non idle.
   TimeDelta MaybeProcess();
@@ -80,6 +88,8 @@ class ReceiveSideCongestionController : public CallStatsObserver {
   std::unique_ptr<RemoteBitrateEstimator> rbe_ RTC_GUARDED_BY(mutex_);
   bool using_absolute_send_time_ RTC_GUARDED_BY(mutex_);
   uint32_t packets_since_absolute_send_time_ RTC_GUARDED_BY(mutex_);
+  BatchedFeedbackGenerator* batched_feedback_generator_ RTC_GUARDED_BY(mutex_) =
+      nullptr;
 };
 
 }  // namespace webrtc
@@ -13,6 +13,7 @@
 #include "api/media_types.h"
 #include "api/units/data_rate.h"
 #include "modules/pacing/packet_router.h"
+#include "modules/remote_bitrate_estimator/batched_feedback_generator.h"
 #include "modules/remote_bitrate_estimator/include/bwe_defines.h"
 #include "modules/remote_bitrate_estimator/remote_bitrate_estimator_abs_send_time.h"
 #include "modules/remote_bitrate_estimator/remote_bitrate_estimator_single_stream.h"
@@ -81,6 +82,22 @@ ReceiveSideCongestionController::ReceiveSideCongestionController(
       using_absolute_send_time_(false),
       packets_since_absolute_send_time_(0) {}
 
+ReceiveSideCongestionController::~ReceiveSideCongestionController() {
+  SetBatchedFeedbackGenerator(nullptr);
+}
+
+void ReceiveSideCongestionController::SetBatchedFeedbackGenerator(
+    BatchedFeedbackGenerator* generator) {
+  MutexLock lock(&mutex_);
+  if (generator == batched_feedback_generator_)
+    return;
+  if (batched_feedback_generator_)
+    batched_feedback_generator_->RemoveProxy(&remote_estimator_proxy_);
+  batched_feedback_generator_ = generator;
+  if (batched_feedback_generator_)
+    batched_feedback_generator_->AddProxy(&remote_estimator_proxy_);
+}
+
 void ReceiveSideCongestionController::OnReceivedPacket(
     const RtpPacketReceived& packet,
     MediaType media_type) {
@@ -111,8 +128,11 @@ TimeDelta ReceiveSideCongestionController::MaybeProcess() {
   Timestamp now = clock_.CurrentTime();
   mutex_.Lock();
   TimeDelta time_until_rbe = rbe_->Process();
+  bool feedback_is_batched = batched_feedback_generator_ != nullptr;
   mutex_.Unlock();
-  TimeDelta time_until_rep = remote_estimator_proxy_.Process(now);
+  TimeDelta time_until_rep = feedback_is_batched
+                                 ? TimeDelta::PlusInfinity()
+                                 : remote_estimator_proxy_.Process(now);
   TimeDelta time_until = std::min(time_until_rbe, time_until_rep);
   return std::max(time_until, TimeDelta::Zero());
 }
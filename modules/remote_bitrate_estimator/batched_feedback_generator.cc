@@ -0,0 +1,70 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/remote_bitrate_estimator/batched_feedback_generator.h"
+
+#include <algorithm>
+
+#include "absl/algorithm/container.h"
+#include "api/sequence_checker.h"
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+namespace {
+
+// Used when no proxy has periodic feedback enabled, so that proxies that are
+// added later are served without much delay.
+constexpr TimeDelta kIdleInterval = TimeDelta::Millis(100);
+
+}  // namespace
+
+BatchedFeedbackGenerator::BatchedFeedbackGenerator(TaskQueueBase* task_queue,
+                                                   Clock* clock,
+                                                   TimeDelta coalescing_window)
+    : task_queue_(task_queue), coalescing_window_(coalescing_window) {
+  RTC_DCHECK_GE(coalescing_window_, TimeDelta::Zero());
+  process_task_ = RepeatingTaskHandle::Start(
+      task_queue_, [this, clock] { return ProcessAll(clock->CurrentTime()); },
+      TaskQueueBase::DelayPrecision::kLow, clock);
+}
+
+BatchedFeedbackGenerator::~BatchedFeedbackGenerator() {
+  RTC_DCHECK_RUN_ON(task_queue_);
+  process_task_.Stop();
+}
+
+void BatchedFeedbackGenerator::AddProxy(RemoteEstimatorProxy* proxy) {
+  RTC_DCHECK_RUN_ON(task_queue_);
+  RTC_DCHECK(!absl::c_linear_search(proxies_, proxy));
+  proxies_.push_back(proxy);
+}
+
+void BatchedFeedbackGenerator::RemoveProxy(RemoteEstimatorProxy* proxy) {
+  RTC_DCHECK_RUN_ON(task_queue_);
+  auto it = absl::c_find(proxies_, proxy);
+  if (it == proxies_.end())
+    return;
+  *it = proxies_.back();
+  proxies_.pop_back();
+}
+
+TimeDelta BatchedFeedbackGenerator::ProcessAll(Timestamp now) {
+  RTC_DCHECK_RUN_ON(task_queue_);
+  TimeDelta time_until_next = TimeDelta::PlusInfinity();
+  for (RemoteEstimatorProxy* proxy : proxies_) {
+    time_until_next =
+        std::min(time_until_next, proxy->Process(now, coalescing_window_));
+  }
+  if (time_until_next.IsInfinite())
+    return kIdleInterval;
+  return std::max(time_until_next, TimeDelta::Zero());
+}
+
+}  // namespace webrtc
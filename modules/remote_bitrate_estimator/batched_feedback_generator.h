@@ -0,0 +1,69 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_REMOTE_BITRATE_ESTIMATOR_BATCHED_FEEDBACK_GENERATOR_H_
+#define MODULES_REMOTE_BITRATE_ESTIMATOR_BATCHED_FEEDBACK_GENERATOR_H_
+
+#include <vector>
+
+#include "api/task_queue/task_queue_base.h"
+#include "api/units/time_delta.h"
+#include "api/units/timestamp.h"
+#include "modules/remote_bitrate_estimator/remote_estimator_proxy.h"
+#include "rtc_base/task_utils/repeating_task.h"
+#include "rtc_base/thread_annotations.h"
+#include "system_wrappers/include/clock.h"
+
+namespace webrtc {
+
+// Generates periodic transport feedback for many RemoteEstimatorProxy
+// instances from a single repeating task, instead of one periodic task per
+// receiving transport. Proxies that are due within `coalescing_window` of a
+// pass are served by that pass, so their feedback phases converge and the
+// number of wakeups stays bounded as the number of transports grows.
+//
+// Feedback is sent from the generator's task queue, through the packet router
+// of each proxy's call. The generator can therefore only be shared between
+// calls whose worker thread is that task queue.
+class BatchedFeedbackGenerator {
+ public:
+  static constexpr TimeDelta kDefaultCoalescingWindow = TimeDelta::Millis(5);
+
+  // Starts the shared periodic task on `task_queue`. All methods must be
+  // called, and the generator destroyed, on `task_queue`.
+  BatchedFeedbackGenerator(
+      TaskQueueBase* task_queue,
+      Clock* clock,
+      TimeDelta coalescing_window = kDefaultCoalescingWindow);
+  ~BatchedFeedbackGenerator();
+
+  BatchedFeedbackGenerator(const BatchedFeedbackGenerator&) = delete;
+  BatchedFeedbackGenerator& operator=(const BatchedFeedbackGenerator&) = delete;
+
+  // Once RemoveProxy returns, `proxy` is no longer accessed by the generator.
+  void AddProxy(RemoteEstimatorProxy* proxy);
+  void RemoveProxy(RemoteEstimatorProxy* proxy);
+
+  // Sends feedback for all proxies that are due, returns the time until the
+  // next proxy is due. Called by the periodic task, exposed for testing.
+  TimeDelta ProcessAll(Timestamp now);
+
+  TaskQueueBase* task_queue() const { return task_queue_; }
+
+ private:
+  TaskQueueBase* const task_queue_;
+  const TimeDelta coalescing_window_;
+  RepeatingTaskHandle process_task_ RTC_GUARDED_BY(task_queue_);
+  std::vector<RemoteEstimatorProxy*> proxies_ RTC_GUARDED_BY(task_queue_);
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_REMOTE_BITRATE_ESTIMATOR_BATCHED_FEEDBACK_GENERATOR_H_
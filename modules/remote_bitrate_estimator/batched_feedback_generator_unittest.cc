@@ -0,0 +1,116 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/remote_bitrate_estimator/batched_feedback_generator.h"
+
+#include <memory>
+#include <vector>
+
+#include "api/units/time_delta.h"
+#include "api/units/timestamp.h"
+#include "modules/remote_bitrate_estimator/remote_estimator_proxy.h"
+#include "modules/rtp_rtcp/source/rtcp_packet.h"
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "modules/rtp_rtcp/source/rtp_packet_received.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+#include "test/time_controller/simulated_time_controller.h"
+
+namespace webrtc {
+namespace {
+
+using ::testing::MockFunction;
+
+constexpr uint32_t kMediaSsrc = 456;
+
+class BatchedFeedbackGeneratorTest : public ::testing::Test {
+ protected:
+  BatchedFeedbackGeneratorTest()
+      : time_controller_(Timestamp::Seconds(1000)),
+        proxy_a_(feedback_sender_a_.AsStdFunction(),
+                 /*network_state_estimator=*/nullptr),
+        proxy_b_(feedback_sender_b_.AsStdFunction(),
+                 /*network_state_estimator=*/nullptr) {}
+
+  void IncomingPacket(RemoteEstimatorProxy& proxy, uint16_t seq) {
+    RtpHeaderExtensionMap map;
+    map.Register<TransportSequenceNumber>(1);
+    RtpPacketReceived packet(&map, Now());
+    packet.SetSsrc(kMediaSsrc);
+    packet.SetExtension<TransportSequenceNumber>(seq);
+    proxy.IncomingPacket(packet);
+  }
+
+  Timestamp Now() { return time_controller_.GetClock()->CurrentTime(); }
+
+  GlobalSimulatedTimeController time_controller_;
+  MockFunction<void(std::vector<std::unique_ptr<rtcp::RtcpPacket>>)>
+      feedback_sender_a_;
+  MockFunction<void(std::vector<std::unique_ptr<rtcp::RtcpPacket>>)>
+      feedback_sender_b_;
+  RemoteEstimatorProxy proxy_a_;
+  RemoteEstimatorProxy proxy_b_;
+};
+
+TEST_F(BatchedFeedbackGeneratorTest, SendsFeedbackForAllProxies) {
+  BatchedFeedbackGenerator generator(time_controller_.GetMainThread(),
+                                     time_controller_.GetClock());
+  generator.AddProxy(&proxy_a_);
+  generator.AddProxy(&proxy_b_);
+  IncomingPacket(proxy_a_, 1);
+  IncomingPacket(proxy_b_, 1);
+
+  EXPECT_CALL(feedback_sender_a_, Call).Times(1);
+  EXPECT_CALL(feedback_sender_b_, Call).Times(1);
+  time_controller_.AdvanceTime(TimeDelta::Millis(500));
+}
+
+TEST_F(BatchedFeedbackGeneratorTest, DoesNotProcessRemovedProxy) {
+  BatchedFeedbackGenerator generator(time_controller_.GetMainThread(),
+                                     time_controller_.GetClock());
+  generator.AddProxy(&proxy_a_);
+  generator.AddProxy(&proxy_b_);
+  generator.RemoveProxy(&proxy_a_);
+  IncomingPacket(proxy_a_, 1);
+  IncomingPacket(proxy_b_, 1);
+
+  EXPECT_CALL(feedback_sender_a_, Call).Times(0);
+  EXPECT_CALL(feedback_sender_b_, Call).Times(1);
+  time_controller_.AdvanceTime(TimeDelta::Millis(500));
+}
+
+TEST_F(BatchedFeedbackGeneratorTest, ServesProxiesDueWithinCoalescingWindow) {
+  BatchedFeedbackGenerator generator(time_controller_.GetMainThread(),
+                                     time_controller_.GetClock(),
+                                     TimeDelta::Millis(5));
+  const Timestamp start = Now();
+  IncomingPacket(proxy_a_, 1);
+  IncomingPacket(proxy_b_, 1);
+
+  // Give the proxies feedback phases 3 ms apart.
+  EXPECT_CALL(feedback_sender_a_, Call).Times(1);
+  generator.AddProxy(&proxy_a_);
+  generator.ProcessAll(start);
+  EXPECT_CALL(feedback_sender_b_, Call).Times(1);
+  generator.AddProxy(&proxy_b_);
+  generator.ProcessAll(start + TimeDelta::Millis(3));
+
+  IncomingPacket(proxy_a_, 2);
+  IncomingPacket(proxy_b_, 2);
+  // Proxy A is due at 100 ms and proxy B at 103 ms, both are served by a
+  // single pass at 99 ms and are aligned afterwards.
+  EXPECT_CALL(feedback_sender_a_, Call).Times(1);
+  EXPECT_CALL(feedback_sender_b_, Call).Times(1);
+  EXPECT_EQ(generator.ProcessAll(start + TimeDelta::Millis(99)),
+            TimeDelta::Millis(100));
+}
+
+}  // namespace
+}  // namespace webrtc
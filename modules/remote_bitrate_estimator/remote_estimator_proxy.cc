@@ -15,6 +15,7 @@
 #include <limits>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/types/optional.h"
 #include "api/units/data_size.h"
@@ -25,6 +26,7 @@
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/numerics/safe_minmax.h"
+#include "rtc_base/synchronization/mutex.h"
 #include "system_wrappers/include/clock.h"
 
 namespace webrtc {
@@ -34,6 +36,8 @@ constexpr TimeDelta kBackWindow = TimeDelta::Millis(500);
 constexpr TimeDelta kMinInterval = TimeDelta::Millis(50);
 constexpr TimeDelta kMaxInterval = TimeDelta::Millis(250);
 constexpr TimeDelta kDefaultInterval = TimeDelta::Millis(100);
+// Upper bound on the number of packets a feedback packet is pre-sized for.
+constexpr int64_t kMaxReservedFeedbackPackets = 1024;
 
 TimeDelta GetAbsoluteSendTimeDelta(uint32_t new_sendtime,
                                    uint32_t previous_sendtime) {
@@ -51,10 +55,67 @@ TimeDelta GetAbsoluteSendTimeDelta(uint32_t new_sendtime,
 }
 }  // namespace
 
+// Periodic feedback packets are handed over to the feedback sender, which may
+// release them on another thread. A released packet gives its buffers back to
+// the pool, and the next periodic feedback packet is built in them, so that
+// steady state feedback does not reallocate them every cycle.
+class RemoteEstimatorProxy::FeedbackPacketPool
+    : public std::enable_shared_from_this<FeedbackPacketPool> {
+ public:
+  FeedbackPacketPool() { released_.reserve(kMaxReleasedPackets); }
+
+  // Returns an empty feedback packet with timestamps, built in the buffers of
+  // a released packet when there is one.
+  std::unique_ptr<rtcp::TransportFeedback> Create() {
+    std::unique_ptr<PooledPacket> packet;
+    {
+      MutexLock lock(&mutex_);
+      if (!released_.empty()) {
+        packet = std::make_unique<PooledPacket>(std::move(released_.back()),
+                                                shared_from_this());
+        released_.pop_back();
+      }
+    }
+    if (packet == nullptr) {
+      packet = std::make_unique<PooledPacket>(
+          rtcp::TransportFeedback(/*include_timestamps=*/true),
+          shared_from_this());
+    }
+    packet->Reset();
+    return packet;
+  }
+
+ private:
+  // Bounds the buffers kept when many packets are in flight at once.
+  static constexpr size_t kMaxReleasedPackets = 4;
+
+  class PooledPacket : public rtcp::TransportFeedback {
+   public:
+    PooledPacket(rtcp::TransportFeedback buffers,
+                 std::shared_ptr<FeedbackPacketPool> pool)
+        : rtcp::TransportFeedback(std::move(buffers)), pool_(std::move(pool)) {}
+    ~PooledPacket() override { pool_->Release(std::move(*this)); }
+
+   private:
+    const std::shared_ptr<FeedbackPacketPool> pool_;
+  };
+
+  void Release(rtcp::TransportFeedback&& packet) {
+    MutexLock lock(&mutex_);
+    if (released_.size() < kMaxReleasedPackets) {
+      released_.emplace_back(std::move(packet));
+    }
+  }
+
+  Mutex mutex_;
+  std::vector<rtcp::TransportFeedback> released_ RTC_GUARDED_BY(mutex_);
+};
+
 RemoteEstimatorProxy::RemoteEstimatorProxy(
     TransportFeedbackSender feedback_sender,
     NetworkStateEstimator* network_state_estimator)
     : feedback_sender_(std::move(feedback_sender)),
+      feedback_packet_pool_(std::make_shared<FeedbackPacketPool>()),
       last_process_time_(Timestamp::MinusInfinity()),
       network_state_estimator_(network_state_estimator),
       media_ssrc_(0),
@@ -157,7 +218,7 @@ void RemoteEstimatorProxy::IncomingPacket(const RtpPacketReceived& packet) {
   }
 }
 
-TimeDelta RemoteEstimatorProxy::Process(Timestamp now) {
+TimeDelta RemoteEstimatorProxy::Process(Timestamp now, TimeDelta max_early) {
   MutexLock lock(&lock_);
   if (!send_periodic_feedback_) {
     // If TransportSequenceNumberV2 has been received in one packet,
@@ -165,7 +226,7 @@ TimeDelta RemoteEstimatorProxy::Process(Timestamp now) {
     return TimeDelta::PlusInfinity();
   }
   Timestamp next_process_time = last_process_time_ + send_interval_;
-  if (now >= next_process_time) {
+  if (now + max_early >= next_process_time) {
     last_process_time_ = now;
     SendPeriodicFeedbacks();
     return send_interval_;
@@ -303,9 +364,18 @@ RemoteEstimatorProxy::MaybeBuildFeedbackPacket(
     }
 
     if (feedback_packet == nullptr) {
-      feedback_packet =
-          std::make_unique<rtcp::TransportFeedback>(include_timestamps);
+      if (is_periodic_update) {
+        RTC_DCHECK(include_timestamps);
+        feedback_packet = feedback_packet_pool_->Create();
+      } else {
+        feedback_packet =
+            std::make_unique<rtcp::TransportFeedback>(include_timestamps);
+      }
       feedback_packet->SetMediaSsrc(media_ssrc_);
+      // Size this packet for the whole range up front, rather than growing it
+      // packet by packet, since most of the range is normally received.
+      feedback_packet->ReserveReceivedPackets(
+          std::min<int64_t>(end_seq - seq, kMaxReservedFeedbackPackets));
 
       // It should be possible to add `seq` to this new `feedback_packet`,
       // If difference between `seq` and `begin_sequence_number_inclusive`,
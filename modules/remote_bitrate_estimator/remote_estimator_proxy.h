@@ -47,14 +47,19 @@ class RemoteEstimatorProxy {
 
   void IncomingPacket(const RtpPacketReceived& packet);
 
-  // Sends periodic feedback if it is time to send it.
+  // Sends periodic feedback if it is time to send it, or if it will be within
+  // `max_early`. The latter lets a caller processing many proxies on a shared
+  // timer serve all proxies that are almost due in the same pass.
   // Returns time until next call to Process should be made.
-  TimeDelta Process(Timestamp now);
+  TimeDelta Process(Timestamp now, TimeDelta max_early = TimeDelta::Zero());
 
   void OnBitrateChanged(int bitrate);
   void SetTransportOverhead(DataSize overhead_per_packet);
 
  private:
+  // Recycles the buffers of sent periodic feedback packets into the next ones.
+  class FeedbackPacketPool;
+
   void MaybeCullOldPackets(int64_t sequence_number, Timestamp arrival_time)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(&lock_);
   void SendPeriodicFeedbacks() RTC_EXCLUSIVE_LOCKS_REQUIRED(&lock_);
@@ -81,6 +86,8 @@ class RemoteEstimatorProxy {
       bool is_periodic_update) RTC_EXCLUSIVE_LOCKS_REQUIRED(&lock_);
 
   const TransportFeedbackSender feedback_sender_;
+  // Shared with the periodic feedback packets, which may outlive the proxy.
+  const std::shared_ptr<FeedbackPacketPool> feedback_packet_pool_;
   Timestamp last_process_time_;
 
   Mutex lock_;
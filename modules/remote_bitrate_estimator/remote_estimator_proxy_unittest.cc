@@ -143,6 +143,36 @@ TEST_F(RemoteEstimatorProxyTest, SendsSinglePacketFeedback) {
   Process();
 }
 
+TEST_F(RemoteEstimatorProxyTest, ReusesBuffersOfReleasedPeriodicFeedback) {
+  const rtcp::TransportFeedback::ReceivedPacket* first_buffer = nullptr;
+  const rtcp::TransportFeedback::ReceivedPacket* second_buffer = nullptr;
+  EXPECT_CALL(feedback_sender_, Call)
+      .WillOnce(
+          [&](std::vector<std::unique_ptr<rtcp::RtcpPacket>> feedback_packets) {
+            first_buffer = static_cast<rtcp::TransportFeedback*>(
+                               feedback_packets[0].get())
+                               ->GetReceivedPackets()
+                               .data();
+          })
+      .WillOnce(
+          [&](std::vector<std::unique_ptr<rtcp::RtcpPacket>> feedback_packets) {
+            rtcp::TransportFeedback* feedback_packet =
+                static_cast<rtcp::TransportFeedback*>(
+                    feedback_packets[0].get());
+            EXPECT_THAT(SequenceNumbers(*feedback_packet),
+                        ElementsAre(kBaseSeq + 1));
+            second_buffer = feedback_packet->GetReceivedPackets().data();
+          });
+
+  IncomingPacket(kBaseSeq, kBaseTime);
+  Process();
+  IncomingPacket(kBaseSeq + 1, kBaseTime + TimeDelta::Millis(1));
+  Process();
+
+  ASSERT_NE(first_buffer, nullptr);
+  EXPECT_EQ(second_buffer, first_buffer);
+}
+
 TEST_F(RemoteEstimatorProxyTest, DuplicatedPackets) {
   IncomingPacket(kBaseSeq, kBaseTime);
   IncomingPacket(kBaseSeq, kBaseTime + TimeDelta::Seconds(1));
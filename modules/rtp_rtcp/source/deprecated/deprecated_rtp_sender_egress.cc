@@ -88,6 +88,8 @@ void DEPRECATED_RtpSenderEgress::SendPacket(
     RtpPacketToSend* packet,
     const PacedPacketInfo& pacing_info) {
   RTC_DCHECK(packet);
+  // Packets are sent to the transport as contiguous data.
+  packet->MaterializePayload();
 
   const uint32_t packet_ssrc = packet->Ssrc();
   RTC_DCHECK(packet->packet_type().has_value());
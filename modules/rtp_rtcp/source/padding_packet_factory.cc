@@ -0,0 +1,72 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/padding_packet_factory.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+std::shared_ptr<const RtpPacketToSend> PaddingPacketFactory::GetPrototype(
+    const Config& config,
+    const RtpHeaderExtensionMap& extensions) {
+  if (prototype_ != nullptr && config == config_) {
+    return prototype_;
+  }
+
+  auto packet = std::make_shared<RtpPacketToSend>(&extensions);
+  packet->set_packet_type(RtpPacketMediaType::kPadding);
+  packet->SetMarker(false);
+  packet->SetSsrc(config.ssrc);
+  if (config.payload_type.has_value()) {
+    packet->SetPayloadType(*config.payload_type);
+  }
+  if (extensions.IsRegistered(TransportSequenceNumber::kId)) {
+    packet->ReserveExtension<TransportSequenceNumber>();
+  }
+  if (extensions.IsRegistered(TransmissionOffset::kId)) {
+    packet->ReserveExtension<TransmissionOffset>();
+  }
+  if (extensions.IsRegistered(AbsoluteSendTime::kId)) {
+    packet->ReserveExtension<AbsoluteSendTime>();
+  }
+  packet->SetPadding(config.padding_size);
+
+  config_ = config;
+  prototype_ = std::move(packet);
+  return prototype_;
+}
+
+void PaddingPacketFactory::Invalidate() {
+  prototype_ = nullptr;
+}
+
+std::vector<std::unique_ptr<RtpPacketToSend>>
+PaddingPacketFactory::CreatePackets(const RtpPacketToSend& prototype,
+                                    size_t target_size_bytes) {
+  std::vector<std::unique_ptr<RtpPacketToSend>> packets;
+  const size_t padding_size = prototype.padding_size();
+  if (target_size_bytes == 0 || padding_size == 0) {
+    return packets;
+  }
+  packets.reserve((target_size_bytes + padding_size - 1) / padding_size);
+  size_t bytes_left = target_size_bytes;
+  while (bytes_left > 0) {
+    packets.push_back(std::make_unique<RtpPacketToSend>(prototype));
+    bytes_left -= std::min(bytes_left, padding_size);
+  }
+  return packets;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_RTP_RTCP_SOURCE_PADDING_PACKET_FACTORY_H_
+#define MODULES_RTP_RTCP_SOURCE_PADDING_PACKET_FACTORY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+
+namespace webrtc {
+
+// Builds padding-only RTP packets (i.e. packets without payload, as used for
+// probing and for filling the padding budget) from a pre-serialized
+// prototype. The prototype carries SSRC, payload type, reserved header
+// extensions and the padding itself, so producing a probe burst only copies
+// the prototype; the packet buffers are shared copy-on-write until the
+// sequencer writes sequence number, timestamps and transport-wide sequence
+// number at send time.
+//
+// The factory itself is not thread safe and is expected to be protected by
+// the owner's lock. The prototype returned by GetPrototype() is immutable, so
+// CreatePackets() may be called after the lock has been released.
+class PaddingPacketFactory {
+ public:
+  struct Config {
+    bool operator==(const Config& other) const {
+      return ssrc == other.ssrc && payload_type == other.payload_type &&
+             padding_size == other.padding_size;
+    }
+    bool operator!=(const Config& other) const { return !(*this == other); }
+
+    uint32_t ssrc = 0;
+    // Set when padding is sent on the RTX SSRC.
+    absl::optional<int> payload_type;
+    size_t padding_size = 0;
+  };
+
+  PaddingPacketFactory() = default;
+  PaddingPacketFactory(const PaddingPacketFactory&) = delete;
+  PaddingPacketFactory& operator=(const PaddingPacketFactory&) = delete;
+  ~PaddingPacketFactory() = default;
+
+  // Returns a prototype matching `config`. The prototype is rebuilt only if
+  // `config` differs from the previous call or Invalidate() has been called.
+  std::shared_ptr<const RtpPacketToSend> GetPrototype(
+      const Config& config,
+      const RtpHeaderExtensionMap& extensions);
+
+  // Must be called whenever the header extension mapping changes.
+  void Invalidate();
+
+  // Creates as many copies of `prototype` as needed to cover
+  // `target_size_bytes` of padding. At least one packet is created if
+  // `target_size_bytes` is non-zero.
+  static std::vector<std::unique_ptr<RtpPacketToSend>> CreatePackets(
+      const RtpPacketToSend& prototype,
+      size_t target_size_bytes);
+
+ private:
+  Config config_;
+  std::shared_ptr<const RtpPacketToSend> prototype_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_RTP_RTCP_SOURCE_PADDING_PACKET_FACTORY_H_
@@ -0,0 +1,120 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/padding_packet_factory.h"
+
+#include "modules/rtp_rtcp/source/rtp_header_extensions.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using ::testing::SizeIs;
+
+constexpr uint32_t kMediaSsrc = 123456;
+constexpr uint32_t kRtxSsrc = 123457;
+constexpr int kRtxPayloadType = 98;
+constexpr size_t kPaddingSize = 224;
+constexpr int kTransportSequenceNumberId = 1;
+
+PaddingPacketFactory::Config RtxConfig() {
+  PaddingPacketFactory::Config config;
+  config.ssrc = kRtxSsrc;
+  config.payload_type = kRtxPayloadType;
+  config.padding_size = kPaddingSize;
+  return config;
+}
+
+TEST(PaddingPacketFactoryTest, BuildsPaddingOnlyPrototype) {
+  RtpHeaderExtensionMap extensions;
+  extensions.Register<TransportSequenceNumber>(kTransportSequenceNumberId);
+  PaddingPacketFactory factory;
+
+  auto prototype = factory.GetPrototype(RtxConfig(), extensions);
+  ASSERT_TRUE(prototype);
+  EXPECT_EQ(prototype->Ssrc(), kRtxSsrc);
+  EXPECT_EQ(prototype->PayloadType(), kRtxPayloadType);
+  EXPECT_EQ(prototype->payload_size(), 0u);
+  EXPECT_EQ(prototype->padding_size(), kPaddingSize);
+  EXPECT_EQ(prototype->packet_type(), RtpPacketMediaType::kPadding);
+  EXPECT_TRUE(prototype->HasExtension<TransportSequenceNumber>());
+  EXPECT_FALSE(prototype->HasExtension<AbsoluteSendTime>());
+}
+
+TEST(PaddingPacketFactoryTest, ReusesPrototypeForSameConfig) {
+  RtpHeaderExtensionMap extensions;
+  PaddingPacketFactory factory;
+
+  auto first = factory.GetPrototype(RtxConfig(), extensions);
+  auto second = factory.GetPrototype(RtxConfig(), extensions);
+  EXPECT_EQ(first, second);
+
+  PaddingPacketFactory::Config media_config;
+  media_config.ssrc = kMediaSsrc;
+  media_config.padding_size = kPaddingSize;
+  auto third = factory.GetPrototype(media_config, extensions);
+  EXPECT_NE(first, third);
+  EXPECT_EQ(third->Ssrc(), kMediaSsrc);
+}
+
+TEST(PaddingPacketFactoryTest, InvalidateRebuildsWithNewExtensions) {
+  RtpHeaderExtensionMap extensions;
+  PaddingPacketFactory factory;
+
+  auto before = factory.GetPrototype(RtxConfig(), extensions);
+  EXPECT_FALSE(before->HasExtension<TransportSequenceNumber>());
+
+  extensions.Register<TransportSequenceNumber>(kTransportSequenceNumberId);
+  factory.Invalidate();
+  auto after = factory.GetPrototype(RtxConfig(), extensions);
+  EXPECT_NE(before, after);
+  EXPECT_TRUE(after->HasExtension<TransportSequenceNumber>());
+}
+
+TEST(PaddingPacketFactoryTest, CreatesEnoughPacketsToCoverTarget) {
+  RtpHeaderExtensionMap extensions;
+  PaddingPacketFactory factory;
+  auto prototype = factory.GetPrototype(RtxConfig(), extensions);
+
+  EXPECT_THAT(PaddingPacketFactory::CreatePackets(*prototype, 0), SizeIs(0));
+  EXPECT_THAT(PaddingPacketFactory::CreatePackets(*prototype, 1), SizeIs(1));
+  EXPECT_THAT(PaddingPacketFactory::CreatePackets(*prototype, kPaddingSize),
+              SizeIs(1));
+  EXPECT_THAT(
+      PaddingPacketFactory::CreatePackets(*prototype, 10 * kPaddingSize + 1),
+      SizeIs(11));
+}
+
+TEST(PaddingPacketFactoryTest, PacketsAreIndependentOfPrototype) {
+  RtpHeaderExtensionMap extensions;
+  extensions.Register<TransportSequenceNumber>(kTransportSequenceNumberId);
+  PaddingPacketFactory factory;
+  auto prototype = factory.GetPrototype(RtxConfig(), extensions);
+
+  auto packets = PaddingPacketFactory::CreatePackets(*prototype, 2);
+  ASSERT_THAT(packets, SizeIs(1));
+  packets[0]->SetSequenceNumber(17);
+  packets[0]->SetExtension<TransportSequenceNumber>(42);
+
+  EXPECT_EQ(prototype->SequenceNumber(), 0);
+  uint16_t transport_sequence_number = 0;
+  EXPECT_TRUE(prototype->GetExtension<TransportSequenceNumber>(
+      &transport_sequence_number));
+  EXPECT_EQ(transport_sequence_number, 0);
+
+  auto more_packets = PaddingPacketFactory::CreatePackets(*prototype, 1);
+  ASSERT_THAT(more_packets, SizeIs(1));
+  EXPECT_EQ(more_packets[0]->SequenceNumber(), 0);
+  EXPECT_EQ(more_packets[0]->padding_size(), kPaddingSize);
+}
+
+}  // namespace
+}  // namespace webrtc
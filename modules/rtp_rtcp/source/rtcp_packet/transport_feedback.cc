@@ -303,6 +303,13 @@ TransportFeedback::TransportFeedback(TransportFeedback&& other)
 
 TransportFeedback::~TransportFeedback() {}
 
+void TransportFeedback::Reset() {
+  base_seq_no_ = 0;
+  base_time_ticks_ = 0;
+  feedback_seq_ = 0;
+  Clear();
+}
+
 void TransportFeedback::SetBase(uint16_t base_sequence,
                                 Timestamp ref_timestamp) {
   RTC_DCHECK_EQ(num_seq_no_, 0);
@@ -316,6 +323,13 @@ void TransportFeedback::SetFeedbackSequenceNumber(uint8_t feedback_sequence) {
   feedback_seq_ = feedback_sequence;
 }
 
+void TransportFeedback::ReserveReceivedPackets(size_t num_packets) {
+  received_packets_.reserve(num_packets);
+  // Without losses each chunk holds at least seven packets, see
+  // LastChunk::kMaxTwoBitCapacity.
+  encoded_chunks_.reserve(num_packets / 7 + 1);
+}
+
 bool TransportFeedback::AddReceivedPacket(uint16_t sequence_number,
                                           Timestamp timestamp) {
   // Set delta to zero if timestamps are not included, this will simplify the
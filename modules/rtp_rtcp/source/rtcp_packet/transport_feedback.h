@@ -59,10 +59,16 @@ class TransportFeedback : public Rtpfb {
 
   ~TransportFeedback() override;
 
+  // Resets the packet to an empty one, keeping its allocated buffers so that
+  // it can be reused for the next feedback.
+  void Reset();
+
   void SetBase(uint16_t base_sequence,    // Seq# of first packet in this msg.
                Timestamp ref_timestamp);  // Reference timestamp for this msg.
 
   void SetFeedbackSequenceNumber(uint8_t feedback_sequence);
+  // Preallocates space for `num_packets` calls to AddReceivedPacket.
+  void ReserveReceivedPackets(size_t num_packets);
   // NOTE: This method requires increasing sequence numbers (excepting wraps).
   bool AddReceivedPacket(uint16_t sequence_number, Timestamp timestamp);
   const std::vector<ReceivedPacket>& GetReceivedPackets() const;
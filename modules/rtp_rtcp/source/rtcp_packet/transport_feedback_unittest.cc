@@ -625,6 +625,36 @@ TEST(RtcpPacketTest, TransportFeedbackMoveConstructor) {
   EXPECT_EQ(moved.Build(), feedback_copy.Build());
 }
 
+TEST(RtcpPacketTest, TransportFeedbackResetAllowsReuse) {
+  const uint16_t kBaseSeqNo = 7531;
+  const Timestamp kBaseTimestamp = Timestamp::Micros(123'456'789);
+
+  TransportFeedback expected;
+  expected.SetBase(kBaseSeqNo, kBaseTimestamp);
+  expected.SetFeedbackSequenceNumber(2);
+  expected.AddReceivedPacket(kBaseSeqNo, kBaseTimestamp);
+  expected.AddReceivedPacket(kBaseSeqNo + 2,
+                             kBaseTimestamp + TimeDelta::Millis(1));
+
+  TransportFeedback reused;
+  reused.SetBase(1, Timestamp::Millis(1));
+  reused.SetFeedbackSequenceNumber(1);
+  for (int i = 0; i < 100; ++i) {
+    reused.AddReceivedPacket(1 + 3 * i, Timestamp::Millis(1 + i));
+  }
+  reused.Reset();
+  EXPECT_TRUE(reused.IsConsistent());
+  EXPECT_THAT(reused.GetReceivedPackets(), SizeIs(0));
+
+  reused.SetBase(kBaseSeqNo, kBaseTimestamp);
+  reused.SetFeedbackSequenceNumber(2);
+  reused.AddReceivedPacket(kBaseSeqNo, kBaseTimestamp);
+  reused.AddReceivedPacket(kBaseSeqNo + 2,
+                           kBaseTimestamp + TimeDelta::Millis(1));
+  EXPECT_TRUE(reused.IsConsistent());
+  EXPECT_EQ(reused.Build(), expected.Build());
+}
+
 TEST(TransportFeedbackTest, ReportsMissingPackets) {
   const uint16_t kBaseSeqNo = 1000;
   const Timestamp kBaseTimestamp = Timestamp::Millis(10);
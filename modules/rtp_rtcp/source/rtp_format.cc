@@ -10,6 +10,8 @@
 
 #include "modules/rtp_rtcp/source/rtp_format.h"
 
+#include <string.h>
+
 #include <memory>
 
 #include "absl/types/variant.h"
@@ -17,6 +19,7 @@
 #include "modules/rtp_rtcp/source/rtp_format_video_generic.h"
 #include "modules/rtp_rtcp/source/rtp_format_vp8.h"
 #include "modules/rtp_rtcp/source/rtp_format_vp9.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
 #include "modules/rtp_rtcp/source/rtp_packetizer_av1.h"
 #include "modules/video_coding/codecs/h264/include/h264_globals.h"
 #include "modules/video_coding/codecs/vp8/include/vp8_globals.h"
@@ -72,6 +75,23 @@ std::unique_ptr<RtpPacketizer> RtpPacketizer::Create(
   }
 }
 
+uint8_t* RtpPacketizer::WritePayload(
+    RtpPacketToSend* packet,
+    size_t header_size,
+    rtc::ArrayView<const uint8_t> fragment) const {
+  const EncodedImageBufferInterface* buffer = payload_buffer_.get();
+  if (buffer != nullptr && !fragment.empty() &&
+      fragment.data() >= buffer->data() &&
+      fragment.data() + fragment.size() <= buffer->data() + buffer->size()) {
+    return packet->SetPayloadReference(header_size, fragment, payload_buffer_);
+  }
+  uint8_t* payload = packet->AllocatePayload(header_size + fragment.size());
+  if (!fragment.empty()) {
+    memcpy(payload + header_size, fragment.data(), fragment.size());
+  }
+  return payload;
+}
+
 std::vector<int> RtpPacketizer::SplitAboutEqually(
     int payload_len,
     const PayloadSizeLimits& limits) {
@@ -14,10 +14,13 @@
 #include <stdint.h>
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "absl/types/optional.h"
 #include "api/array_view.h"
+#include "api/scoped_refptr.h"
+#include "api/video/encoded_image.h"
 #include "modules/rtp_rtcp/source/rtp_video_header.h"
 
 namespace webrtc {
@@ -52,10 +55,28 @@ class RtpPacketizer {
   // Returns true on success, false otherwise.
   virtual bool NextPacket(RtpPacketToSend* packet) = 0;
 
+  // Lets packets reference the parts of the payload that lie within `buffer`
+  // instead of copying them. `buffer` must not be modified while packets
+  // reference it.
+  void SetPayloadBuffer(
+      rtc::scoped_refptr<EncodedImageBufferInterface> buffer) {
+    payload_buffer_ = std::move(buffer);
+  }
+
   // Split payload_len into sum of integers with respect to `limits`.
   // Returns empty vector on failure.
   static std::vector<int> SplitAboutEqually(int payload_len,
                                             const PayloadSizeLimits& limits);
+
+ protected:
+  // Sets the payload of `packet` to a payload header of `header_size` bytes,
+  // returned for writing, followed by `fragment`.
+  uint8_t* WritePayload(RtpPacketToSend* packet,
+                        size_t header_size,
+                        rtc::ArrayView<const uint8_t> fragment) const;
+
+ private:
+  rtc::scoped_refptr<EncodedImageBufferInterface> payload_buffer_;
 };
 }  // namespace webrtc
 #endif  // MODULES_RTP_RTCP_SOURCE_RTP_FORMAT_H_
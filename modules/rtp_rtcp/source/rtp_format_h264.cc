@@ -239,9 +239,7 @@ bool RtpPacketizerH264::NextPacket(RtpPacketToSend* rtp_packet) {
   PacketUnit packet = packets_.front();
   if (packet.first_fragment && packet.last_fragment) {
     // Single NAL unit packet.
-    size_t bytes_to_send = packet.source_fragment.size();
-    uint8_t* buffer = rtp_packet->AllocatePayload(bytes_to_send);
-    memcpy(buffer, packet.source_fragment.data(), bytes_to_send);
+    WritePayload(rtp_packet, /*header_size=*/0, packet.source_fragment);
     packets_.pop();
     input_fragments_.pop_front();
   } else if (packet.aggregated) {
@@ -301,12 +299,10 @@ void RtpPacketizerH264::NextFragmentPacket(RtpPacketToSend* rtp_packet) {
   fu_header |= (packet->last_fragment ? kH264EBit : 0);
   uint8_t type = packet->header & kH264TypeMask;
   fu_header |= type;
-  rtc::ArrayView<const uint8_t> fragment = packet->source_fragment;
   uint8_t* buffer =
-      rtp_packet->AllocatePayload(kFuAHeaderSize + fragment.size());
+      WritePayload(rtp_packet, kFuAHeaderSize, packet->source_fragment);
   buffer[0] = fu_indicator;
   buffer[1] = fu_header;
-  memcpy(buffer + kFuAHeaderSize, fragment.data(), fragment.size());
   if (packet->last_fragment)
     input_fragments_.pop_front();
   packets_.pop();
@@ -55,8 +55,9 @@ bool RtpPacketizerGeneric::NextPacket(RtpPacketToSend* packet) {
 
   size_t next_packet_payload_len = *current_packet_;
 
-  uint8_t* out_ptr =
-      packet->AllocatePayload(header_size_ + next_packet_payload_len);
+  uint8_t* out_ptr = WritePayload(
+      packet, header_size_,
+      remaining_payload_.subview(0, next_packet_payload_len));
   RTC_CHECK(out_ptr);
 
   if (header_size_ > 0) {
@@ -65,9 +66,6 @@ bool RtpPacketizerGeneric::NextPacket(RtpPacketToSend* packet) {
     header_[0] &= ~RtpFormatVideoGeneric::kFirstPacketBit;
   }
 
-  memcpy(out_ptr + header_size_, remaining_payload_.data(),
-         next_packet_payload_len);
-
   remaining_payload_ = remaining_payload_.subview(next_packet_payload_len);
 
   ++current_packet_;
@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "api/array_view.h"
+#include "api/video/encoded_image.h"
 #include "modules/rtp_rtcp/mocks/mock_rtp_rtcp.h"
 #include "modules/rtp_rtcp/source/byte_io.h"
 #include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
@@ -168,5 +169,30 @@ TEST(RtpPacketizerVideoGeneric, DoesNotWriteHeaderForRawPayload) {
   EXPECT_THAT(payload, ElementsAreArray(kPayload));
 }
 
+TEST(RtpPacketizerVideoGeneric, ReferencesPayloadWithinPayloadBuffer) {
+  const uint8_t kPayload[] = {0x05, 0x25, 0x52};
+  rtc::scoped_refptr<EncodedImageBuffer> frame =
+      EncodedImageBuffer::Create(kPayload, sizeof(kPayload));
+  RTPVideoHeader rtp_video_header;
+  rtp_video_header.video_type_header.emplace<RTPVideoHeaderLegacyGeneric>()
+      .picture_id = 37;
+
+  RtpPacketizerGeneric packetizer(
+      rtc::MakeArrayView(frame->data(), frame->size()), kNoSizeLimits,
+      rtp_video_header);
+  packetizer.SetPayloadBuffer(frame);
+
+  RtpPacketToSend packet(nullptr);
+  ASSERT_TRUE(packetizer.NextPacket(&packet));
+
+  // Only the generic header is stored in the packet.
+  EXPECT_EQ(packet.stored_data().size(), packet.headers_size() + 3);
+  EXPECT_EQ(packet.referenced_payload().data(), frame->data());
+  packet.MaterializePayload();
+  rtc::ArrayView<const uint8_t> payload = packet.payload();
+  EXPECT_EQ(payload.size(), 3 + sizeof(kPayload));
+  EXPECT_THAT(payload.subview(3), ElementsAreArray(kPayload));
+}
+
 }  // namespace
 }  // namespace webrtc
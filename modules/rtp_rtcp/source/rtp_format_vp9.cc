@@ -348,14 +348,14 @@ bool RtpPacketizerVp9::NextPacket(RtpPacketToSend* packet) {
   if (layer_begin)
     header_size += first_packet_extra_header_size_;
 
-  uint8_t* buffer = packet->AllocatePayload(header_size + packet_payload_len);
+  uint8_t* buffer = WritePayload(
+      packet, header_size, remaining_payload_.subview(0, packet_payload_len));
   RTC_CHECK(buffer);
 
   if (!WriteHeader(layer_begin, layer_end,
                    rtc::MakeArrayView(buffer, header_size)))
     return false;
 
-  memcpy(buffer + header_size, remaining_payload_.data(), packet_payload_len);
   remaining_payload_ = remaining_payload_.subview(packet_payload_len);
 
   // Ensure end_of_picture is always set on top spatial layer when it is not
@@ -103,12 +103,12 @@ bool RtpPacket::Parse(rtc::CopyOnWriteBuffer buffer) {
 }
 
 std::vector<uint32_t> RtpPacket::Csrcs() const {
-  size_t num_csrc = data()[0] & 0x0F;
+  size_t num_csrc = *ReadAt(0) & 0x0F;
   RTC_DCHECK_GE(capacity(), kFixedHeaderSize + num_csrc * 4);
   std::vector<uint32_t> csrcs(num_csrc);
   for (size_t i = 0; i < num_csrc; ++i) {
     csrcs[i] =
-        ByteReader<uint32_t>::ReadBigEndian(&data()[kFixedHeaderSize + i * 4]);
+        ByteReader<uint32_t>::ReadBigEndian(ReadAt(kFixedHeaderSize + i * 4));
   }
   return csrcs;
 }
@@ -124,6 +124,7 @@ void RtpPacket::CopyHeaderFrom(const RtpPacket& packet) {
   extension_entries_ = packet.extension_entries_;
   extensions_size_ = packet.extensions_size_;
   buffer_ = packet.buffer_.Slice(0, packet.headers_size());
+  ResetReferencedPayload();
   // Reset payload and padding.
   payload_size_ = 0;
   padding_size_ = 0;
@@ -132,16 +133,16 @@ void RtpPacket::CopyHeaderFrom(const RtpPacket& packet) {
 void RtpPacket::SetMarker(bool marker_bit) {
   marker_ = marker_bit;
   if (marker_) {
-    WriteAt(1, data()[1] | 0x80);
+    WriteAt(1, *ReadAt(1) | 0x80);
   } else {
-    WriteAt(1, data()[1] & 0x7F);
+    WriteAt(1, *ReadAt(1) & 0x7F);
   }
 }
 
 void RtpPacket::SetPayloadType(uint8_t payload_type) {
   RTC_DCHECK_LE(payload_type, 0x7Fu);
   payload_type_ = payload_type;
-  WriteAt(1, (data()[1] & 0x80) | payload_type);
+  WriteAt(1, (*ReadAt(1) & 0x80) | payload_type);
 }
 
 void RtpPacket::SetSequenceNumber(uint16_t seq_no) {
@@ -216,7 +217,7 @@ void RtpPacket::SetCsrcs(rtc::ArrayView<const uint32_t> csrcs) {
   RTC_DCHECK_LE(csrcs.size(), 0x0fu);
   RTC_DCHECK_LE(kFixedHeaderSize + 4 * csrcs.size(), capacity());
   payload_offset_ = kFixedHeaderSize + 4 * csrcs.size();
-  WriteAt(0, (data()[0] & 0xF0) | rtc::dchecked_cast<uint8_t>(csrcs.size()));
+  WriteAt(0, (*ReadAt(0) & 0xF0) | rtc::dchecked_cast<uint8_t>(csrcs.size()));
   size_t offset = kFixedHeaderSize;
   for (uint32_t csrc : csrcs) {
     ByteWriter<uint32_t>::WriteBigEndian(WriteAt(offset), csrc);
@@ -253,7 +254,7 @@ rtc::ArrayView<uint8_t> RtpPacket::AllocateRawExtension(int id, size_t length) {
     return nullptr;
   }
 
-  const size_t num_csrc = data()[0] & 0x0F;
+  const size_t num_csrc = *ReadAt(0) & 0x0F;
   const size_t extensions_offset = kFixedHeaderSize + (num_csrc * 4) + 4;
   // Determine if two-byte header is required for the extension based on id and
   // length. Please note that a length of 0 also requires two-byte header
@@ -266,7 +267,7 @@ rtc::ArrayView<uint8_t> RtpPacket::AllocateRawExtension(int id, size_t length) {
   uint16_t profile_id;
   if (extensions_size_ > 0) {
     profile_id =
-        ByteReader<uint16_t>::ReadBigEndian(data() + extensions_offset - 4);
+        ByteReader<uint16_t>::ReadBigEndian(ReadAt(extensions_offset - 4));
     if (profile_id == kOneByteExtensionProfileId && two_byte_header_required) {
       // Is buffer size big enough to fit promotion and new data field?
       // The header extension will grow with one byte per already allocated
@@ -306,7 +307,7 @@ rtc::ArrayView<uint8_t> RtpPacket::AllocateRawExtension(int id, size_t length) {
   // All checks passed, write down the extension headers.
   if (extensions_size_ == 0) {
     RTC_DCHECK_EQ(payload_offset_, kFixedHeaderSize + (num_csrc * 4));
-    WriteAt(0, data()[0] | 0x10);  // Set extension bit.
+    WriteAt(0, *ReadAt(0) | 0x10);  // Set extension bit.
     ByteWriter<uint16_t>::WriteBigEndian(WriteAt(extensions_offset - 4),
                                          profile_id);
   }
@@ -340,13 +341,13 @@ rtc::ArrayView<uint8_t> RtpPacket::AllocateRawExtension(int id, size_t length) {
 }
 
 void RtpPacket::PromoteToTwoByteHeaderExtension() {
-  size_t num_csrc = data()[0] & 0x0F;
+  size_t num_csrc = *ReadAt(0) & 0x0F;
   size_t extensions_offset = kFixedHeaderSize + (num_csrc * 4) + 4;
 
   RTC_CHECK_GT(extension_entries_.size(), 0);
   RTC_CHECK_EQ(payload_size_, 0);
   RTC_CHECK_EQ(kOneByteExtensionProfileId, ByteReader<uint16_t>::ReadBigEndian(
-                                               data() + extensions_offset - 4));
+                                               ReadAt(extensions_offset - 4)));
   // Rewrite data.
   // Each extension adds one to the offset. The write-read delta for the last
   // extension is therefore the same as the number of extension entries.
@@ -358,7 +359,7 @@ void RtpPacket::PromoteToTwoByteHeaderExtension() {
     // Update offset.
     extension_entry->offset = rtc::dchecked_cast<uint16_t>(write_index);
     // Copy data. Use memmove since read/write regions may overlap.
-    memmove(WriteAt(write_index), data() + read_index, extension_entry->length);
+    memmove(WriteAt(write_index), ReadAt(read_index), extension_entry->length);
     // Rewrite id and length.
     WriteAt(--write_index, extension_entry->length);
     WriteAt(--write_index, extension_entry->id);
@@ -392,12 +393,44 @@ uint16_t RtpPacket::SetExtensionLengthMaybeAddZeroPadding(
 uint8_t* RtpPacket::AllocatePayload(size_t size_bytes) {
   // Reset payload size to 0. If CopyOnWrite buffer_ was shared, this will cause
   // reallocation and memcpy. Keeping just header reduces memcpy size.
+  ResetReferencedPayload();
   SetPayloadSize(0);
   return SetPayloadSize(size_bytes);
 }
 
+uint8_t* RtpPacket::SetPayloadReference(
+    size_t prefix_size,
+    rtc::ArrayView<const uint8_t> data,
+    rtc::scoped_refptr<RefCountInterface> owner) {
+  RTC_DCHECK(data.empty() || owner);
+  uint8_t* prefix = AllocatePayload(prefix_size);
+  if (!data.empty()) {
+    referenced_payload_ = data;
+    referenced_payload_owner_ = std::move(owner);
+    payload_size_ += data.size();
+  }
+  return prefix;
+}
+
+void RtpPacket::CopyReferencedPayload() {
+  RTC_DCHECK_EQ(padding_size_, 0);
+  RTC_DCHECK_EQ(buffer_.size() + referenced_payload_.size(), size());
+  buffer_.AppendData(referenced_payload_.data(), referenced_payload_.size());
+  referenced_payload_ = nullptr;
+  referenced_payload_owner_ = nullptr;
+}
+
+void RtpPacket::ResetReferencedPayload() {
+  if (!referenced_payload_.empty()) {
+    payload_size_ -= referenced_payload_.size();
+    referenced_payload_ = nullptr;
+    referenced_payload_owner_ = nullptr;
+  }
+}
+
 uint8_t* RtpPacket::SetPayloadSize(size_t size_bytes) {
   RTC_DCHECK_EQ(padding_size_, 0);
+  MaterializePayload();
   payload_size_ = size_bytes;
   buffer_.SetSize(payload_offset_ + payload_size_);
   return WriteAt(payload_offset_);
@@ -411,6 +444,7 @@ bool RtpPacket::SetPadding(size_t padding_bytes) {
                         << " bytes left in buffer.";
     return false;
   }
+  MaterializePayload();
   padding_size_ = rtc::dchecked_cast<uint8_t>(padding_bytes);
   buffer_.SetSize(payload_offset_ + payload_size_ + padding_size_);
   if (padding_size_ > 0) {
@@ -418,9 +452,9 @@ bool RtpPacket::SetPadding(size_t padding_bytes) {
     size_t padding_end = padding_offset + padding_size_;
     memset(WriteAt(padding_offset), 0, padding_size_ - 1);
     WriteAt(padding_end - 1, padding_size_);
-    WriteAt(0, data()[0] | 0x20);  // Set padding bit.
+    WriteAt(0, *ReadAt(0) | 0x20);  // Set padding bit.
   } else {
-    WriteAt(0, data()[0] & ~0x20);  // Clear padding bit.
+    WriteAt(0, *ReadAt(0) & ~0x20);  // Clear padding bit.
   }
   return true;
 }
@@ -436,6 +470,8 @@ void RtpPacket::Clear() {
   padding_size_ = 0;
   extensions_size_ = 0;
   extension_entries_.clear();
+  referenced_payload_ = nullptr;
+  referenced_payload_owner_ = nullptr;
 
   memset(WriteAt(0), 0, kFixedHeaderSize);
   buffer_.SetSize(kFixedHeaderSize);
@@ -443,6 +479,7 @@ void RtpPacket::Clear() {
 }
 
 bool RtpPacket::ParseBuffer(const uint8_t* buffer, size_t size) {
+  ResetReferencedPayload();
   if (size < kFixedHeaderSize) {
     return false;
   }
@@ -591,7 +628,8 @@ rtc::ArrayView<const uint8_t> RtpPacket::FindExtension(
   if (extension_info == nullptr) {
     return nullptr;
   }
-  return rtc::MakeArrayView(data() + extension_info->offset,
+  // Extensions are stored in the packet buffer also when the payload is not.
+  return rtc::MakeArrayView(ReadAt(extension_info->offset),
                             extension_info->length);
 }
 
@@ -670,6 +708,7 @@ bool RtpPacket::RemoveExtension(ExtensionType type) {
   }
 
   // Copy payload data to new packet.
+  MaterializePayload();
   if (payload_size() > 0) {
     memcpy(new_packet.AllocatePayload(payload_size()), payload().data(),
            payload_size());
@@ -16,8 +16,11 @@
 
 #include "absl/types/optional.h"
 #include "api/array_view.h"
+#include "api/ref_count.h"
+#include "api/scoped_refptr.h"
 #include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "rtc_base/checks.h"
 #include "rtc_base/copy_on_write_buffer.h"
 
 namespace webrtc {
@@ -78,19 +81,46 @@ class RtpPacket {
     return rtc::MakeArrayView(data() + payload_offset_, payload_size_);
   }
   rtc::CopyOnWriteBuffer PayloadBuffer() const {
+    RTC_DCHECK(referenced_payload_.empty());
     return buffer_.Slice(payload_offset_, payload_size_);
   }
 
   // Buffer.
-  rtc::CopyOnWriteBuffer Buffer() const { return buffer_; }
+  // Buffer(), data(), payload() and PayloadBuffer() require the whole packet
+  // to be stored in the packet buffer. For a payload referenced with
+  // SetPayloadReference(), call MaterializePayload() first.
+  rtc::CopyOnWriteBuffer Buffer() const {
+    RTC_DCHECK(referenced_payload_.empty());
+    return buffer_;
+  }
   size_t capacity() const { return buffer_.capacity(); }
   size_t size() const {
     return payload_offset_ + payload_size_ + padding_size_;
   }
-  const uint8_t* data() const { return buffer_.cdata(); }
+  const uint8_t* data() const {
+    RTC_DCHECK(referenced_payload_.empty());
+    return buffer_.cdata();
+  }
   size_t FreeCapacity() const { return capacity() - size(); }
   size_t MaxPayloadSize() const { return capacity() - headers_size(); }
 
+  // The packet as the bytes stored in the packet buffer followed by the
+  // referenced payload, without copying the latter. `referenced_payload()` is
+  // empty unless the payload was set with SetPayloadReference() and has not
+  // been copied into the packet buffer since.
+  rtc::ArrayView<const uint8_t> stored_data() const {
+    return rtc::MakeArrayView(buffer_.cdata(), buffer_.size());
+  }
+  rtc::ArrayView<const uint8_t> referenced_payload() const {
+    return referenced_payload_;
+  }
+  // Copies a referenced payload into the packet buffer, if there is one.
+  void MaterializePayload() {
+    if (!referenced_payload_.empty()) {
+      CopyReferencedPayload();
+    }
+  }
+
   // Reset fields and buffer.
   void Clear();
 
@@ -162,6 +192,14 @@ class RtpPacket {
   // Same as SetPayloadSize but doesn't guarantee to keep current payload.
   uint8_t* AllocatePayload(size_t size_bytes);
 
+  // Sets the payload to `prefix_size` bytes, returned for writing, followed by
+  // `data`, which is referenced instead of copied. `owner` keeps `data` alive
+  // and unmodified for as long as the packet or any copy of it references it.
+  uint8_t* SetPayloadReference(
+      size_t prefix_size,
+      rtc::ArrayView<const uint8_t> data,
+      rtc::scoped_refptr<RefCountInterface> owner);
+
   bool SetPadding(size_t padding_size);
 
   // Returns debug string of RTP packet (without detailed extension info).
@@ -181,6 +219,9 @@ class RtpPacket {
   // but does not touch packet own buffer, leaving packet in invalid state.
   bool ParseBuffer(const uint8_t* buffer, size_t size);
 
+  void CopyReferencedPayload();
+  void ResetReferencedPayload();
+
   // Returns pointer to extension info for a given id. Returns nullptr if not
   // found.
   const ExtensionInfo* FindExtensionInfo(int id) const;
@@ -219,6 +260,8 @@ class RtpPacket {
   std::vector<ExtensionInfo> extension_entries_;
   size_t extensions_size_ = 0;  // Unaligned.
   rtc::CopyOnWriteBuffer buffer_;
+  rtc::ArrayView<const uint8_t> referenced_payload_;
+  rtc::scoped_refptr<RefCountInterface> referenced_payload_owner_;
 };
 
 template <typename Extension>
@@ -7,6 +7,7 @@
  *  in the file PATENTS.  All contributing project authors may
  *  be found in the AUTHORS file in the root of the source tree.
  */
+#include "api/video/encoded_image.h"
 #include "common_video/test/utilities.h"
 #include "modules/rtp_rtcp/include/rtp_header_extension_map.h"
 #include "modules/rtp_rtcp/source/rtp_dependency_descriptor_extension.h"
@@ -482,6 +483,47 @@ TEST(RtpPacketTest, FailsToAddPaddingWithoutCapacity) {
   EXPECT_FALSE(packet.SetPadding(1));
 }
 
+TEST(RtpPacketTest, CopiesReferencedPayloadOnlyWhenMaterialized) {
+  rtc::scoped_refptr<EncodedImageBuffer> frame =
+      EncodedImageBuffer::Create(kPayload, sizeof(kPayload));
+  RtpPacketToSend packet(nullptr);
+  packet.SetSsrc(kSsrc);
+  uint8_t* prefix = packet.SetPayloadReference(
+      /*prefix_size=*/1, rtc::MakeArrayView(frame->data(), frame->size()),
+      frame);
+  prefix[0] = 0xab;
+
+  EXPECT_EQ(packet.payload_size(), 1 + sizeof(kPayload));
+  EXPECT_EQ(packet.size(), packet.headers_size() + 1 + sizeof(kPayload));
+  EXPECT_EQ(packet.stored_data().size(), packet.headers_size() + 1);
+  EXPECT_EQ(packet.referenced_payload().data(), frame->data());
+
+  RtpPacketToSend copy = packet;
+  packet.MaterializePayload();
+  EXPECT_THAT(packet.payload(),
+              ElementsAre(0xab, 'p', 'a', 'y', 'l', 'o', 'a', 'd'));
+  EXPECT_THAT(packet.referenced_payload(), IsEmpty());
+  EXPECT_EQ(packet.stored_data().size(), packet.size());
+  // Copies keep referencing the payload until they need it themselves.
+  EXPECT_EQ(copy.referenced_payload().data(), frame->data());
+  copy.MaterializePayload();
+  EXPECT_THAT(rtc::MakeArrayView(copy.data(), copy.size()),
+              ElementsAreArray(packet.data(), packet.size()));
+}
+
+TEST(RtpPacketTest, AllocatePayloadDropsReferencedPayload) {
+  rtc::scoped_refptr<EncodedImageBuffer> frame =
+      EncodedImageBuffer::Create(kPayload, sizeof(kPayload));
+  RtpPacketToSend packet(nullptr);
+  packet.SetPayloadReference(
+      /*prefix_size=*/0, rtc::MakeArrayView(frame->data(), frame->size()),
+      frame);
+  packet.AllocatePayload(2);
+
+  EXPECT_EQ(packet.payload_size(), 2u);
+  EXPECT_THAT(packet.referenced_payload(), IsEmpty());
+}
+
 TEST(RtpPacketTest, ParseMinimum) {
   RtpPacketReceived packet;
   EXPECT_TRUE(packet.Parse(kMinimumPacket, sizeof(kMinimumPacket)));
@@ -23,6 +23,7 @@
 #include "logging/rtc_event_log/events/rtc_event_rtp_packet_outgoing.h"
 #include "modules/rtp_rtcp/include/rtp_cvo.h"
 #include "modules/rtp_rtcp/source/byte_io.h"
+#include "modules/rtp_rtcp/source/padding_packet_factory.h"
 #include "modules/rtp_rtcp/source/rtp_generic_frame_descriptor_extension.h"
 #include "modules/rtp_rtcp/source/rtp_header_extensions.h"
 #include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
@@ -204,12 +205,14 @@ rtc::ArrayView<const RtpExtensionSize> RTPSender::AudioExtensionSizes() {
 void RTPSender::SetExtmapAllowMixed(bool extmap_allow_mixed) {
   MutexLock lock(&send_mutex_);
   rtp_header_extension_map_.SetExtmapAllowMixed(extmap_allow_mixed);
+  padding_packet_factory_.Invalidate();
 }
 
 bool RTPSender::RegisterRtpHeaderExtension(absl::string_view uri, int id) {
   MutexLock lock(&send_mutex_);
   bool registered = rtp_header_extension_map_.RegisterByUri(id, uri);
   supports_bwe_extension_ = HasBweExtension(rtp_header_extension_map_);
+  padding_packet_factory_.Invalidate();
   UpdateHeaderSizes();
   return registered;
 }
@@ -223,6 +226,7 @@ void RTPSender::DeregisterRtpHeaderExtension(absl::string_view uri) {
   MutexLock lock(&send_mutex_);
   rtp_header_extension_map_.Deregister(uri);
   supports_bwe_extension_ = HasBweExtension(rtp_header_extension_map_);
+  padding_packet_factory_.Invalidate();
   UpdateHeaderSizes();
 }
 
@@ -396,37 +400,38 @@ std::vector<std::unique_ptr<RtpPacketToSend>> RTPSender::GeneratePadding(
     }
   }
 
-  MutexLock lock(&send_mutex_);
-  if (!sending_media_) {
-    return {};
-  }
+  // Only the prototype lookup happens under `send_mutex_`; the copies are
+  // made after releasing it so that large probe bursts don't contend with
+  // the encoder thread packetizing media.
+  std::shared_ptr<const RtpPacketToSend> prototype;
+  {
+    MutexLock lock(&send_mutex_);
+    if (!sending_media_) {
+      return {};
+    }
 
-  size_t padding_bytes_in_packet;
-  const size_t max_payload_size =
-      max_packet_size_ - max_padding_fec_packet_header_;
-  if (audio_configured_) {
-    // Allow smaller padding packets for audio.
-    padding_bytes_in_packet = rtc::SafeClamp<size_t>(
-        bytes_left, kMinAudioPaddingLength,
-        rtc::SafeMin(max_payload_size, kMaxPaddingLength));
-  } else {
-    // Always send full padding packets. This is accounted for by the
-    // RtpPacketSender, which will make sure we don't send too much padding even
-    // if a single packet is larger than requested.
-    // We do this to avoid frequently sending small packets on higher bitrates.
-    padding_bytes_in_packet = rtc::SafeMin(max_payload_size, kMaxPaddingLength);
-  }
+    PaddingPacketFactory::Config config;
+    const size_t max_payload_size =
+        max_packet_size_ - max_padding_fec_packet_header_;
+    if (audio_configured_) {
+      // Allow smaller padding packets for audio.
+      config.padding_size = rtc::SafeClamp<size_t>(
+          bytes_left, kMinAudioPaddingLength,
+          rtc::SafeMin(max_payload_size, kMaxPaddingLength));
+    } else {
+      // Always send full padding packets. This is accounted for by the
+      // RtpPacketSender, which will make sure we don't send too much padding
+      // even if a single packet is larger than requested.
+      // We do this to avoid frequently sending small packets on higher
+      // bitrates.
+      config.padding_size = rtc::SafeMin(max_payload_size, kMaxPaddingLength);
+    }
 
-  while (bytes_left > 0) {
-    auto padding_packet =
-        std::make_unique<RtpPacketToSend>(&rtp_header_extension_map_);
-    padding_packet->set_packet_type(RtpPacketMediaType::kPadding);
-    padding_packet->SetMarker(false);
     if (rtx_ == kRtxOff) {
       if (!can_send_padding_on_media_ssrc) {
-        break;
+        return padding_packets;
       }
-      padding_packet->SetSsrc(ssrc_);
+      config.ssrc = ssrc_;
     } else {
       // Without abs-send-time or transport sequence number a media packet
       // must be sent before padding so that the timestamps used for
@@ -435,28 +440,21 @@ std::vector<std::unique_ptr<RtpPacketToSend>> RTPSender::GeneratePadding(
           !(rtp_header_extension_map_.IsRegistered(AbsoluteSendTime::kId) ||
             rtp_header_extension_map_.IsRegistered(
                 TransportSequenceNumber::kId))) {
-        break;
+        return padding_packets;
       }
 
       RTC_DCHECK(rtx_ssrc_);
       RTC_DCHECK(!rtx_payload_type_map_.empty());
-      padding_packet->SetSsrc(*rtx_ssrc_);
-      padding_packet->SetPayloadType(rtx_payload_type_map_.begin()->second);
-    }
-
-    if (rtp_header_extension_map_.IsRegistered(TransportSequenceNumber::kId)) {
-      padding_packet->ReserveExtension<TransportSequenceNumber>();
-    }
-    if (rtp_header_extension_map_.IsRegistered(TransmissionOffset::kId)) {
-      padding_packet->ReserveExtension<TransmissionOffset>();
-    }
-    if (rtp_header_extension_map_.IsRegistered(AbsoluteSendTime::kId)) {
-      padding_packet->ReserveExtension<AbsoluteSendTime>();
+      config.ssrc = *rtx_ssrc_;
+      config.payload_type = rtx_payload_type_map_.begin()->second;
     }
+    prototype = padding_packet_factory_.GetPrototype(
+        config, rtp_header_extension_map_);
+  }
 
-    padding_packet->SetPadding(padding_bytes_in_packet);
-    bytes_left -= std::min(bytes_left, padding_bytes_in_packet);
-    padding_packets.push_back(std::move(padding_packet));
+  for (auto& packet :
+       PaddingPacketFactory::CreatePackets(*prototype, bytes_left)) {
+    padding_packets.push_back(std::move(packet));
   }
 
   return padding_packets;
@@ -696,10 +694,19 @@ std::unique_ptr<RtpPacketToSend> RTPSender::BuildRtxPacket(
   // Add OSN (original sequence number).
   ByteWriter<uint16_t>::WriteBigEndian(rtx_payload, packet.SequenceNumber());
 
-  // Add original payload data.
-  auto payload = packet.payload();
-  if (!payload.empty()) {
-    memcpy(rtx_payload + kRtxHeaderSize, payload.data(), payload.size());
+  // Add original payload data. Part of it may be referenced rather than stored
+  // in the original packet.
+  rtc::ArrayView<const uint8_t> referenced_payload =
+      packet.referenced_payload();
+  rtc::ArrayView<const uint8_t> stored_payload = packet.stored_data().subview(
+      packet.headers_size(), packet.payload_size() - referenced_payload.size());
+  if (!stored_payload.empty()) {
+    memcpy(rtx_payload + kRtxHeaderSize, stored_payload.data(),
+           stored_payload.size());
+  }
+  if (!referenced_payload.empty()) {
+    memcpy(rtx_payload + kRtxHeaderSize + stored_payload.size(),
+           referenced_payload.data(), referenced_payload.size());
   }
 
   // Add original additional data.
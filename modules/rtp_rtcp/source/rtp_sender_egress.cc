@@ -190,7 +190,9 @@ void RtpSenderEgress::SendPacket(std::unique_ptr<RtpPacketToSend> packet,
 
       fec_generator_->AddPacketAndGenerateFec(unpacked_packet);
     } else {
-      // If not RED encapsulated - we can just insert packet directly.
+      // If not RED encapsulated - we can just insert packet directly. FEC is
+      // computed over the contiguous packet.
+      packet->MaterializePayload();
       fec_generator_->AddPacketAndGenerateFec(*packet);
     }
   }
@@ -420,9 +422,14 @@ bool RtpSenderEgress::SendPacketToNetwork(const RtpPacketToSend& packet,
   RTC_DCHECK_RUN_ON(worker_queue_);
   int bytes_sent = -1;
   if (transport_) {
-    bytes_sent = transport_->SendRtp(packet, options)
-                     ? static_cast<int>(packet.size())
-                     : -1;
+    // Packets referencing their payload are gathered by the transport, which
+    // saves copying the payload into the packet first.
+    const bool sent =
+        packet.referenced_payload().empty()
+            ? transport_->SendRtp(packet, options)
+            : transport_->SendRtpGathered(
+                  packet.stored_data(), packet.referenced_payload(), options);
+    bytes_sent = sent ? static_cast<int>(packet.size()) : -1;
     if (event_log_ && bytes_sent > 0) {
       event_log_->Log(std::make_unique<RtcEventRtpPacketOutgoing>(
           packet, pacing_info.probe_cluster_id));
@@ -19,6 +19,7 @@
 #include "api/field_trials_registry.h"
 #include "api/units/data_size.h"
 #include "api/units/timestamp.h"
+#include "api/video/encoded_image.h"
 #include "logging/rtc_event_log/mock/mock_rtc_event_log.h"
 #include "modules/rtp_rtcp/include/flexfec_sender.h"
 #include "modules/rtp_rtcp/include/rtp_rtcp.h"
@@ -37,6 +38,7 @@ namespace {
 
 using ::testing::_;
 using ::testing::AllOf;
+using ::testing::ElementsAre;
 using ::testing::Eq;
 using ::testing::Field;
 using ::testing::InSequence;
@@ -101,11 +103,20 @@ class TestTransport : public Transport {
     RTC_CHECK_NOTREACHED();
   }
 
+  bool SendRtpGathered(rtc::ArrayView<const uint8_t> head,
+                       rtc::ArrayView<const uint8_t> tail,
+                       const PacketOptions& options) override {
+    ++num_gathered_packets_;
+    return Transport::SendRtpGathered(head, tail, options);
+  }
+
   absl::optional<TransmittedPacket> last_packet() { return last_packet_; }
+  int num_gathered_packets() const { return num_gathered_packets_; }
 
  private:
   DataSize total_data_sent_;
   absl::optional<TransmittedPacket> last_packet_;
+  int num_gathered_packets_ = 0;
   RtpHeaderExtensionMap* const extensions_;
 };
 
@@ -211,6 +222,33 @@ TEST_F(RtpSenderEgressTest, CollectsPacketsWhenBatchingWithVideo) {
   sender->OnBatchComplete();
 }
 
+TEST_F(RtpSenderEgressTest, GathersReferencedPayloadIntoSamePacket) {
+  const uint8_t kPayload[] = {0x05, 0x25, 0x52};
+  rtc::scoped_refptr<EncodedImageBuffer> frame =
+      EncodedImageBuffer::Create(kPayload, sizeof(kPayload));
+  std::unique_ptr<RtpSenderEgress> sender = CreateRtpSenderEgress();
+
+  std::unique_ptr<RtpPacketToSend> packet = BuildRtpPacket();
+  uint8_t* prefix = packet->SetPayloadReference(
+      /*prefix_size=*/1, rtc::MakeArrayView(frame->data(), frame->size()),
+      frame);
+  prefix[0] = 0xab;
+  auto contiguous_packet = std::make_unique<RtpPacketToSend>(*packet);
+  contiguous_packet->MaterializePayload();
+
+  sender->SendPacket(std::move(packet), PacedPacketInfo());
+  EXPECT_EQ(transport_.num_gathered_packets(), 1);
+  ASSERT_TRUE(transport_.last_packet().has_value());
+  const rtc::CopyOnWriteBuffer gathered =
+      transport_.last_packet()->packet.Buffer();
+
+  sender->SendPacket(std::move(contiguous_packet), PacedPacketInfo());
+  EXPECT_EQ(transport_.num_gathered_packets(), 1);
+  EXPECT_EQ(transport_.last_packet()->packet.Buffer(), gathered);
+  EXPECT_THAT(transport_.last_packet()->packet.payload(),
+              ElementsAre(0xab, 0x05, 0x25, 0x52));
+}
+
 TEST_F(RtpSenderEgressTest, PacketOptionsIsRetransmitSetByPacketType) {
   std::unique_ptr<RtpSenderEgress> sender = CreateRtpSenderEgress();
 
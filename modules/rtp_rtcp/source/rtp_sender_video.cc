@@ -150,6 +150,8 @@ RTPSenderVideo::RTPSenderVideo(const Config& config)
       generic_descriptor_auth_experiment_(!absl::StartsWith(
           config.field_trials->Lookup("WebRTC-GenericDescriptorAuth"),
           "Disabled")),
+      reference_packet_payload_(config.field_trials->IsEnabled(
+          "WebRTC-Video-ReferencePacketPayload")),
       absolute_capture_time_sender_(config.clock),
       frame_transformer_delegate_(
           config.frame_transformer
@@ -463,6 +465,23 @@ bool RTPSenderVideo::SendVideo(int payload_type,
                                RTPVideoHeader video_header,
                                TimeDelta expected_retransmission_time,
                                std::vector<uint32_t> csrcs) {
+  return SendVideoInternal(payload_type, codec_type, rtp_timestamp,
+                           capture_time, payload, /*payload_buffer=*/nullptr,
+                           encoder_output_size, std::move(video_header),
+                           expected_retransmission_time, std::move(csrcs));
+}
+
+bool RTPSenderVideo::SendVideoInternal(
+    int payload_type,
+    absl::optional<VideoCodecType> codec_type,
+    uint32_t rtp_timestamp,
+    Timestamp capture_time,
+    rtc::ArrayView<const uint8_t> payload,
+    rtc::scoped_refptr<EncodedImageBufferInterface> payload_buffer,
+    size_t encoder_output_size,
+    RTPVideoHeader video_header,
+    TimeDelta expected_retransmission_time,
+    std::vector<uint32_t> csrcs) {
   RTC_CHECK_RUNS_SERIALIZED(&send_checker_);
 
   if (video_header.frame_type == VideoFrameType::kEmptyFrame)
@@ -640,6 +659,12 @@ bool RTPSenderVideo::SendVideo(int payload_type,
 
   std::unique_ptr<RtpPacketizer> packetizer =
       RtpPacketizer::Create(codec_type, payload, limits, video_header);
+  // Encrypted payloads are not part of `payload_buffer`, and RED packets copy
+  // the payload anyway.
+  if (payload_buffer != nullptr && frame_encryptor_ == nullptr &&
+      !red_enabled()) {
+    packetizer->SetPayloadBuffer(std::move(payload_buffer));
+  }
 
   const size_t num_packets = packetizer->NumPackets();
 
@@ -754,10 +779,12 @@ bool RTPSenderVideo::SendEncodedImage(int payload_type,
         payload_type, codec_type, rtp_timestamp, encoded_image, video_header,
         expected_retransmission_time);
   }
-  return SendVideo(payload_type, codec_type, rtp_timestamp,
-                   encoded_image.CaptureTime(), encoded_image,
-                   encoded_image.size(), video_header,
-                   expected_retransmission_time, /*csrcs=*/{});
+  return SendVideoInternal(
+      payload_type, codec_type, rtp_timestamp, encoded_image.CaptureTime(),
+      encoded_image,
+      reference_packet_payload_ ? encoded_image.GetEncodedData() : nullptr,
+      encoded_image.size(), video_header, expected_retransmission_time,
+      /*csrcs=*/{});
 }
 
 DataRate RTPSenderVideo::PostEncodeOverhead() const {
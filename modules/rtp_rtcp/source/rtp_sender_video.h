@@ -26,6 +26,7 @@
 #include "api/transport/rtp/dependency_descriptor.h"
 #include "api/units/time_delta.h"
 #include "api/units/timestamp.h"
+#include "api/video/encoded_image.h"
 #include "api/video/video_codec_type.h"
 #include "api/video/video_frame_type.h"
 #include "api/video/video_layers_allocation.h"
@@ -166,6 +167,20 @@ class RTPSenderVideo : public RTPVideoFrameSenderInterface {
     kDontSend
   };
 
+  // Same as SendVideo(). If `payload_buffer` is set, `payload` lies within it
+  // and packets may reference `payload_buffer` instead of copying `payload`.
+  bool SendVideoInternal(
+      int payload_type,
+      absl::optional<VideoCodecType> codec_type,
+      uint32_t rtp_timestamp,
+      Timestamp capture_time,
+      rtc::ArrayView<const uint8_t> payload,
+      rtc::scoped_refptr<EncodedImageBufferInterface> payload_buffer,
+      size_t encoder_output_size,
+      RTPVideoHeader video_header,
+      TimeDelta expected_retransmission_time,
+      std::vector<uint32_t> csrcs);
+
   void SetVideoStructureInternal(
       const FrameDependencyStructure* video_structure);
   void SetVideoLayersAllocationInternal(VideoLayersAllocation allocation);
@@ -243,6 +258,10 @@ class RTPSenderVideo : public RTPVideoFrameSenderInterface {
   const bool require_frame_encryption_;
   // Set to true if the generic descriptor should be authenticated.
   const bool generic_descriptor_auth_experiment_;
+  // Set by the field trial WebRTC-Video-ReferencePacketPayload to let packets
+  // of encoded images reference the encoded data rather than copy it. Requires
+  // encoders to never modify an encoded image buffer once it is delivered.
+  const bool reference_packet_payload_;
 
   AbsoluteCaptureTimeSender absolute_capture_time_sender_
       RTC_GUARDED_BY(send_checker_);
@@ -24,6 +24,7 @@
 #include "api/test/mock_frame_transformer.h"
 #include "api/transport/rtp/dependency_descriptor.h"
 #include "api/units/timestamp.h"
+#include "api/video/encoded_image.h"
 #include "api/video/video_codec_constants.h"
 #include "api/video/video_timing.h"
 #include "modules/rtp_rtcp/include/rtp_cvo.h"
@@ -119,9 +120,16 @@ class LoopbackTransportTest : public webrtc::Transport {
     EXPECT_TRUE(sent_packets_.back().Parse(data));
     return true;
   }
+  bool SendRtpGathered(rtc::ArrayView<const uint8_t> head,
+                       rtc::ArrayView<const uint8_t> tail,
+                       const PacketOptions& options) override {
+    ++gathered_packets_sent_;
+    return Transport::SendRtpGathered(head, tail, options);
+  }
   bool SendRtcp(rtc::ArrayView<const uint8_t> data) override { return false; }
   const RtpPacketReceived& last_sent_packet() { return sent_packets_.back(); }
   int packets_sent() { return sent_packets_.size(); }
+  int gathered_packets_sent() { return gathered_packets_sent_; }
   const std::vector<RtpPacketReceived>& sent_packets() const {
     return sent_packets_;
   }
@@ -129,6 +137,7 @@ class LoopbackTransportTest : public webrtc::Transport {
  private:
   RtpHeaderExtensionMap receivers_extensions_;
   std::vector<RtpPacketReceived> sent_packets_;
+  int gathered_packets_sent_ = 0;
 };
 
 class TestRtpSenderVideo : public RTPSenderVideo {
@@ -861,6 +870,45 @@ TEST_F(RtpSenderVideoTest,
                   .HasExtension<RtpDependencyDescriptorExtension>());
 }
 
+TEST_F(RtpSenderVideoTest, CopiesEncodedImagePayloadByDefault) {
+  const uint8_t kFrame[] = {1, 2, 3, 4};
+  EncodedImage encoded_image;
+  encoded_image.SetEncodedData(EncodedImageBuffer::Create(kFrame, 4));
+  RTPVideoHeader hdr;
+  hdr.frame_type = VideoFrameType::kVideoFrameKey;
+
+  ASSERT_TRUE(rtp_sender_video_->SendEncodedImage(
+      kPayload, kType, kTimestamp, encoded_image, hdr,
+      kDefaultExpectedRetransmissionTime));
+  ASSERT_EQ(transport_.packets_sent(), 1);
+  EXPECT_EQ(transport_.gathered_packets_sent(), 0);
+}
+
+TEST_F(RtpSenderVideoTest, ReferencesEncodedImagePayloadWhenEnabled) {
+  test::ExplicitKeyValueConfig field_trials(
+      "WebRTC-Video-ReferencePacketPayload/Enabled/");
+  RTPSenderVideo::Config config;
+  config.clock = &fake_clock_;
+  config.rtp_sender = rtp_module_->RtpSender();
+  config.field_trials = &field_trials;
+  RTPSenderVideo rtp_sender_video(config);
+
+  const uint8_t kFrame[] = {1, 2, 3, 4};
+  EncodedImage encoded_image;
+  encoded_image.SetEncodedData(EncodedImageBuffer::Create(kFrame, 4));
+  RTPVideoHeader hdr;
+  hdr.frame_type = VideoFrameType::kVideoFrameKey;
+
+  ASSERT_TRUE(rtp_sender_video.SendEncodedImage(
+      kPayload, kType, kTimestamp, encoded_image, hdr,
+      kDefaultExpectedRetransmissionTime));
+  ASSERT_EQ(transport_.packets_sent(), 1);
+  EXPECT_EQ(transport_.gathered_packets_sent(), 1);
+  // Generic payload header followed by the referenced frame.
+  EXPECT_THAT(transport_.last_sent_packet().payload().subview(1),
+              ElementsAreArray(kFrame));
+}
+
 TEST_F(RtpSenderVideoTest, PopulateGenericFrameDescriptor) {
   const int64_t kFrameId = 100000;
   uint8_t kFrame[100];
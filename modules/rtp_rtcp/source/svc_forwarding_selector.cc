@@ -0,0 +1,274 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/svc_forwarding_selector.h"
+
+#include <algorithm>
+#include <tuple>
+
+#include "api/video/video_codec_constants.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+
+namespace webrtc {
+namespace {
+
+// Packets older than this, relative to the newest packet, are dropped when
+// they arrive.
+constexpr int64_t kMaxReorderingDistance = 1000;
+
+int LayerBit(int spatial_id, int temporal_id) {
+  return spatial_id * DependencyDescriptor::kMaxTemporalIds + temporal_id;
+}
+
+DecodeTargetIndication Indication(const FrameDependencyTemplate& frame,
+                                  int decode_target) {
+  return static_cast<size_t>(decode_target) <
+                 frame.decode_target_indications.size()
+             ? frame.decode_target_indications[decode_target]
+             : DecodeTargetIndication::kNotPresent;
+}
+
+}  // namespace
+
+SvcForwardingSelector::SvcForwardingSelector() = default;
+SvcForwardingSelector::~SvcForwardingSelector() = default;
+
+void SvcForwardingSelector::SetTarget(const Target& target) {
+  target_ = target;
+  SelectDecodeTarget();
+}
+
+void SvcForwardingSelector::SetLayerBitrates(
+    const VideoBitrateAllocation& bitrates) {
+  layer_bitrates_ = bitrates;
+  SelectDecodeTarget();
+}
+
+SvcForwardingSelector::Decision SvcForwardingSelector::OnPacket(
+    uint16_t sequence_number,
+    const DependencyDescriptor& descriptor) {
+  const int64_t unwrapped_sequence_number =
+      sequence_number_unwrapper_.Unwrap(sequence_number);
+  const int64_t frame_id = frame_id_unwrapper_.Unwrap(descriptor.frame_number);
+  const bool newest_frame = !last_frame_id_ || frame_id > *last_frame_id_;
+  if (newest_frame && descriptor.attached_structure) {
+    OnStructure(*descriptor.attached_structure);
+  }
+
+  Decision decision;
+  if (has_structure_) {
+    decision.forward = DecideFrame(frame_id, descriptor);
+  }
+  absl::optional<uint16_t> forwarded_sequence_number =
+      MapSequenceNumber(unwrapped_sequence_number, decision.forward);
+  if (!forwarded_sequence_number) {
+    return Decision();
+  }
+  decision.sequence_number = *forwarded_sequence_number;
+  if (descriptor.first_packet_in_frame && frame_id == *last_frame_id_) {
+    decision.active_decode_targets_bitmask = active_decode_targets_bitmask_;
+  }
+  return decision;
+}
+
+void SvcForwardingSelector::OnStructure(
+    const FrameDependencyStructure& structure) {
+  const int num_decode_targets = structure.num_decode_targets;
+  RTC_DCHECK_LE(num_decode_targets, DependencyDescriptor::kMaxDecodeTargets);
+  const uint32_t all_decode_targets =
+      num_decode_targets == 0 ? 0 : ~uint32_t{0} >> (32 - num_decode_targets);
+
+  decode_targets_.assign(num_decode_targets, DecodeTargetInfo());
+  // Decode targets that are not part of a frame, per decode target that is.
+  std::array<uint32_t, DependencyDescriptor::kMaxDecodeTargets> missing_from =
+      {};
+  for (const FrameDependencyTemplate& frame : structure.templates) {
+    uint32_t present = 0;
+    for (int dt = 0; dt < num_decode_targets; ++dt) {
+      if (Indication(frame, dt) == DecodeTargetIndication::kNotPresent) {
+        continue;
+      }
+      present |= uint32_t{1} << dt;
+      DecodeTargetInfo& info = decode_targets_[dt];
+      info.spatial_id = std::max(info.spatial_id, frame.spatial_id);
+      info.temporal_id = std::max(info.temporal_id, frame.temporal_id);
+      info.layers |= uint32_t{1}
+                     << LayerBit(frame.spatial_id, frame.temporal_id);
+    }
+    for (int dt = 0; dt < num_decode_targets; ++dt) {
+      if (!(present & (uint32_t{1} << dt))) {
+        missing_from[dt] |= present;
+      }
+    }
+  }
+  // A decode target can be decoded from the frames of another one if none of
+  // its frames is missing from it.
+  for (int dt = 0; dt < num_decode_targets; ++dt) {
+    decode_targets_[dt].decodable = all_decode_targets & ~missing_from[dt];
+  }
+
+  decode_target_protected_by_chain_ =
+      structure.decode_target_protected_by_chain;
+  has_structure_ = true;
+  active_decode_targets_ = all_decode_targets;
+  // The structure comes with a key frame, which is a switch point for all
+  // decode targets.
+  current_decode_target_ = absl::nullopt;
+  SelectDecodeTarget();
+}
+
+void SvcForwardingSelector::SelectDecodeTarget() {
+  absl::optional<int> best;
+  absl::optional<int> cheapest;
+  const bool limit_bitrate = target_.max_bitrate && layer_bitrates_;
+  for (size_t dt = 0; dt < decode_targets_.size(); ++dt) {
+    const DecodeTargetInfo& info = decode_targets_[dt];
+    if (!(active_decode_targets_ & (uint32_t{1} << dt)) ||
+        info.spatial_id > target_.max_spatial_id ||
+        info.temporal_id > target_.max_temporal_id) {
+      continue;
+    }
+    if (!cheapest || Bitrate(info) < Bitrate(decode_targets_[*cheapest])) {
+      cheapest = dt;
+    }
+    if (limit_bitrate && Bitrate(info) > *target_.max_bitrate) {
+      continue;
+    }
+    if (!best ||
+        std::tie(info.spatial_id, info.temporal_id) >
+            std::tie(decode_targets_[*best].spatial_id,
+                     decode_targets_[*best].temporal_id)) {
+      best = dt;
+    }
+  }
+  selected_decode_target_ = best ? best : cheapest;
+  if (!selected_decode_target_) {
+    // Not forwarding anything can start at any frame.
+    current_decode_target_ = absl::nullopt;
+  }
+}
+
+DataRate SvcForwardingSelector::Bitrate(const DecodeTargetInfo& info) const {
+  if (!layer_bitrates_) {
+    return DataRate::Zero();
+  }
+  uint32_t bitrate_bps = 0;
+  for (int s = 0; s < kMaxSpatialLayers; ++s) {
+    for (int t = 0; t < kMaxTemporalStreams; ++t) {
+      if (info.layers & (uint32_t{1} << LayerBit(s, t))) {
+        bitrate_bps += layer_bitrates_->GetBitrate(s, t);
+      }
+    }
+  }
+  return DataRate::BitsPerSec(bitrate_bps);
+}
+
+bool SvcForwardingSelector::DecideFrame(
+    int64_t frame_id,
+    const DependencyDescriptor& descriptor) {
+  FrameDecision& stored =
+      frame_decisions_[static_cast<uint64_t>(frame_id) % kFrameHistorySize];
+  if (stored.frame_id == frame_id) {
+    return stored.forward;
+  }
+  const FrameDependencyTemplate& frame = descriptor.frame_dependencies;
+  stored.frame_id = frame_id;
+
+  if (last_frame_id_ && frame_id < *last_frame_id_) {
+    // The first packet seen of an older frame. Forward it if it is part of
+    // the current decode target, but do not switch at it.
+    stored.forward = current_decode_target_ &&
+                     Indication(frame, *current_decode_target_) !=
+                         DecodeTargetIndication::kNotPresent;
+    return stored.forward;
+  }
+  last_frame_id_ = frame_id;
+  active_decode_targets_bitmask_ = absl::nullopt;
+
+  if (descriptor.active_decode_targets_bitmask &&
+      *descriptor.active_decode_targets_bitmask != active_decode_targets_) {
+    active_decode_targets_ = *descriptor.active_decode_targets_bitmask;
+    SelectDecodeTarget();
+  }
+  if (selected_decode_target_ != current_decode_target_ &&
+      Indication(frame, *selected_decode_target_) ==
+          DecodeTargetIndication::kSwitch &&
+      ReferencesForwarded(frame_id, frame)) {
+    RTC_LOG(LS_VERBOSE) << "Switching to decode target "
+                        << *selected_decode_target_ << " at frame "
+                        << frame_id;
+    current_decode_target_ = selected_decode_target_;
+  }
+  stored.forward = current_decode_target_ &&
+                   Indication(frame, *current_decode_target_) !=
+                       DecodeTargetIndication::kNotPresent;
+
+  if (stored.forward) {
+    active_decode_targets_helper_.OnFrame(
+        decode_target_protected_by_chain_,
+        decode_targets_[*current_decode_target_].decodable &
+            active_decode_targets_,
+        /*is_keyframe=*/descriptor.attached_structure != nullptr, frame_id,
+        frame.chain_diffs);
+    active_decode_targets_bitmask_ =
+        active_decode_targets_helper_.ActiveDecodeTargetsBitmask();
+  }
+  return stored.forward;
+}
+
+bool SvcForwardingSelector::ReferencesForwarded(
+    int64_t frame_id,
+    const FrameDependencyTemplate& frame) const {
+  for (int frame_diff : frame.frame_diffs) {
+    const FrameDecision& reference =
+        frame_decisions_[static_cast<uint64_t>(frame_id - frame_diff) %
+                         kFrameHistorySize];
+    if (reference.frame_id != frame_id - frame_diff || !reference.forward) {
+      return false;
+    }
+  }
+  return true;
+}
+
+absl::optional<uint16_t> SvcForwardingSelector::MapSequenceNumber(
+    int64_t sequence_number,
+    bool forward) {
+  // Forwarded packets keep their order and get consecutive sequence numbers,
+  // i.e. are moved back by the number of packets dropped before them.
+  if (!last_sequence_number_ || sequence_number > *last_sequence_number_) {
+    last_sequence_number_ = sequence_number;
+    while (!recently_dropped_.empty() &&
+           recently_dropped_.front() <
+               sequence_number - kMaxReorderingDistance) {
+      recently_dropped_.pop_front();
+    }
+    if (!forward) {
+      recently_dropped_.push_back(sequence_number);
+      ++num_dropped_;
+      return absl::nullopt;
+    }
+    return static_cast<uint16_t>(sequence_number - num_dropped_);
+  }
+
+  // A reordered or duplicate packet. Dropping it leaves a gap.
+  if (!forward ||
+      sequence_number < *last_sequence_number_ - kMaxReorderingDistance) {
+    return absl::nullopt;
+  }
+  const int64_t dropped_after =
+      recently_dropped_.end() - std::upper_bound(recently_dropped_.begin(),
+                                                 recently_dropped_.end(),
+                                                 sequence_number);
+  return static_cast<uint16_t>(sequence_number -
+                               (num_dropped_ - dropped_after));
+}
+
+}  // namespace webrtc
@@ -0,0 +1,146 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_RTP_RTCP_SOURCE_SVC_FORWARDING_SELECTOR_H_
+#define MODULES_RTP_RTCP_SOURCE_SVC_FORWARDING_SELECTOR_H_
+
+#include <stdint.h>
+
+#include <array>
+#include <deque>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/types/optional.h"
+#include "api/transport/rtp/dependency_descriptor.h"
+#include "api/units/data_rate.h"
+#include "api/video/video_bitrate_allocation.h"
+#include "modules/rtp_rtcp/source/active_decode_targets_helper.h"
+#include "rtc_base/numerics/sequence_number_unwrapper.h"
+
+namespace webrtc {
+
+// Decides which packets of a scalable video stream a selective forwarding unit
+// forwards to one receiver, based on the dependency descriptor of each packet.
+// Frames are forwarded if they are part of the decode target selected for the
+// receiver, i.e. the highest decode target within its layer and bitrate
+// limits. The decode target changes at frames that are switch points for the
+// new one and whose references were forwarded, e.g. at key frames. Forwarded
+// packets get consecutive sequence numbers, and the active decode targets are
+// signaled to the receiver when they change.
+// See https://aomediacodec.github.io/av1-rtp-spec/#a4-sfu-behavior
+//
+// Frame numbers and the rest of the dependency descriptor are kept, so it can
+// be forwarded as is except for the active decode targets bitmask.
+// This class is thread-compatible.
+class SvcForwardingSelector {
+ public:
+  struct Target {
+    int max_spatial_id = DependencyDescriptor::kMaxSpatialIds - 1;
+    int max_temporal_id = DependencyDescriptor::kMaxTemporalIds - 1;
+    // Limits the decode target to the layers that fit, if their bitrates are
+    // known. The lowest decode target is forwarded if none fits.
+    absl::optional<DataRate> max_bitrate;
+  };
+
+  struct Decision {
+    bool forward = false;
+    // Sequence number of the forwarded packet.
+    uint16_t sequence_number = 0;
+    // If set, to be written into the dependency descriptor of the forwarded
+    // packet.
+    absl::optional<uint32_t> active_decode_targets_bitmask;
+  };
+
+  SvcForwardingSelector();
+  SvcForwardingSelector(const SvcForwardingSelector&) = delete;
+  SvcForwardingSelector& operator=(const SvcForwardingSelector&) = delete;
+  ~SvcForwardingSelector();
+
+  void SetTarget(const Target& target);
+
+  // Bitrates of the spatial and temporal layers of the incoming stream, e.g.
+  // from its video layers allocation, used to apply `Target::max_bitrate`.
+  void SetLayerBitrates(const VideoBitrateAllocation& bitrates);
+
+  // Decides about the next packet of the stream. `descriptor` is the parsed
+  // dependency descriptor of the packet; packets without one are dropped.
+  // Packets may be passed in arrival order, including reordering. A dropped
+  // packet that arrives after later packets were forwarded leaves a gap in the
+  // forwarded sequence numbers.
+  Decision OnPacket(uint16_t sequence_number,
+                    const DependencyDescriptor& descriptor);
+
+  // Decode target forwarded now, if any.
+  absl::optional<int> decode_target() const { return current_decode_target_; }
+
+  // Whether the decode target is to change once a frame allows switching to
+  // it. The receiver can ask for a key frame if this takes too long.
+  bool switch_pending() const {
+    return selected_decode_target_ != current_decode_target_;
+  }
+
+ private:
+  // What is derived from the frame dependency structure per decode target.
+  struct DecodeTargetInfo {
+    int spatial_id = 0;
+    int temporal_id = 0;
+    // Bit `s * kMaxTemporalIds + t` is set if the decode target contains
+    // frames of spatial layer `s` and temporal layer `t`.
+    uint32_t layers = 0;
+    // Decode targets whose frames are all part of this decode target, i.e.
+    // that can be decoded when this one is forwarded.
+    uint32_t decodable = 0;
+  };
+  struct FrameDecision {
+    int64_t frame_id = -1;
+    bool forward = false;
+  };
+  // Frames of which decisions are kept for reordered packets.
+  static constexpr int kFrameHistorySize = 128;
+
+  void OnStructure(const FrameDependencyStructure& structure);
+  void SelectDecodeTarget();
+  DataRate Bitrate(const DecodeTargetInfo& info) const;
+  bool DecideFrame(int64_t frame_id, const DependencyDescriptor& descriptor);
+  bool ReferencesForwarded(int64_t frame_id,
+                           const FrameDependencyTemplate& frame) const;
+  absl::optional<uint16_t> MapSequenceNumber(int64_t sequence_number,
+                                             bool forward);
+
+  Target target_;
+  absl::optional<VideoBitrateAllocation> layer_bitrates_;
+
+  // Derived from the latest frame dependency structure.
+  bool has_structure_ = false;
+  absl::InlinedVector<DecodeTargetInfo, 10> decode_targets_;
+  absl::InlinedVector<int, 10> decode_target_protected_by_chain_;
+  // Decode targets active at the sender.
+  uint32_t active_decode_targets_ = ~uint32_t{0};
+
+  absl::optional<int> selected_decode_target_;
+  absl::optional<int> current_decode_target_;
+
+  SeqNumUnwrapper<uint16_t> frame_id_unwrapper_;
+  absl::optional<int64_t> last_frame_id_;
+  std::array<FrameDecision, kFrameHistorySize> frame_decisions_;
+  ActiveDecodeTargetsHelper active_decode_targets_helper_;
+  // Bitmask to write into the first packet of the latest frame.
+  absl::optional<uint32_t> active_decode_targets_bitmask_;
+
+  SeqNumUnwrapper<uint16_t> sequence_number_unwrapper_;
+  absl::optional<int64_t> last_sequence_number_;
+  // Dropped packets, for reordered packets that arrive after them.
+  std::deque<int64_t> recently_dropped_;
+  int64_t num_dropped_ = 0;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_RTP_RTCP_SOURCE_SVC_FORWARDING_SELECTOR_H_
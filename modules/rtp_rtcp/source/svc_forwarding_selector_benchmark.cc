@@ -0,0 +1,92 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "api/transport/rtp/dependency_descriptor.h"
+#include "api/video_codecs/scalability_mode.h"
+#include "benchmark/benchmark.h"
+#include "common_video/generic_frame_descriptor/generic_frame_info.h"
+#include "modules/rtp_rtcp/source/svc_forwarding_selector.h"
+#include "modules/video_coding/chain_diff_calculator.h"
+#include "modules/video_coding/svc/create_scalability_structure.h"
+#include "modules/video_coding/svc/scalable_video_controller.h"
+#include "rtc_base/system/unused.h"
+
+namespace webrtc {
+namespace {
+
+constexpr int kPacketsPerFrame = 4;
+
+// Dependency descriptors of `num_temporal_units` of an L3T3 stream, one per
+// packet.
+std::vector<DependencyDescriptor> CreateStream(int num_temporal_units) {
+  std::unique_ptr<ScalableVideoController> controller =
+      CreateScalabilityStructure(ScalabilityMode::kL3T3);
+  ChainDiffCalculator chain_diff_calculator;
+  std::vector<DependencyDescriptor> packets;
+  int64_t frame_id = 0;
+  for (int i = 0; i < num_temporal_units; ++i) {
+    for (const ScalableVideoController::LayerFrameConfig& layer_frame :
+         controller->NextFrameConfig(/*restart=*/false)) {
+      ++frame_id;
+      GenericFrameInfo frame_info = controller->OnEncodeDone(layer_frame);
+      if (layer_frame.IsKeyframe()) {
+        chain_diff_calculator.Reset(frame_info.part_of_chain);
+      }
+      frame_info.chain_diffs =
+          chain_diff_calculator.From(frame_id, frame_info.part_of_chain);
+      for (int p = 0; p < kPacketsPerFrame; ++p) {
+        DependencyDescriptor& packet = packets.emplace_back();
+        packet.first_packet_in_frame = p == 0;
+        packet.last_packet_in_frame = p == kPacketsPerFrame - 1;
+        packet.frame_number = static_cast<uint16_t>(frame_id);
+        packet.frame_dependencies = frame_info;
+        if (layer_frame.IsKeyframe() && p == 0) {
+          packet.attached_structure =
+              std::make_unique<FrameDependencyStructure>(
+                  controller->DependencyStructure());
+        }
+      }
+    }
+  }
+  return packets;
+}
+
+// Forwards each packet to `state.range(0)` subscribers, each with its own
+// layer limits.
+void BM_SvcForwardingSelector(benchmark::State& state) {
+  const int num_subscribers = static_cast<int>(state.range(0));
+  const std::vector<DependencyDescriptor> packets =
+      CreateStream(/*num_temporal_units=*/1000);
+  for (auto s : state) {
+    RTC_UNUSED(s);
+    std::vector<SvcForwardingSelector> selectors(num_subscribers);
+    for (int i = 0; i < num_subscribers; ++i) {
+      selectors[i].SetTarget(
+          {.max_spatial_id = i % 3, .max_temporal_id = (i / 3) % 3});
+    }
+    uint16_t sequence_number = 0;
+    for (const DependencyDescriptor& packet : packets) {
+      for (SvcForwardingSelector& selector : selectors) {
+        benchmark::DoNotOptimize(selector.OnPacket(sequence_number, packet));
+      }
+      ++sequence_number;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * packets.size() *
+                          num_subscribers);
+}
+
+BENCHMARK(BM_SvcForwardingSelector)->Arg(1)->Arg(9)->Arg(50);
+
+}  // namespace
+}  // namespace webrtc
@@ -0,0 +1,315 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/svc_forwarding_selector.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "api/array_view.h"
+#include "api/transport/rtp/dependency_descriptor.h"
+#include "api/units/data_rate.h"
+#include "api/video/video_bitrate_allocation.h"
+#include "api/video_codecs/scalability_mode.h"
+#include "common_video/generic_frame_descriptor/generic_frame_info.h"
+#include "modules/video_coding/chain_diff_calculator.h"
+#include "modules/video_coding/frame_dependencies_calculator.h"
+#include "modules/video_coding/svc/create_scalability_structure.h"
+#include "modules/video_coding/svc/scalable_video_controller.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using ::testing::Optional;
+
+struct Packet {
+  uint16_t sequence_number;
+  DependencyDescriptor descriptor;
+};
+
+// Produces the packets of a scalable video stream, with dependency descriptors
+// as an encoder using `mode` would.
+class SvcStream {
+ public:
+  explicit SvcStream(ScalabilityMode mode, uint16_t first_sequence_number = 0)
+      : controller_(CreateScalabilityStructure(mode)),
+        sequence_number_(first_sequence_number) {}
+
+  // Packets of the next `num_temporal_units` temporal units.
+  std::vector<Packet> Next(int num_temporal_units,
+                           int packets_per_frame = 1,
+                           bool key_frame = false) {
+    std::vector<Packet> packets;
+    for (int i = 0; i < num_temporal_units; ++i) {
+      for (const ScalableVideoController::LayerFrameConfig& layer_frame :
+           controller_->NextFrameConfig(/*restart=*/key_frame && i == 0)) {
+        const int64_t frame_id = ++frame_id_;
+        const bool is_keyframe = layer_frame.IsKeyframe();
+        GenericFrameInfo frame_info = controller_->OnEncodeDone(layer_frame);
+        if (is_keyframe) {
+          chain_diff_calculator_.Reset(frame_info.part_of_chain);
+        }
+        frame_info.chain_diffs =
+            chain_diff_calculator_.From(frame_id, frame_info.part_of_chain);
+        for (int64_t base_frame_id : frame_deps_calculator_.FromBuffersUsage(
+                 frame_id, frame_info.encoder_buffers)) {
+          frame_info.frame_diffs.push_back(frame_id - base_frame_id);
+        }
+        for (int p = 0; p < packets_per_frame; ++p) {
+          Packet& packet = packets.emplace_back();
+          packet.sequence_number = sequence_number_++;
+          packet.descriptor.first_packet_in_frame = p == 0;
+          packet.descriptor.last_packet_in_frame = p == packets_per_frame - 1;
+          packet.descriptor.frame_number = static_cast<uint16_t>(frame_id);
+          packet.descriptor.frame_dependencies = frame_info;
+          if (is_keyframe && p == 0) {
+            packet.descriptor.attached_structure =
+                std::make_unique<FrameDependencyStructure>(
+                    controller_->DependencyStructure());
+          }
+        }
+      }
+    }
+    return packets;
+  }
+
+ private:
+  const std::unique_ptr<ScalableVideoController> controller_;
+  ChainDiffCalculator chain_diff_calculator_;
+  FrameDependenciesCalculator frame_deps_calculator_;
+  uint16_t sequence_number_;
+  int64_t frame_id_ = 0;
+};
+
+struct Forwarded {
+  int spatial_id;
+  int temporal_id;
+  uint16_t sequence_number;
+};
+
+std::vector<Forwarded> Forward(SvcForwardingSelector& selector,
+                               rtc::ArrayView<const Packet> packets) {
+  std::vector<Forwarded> forwarded;
+  for (const Packet& packet : packets) {
+    SvcForwardingSelector::Decision decision =
+        selector.OnPacket(packet.sequence_number, packet.descriptor);
+    if (decision.forward) {
+      forwarded.push_back(
+          {.spatial_id = packet.descriptor.frame_dependencies.spatial_id,
+           .temporal_id = packet.descriptor.frame_dependencies.temporal_id,
+           .sequence_number = decision.sequence_number});
+    }
+  }
+  return forwarded;
+}
+
+// Index of decode target (S`spatial_id`, T`temporal_id`) in L3T3 structures.
+int L3T3DecodeTarget(int spatial_id, int temporal_id) {
+  return spatial_id * 3 + temporal_id;
+}
+
+TEST(SvcForwardingSelectorTest, ForwardsFramesOfTargetLayers) {
+  SvcStream stream(ScalabilityMode::kL3T3);
+  SvcForwardingSelector selector;
+  selector.SetTarget({.max_spatial_id = 1, .max_temporal_id = 1});
+
+  std::vector<Packet> packets = stream.Next(/*num_temporal_units=*/8);
+  std::vector<Forwarded> forwarded = Forward(selector, packets);
+
+  EXPECT_THAT(selector.decode_target(), Optional(L3T3DecodeTarget(1, 1)));
+  int expected = 0;
+  for (const Packet& packet : packets) {
+    const FrameDependencyTemplate& frame = packet.descriptor.frame_dependencies;
+    if (frame.spatial_id <= 1 && frame.temporal_id <= 1) {
+      ++expected;
+    }
+  }
+  ASSERT_EQ(forwarded.size(), static_cast<size_t>(expected));
+  for (const Forwarded& f : forwarded) {
+    EXPECT_LE(f.spatial_id, 1);
+    EXPECT_LE(f.temporal_id, 1);
+  }
+}
+
+TEST(SvcForwardingSelectorTest, RewritesSequenceNumbersConsecutively) {
+  SvcStream stream(ScalabilityMode::kL3T3, /*first_sequence_number=*/0xFFF0);
+  SvcForwardingSelector selector;
+  selector.SetTarget({.max_spatial_id = 0, .max_temporal_id = 0});
+
+  std::vector<Forwarded> forwarded =
+      Forward(selector,
+              stream.Next(/*num_temporal_units=*/12, /*packets_per_frame=*/3));
+
+  // One frame of S0T0 every 4 temporal units.
+  ASSERT_EQ(forwarded.size(), 3u * 3u);
+  EXPECT_EQ(forwarded[0].sequence_number, 0xFFF0);
+  for (size_t i = 1; i < forwarded.size(); ++i) {
+    EXPECT_EQ(forwarded[i].sequence_number,
+              static_cast<uint16_t>(forwarded[i - 1].sequence_number + 1));
+  }
+}
+
+TEST(SvcForwardingSelectorTest, MapsReorderedPacketsIntoTheSameSequence) {
+  SvcStream stream(ScalabilityMode::kL3T3);
+  std::vector<Packet> packets =
+      stream.Next(/*num_temporal_units=*/8, /*packets_per_frame=*/2);
+  SvcForwardingSelector in_order;
+  SvcForwardingSelector reordered;
+  in_order.SetTarget({.max_spatial_id = 1, .max_temporal_id = 2});
+  reordered.SetTarget({.max_spatial_id = 1, .max_temporal_id = 2});
+
+  std::vector<uint16_t> expected(packets.size(), 0);
+  std::vector<bool> expected_forward(packets.size(), false);
+  for (size_t i = 0; i < packets.size(); ++i) {
+    SvcForwardingSelector::Decision decision =
+        in_order.OnPacket(packets[i].sequence_number, packets[i].descriptor);
+    expected_forward[i] = decision.forward;
+    expected[i] = decision.sequence_number;
+  }
+  // Swap pairs of forwarded packets after the key frame, including packets of
+  // different frames.
+  std::vector<size_t> order;
+  for (size_t i = 0; i < packets.size(); ++i) {
+    order.push_back(i);
+  }
+  int num_swapped = 0;
+  for (size_t i = 2; i + 1 < order.size(); ++i) {
+    if (expected_forward[i] && expected_forward[i + 1]) {
+      std::swap(order[i], order[i + 1]);
+      ++num_swapped;
+      i += 2;
+    }
+  }
+  ASSERT_GT(num_swapped, 0);
+  for (size_t i : order) {
+    SvcForwardingSelector::Decision decision =
+        reordered.OnPacket(packets[i].sequence_number, packets[i].descriptor);
+    EXPECT_EQ(decision.forward, expected_forward[i]) << i;
+    if (decision.forward) {
+      EXPECT_EQ(decision.sequence_number, expected[i]) << i;
+    }
+  }
+}
+
+TEST(SvcForwardingSelectorTest, SwitchesDownAtSwitchPoint) {
+  SvcStream stream(ScalabilityMode::kL3T3);
+  SvcForwardingSelector selector;
+  Forward(selector, stream.Next(/*num_temporal_units=*/2));
+  EXPECT_THAT(selector.decode_target(), Optional(L3T3DecodeTarget(2, 2)));
+
+  selector.SetTarget({.max_spatial_id = 0, .max_temporal_id = 0});
+  EXPECT_TRUE(selector.switch_pending());
+  // The next two temporal units have no S0T0 frame, which is the switch point
+  // for S0T0.
+  std::vector<Forwarded> forwarded =
+      Forward(selector, stream.Next(/*num_temporal_units=*/2));
+  EXPECT_EQ(forwarded.size(), 2u * 3u);
+  EXPECT_TRUE(selector.switch_pending());
+
+  forwarded = Forward(selector, stream.Next(/*num_temporal_units=*/4));
+  EXPECT_FALSE(selector.switch_pending());
+  EXPECT_THAT(selector.decode_target(), Optional(L3T3DecodeTarget(0, 0)));
+  ASSERT_EQ(forwarded.size(), 1u);
+  for (const Forwarded& f : forwarded) {
+    EXPECT_EQ(f.spatial_id, 0);
+  }
+}
+
+TEST(SvcForwardingSelectorTest, SwitchesUpOnlyAtFrameWithForwardedReferences) {
+  SvcStream stream(ScalabilityMode::kL3T3_KEY);
+  SvcForwardingSelector selector;
+  selector.SetTarget({.max_spatial_id = 0, .max_temporal_id = 2});
+  Forward(selector, stream.Next(/*num_temporal_units=*/4));
+
+  // Upper temporal layers of the same spatial layer can be added at the next
+  // S0T0 frame.
+  selector.SetTarget({.max_spatial_id = 0, .max_temporal_id = 0});
+  Forward(selector, stream.Next(/*num_temporal_units=*/4));
+  EXPECT_THAT(selector.decode_target(), Optional(L3T3DecodeTarget(0, 0)));
+  selector.SetTarget({.max_spatial_id = 0, .max_temporal_id = 2});
+  Forward(selector, stream.Next(/*num_temporal_units=*/4));
+  EXPECT_THAT(selector.decode_target(), Optional(L3T3DecodeTarget(0, 2)));
+
+  // Upper spatial layers reference frames that were not forwarded, so they
+  // need a key frame.
+  selector.SetTarget({});
+  std::vector<Forwarded> forwarded =
+      Forward(selector, stream.Next(/*num_temporal_units=*/8));
+  EXPECT_TRUE(selector.switch_pending());
+  for (const Forwarded& f : forwarded) {
+    EXPECT_EQ(f.spatial_id, 0);
+  }
+
+  forwarded = Forward(selector, stream.Next(/*num_temporal_units=*/1,
+                                            /*packets_per_frame=*/1,
+                                            /*key_frame=*/true));
+  EXPECT_FALSE(selector.switch_pending());
+  EXPECT_THAT(selector.decode_target(), Optional(L3T3DecodeTarget(2, 2)));
+  EXPECT_EQ(forwarded.size(), 3u);
+}
+
+TEST(SvcForwardingSelectorTest, SelectsHighestDecodeTargetWithinBitrate) {
+  VideoBitrateAllocation bitrates;
+  for (int s = 0; s < 3; ++s) {
+    for (int t = 0; t < 3; ++t) {
+      bitrates.SetBitrate(s, t, 100'000);
+    }
+  }
+  SvcStream stream(ScalabilityMode::kL3T3);
+  SvcForwardingSelector selector;
+  selector.SetLayerBitrates(bitrates);
+  selector.SetTarget({.max_bitrate = DataRate::KilobitsPerSec(450)});
+  Forward(selector, stream.Next(/*num_temporal_units=*/1));
+  // S2T0 consists of 3 layers, S1T1 of 4 and S2T1 of 6.
+  EXPECT_THAT(selector.decode_target(), Optional(L3T3DecodeTarget(2, 0)));
+
+  selector.SetTarget({.max_bitrate = DataRate::KilobitsPerSec(50)});
+  Forward(selector, stream.Next(/*num_temporal_units=*/4));
+  EXPECT_THAT(selector.decode_target(), Optional(L3T3DecodeTarget(0, 0)));
+}
+
+TEST(SvcForwardingSelectorTest, SignalsForwardedDecodeTargetsAsActive) {
+  SvcStream stream(ScalabilityMode::kL3T3);
+  SvcForwardingSelector selector;
+  selector.SetTarget({.max_spatial_id = 0, .max_temporal_id = 1});
+
+  std::vector<Packet> packets =
+      stream.Next(/*num_temporal_units=*/1, /*packets_per_frame=*/2);
+  SvcForwardingSelector::Decision decision =
+      selector.OnPacket(packets[0].sequence_number, packets[0].descriptor);
+  ASSERT_TRUE(decision.forward);
+  EXPECT_THAT(decision.active_decode_targets_bitmask, Optional(0b11u));
+  decision =
+      selector.OnPacket(packets[1].sequence_number, packets[1].descriptor);
+  ASSERT_TRUE(decision.forward);
+  EXPECT_EQ(decision.active_decode_targets_bitmask, absl::nullopt);
+
+  // Once sent on the chain, the bitmask is not repeated.
+  for (const Packet& packet : stream.Next(/*num_temporal_units=*/8)) {
+    decision = selector.OnPacket(packet.sequence_number, packet.descriptor);
+    EXPECT_EQ(decision.active_decode_targets_bitmask, absl::nullopt);
+  }
+}
+
+TEST(SvcForwardingSelectorTest, DropsPacketsUntilStructureIsReceived) {
+  SvcStream stream(ScalabilityMode::kL1T3);
+  std::vector<Packet> packets = stream.Next(/*num_temporal_units=*/4);
+  SvcForwardingSelector selector;
+
+  EXPECT_TRUE(
+      Forward(selector, rtc::ArrayView<const Packet>(packets).subview(1))
+          .empty());
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -18,6 +18,7 @@
 #include "common_video/include/video_frame_buffer.h"
 #include "modules/video_coding/include/video_error_codes.h"
 #include "rtc_base/logging.h"
+#include "rtc_base/memory/frame_memory_pool.h"
 #include "third_party/dav1d/libdav1d/include/dav1d/dav1d.h"
 #include "third_party/libyuv/include/libyuv/convert.h"
 #include "third_party/libyuv/include/libyuv/planar_functions.h"
@@ -74,6 +75,53 @@ constexpr char kDav1dName[] = "dav1d";
 // Calling `dav1d_data_wrap` requires a `free_callback` to be registered.
 void NullFreeCallback(const uint8_t* buffer, void* opaque) {}
 
+// Picture allocator placing decoded pictures in the process wide frame memory
+// pool. Output frames wrap the pictures, so pooling them lets a picture's
+// memory be reused by any stream or buffer of a similar size once the last
+// reference to the frame is gone. Mirrors dav1d's default allocator.
+int AllocPicture(Dav1dPicture* picture, void* /*cookie*/) {
+  const bool high_bit_depth = picture->p.bpc > 8;
+  const int aligned_width = (picture->p.w + 127) & ~127;
+  const int aligned_height = (picture->p.h + 127) & ~127;
+  const bool has_chroma = picture->p.layout != DAV1D_PIXEL_LAYOUT_I400;
+  const bool subsampled_vertically =
+      picture->p.layout == DAV1D_PIXEL_LAYOUT_I420;
+  const bool subsampled_horizontally =
+      picture->p.layout != DAV1D_PIXEL_LAYOUT_I444;
+  ptrdiff_t y_stride = aligned_width << (high_bit_depth ? 1 : 0);
+  ptrdiff_t uv_stride =
+      has_chroma ? y_stride >> (subsampled_horizontally ? 1 : 0) : 0;
+  // Strides that are multiples of 1024 make rows of a superblock compete for
+  // the same cache sets.
+  if (y_stride % 1024 == 0) {
+    y_stride += DAV1D_PICTURE_ALIGNMENT;
+  }
+  if (has_chroma && uv_stride % 1024 == 0) {
+    uv_stride += DAV1D_PICTURE_ALIGNMENT;
+  }
+  const size_t y_size = y_stride * aligned_height;
+  const size_t uv_size =
+      uv_stride * (aligned_height >> (subsampled_vertically ? 1 : 0));
+  // dav1d may read up to DAV1D_PICTURE_ALIGNMENT bytes past the end.
+  uint8_t* data = static_cast<uint8_t*>(FrameMemoryPool::Global().Allocate(
+      y_size + 2 * uv_size + DAV1D_PICTURE_ALIGNMENT,
+      DAV1D_PICTURE_ALIGNMENT));
+  if (data == nullptr) {
+    return DAV1D_ERR(ENOMEM);
+  }
+  picture->stride[0] = y_stride;
+  picture->stride[1] = uv_stride;
+  picture->data[0] = data;
+  picture->data[1] = has_chroma ? data + y_size : nullptr;
+  picture->data[2] = has_chroma ? data + y_size + uv_size : nullptr;
+  picture->allocator_data = data;
+  return 0;
+}
+
+void ReleasePicture(Dav1dPicture* picture, void* /*cookie*/) {
+  FrameMemoryPool::Free(picture->allocator_data);
+}
+
 Dav1dDecoder::Dav1dDecoder() = default;
 
 Dav1dDecoder::~Dav1dDecoder() {
@@ -81,15 +129,32 @@ Dav1dDecoder::~Dav1dDecoder() {
 }
 
 bool Dav1dDecoder::Configure(const Settings& settings) {
+  // Configure is called again when the decode threads change.
+  if (Release() != WEBRTC_VIDEO_CODEC_OK) {
+    return false;
+  }
+
   Dav1dSettings s;
   dav1d_default_settings(&s);
 
-  s.n_threads = std::max(2, settings.number_of_cores());
+  // dav1d spreads `n_threads` over tile and postfilter work. Frame threading
+  // is kept off through `max_frame_delay`, since every frame of delay adds
+  // end-to-end latency. A thread budget grant is used as is, so that the
+  // decoder stays within it.
+  s.n_threads = settings.decode_threads().value_or(
+      std::max(2, settings.number_of_cores()));
   s.max_frame_delay = 1;   // For low latency decoding.
   s.all_layers = 0;        // Don't output a frame for every spatial layer.
   // Limit max frame size to avoid OOM'ing fuzzers. crbug.com/325284120.
   s.frame_size_limit = 16384 * 16384;
   s.operating_point = 31;  // Decode all operating points.
+  if (FrameMemoryPool::Global().enabled()) {
+    // Otherwise dav1d's own picture pool is a better choice than allocating
+    // every picture from the heap.
+    s.allocator.cookie = nullptr;
+    s.allocator.alloc_picture_callback = &AllocPicture;
+    s.allocator.release_picture_callback = &ReleasePicture;
+  }
 
   return dav1d_open(&context_, &s) == 0;
 }
@@ -148,35 +213,53 @@ int32_t Dav1dDecoder::Decode(const EncodedImage& encoded_image,
     return WEBRTC_VIDEO_CODEC_ERROR;
   }
 
-  if (dav1d_picture.p.bpc != 8) {
-    // Only accept 8 bit depth.
+  if (dav1d_picture.p.bpc != 8 && dav1d_picture.p.bpc != 10) {
     RTC_LOG(LS_ERROR) << "Dav1dDecoder::Decode unhandled bit depth: "
                       << dav1d_picture.p.bpc;
     return WEBRTC_VIDEO_CODEC_ERROR;
   }
 
+  if (dav1d_picture.p.layout != DAV1D_PIXEL_LAYOUT_I420 &&
+      dav1d_picture.p.layout != DAV1D_PIXEL_LAYOUT_I444) {
+    // Only accept I420 or I444 pixel format.
+    RTC_LOG(LS_ERROR) << "Dav1dDecoder::Decode unhandled pixel layout: "
+                      << dav1d_picture.p.layout;
+    return WEBRTC_VIDEO_CODEC_ERROR;
+  }
+
+  // The decoded planes are wrapped, not copied. To keep
+  // |scoped_dav1d_picture.Picture()| alive the buffer holds a reference.
   rtc::scoped_refptr<VideoFrameBuffer> wrapped_buffer;
-  if (dav1d_picture.p.layout == DAV1D_PIXEL_LAYOUT_I420) {
+  if (dav1d_picture.p.bpc == 10) {
+    // High bit depth samples are 16 bit, strides are in samples.
+    const uint16_t* y = static_cast<const uint16_t*>(dav1d_picture.data[0]);
+    const uint16_t* u = static_cast<const uint16_t*>(dav1d_picture.data[1]);
+    const uint16_t* v = static_cast<const uint16_t*>(dav1d_picture.data[2]);
+    const int y_stride = dav1d_picture.stride[0] / 2;
+    const int uv_stride = dav1d_picture.stride[1] / 2;
+    if (dav1d_picture.p.layout == DAV1D_PIXEL_LAYOUT_I420) {
+      wrapped_buffer = WrapI010Buffer(
+          dav1d_picture.p.w, dav1d_picture.p.h, y, y_stride, u, uv_stride, v,
+          uv_stride, [scoped_dav1d_picture] {});
+    } else {
+      wrapped_buffer = WrapI410Buffer(
+          dav1d_picture.p.w, dav1d_picture.p.h, y, y_stride, u, uv_stride, v,
+          uv_stride, [scoped_dav1d_picture] {});
+    }
+  } else if (dav1d_picture.p.layout == DAV1D_PIXEL_LAYOUT_I420) {
     wrapped_buffer = WrapI420Buffer(
         dav1d_picture.p.w, dav1d_picture.p.h,
         static_cast<uint8_t*>(dav1d_picture.data[0]), dav1d_picture.stride[0],
         static_cast<uint8_t*>(dav1d_picture.data[1]), dav1d_picture.stride[1],
         static_cast<uint8_t*>(dav1d_picture.data[2]), dav1d_picture.stride[1],
-        // To keep |scoped_dav1d_picture.Picture()| alive
         [scoped_dav1d_picture] {});
-  } else if (dav1d_picture.p.layout == DAV1D_PIXEL_LAYOUT_I444) {
+  } else {
     wrapped_buffer = WrapI444Buffer(
         dav1d_picture.p.w, dav1d_picture.p.h,
         static_cast<uint8_t*>(dav1d_picture.data[0]), dav1d_picture.stride[0],
         static_cast<uint8_t*>(dav1d_picture.data[1]), dav1d_picture.stride[1],
         static_cast<uint8_t*>(dav1d_picture.data[2]), dav1d_picture.stride[1],
-        // To keep |scoped_dav1d_picture.Picture()| alive
         [scoped_dav1d_picture] {});
-  } else {
-    // Only accept I420 or I444 pixel format.
-    RTC_LOG(LS_ERROR) << "Dav1dDecoder::Decode unhandled pixel layout: "
-                      << dav1d_picture.p.layout;
-    return WEBRTC_VIDEO_CODEC_ERROR;
   }
 
   if (!wrapped_buffer.get()) {
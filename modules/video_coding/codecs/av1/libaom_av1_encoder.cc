@@ -12,6 +12,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -21,9 +22,12 @@
 #include "absl/base/nullability.h"
 #include "absl/strings/match.h"
 #include "absl/types/optional.h"
+#include "api/array_view.h"
 #include "api/environment/environment.h"
 #include "api/field_trials_view.h"
 #include "api/scoped_refptr.h"
+#include "api/units/time_delta.h"
+#include "api/units/timestamp.h"
 #include "api/video/encoded_image.h"
 #include "api/video/i420_buffer.h"
 #include "api/video/video_frame.h"
@@ -35,8 +39,11 @@
 #include "modules/video_coding/svc/create_scalability_structure.h"
 #include "modules/video_coding/svc/scalable_video_controller.h"
 #include "modules/video_coding/svc/scalable_video_controller_no_layering.h"
+#include "modules/video_coding/utility/active_map.h"
+#include "modules/video_coding/utility/roi_map.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/experiments/encoder_info_settings.h"
+#include "rtc_base/experiments/field_trial_parser.h"
 #include "rtc_base/logging.h"
 #include "third_party/libaom/source/libaom/aom/aom_codec.h"
 #include "third_party/libaom/source/libaom/aom/aom_encoder.h"
@@ -116,6 +123,16 @@ class LibaomAv1Encoder final : public VideoEncoder {
       const ScalableVideoController::LayerFrameConfig& layer_frame);
   // If pixel format doesn't match, then reallocate.
   void MaybeRewrapImgWithFormat(const aom_img_fmt_t fmt);
+  bool ScreenContentFastPathEnabled() const {
+    return screen_content_fast_path_.enabled &&
+           encoder_settings_.mode == VideoCodecMode::kScreensharing;
+  }
+  // Restricts encoding of the next frame to the blocks touched by
+  // `update_rect`, or lifts the restriction if `update_rect` is unset.
+  void SetActiveMap(absl::optional<VideoFrame::UpdateRect> update_rect);
+  // Configures the encoder to encode the next frame with the quality of
+  // `regions`. Returns whether a region of interest map is in use.
+  bool SetRoiMap(rtc::ArrayView<const VideoFrame::QualityRegion> regions);
 
   std::unique_ptr<ScalableVideoController> svc_controller_;
   absl::optional<ScalabilityMode> scalability_mode_;
@@ -134,6 +151,29 @@ class LibaomAv1Encoder final : public VideoEncoder {
   // after frame dropping is fully rolled out.
   bool disable_frame_dropping_;
   int max_consec_frame_drop_;
+
+  // For screensharing, encodes only the regions of a frame that changed
+  // according to VideoFrame::update_rect() and skips unchanged frames.
+  const struct ScreenContentFastPath {
+    bool enabled = false;
+    // Unchanged frames are still encoded at least this often, so that the
+    // receiver can recover from losses and the quality keeps converging.
+    TimeDelta refresh_interval = TimeDelta::Seconds(1);
+    // Number of unchanged frames encoded after a change before unchanged
+    // frames are skipped, to let the quality of changed regions converge.
+    int frames_before_skip = 3;
+  } screen_content_fast_path_;
+  static ScreenContentFastPath ParseScreenContentFastPath(
+      const FieldTrialsView& field_trials);
+  // Union of the update rects of the frames since the last encoded base layer
+  // frame.
+  VideoFrame::UpdateRect pending_update_rect_;
+  int unchanged_frames_encoded_ = 0;
+  absl::optional<Timestamp> last_encoded_frame_time_;
+  bool active_map_set_ = false;
+  bool roi_map_set_ = false;
+  // Cleared if libaom rejects region of interest maps.
+  bool roi_map_supported_ = true;
 };
 
 int32_t VerifyCodecSettings(const VideoCodec& codec_settings) {
@@ -172,6 +212,25 @@ int GetMaxConsecutiveFrameDrop(const FieldTrialsView& field_trials) {
   return maxdrop;
 }
 
+// static
+LibaomAv1Encoder::ScreenContentFastPath
+LibaomAv1Encoder::ParseScreenContentFastPath(
+    const FieldTrialsView& field_trials) {
+  ScreenContentFastPath config;
+  FieldTrialFlag enabled("Enabled");
+  FieldTrialParameter<TimeDelta> refresh_interval("refresh_interval",
+                                                  config.refresh_interval);
+  FieldTrialParameter<int> frames_before_skip("frames_before_skip",
+                                              config.frames_before_skip);
+  ParseFieldTrial(
+      {&enabled, &refresh_interval, &frames_before_skip},
+      field_trials.Lookup("WebRTC-LibaomAv1Encoder-ScreenContentFastPath"));
+  config.enabled = enabled.Get();
+  config.refresh_interval = refresh_interval.Get();
+  config.frames_before_skip = frames_before_skip.Get();
+  return config;
+}
+
 LibaomAv1Encoder::LibaomAv1Encoder(const Environment& env,
                                    LibaomAv1EncoderSettings settings)
     : inited_(false),
@@ -182,7 +241,9 @@ LibaomAv1Encoder::LibaomAv1Encoder(const Environment& env,
       timestamp_(0),
       disable_frame_dropping_(env.field_trials().IsEnabled(
           "WebRTC-LibaomAv1Encoder-DisableFrameDropping")),
-      max_consec_frame_drop_(GetMaxConsecutiveFrameDrop(env.field_trials())) {}
+      max_consec_frame_drop_(GetMaxConsecutiveFrameDrop(env.field_trials())),
+      screen_content_fast_path_(
+          ParseScreenContentFastPath(env.field_trials())) {}
 
 LibaomAv1Encoder::~LibaomAv1Encoder() {
   Release();
@@ -283,6 +344,11 @@ int LibaomAv1Encoder::InitEncode(const VideoCodec* codec_settings,
     return WEBRTC_VIDEO_CODEC_ERROR;
   }
   inited_ = true;
+  pending_update_rect_.MakeEmptyUpdate();
+  unchanged_frames_encoded_ = 0;
+  last_encoded_frame_time_ = absl::nullopt;
+  active_map_set_ = false;
+  roi_map_set_ = false;
 
   // Set control parameters
   SET_ENCODER_PARAM_OR_RETURN_ERROR(AOME_SET_CPUUSED,
@@ -347,7 +413,9 @@ int LibaomAv1Encoder::InitEncode(const VideoCodec* codec_settings,
   SET_ENCODER_PARAM_OR_RETURN_ERROR(AV1E_SET_ENABLE_INTERINTRA_COMP, 0);
   SET_ENCODER_PARAM_OR_RETURN_ERROR(AV1E_SET_ENABLE_INTERINTRA_WEDGE, 0);
   SET_ENCODER_PARAM_OR_RETURN_ERROR(AV1E_SET_ENABLE_INTRA_EDGE_FILTER, 0);
-  SET_ENCODER_PARAM_OR_RETURN_ERROR(AV1E_SET_ENABLE_INTRABC, 0);
+  // Intra block copy pays off for text and other repeated screen content.
+  SET_ENCODER_PARAM_OR_RETURN_ERROR(AV1E_SET_ENABLE_INTRABC,
+                                    ScreenContentFastPathEnabled() ? 1 : 0);
   SET_ENCODER_PARAM_OR_RETURN_ERROR(AV1E_SET_ENABLE_MASKED_COMP, 0);
   SET_ENCODER_PARAM_OR_RETURN_ERROR(AV1E_SET_ENABLE_PAETH_INTRA, 0);
   SET_ENCODER_PARAM_OR_RETURN_ERROR(AV1E_SET_ENABLE_QM, 0);
@@ -579,6 +647,22 @@ int32_t LibaomAv1Encoder::Encode(
       frame_types != nullptr &&
       absl::c_linear_search(*frame_types, VideoFrameType::kVideoFrameKey);
 
+  const Timestamp now = Timestamp::Micros(frame.timestamp_us());
+  if (ScreenContentFastPathEnabled()) {
+    pending_update_rect_.Union(frame.update_rect());
+    if (!pending_update_rect_.IsEmpty() || keyframe_required) {
+      unchanged_frames_encoded_ = 0;
+    } else if (unchanged_frames_encoded_ >=
+                   screen_content_fast_path_.frames_before_skip &&
+               last_encoded_frame_time_.has_value() &&
+               now - *last_encoded_frame_time_ <
+                   screen_content_fast_path_.refresh_interval) {
+      return WEBRTC_VIDEO_CODEC_OK;
+    } else {
+      ++unchanged_frames_encoded_;
+    }
+  }
+
   std::vector<ScalableVideoController::LayerFrameConfig> layer_frames =
       svc_controller_->NextFrameConfig(keyframe_required);
 
@@ -659,6 +743,21 @@ int32_t LibaomAv1Encoder::Encode(
       return WEBRTC_VIDEO_CODEC_ENCODER_FAILURE;
   }
 
+  const bool use_roi_map = SetRoiMap(frame.quality_regions());
+  if (ScreenContentFastPathEnabled()) {
+    // Active maps are given in blocks of the full resolution frame, so they
+    // are only used without spatial layers. Both maps rely on segmentation,
+    // so a region of interest map takes precedence.
+    const bool use_active_map =
+        !use_roi_map && !layer_frames.front().IsKeyframe() &&
+        !pending_update_rect_.IsEmpty() &&
+        (!svc_params_ || svc_params_->number_spatial_layers == 1) &&
+        frame.width() == static_cast<int>(cfg_.g_w) &&
+        frame.height() == static_cast<int>(cfg_.g_h);
+    SetActiveMap(use_active_map ? absl::make_optional(pending_update_rect_)
+                                : absl::nullopt);
+  }
+
   const uint32_t duration =
       kRtpTicksPerSecond / static_cast<float>(encoder_settings_.maxFramerate);
   timestamp_ += duration;
@@ -786,12 +885,88 @@ int32_t LibaomAv1Encoder::Encode(
       }
       encoded_image_callback_->OnEncodedImage(encoded_image,
                                               &codec_specific_info);
+      // Regions changed in frames the rate controller dropped still need to be
+      // encoded, so the update rect is only reset once a frame is sent. Frames
+      // reference at most back to the last base layer frame, so with temporal
+      // layers it covers everything changed since then.
+      if (layer_frame->TemporalId() == 0) {
+        pending_update_rect_.MakeEmptyUpdate();
+      }
+      last_encoded_frame_time_ = now;
     }
   }
 
   return WEBRTC_VIDEO_CODEC_OK;
 }
 
+void LibaomAv1Encoder::SetActiveMap(
+    absl::optional<VideoFrame::UpdateRect> update_rect) {
+  ActiveMap active_map = ActiveMap::FromUpdateRect(
+      cfg_.g_w, cfg_.g_h,
+      update_rect.value_or(VideoFrame::UpdateRect{
+          .width = static_cast<int>(cfg_.g_w),
+          .height = static_cast<int>(cfg_.g_h)}));
+  const bool restrict_blocks = !active_map.AllActive();
+  if (!restrict_blocks && !active_map_set_) {
+    return;
+  }
+  // Without a map libaom encodes all blocks again.
+  aom_active_map_t aom_active_map;
+  aom_active_map.active_map =
+      restrict_blocks ? active_map.map.data() : nullptr;
+  aom_active_map.rows = active_map.rows;
+  aom_active_map.cols = active_map.cols;
+  active_map_set_ =
+      SetEncoderControlParameters(AOME_SET_ACTIVEMAP, &aom_active_map) &&
+      restrict_blocks;
+}
+
+bool LibaomAv1Encoder::SetRoiMap(
+    rtc::ArrayView<const VideoFrame::QualityRegion> regions) {
+  // AV1 segments 4x4 blocks into at most eight segments. The quantizer deltas
+  // are on the same 0-63 scale as the QP, libaom maps them to its internal
+  // quantizer index.
+  constexpr int kBlockSize = 4;
+  constexpr int kMaxSegments = 8;
+  constexpr int kMaxDeltaQ = 63;
+  // Region of interest maps are given in blocks of the full resolution frame,
+  // so they are only used without spatial layers.
+  absl::optional<RoiMap> roi_map;
+  if (roi_map_supported_ &&
+      (!svc_params_ || svc_params_->number_spatial_layers == 1)) {
+    roi_map =
+        RoiMap::Create(cfg_.g_w, cfg_.g_h, kBlockSize, kMaxSegments, regions);
+  }
+  if (!roi_map && !roi_map_set_) {
+    return false;
+  }
+  aom_roi_map_t aom_roi_map = {};
+  aom_roi_map.rows = (cfg_.g_h + kBlockSize - 1) / kBlockSize;
+  aom_roi_map.cols = (cfg_.g_w + kBlockSize - 1) / kBlockSize;
+  for (int& ref_frame : aom_roi_map.ref_frame) {
+    ref_frame = -1;
+  }
+  if (roi_map) {
+    aom_roi_map.enabled = 1;
+    aom_roi_map.roi_map = roi_map->segment_map.data();
+    for (size_t i = 0; i < roi_map->segments.size(); ++i) {
+      aom_roi_map.delta_q[i] =
+          std::clamp(roi_map->segments[i].qp_delta, -kMaxDeltaQ, kMaxDeltaQ);
+      aom_roi_map.skip[i] = roi_map->segments[i].skip ? 1 : 0;
+    }
+  }
+  if (aom_codec_control(&ctx_, AOME_SET_ROI_MAP, &aom_roi_map) !=
+      AOM_CODEC_OK) {
+    RTC_LOG(LS_WARNING) << "libaom rejected a region of interest map, "
+                           "ignoring regions from now on.";
+    roi_map_supported_ = false;
+    roi_map_set_ = false;
+    return false;
+  }
+  roi_map_set_ = roi_map.has_value();
+  return roi_map_set_;
+}
+
 void LibaomAv1Encoder::SetRates(const RateControlParameters& parameters) {
   if (!inited_) {
     RTC_LOG(LS_WARNING) << "SetRates() while encoder is not initialized";
@@ -443,6 +443,134 @@ TEST(LibaomAv1EncoderTest, AdheresToTargetBitrateDespiteUnevenFrameTiming) {
       kTargetBitrateBps, kTargetBitrateBps / 10);
 }
 
+TEST(LibaomAv1EncoderTest, SkipsUnchangedScreenContentUntilRefresh) {
+  auto field_trials = std::make_unique<ScopedKeyValueConfig>(
+      "WebRTC-LibaomAv1Encoder-ScreenContentFastPath/"
+      "Enabled,refresh_interval:1s,frames_before_skip:2/");
+  std::unique_ptr<VideoEncoder> encoder =
+      CreateLibaomAv1Encoder(CreateEnvironment(std::move(field_trials)));
+  VideoCodec codec_settings = DefaultCodecSettings();
+  codec_settings.mode = VideoCodecMode::kScreensharing;
+  codec_settings.SetScalabilityMode(ScalabilityMode::kL1T1);
+  ASSERT_EQ(encoder->InitEncode(&codec_settings, DefaultEncoderSettings()),
+            WEBRTC_VIDEO_CODEC_OK);
+
+  const int kFps = 10;
+  VideoEncoder::RateControlParameters rate_parameters;
+  rate_parameters.framerate_fps = kFps;
+  rate_parameters.bitrate.SetBitrate(/*spatial_index=*/0, 0, 300'000);
+  encoder->SetRates(rate_parameters);
+
+  class EncoderCallback : public EncodedImageCallback {
+   public:
+    std::vector<uint32_t> rtp_timestamps;
+
+   private:
+    Result OnEncodedImage(
+        const EncodedImage& encoded_image,
+        const CodecSpecificInfo* codec_specific_info) override {
+      rtp_timestamps.push_back(encoded_image.RtpTimestamp());
+      return Result(Result::Error::OK);
+    }
+  } callback;
+  encoder->RegisterEncodeCompleteCallback(&callback);
+
+  std::unique_ptr<test::FrameGeneratorInterface> frame_buffer_generator =
+      test::CreateSquareFrameGenerator(
+          codec_settings.width, codec_settings.height,
+          test::FrameGeneratorInterface::OutputType::kI420, absl::nullopt);
+  rtc::scoped_refptr<VideoFrameBuffer> buffer =
+      frame_buffer_generator->NextFrame().buffer;
+  std::vector<VideoFrameType> frame_types = {VideoFrameType::kVideoFrameKey};
+  // The first frame changes everything, then the content stays the same for
+  // 1.5 seconds.
+  for (int i = 0; i < kFps * 3 / 2; ++i) {
+    VideoFrame frame =
+        VideoFrame::Builder()
+            .set_video_frame_buffer(buffer)
+            .set_rtp_timestamp(i * 90000 / kFps)
+            .set_timestamp_us(i * 1'000'000 / kFps)
+            .set_update_rect(i == 0 ? VideoFrame::UpdateRect{0, 0,
+                                                             buffer->width(),
+                                                             buffer->height()}
+                                    : VideoFrame::UpdateRect{})
+            .build();
+    ASSERT_EQ(encoder->Encode(frame, &frame_types), WEBRTC_VIDEO_CODEC_OK);
+    frame_types[0] = VideoFrameType::kVideoFrameDelta;
+  }
+
+  // The changed frame, two unchanged frames to let the quality converge and
+  // one refresh a second after the last encoded frame.
+  EXPECT_THAT(callback.rtp_timestamps,
+              ElementsAre(0u, 9000u, 18000u, 18000u + 90000u));
+}
+
+TEST(LibaomAv1EncoderTest, KeepsChangesOfUpperTemporalLayersForBaseLayer) {
+  auto field_trials = std::make_unique<ScopedKeyValueConfig>(
+      "WebRTC-LibaomAv1Encoder-ScreenContentFastPath/"
+      "Enabled,refresh_interval:10s,frames_before_skip:0/");
+  std::unique_ptr<VideoEncoder> encoder =
+      CreateLibaomAv1Encoder(CreateEnvironment(std::move(field_trials)));
+  VideoCodec codec_settings = DefaultCodecSettings();
+  codec_settings.mode = VideoCodecMode::kScreensharing;
+  codec_settings.SetScalabilityMode(ScalabilityMode::kL1T2);
+  ASSERT_EQ(encoder->InitEncode(&codec_settings, DefaultEncoderSettings()),
+            WEBRTC_VIDEO_CODEC_OK);
+
+  const int kFps = 10;
+  VideoEncoder::RateControlParameters rate_parameters;
+  rate_parameters.framerate_fps = kFps;
+  rate_parameters.bitrate.SetBitrate(/*spatial_index=*/0, 0, 200'000);
+  rate_parameters.bitrate.SetBitrate(/*spatial_index=*/0, 1, 100'000);
+  encoder->SetRates(rate_parameters);
+
+  class EncoderCallback : public EncodedImageCallback {
+   public:
+    std::vector<std::pair<uint32_t, int>> frames;
+
+   private:
+    Result OnEncodedImage(
+        const EncodedImage& encoded_image,
+        const CodecSpecificInfo* codec_specific_info) override {
+      frames.emplace_back(encoded_image.RtpTimestamp(),
+                          encoded_image.TemporalIndex().value_or(0));
+      return Result(Result::Error::OK);
+    }
+  } callback;
+  encoder->RegisterEncodeCompleteCallback(&callback);
+
+  std::unique_ptr<test::FrameGeneratorInterface> frame_buffer_generator =
+      test::CreateSquareFrameGenerator(
+          codec_settings.width, codec_settings.height,
+          test::FrameGeneratorInterface::OutputType::kI420, absl::nullopt);
+  rtc::scoped_refptr<VideoFrameBuffer> buffer =
+      frame_buffer_generator->NextFrame().buffer;
+  std::vector<VideoFrameType> frame_types = {VideoFrameType::kVideoFrameKey};
+  // The key frame and the following upper layer frame change the content,
+  // then it stays the same.
+  for (int i = 0; i < 6; ++i) {
+    VideoFrame frame =
+        VideoFrame::Builder()
+            .set_video_frame_buffer(buffer)
+            .set_rtp_timestamp(i * 90000 / kFps)
+            .set_timestamp_us(i * 1'000'000 / kFps)
+            .set_update_rect(i < 2 ? VideoFrame::UpdateRect{0, 0,
+                                                            buffer->width(),
+                                                            buffer->height()}
+                                   : VideoFrame::UpdateRect{})
+            .build();
+    ASSERT_EQ(encoder->Encode(frame, &frame_types), WEBRTC_VIDEO_CODEC_OK);
+    frame_types[0] = VideoFrameType::kVideoFrameDelta;
+  }
+
+  // A receiver of only the base layer misses the change in the upper layer
+  // frame, so the next base layer frame is still encoded before unchanged
+  // frames are skipped.
+  EXPECT_THAT(callback.frames,
+              ElementsAre(std::make_pair(0u, 0), std::make_pair(9000u, 1),
+                          std::make_pair(18000u, 0)));
+}
+
 TEST(LibaomAv1EncoderTest, DisableAutomaticResize) {
   std::unique_ptr<VideoEncoder> encoder =
       CreateLibaomAv1Encoder(CreateEnvironment());
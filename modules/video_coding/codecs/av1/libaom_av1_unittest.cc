@@ -11,6 +11,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <ostream>
@@ -22,6 +23,8 @@
 #include "api/environment/environment_factory.h"
 #include "api/units/data_size.h"
 #include "api/units/time_delta.h"
+#include "api/video/encoded_image.h"
+#include "api/video/video_frame_buffer.h"
 #include "api/video_codecs/video_codec.h"
 #include "api/video_codecs/video_encoder.h"
 #include "modules/video_coding/codecs/av1/dav1d_decoder.h"
@@ -33,8 +36,13 @@
 #include "modules/video_coding/svc/scalability_mode_util.h"
 #include "modules/video_coding/svc/scalable_video_controller.h"
 #include "modules/video_coding/svc/scalable_video_controller_no_layering.h"
+#include "rtc_base/memory/frame_memory_pool.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
+#include "third_party/libaom/source/libaom/aom/aom_codec.h"
+#include "third_party/libaom/source/libaom/aom/aom_encoder.h"
+#include "third_party/libaom/source/libaom/aom/aom_image.h"
+#include "third_party/libaom/source/libaom/aom/aomcx.h"
 
 namespace webrtc {
 namespace {
@@ -105,28 +113,38 @@ class TestAv1Decoder {
 
   const std::vector<int64_t>& decoded_frame_ids() const { return decoded_ids_; }
   size_t num_output_frames() const { return callback_.num_called(); }
+  const rtc::scoped_refptr<VideoFrameBuffer>& last_output_buffer() const {
+    return callback_.last_buffer();
+  }
 
  private:
-  // Decoder callback that only counts how many times it was called.
+  // Decoder callback that counts how many times it was called and keeps the
+  // buffer of the last frame.
   // While it is tempting to replace it with a simple mock, that one requires
   // to set expectation on number of calls in advance. Tests below unsure about
   // expected number of calls until after calls are done.
   class DecoderCallback : public DecodedImageCallback {
    public:
     size_t num_called() const { return num_called_; }
+    const rtc::scoped_refptr<VideoFrameBuffer>& last_buffer() const {
+      return last_buffer_;
+    }
 
    private:
-    int32_t Decoded(VideoFrame& /*decoded_image*/) override {
+    int32_t Decoded(VideoFrame& decoded_image) override {
       ++num_called_;
+      last_buffer_ = decoded_image.video_frame_buffer();
       return 0;
     }
-    void Decoded(VideoFrame& /*decoded_image*/,
+    void Decoded(VideoFrame& decoded_image,
                  absl::optional<int32_t> /*decode_time_ms*/,
                  absl::optional<uint8_t> /*qp*/) override {
       ++num_called_;
+      last_buffer_ = decoded_image.video_frame_buffer();
     }
 
     int num_called_ = 0;
+    rtc::scoped_refptr<VideoFrameBuffer> last_buffer_;
   };
 
   const int decoder_id_;
@@ -163,6 +181,158 @@ TEST(LibaomAv1Test, EncodeDecode) {
   EXPECT_EQ(decoder.num_output_frames(), decoder.decoded_frame_ids().size());
 }
 
+TEST(LibaomAv1Test, DecodesIntoFrameMemoryPoolWhenEnabled) {
+  FrameMemoryPool& pool = FrameMemoryPool::Global();
+  pool.SetMaxCachedBytes(64 << 20);
+  pool.Trim();
+  const size_t cached_bytes_before = pool.cached_bytes();
+  {
+    const Environment env = CreateEnvironment();
+    // The decoder picks its picture allocator when configured.
+    TestAv1Decoder decoder(0);
+    std::unique_ptr<VideoEncoder> encoder = CreateLibaomAv1Encoder(env);
+    VideoCodec codec_settings = DefaultCodecSettings();
+    ASSERT_EQ(encoder->InitEncode(&codec_settings, DefaultEncoderSettings()),
+              WEBRTC_VIDEO_CODEC_OK);
+
+    std::vector<EncodedVideoFrameProducer::EncodedFrame> encoded_frames =
+        EncodedVideoFrameProducer(*encoder).SetNumInputFrames(4).Encode();
+    ASSERT_THAT(encoded_frames, Not(IsEmpty()));
+    for (size_t frame_id = 0; frame_id < encoded_frames.size(); ++frame_id) {
+      decoder.Decode(static_cast<int64_t>(frame_id),
+                     encoded_frames[frame_id].encoded_image);
+    }
+    EXPECT_EQ(decoder.num_output_frames(), encoded_frames.size());
+    ASSERT_THAT(decoder.last_output_buffer(), NotNull());
+    EXPECT_EQ(decoder.last_output_buffer()->type(),
+              VideoFrameBuffer::Type::kI420);
+  }
+  // Pictures released by the decoder and by the output frames are kept in the
+  // pool for reuse.
+  EXPECT_GT(pool.cached_bytes(), cached_bytes_before);
+
+  pool.SetMaxCachedBytes(0);
+  pool.Trim();
+}
+
+// Encodes a key frame of uniform 10 bit samples `value` in `format`, which is
+// AOM_IMG_FMT_I42016 or AOM_IMG_FMT_I44416, with libaom directly since the
+// WebRTC encoder only takes 8 bit input. Returns an empty image if this libaom
+// build can not encode high bit depth.
+EncodedImage EncodeHighBitDepthKeyFrame(aom_img_fmt_t format, uint16_t value) {
+  aom_codec_iface_t* const iface = aom_codec_av1_cx();
+  EncodedImage encoded_image;
+  if (!(aom_codec_get_caps(iface) & AOM_CODEC_CAP_HIGHBITDEPTH)) {
+    return encoded_image;
+  }
+  aom_codec_enc_cfg_t cfg;
+  if (aom_codec_enc_config_default(iface, &cfg, AOM_USAGE_REALTIME) !=
+      AOM_CODEC_OK) {
+    return encoded_image;
+  }
+  cfg.g_w = kWidth;
+  cfg.g_h = kHeight;
+  cfg.g_threads = 1;
+  cfg.g_lag_in_frames = 0;
+  cfg.g_bit_depth = AOM_BITS_10;
+  cfg.g_input_bit_depth = 10;
+  // 4:4:4 needs the high profile.
+  cfg.g_profile = format == AOM_IMG_FMT_I44416 ? 1 : 0;
+  aom_codec_ctx_t ctx;
+  if (aom_codec_enc_init(&ctx, iface, &cfg, AOM_CODEC_USE_HIGHBITDEPTH) !=
+      AOM_CODEC_OK) {
+    return encoded_image;
+  }
+
+  aom_image_t* const image =
+      aom_img_alloc(nullptr, format, kWidth, kHeight, /*align=*/1);
+  for (int plane = 0; plane < 3; ++plane) {
+    const int shift_x = plane == 0 ? 0 : image->x_chroma_shift;
+    const int shift_y = plane == 0 ? 0 : image->y_chroma_shift;
+    const int width = (kWidth + shift_x) >> shift_x;
+    const int height = (kHeight + shift_y) >> shift_y;
+    for (int y = 0; y < height; ++y) {
+      uint16_t* row = reinterpret_cast<uint16_t*>(image->planes[plane] +
+                                                  y * image->stride[plane]);
+      std::fill(row, row + width, value);
+    }
+  }
+
+  std::vector<uint8_t> bitstream;
+  if (aom_codec_encode(&ctx, image, /*pts=*/0, /*duration=*/1,
+                       AOM_EFLAG_FORCE_KF) == AOM_CODEC_OK) {
+    aom_codec_iter_t iter = nullptr;
+    while (const aom_codec_cx_pkt_t* pkt = aom_codec_get_cx_data(&ctx, &iter)) {
+      if (pkt->kind == AOM_CODEC_CX_FRAME_PKT) {
+        const uint8_t* data = static_cast<const uint8_t*>(pkt->data.frame.buf);
+        bitstream.insert(bitstream.end(), data, data + pkt->data.frame.sz);
+      }
+    }
+  }
+  aom_img_free(image);
+  aom_codec_destroy(&ctx);
+
+  encoded_image.SetEncodedData(
+      EncodedImageBuffer::Create(bitstream.data(), bitstream.size()));
+  encoded_image.SetFrameType(VideoFrameType::kVideoFrameKey);
+  return encoded_image;
+}
+
+TEST(LibaomAv1Test, WrapsDecoded10BitI420PictureAsI010) {
+  constexpr uint16_t kValue = 512;
+  const EncodedImage encoded_image =
+      EncodeHighBitDepthKeyFrame(AOM_IMG_FMT_I42016, kValue);
+  if (encoded_image.size() == 0) {
+    GTEST_SKIP() << "libaom is built without high bit depth support.";
+  }
+
+  TestAv1Decoder decoder(0);
+  decoder.Decode(/*frame_id=*/0, encoded_image);
+  ASSERT_EQ(decoder.num_output_frames(), 1u);
+  const rtc::scoped_refptr<VideoFrameBuffer>& buffer =
+      decoder.last_output_buffer();
+  ASSERT_EQ(buffer->type(), VideoFrameBuffer::Type::kI010);
+  const I010BufferInterface* i010 = buffer->GetI010();
+  EXPECT_EQ(i010->width(), kWidth);
+  EXPECT_EQ(i010->height(), kHeight);
+  // Samples are read from 16 bit words with the stride in samples, so a flat
+  // picture decodes to about the same value everywhere.
+  for (int y : {0, kHeight / 2, kHeight - 1}) {
+    EXPECT_NEAR(i010->DataY()[y * i010->StrideY() + kWidth - 1], kValue, 4);
+  }
+  EXPECT_NEAR(i010->DataU()[(i010->ChromaHeight() - 1) * i010->StrideU()],
+              kValue, 4);
+  EXPECT_NEAR(i010->DataV()[(i010->ChromaHeight() - 1) * i010->StrideV()],
+              kValue, 4);
+}
+
+TEST(LibaomAv1Test, WrapsDecoded10BitI444PictureAsI410) {
+  constexpr uint16_t kValue = 300;
+  const EncodedImage encoded_image =
+      EncodeHighBitDepthKeyFrame(AOM_IMG_FMT_I44416, kValue);
+  if (encoded_image.size() == 0) {
+    GTEST_SKIP() << "libaom is built without high bit depth support.";
+  }
+
+  TestAv1Decoder decoder(0);
+  decoder.Decode(/*frame_id=*/0, encoded_image);
+  ASSERT_EQ(decoder.num_output_frames(), 1u);
+  const rtc::scoped_refptr<VideoFrameBuffer>& buffer =
+      decoder.last_output_buffer();
+  ASSERT_EQ(buffer->type(), VideoFrameBuffer::Type::kI410);
+  const I410BufferInterface* i410 = buffer->GetI410();
+  EXPECT_EQ(i410->width(), kWidth);
+  EXPECT_EQ(i410->height(), kHeight);
+  EXPECT_EQ(i410->ChromaWidth(), kWidth);
+  EXPECT_EQ(i410->ChromaHeight(), kHeight);
+  const int last = (kHeight - 1) * i410->StrideY() + kWidth - 1;
+  EXPECT_NEAR(i410->DataY()[last], kValue, 4);
+  EXPECT_NEAR(i410->DataU()[(kHeight - 1) * i410->StrideU() + kWidth - 1],
+              kValue, 4);
+  EXPECT_NEAR(i410->DataV()[(kHeight - 1) * i410->StrideV() + kWidth - 1],
+              kValue, 4);
+}
+
 struct LayerId {
   friend bool operator==(const LayerId& lhs, const LayerId& rhs) {
     return std::tie(lhs.spatial_id, lhs.temporal_id) ==
@@ -0,0 +1,326 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Measures how many frames per second a machine decodes when several decoders
+// share it. Every decoder runs the `VideoCodecTester` decode pipeline without
+// pacing on its own thread, so the metrics reflect throughput rather than
+// real-time behaviour.
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "api/environment/environment.h"
+#include "api/environment/environment_factory.h"
+#include "api/numerics/samples_stats_counter.h"
+#include "api/test/metrics/global_metrics_logger_and_exporter.h"
+#include "api/units/frequency.h"
+#include "api/units/time_delta.h"
+#include "api/video_codecs/builtin_video_decoder_factory.h"
+#include "api/video_codecs/builtin_video_encoder_factory.h"
+#include "api/video_codecs/video_codec.h"
+#include "modules/video_coding/utility/ivf_file_reader.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/cpu_time.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/memory_usage.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/strings/string_builder.h"
+#include "rtc_base/system/file_wrapper.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/sleep.h"
+#include "test/explicit_key_value_config.h"
+#include "test/gtest.h"
+#include "test/testsupport/file_utils.h"
+#include "test/video_codec_tester.h"
+
+ABSL_FLAG(std::vector<std::string>,
+          input_ivf,
+          {},
+          "IVF files to decode in DISABLED_DecodeInputFiles.");
+ABSL_FLAG(std::vector<std::string>,
+          num_decoders,
+          {"1", "4"},
+          "Numbers of concurrently running decoders to measure.");
+ABSL_FLAG(std::vector<std::string>,
+          decode_threads,
+          {"1"},
+          "Numbers of threads per decoder to measure.");
+ABSL_FLAG(int, width, 1280, "Width of the generated input.");
+ABSL_FLAG(int, height, 720, "Height of the generated input.");
+ABSL_FLAG(int, bitrate_kbps, 2048, "Bitrate of the generated input in kbps.");
+ABSL_FLAG(int, num_frames, 300, "Number of frames of the generated input.");
+ABSL_FLAG(std::string, field_trials, "", "Field trials to apply.");
+
+namespace webrtc {
+namespace test {
+
+namespace {
+using ::testing::Values;
+using VideoCodecStats = VideoCodecTester::VideoCodecStats;
+using Filter = VideoCodecStats::Filter;
+using PacingMode = VideoCodecTester::PacingSettings::PacingMode;
+
+constexpr char kSourceVideoName[] = "FourPeople_1280x720_30";
+constexpr TimeDelta kMemorySamplingInterval = TimeDelta::Millis(50);
+
+class IvfVideoSource : public VideoCodecTester::CodedVideoSource {
+ public:
+  explicit IvfVideoSource(std::unique_ptr<IvfFileReader> reader)
+      : reader_(std::move(reader)) {}
+
+  absl::optional<EncodedImage> PullFrame() override {
+    if (!reader_->HasMoreFrames()) {
+      return absl::nullopt;
+    }
+    return reader_->NextFrame();
+  }
+
+ private:
+  const std::unique_ptr<IvfFileReader> reader_;
+};
+
+std::unique_ptr<IvfFileReader> OpenIvfFile(const std::string& path) {
+  FileWrapper file = FileWrapper::OpenReadOnly(path);
+  RTC_CHECK(file.is_open()) << "Cannot open " << path;
+  std::unique_ptr<IvfFileReader> reader =
+      IvfFileReader::Create(std::move(file));
+  RTC_CHECK(reader) << "Cannot parse " << path;
+  return reader;
+}
+
+std::vector<int> GetIntListFlag(const std::vector<std::string>& values) {
+  std::vector<int> result;
+  std::transform(values.begin(), values.end(), std::back_inserter(result),
+                 [](const std::string& str) { return std::stoi(str); });
+  return result;
+}
+
+std::string TestName() {
+  return ::testing::UnitTest::GetInstance()->current_test_info()->name();
+}
+
+// Encodes the source video with the builtin encoder of `codec_type` and
+// returns the path of the resulting IVF file, or an empty string if there is
+// no such encoder in this build.
+std::string CreateInput(const Environment& env, std::string codec_type) {
+  std::map<uint32_t, VideoCodecTester::EncodingSettings> encoding_settings =
+      VideoCodecTester::CreateEncodingSettings(
+          codec_type, /*scalability_name=*/"L1T1", absl::GetFlag(FLAGS_width),
+          absl::GetFlag(FLAGS_height), {absl::GetFlag(FLAGS_bitrate_kbps)},
+          /*framerate_fps=*/30, absl::GetFlag(FLAGS_num_frames));
+
+  std::unique_ptr<VideoEncoderFactory> encoder_factory =
+      CreateBuiltinVideoEncoderFactory();
+  if (!encoder_factory
+           ->QueryCodecSupport(
+               encoding_settings.begin()->second.sdp_video_format,
+               /*scalability_mode=*/absl::nullopt)
+           .is_supported) {
+    RTC_LOG(LS_WARNING) << "No builtin " << codec_type << " encoder.";
+    return "";
+  }
+
+  std::string base_path =
+      (rtc::StringBuilder() << OutputPath() << "decode_throughput_"
+                            << codec_type)
+          .str();
+  VideoCodecTester::EncoderSettings encoder_settings;
+  encoder_settings.pacing_settings.mode = PacingMode::kNoPacing;
+  encoder_settings.encoder_output_base_path = base_path;
+
+  VideoCodecTester::VideoSourceSettings source_settings{
+      .file_path = ResourcePath(kSourceVideoName, "yuv"),
+      .resolution = {.width = 1280, .height = 720},
+      .framerate = Frequency::Hertz(30)};
+  VideoCodecTester::RunEncodeTest(env, source_settings, encoder_factory.get(),
+                                  encoder_settings, encoding_settings);
+  return base_path + "-s0.ivf";
+}
+
+struct ThroughputResult {
+  int decoded_frames = 0;
+  TimeDelta wall_time = TimeDelta::Zero();
+  TimeDelta cpu_time = TimeDelta::Zero();
+  SamplesStatsCounter decode_time_ms;
+  int64_t peak_resident_bytes = 0;
+};
+
+// Decodes `ivf_path` with `num_decoders` decoders at once, each on its own
+// thread and each configured to use `decode_threads` threads.
+ThroughputResult MeasureThroughput(const Environment& env,
+                                   const std::string& ivf_path,
+                                   int num_decoders,
+                                   int decode_threads) {
+  const SdpVideoFormat sdp_video_format(
+      CodecTypeToPayloadString(OpenIvfFile(ivf_path)->GetVideoCodecType()));
+  VideoCodecTester::DecoderSettings decoder_settings;
+  decoder_settings.pacing_settings.mode = PacingMode::kNoPacing;
+  decoder_settings.decode_threads = decode_threads;
+
+  std::vector<std::unique_ptr<VideoCodecStats>> stats(num_decoders);
+  std::vector<int64_t> end_us(num_decoders);
+  std::atomic<int> num_finished(0);
+  std::vector<rtc::PlatformThread> threads;
+
+  const int64_t start_cpu_ns = rtc::GetProcessCpuTimeNanos();
+  const int64_t start_us = rtc::TimeMicros();
+  for (int i = 0; i < num_decoders; ++i) {
+    threads.push_back(rtc::PlatformThread::SpawnJoinable(
+        [&, i] {
+          std::unique_ptr<VideoDecoderFactory> decoder_factory =
+              CreateBuiltinVideoDecoderFactory();
+          IvfVideoSource video_source(OpenIvfFile(ivf_path));
+          stats[i] = VideoCodecTester::RunDecodeTest(
+              env, &video_source, decoder_factory.get(), decoder_settings,
+              sdp_video_format);
+          end_us[i] = rtc::TimeMicros();
+          ++num_finished;
+        },
+        "Decoder" + std::to_string(i)));
+  }
+
+  ThroughputResult result;
+  while (num_finished < num_decoders) {
+    result.peak_resident_bytes = std::max(result.peak_resident_bytes,
+                                          rtc::GetProcessResidentSizeBytes());
+    SleepMs(kMemorySamplingInterval.ms());
+  }
+  for (rtc::PlatformThread& thread : threads) {
+    thread.Finalize();
+  }
+  // The sampling loop above may overshoot, so stop the clock when the last
+  // decoder finished rather than here.
+  result.wall_time = TimeDelta::Micros(
+      *std::max_element(end_us.begin(), end_us.end()) - start_us);
+  result.cpu_time =
+      TimeDelta::Micros((rtc::GetProcessCpuTimeNanos() - start_cpu_ns) / 1000);
+
+  for (const std::unique_ptr<VideoCodecStats>& decoder_stats : stats) {
+    VideoCodecStats::Stream stream = decoder_stats->Aggregate(Filter{});
+    result.decoded_frames += stream.decode_time_ms.NumSamples();
+    result.decode_time_ms.AddSamples(stream.decode_time_ms);
+  }
+  return result;
+}
+
+void LogThroughputMetrics(const ThroughputResult& result,
+                          std::map<std::string, std::string> metadata) {
+  MetricsLogger* logger = GetGlobalMetricsLogger();
+  const std::string test_name = TestName();
+  const int num_decoders = std::stoi(metadata.at("num_decoders"));
+
+  const double fps = result.decoded_frames / result.wall_time.seconds<double>();
+  logger->LogSingleValueMetric("decode_throughput_fps", test_name, fps,
+                               Unit::kHertz,
+                               ImprovementDirection::kBiggerIsBetter, metadata);
+  logger->LogSingleValueMetric("decode_throughput_per_decoder_fps", test_name,
+                               fps / num_decoders, Unit::kHertz,
+                               ImprovementDirection::kBiggerIsBetter, metadata);
+  if (result.decoded_frames > 0) {
+    logger->LogSingleValueMetric(
+        "cpu_time_per_frame_ms", test_name,
+        result.cpu_time.ms<double>() / result.decoded_frames,
+        Unit::kMilliseconds, ImprovementDirection::kSmallerIsBetter, metadata);
+  }
+  logger->LogMetric("decode_time_ms", test_name, result.decode_time_ms,
+                    Unit::kMilliseconds, ImprovementDirection::kSmallerIsBetter,
+                    metadata);
+  if (!result.decode_time_ms.IsEmpty()) {
+    SamplesStatsCounter decode_time_ms = result.decode_time_ms;
+    for (double percentile : {0.5, 0.95, 0.99}) {
+      logger->LogSingleValueMetric(
+          "decode_time_p" + std::to_string(static_cast<int>(percentile * 100)) +
+              "_ms",
+          test_name, decode_time_ms.GetPercentile(percentile),
+          Unit::kMilliseconds, ImprovementDirection::kSmallerIsBetter,
+          metadata);
+    }
+  }
+  logger->LogSingleValueMetric(
+      "peak_resident_size_bytes", test_name, result.peak_resident_bytes,
+      Unit::kBytes, ImprovementDirection::kSmallerIsBetter, metadata);
+}
+
+void MeasureAndLog(const Environment& env,
+                   const std::string& ivf_path,
+                   std::map<std::string, std::string> metadata) {
+  for (int num_decoders : GetIntListFlag(absl::GetFlag(FLAGS_num_decoders))) {
+    for (int decode_threads :
+         GetIntListFlag(absl::GetFlag(FLAGS_decode_threads))) {
+      RTC_CHECK_GT(num_decoders, 0);
+      RTC_CHECK_GT(decode_threads, 0);
+      ThroughputResult result =
+          MeasureThroughput(env, ivf_path, num_decoders, decode_threads);
+      EXPECT_GT(result.decoded_frames, 0);
+      metadata["num_decoders"] = std::to_string(num_decoders);
+      metadata["decode_threads"] = std::to_string(decode_threads);
+      LogThroughputMetrics(result, metadata);
+    }
+  }
+}
+}  // namespace
+
+class DecodeThroughputTest
+    : public ::testing::TestWithParam</*codec_type=*/std::string> {};
+
+TEST_P(DecodeThroughputTest, ParallelDecode) {
+  const Environment env =
+      CreateEnvironment(std::make_unique<ExplicitKeyValueConfig>(
+          absl::GetFlag(FLAGS_field_trials)));
+  const std::string codec_type = GetParam();
+  std::string ivf_path = CreateInput(env, codec_type);
+  if (ivf_path.empty()) {
+    GTEST_SKIP() << "No " << codec_type << " encoder to create input.";
+  }
+
+  MeasureAndLog(env, ivf_path,
+                {{"codec_type", codec_type},
+                 {"video_name", kSourceVideoName},
+                 {"bitrate_kbps",
+                  std::to_string(absl::GetFlag(FLAGS_bitrate_kbps))}});
+}
+
+INSTANTIATE_TEST_SUITE_P(All,
+                         DecodeThroughputTest,
+                         Values("AV1", "VP9", "VP8", "H264"),
+                         [](const ::testing::TestParamInfo<std::string>& info) {
+                           return info.param;
+                         });
+
+// Measures throughput for externally provided streams, e.g. captures of
+// production traffic:
+//   video_decode_throughput_perf_tests
+//     --gtest_also_run_disabled_tests
+//     --gtest_filter=*DecodeInputFiles --input_ivf=a.ivf,b.ivf
+//     --num_decoders=1,8,32 --decode_threads=1,2,4
+TEST(DecodeThroughputTest, DISABLED_DecodeInputFiles) {
+  const Environment env =
+      CreateEnvironment(std::make_unique<ExplicitKeyValueConfig>(
+          absl::GetFlag(FLAGS_field_trials)));
+  std::vector<std::string> input_files = absl::GetFlag(FLAGS_input_ivf);
+  ASSERT_FALSE(input_files.empty()) << "--input_ivf is not set.";
+
+  for (const std::string& ivf_path : input_files) {
+    MeasureAndLog(
+        env, ivf_path,
+        {{"codec_type", CodecTypeToPayloadString(
+                            OpenIvfFile(ivf_path)->GetVideoCodecType())},
+         {"video_name", ivf_path}});
+  }
+}
+
+}  // namespace test
+}  // namespace webrtc
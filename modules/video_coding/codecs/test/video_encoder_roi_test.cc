@@ -0,0 +1,317 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Measures how quality regions (VideoFrame::QualityRegion) move bits between
+// the region of interest and the background. The source video is encoded with
+// the builtin encoder once without regions and once with the centre of the
+// frame favoured. For both runs the bitrate and the luma PSNR inside and
+// outside the centre are logged.
+
+#include <math.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/types/optional.h"
+#include "api/environment/environment.h"
+#include "api/environment/environment_factory.h"
+#include "api/test/create_frame_generator.h"
+#include "api/test/frame_generator_interface.h"
+#include "api/test/metrics/global_metrics_logger_and_exporter.h"
+#include "api/video/i420_buffer.h"
+#include "api/video/video_bitrate_allocation.h"
+#include "api/video/video_frame.h"
+#include "api/video_codecs/builtin_video_decoder_factory.h"
+#include "api/video_codecs/builtin_video_encoder_factory.h"
+#include "api/video_codecs/sdp_video_format.h"
+#include "api/video_codecs/video_codec.h"
+#include "api/video_codecs/video_decoder.h"
+#include "api/video_codecs/video_encoder.h"
+#include "media/base/media_constants.h"
+#include "modules/video_coding/include/video_error_codes.h"
+#include "rtc_base/checks.h"
+#include "test/explicit_key_value_config.h"
+#include "test/gtest.h"
+#include "test/testsupport/file_utils.h"
+
+ABSL_FLAG(int, bitrate_kbps, 800, "Target bitrate of the encoder.");
+ABSL_FLAG(int, num_frames, 150, "Number of frames to encode.");
+ABSL_FLAG(int, roi_qp_delta, -8, "QP delta of the region of interest.");
+ABSL_FLAG(int,
+          background_qp_delta,
+          8,
+          "QP delta of everything outside the region of interest.");
+ABSL_FLAG(std::string, field_trials, "", "Field trials to run with.");
+
+namespace webrtc {
+namespace {
+
+using ::testing::Values;
+using test::GetGlobalMetricsLogger;
+using test::ImprovementDirection;
+using test::ResourcePath;
+using test::Unit;
+
+constexpr char kSourceVideoName[] = "FourPeople_1280x720_30";
+constexpr int kWidth = 1280;
+constexpr int kHeight = 720;
+constexpr int kFramerate = 30;
+// The region of interest, as fractions of the frame size.
+constexpr VideoFrame::QualityRegion kRoi = {.x = 0.25,
+                                            .y = 0.25,
+                                            .width = 0.5,
+                                            .height = 0.5};
+
+std::string TestName() {
+  return ::testing::UnitTest::GetInstance()->current_test_info()->name();
+}
+
+// Luma squared error, split into the region of interest and the rest.
+struct SquaredError {
+  double roi = 0.0;
+  int64_t roi_pixels = 0;
+  double background = 0.0;
+  int64_t background_pixels = 0;
+};
+
+void AddSquaredError(const I420BufferInterface& ref,
+                     const I420BufferInterface& test,
+                     SquaredError& error) {
+  RTC_CHECK_EQ(ref.width(), test.width());
+  RTC_CHECK_EQ(ref.height(), test.height());
+  const int roi_left = kRoi.x * ref.width();
+  const int roi_top = kRoi.y * ref.height();
+  const int roi_right = (kRoi.x + kRoi.width) * ref.width();
+  const int roi_bottom = (kRoi.y + kRoi.height) * ref.height();
+  for (int y = 0; y < ref.height(); ++y) {
+    const uint8_t* ref_row = ref.DataY() + y * ref.StrideY();
+    const uint8_t* test_row = test.DataY() + y * test.StrideY();
+    for (int x = 0; x < ref.width(); ++x) {
+      const double diff = ref_row[x] - test_row[x];
+      if (y >= roi_top && y < roi_bottom && x >= roi_left && x < roi_right) {
+        error.roi += diff * diff;
+        ++error.roi_pixels;
+      } else {
+        error.background += diff * diff;
+        ++error.background_pixels;
+      }
+    }
+  }
+}
+
+double Psnr(double squared_error, int64_t pixels) {
+  if (squared_error == 0.0) {
+    return 48.0;
+  }
+  return 10.0 * log10(255.0 * 255.0 * pixels / squared_error);
+}
+
+VideoCodec CreateCodecSettings(VideoCodecType codec_type) {
+  VideoCodec vc;
+  vc.codecType = codec_type;
+  vc.width = kWidth;
+  vc.height = kHeight;
+  vc.startBitrate = absl::GetFlag(FLAGS_bitrate_kbps);
+  vc.maxBitrate = absl::GetFlag(FLAGS_bitrate_kbps);
+  vc.minBitrate = 0;
+  vc.maxFramerate = kFramerate;
+  vc.active = true;
+  vc.numberOfSimulcastStreams = 0;
+  vc.mode = VideoCodecMode::kRealtimeVideo;
+  vc.SetFrameDropEnabled(false);
+  vc.SetScalabilityMode(ScalabilityMode::kL1T1);
+  vc.SetVideoEncoderComplexity(VideoCodecComplexity::kComplexityNormal);
+  vc.qpMax = cricket::kDefaultVideoMaxQpVpx;
+  switch (codec_type) {
+    case kVideoCodecVP8:
+      *(vc.VP8()) = VideoEncoder::GetDefaultVp8Settings();
+      break;
+    case kVideoCodecVP9:
+      *(vc.VP9()) = VideoEncoder::GetDefaultVp9Settings();
+      // See LibvpxVp9Encoder::ExplicitlyConfiguredSpatialLayers.
+      vc.spatialLayers[0].targetBitrate = vc.maxBitrate;
+      break;
+    default:
+      break;
+  }
+  return vc;
+}
+
+class Callbacks : public EncodedImageCallback, public DecodedImageCallback {
+ public:
+  explicit Callbacks(VideoDecoder* decoder) : decoder_(decoder) {}
+
+  Result OnEncodedImage(const EncodedImage& encoded_image,
+                        const CodecSpecificInfo* codec_specific_info) override {
+    encoded_bytes_ += encoded_image.size();
+    decoder_->Decode(encoded_image, /*render_time_ms=*/0);
+    return Result(Result::OK);
+  }
+
+  int32_t Decoded(VideoFrame& decoded_image) override {
+    decoded_ = decoded_image.video_frame_buffer();
+    return WEBRTC_VIDEO_CODEC_OK;
+  }
+
+  // Returns the frame decoded since the last call, if any.
+  rtc::scoped_refptr<VideoFrameBuffer> TakeDecoded() {
+    return std::move(decoded_);
+  }
+  int64_t encoded_bytes() const { return encoded_bytes_; }
+
+ private:
+  VideoDecoder* const decoder_;
+  rtc::scoped_refptr<VideoFrameBuffer> decoded_;
+  int64_t encoded_bytes_ = 0;
+};
+
+struct RoiResult {
+  double bitrate_kbps = 0.0;
+  double roi_psnr = 0.0;
+  double background_psnr = 0.0;
+};
+
+// Encodes and decodes the source video, tagging every frame with `regions`.
+absl::optional<RoiResult> EncodeDecode(
+    const Environment& env,
+    const std::string& codec_type,
+    const std::vector<VideoFrame::QualityRegion>& regions) {
+  const SdpVideoFormat format(codec_type);
+  std::unique_ptr<VideoEncoder> encoder =
+      CreateBuiltinVideoEncoderFactory()->Create(env, format);
+  std::unique_ptr<VideoDecoder> decoder =
+      CreateBuiltinVideoDecoderFactory()->Create(env, format);
+  if (encoder == nullptr || decoder == nullptr) {
+    return absl::nullopt;
+  }
+
+  const VideoCodec codec_settings =
+      CreateCodecSettings(PayloadStringToCodecType(codec_type));
+  RTC_CHECK_EQ(encoder->InitEncode(
+                   &codec_settings,
+                   VideoEncoder::Settings(
+                       VideoEncoder::Capabilities(/*loss_notification=*/false),
+                       /*number_of_cores=*/1, /*max_payload_size=*/1440)),
+               WEBRTC_VIDEO_CODEC_OK);
+  VideoBitrateAllocation allocation;
+  allocation.SetBitrate(0, 0, codec_settings.maxBitrate * 1000);
+  encoder->SetRates(
+      VideoEncoder::RateControlParameters(allocation, kFramerate));
+
+  VideoDecoder::Settings decoder_settings;
+  decoder_settings.set_codec_type(codec_settings.codecType);
+  decoder_settings.set_max_render_resolution({kWidth, kHeight});
+  RTC_CHECK(decoder->Configure(decoder_settings));
+
+  Callbacks callbacks(decoder.get());
+  encoder->RegisterEncodeCompleteCallback(&callbacks);
+  decoder->RegisterDecodeCompleteCallback(&callbacks);
+
+  std::unique_ptr<test::FrameGeneratorInterface> source =
+      test::CreateFromYuvFileFrameGenerator(
+          {ResourcePath(kSourceVideoName, "yuv")}, kWidth, kHeight,
+          /*frame_repeat_count=*/1);
+  const int num_frames = absl::GetFlag(FLAGS_num_frames);
+  SquaredError error;
+  for (int i = 0; i < num_frames; ++i) {
+    rtc::scoped_refptr<VideoFrameBuffer> buffer = source->NextFrame().buffer;
+    VideoFrame frame = VideoFrame::Builder()
+                           .set_video_frame_buffer(buffer)
+                           .set_rtp_timestamp(i * 90'000 / kFramerate)
+                           .set_quality_regions(regions)
+                           .build();
+    const std::vector<VideoFrameType> frame_types = {
+        i == 0 ? VideoFrameType::kVideoFrameKey
+               : VideoFrameType::kVideoFrameDelta};
+    RTC_CHECK_EQ(encoder->Encode(frame, &frame_types), WEBRTC_VIDEO_CODEC_OK);
+    // The builtin decoders output synchronously.
+    if (rtc::scoped_refptr<VideoFrameBuffer> decoded =
+            callbacks.TakeDecoded()) {
+      AddSquaredError(*buffer->ToI420(), *decoded->ToI420(), error);
+    }
+  }
+  encoder->Release();
+  decoder->Release();
+
+  return RoiResult{
+      .bitrate_kbps = callbacks.encoded_bytes() * 8.0 * kFramerate /
+                      num_frames / 1000.0,
+      .roi_psnr = Psnr(error.roi, error.roi_pixels),
+      .background_psnr = Psnr(error.background, error.background_pixels)};
+}
+
+void LogResult(const RoiResult& result,
+               const std::string& codec_type,
+               const std::string& variant) {
+  const std::string test_case = TestName() + "/" + variant;
+  std::map<std::string, std::string> metadata = {
+      {"codec_type", codec_type},
+      {"video_name", kSourceVideoName},
+      {"bitrate_kbps", std::to_string(absl::GetFlag(FLAGS_bitrate_kbps))}};
+  GetGlobalMetricsLogger()->LogSingleValueMetric(
+      "bitrate_kbps", test_case, result.bitrate_kbps, Unit::kKilobitsPerSecond,
+      ImprovementDirection::kNeitherIsBetter, metadata);
+  GetGlobalMetricsLogger()->LogSingleValueMetric(
+      "roi_psnr", test_case, result.roi_psnr, Unit::kUnitless,
+      ImprovementDirection::kBiggerIsBetter, metadata);
+  GetGlobalMetricsLogger()->LogSingleValueMetric(
+      "background_psnr", test_case, result.background_psnr, Unit::kUnitless,
+      ImprovementDirection::kBiggerIsBetter, metadata);
+}
+
+}  // namespace
+
+class EncoderRoiTest
+    : public ::testing::TestWithParam</*codec_type=*/std::string> {};
+
+TEST_P(EncoderRoiTest, BitsPerRoiQuality) {
+  const Environment env =
+      CreateEnvironment(std::make_unique<test::ExplicitKeyValueConfig>(
+          absl::GetFlag(FLAGS_field_trials)));
+  const std::string codec_type = GetParam();
+
+  absl::optional<RoiResult> reference =
+      EncodeDecode(env, codec_type, /*regions=*/{});
+  if (!reference) {
+    GTEST_SKIP() << "No builtin " << codec_type << " encoder or decoder.";
+  }
+
+  // The background covers the whole frame and is overridden by the region of
+  // interest, which comes later.
+  VideoFrame::QualityRegion background = {
+      .x = 0.0,
+      .y = 0.0,
+      .width = 1.0,
+      .height = 1.0,
+      .qp_delta = absl::GetFlag(FLAGS_background_qp_delta)};
+  VideoFrame::QualityRegion roi = kRoi;
+  roi.qp_delta = absl::GetFlag(FLAGS_roi_qp_delta);
+  absl::optional<RoiResult> with_roi =
+      EncodeDecode(env, codec_type, {background, roi});
+  ASSERT_TRUE(with_roi);
+
+  LogResult(*reference, codec_type, "reference");
+  LogResult(*with_roi, codec_type, "roi");
+  EXPECT_GT(with_roi->roi_psnr - with_roi->background_psnr,
+            reference->roi_psnr - reference->background_psnr);
+}
+
+INSTANTIATE_TEST_SUITE_P(All,
+                         EncoderRoiTest,
+                         Values("AV1", "VP9", "VP8"),
+                         [](const ::testing::TestParamInfo<std::string>& info) {
+                           return info.param;
+                         });
+
+}  // namespace webrtc
@@ -33,6 +33,7 @@
 #include "modules/video_coding/codecs/vp8/vp8_scalability.h"
 #include "modules/video_coding/include/video_error_codes.h"
 #include "modules/video_coding/svc/scalability_mode_util.h"
+#include "modules/video_coding/utility/roi_map.h"
 #include "modules/video_coding/utility/simulcast_rate_allocator.h"
 #include "modules/video_coding/utility/simulcast_utility.h"
 #include "rtc_base/checks.h"
@@ -552,6 +553,7 @@ int LibvpxVp8Encoder::InitEncode(const VideoCodec* inst,
   raw_images_.resize(number_of_streams);
   send_stream_.resize(number_of_streams);
   send_stream_[0] = true;  // For non-simulcast case.
+  roi_map_set_.assign(number_of_streams, false);
   cpu_speed_.resize(number_of_streams);
   std::fill(key_frame_request_.begin(), key_frame_request_.end(), false);
   std::fill(last_encoder_output_time_.begin(), last_encoder_output_time_.end(),
@@ -1106,6 +1108,7 @@ int LibvpxVp8Encoder::Encode(const VideoFrame& frame,
                            static_cast<int>(flags[stream_idx]));
     libvpx_->codec_control(&encoders_[i], VP8E_SET_TEMPORAL_LAYER_ID,
                            tl_configs[i].encoder_layer_id);
+    SetRoiMap(i, frame.quality_regions());
   }
   // TODO(holmer): Ideally the duration should be the timestamp diff of this
   // frame and the next frame to be encoded, which we don't have. Instead we
@@ -1144,6 +1147,41 @@ int LibvpxVp8Encoder::Encode(const VideoFrame& frame,
   return error;
 }
 
+void LibvpxVp8Encoder::SetRoiMap(
+    size_t encoder_idx,
+    rtc::ArrayView<const VideoFrame::QualityRegion> regions) {
+  // VP8 segments 16x16 macroblocks into at most four segments. The quantizer
+  // deltas are on the same 0-63 scale as the QP, libvpx maps them to its
+  // internal quantizer index.
+  constexpr int kBlockSize = 16;
+  constexpr int kMaxSegments = 4;
+  constexpr int kMaxDeltaQ = 63;
+  const vpx_codec_enc_cfg_t& config = vpx_configs_[encoder_idx];
+  absl::optional<RoiMap> roi_map = RoiMap::Create(
+      config.g_w, config.g_h, kBlockSize, kMaxSegments, regions);
+  if (!roi_map && !roi_map_set_[encoder_idx]) {
+    return;
+  }
+  // Without a map libvpx disables the segmentation again.
+  vpx_roi_map_t vpx_roi_map = {};
+  vpx_roi_map.rows = (config.g_h + kBlockSize - 1) / kBlockSize;
+  vpx_roi_map.cols = (config.g_w + kBlockSize - 1) / kBlockSize;
+  if (roi_map) {
+    vpx_roi_map.roi_map = roi_map->segment_map.data();
+    for (size_t i = 0; i < roi_map->segments.size(); ++i) {
+      // VP8 cannot skip segments, code them at the lowest quality instead.
+      const RoiMap::Segment& segment = roi_map->segments[i];
+      vpx_roi_map.delta_q[i] =
+          segment.skip ? kMaxDeltaQ
+                       : std::clamp(segment.qp_delta, -kMaxDeltaQ, kMaxDeltaQ);
+    }
+  }
+  roi_map_set_[encoder_idx] =
+      libvpx_->codec_control(&encoders_[encoder_idx], VP8E_SET_ROI_MAP,
+                             &vpx_roi_map) == VPX_CODEC_OK &&
+      roi_map.has_value();
+}
+
 void LibvpxVp8Encoder::PopulateCodecSpecific(CodecSpecificInfo* codec_specific,
                                              const vpx_codec_cx_pkt_t& pkt,
                                              int stream_idx,
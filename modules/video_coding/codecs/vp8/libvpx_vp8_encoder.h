@@ -17,6 +17,7 @@
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "api/array_view.h"
 #include "api/fec_controller_override.h"
 #include "api/field_trials_view.h"
 #include "api/units/time_delta.h"
@@ -103,6 +104,11 @@ class LibvpxVp8Encoder : public VideoEncoder {
   bool UpdateVpxConfiguration(size_t stream_index);
 
   void MaybeUpdatePixelFormat(vpx_img_fmt fmt);
+
+  // Configures encoder `encoder_idx` to encode the next frame with the
+  // quality of `regions`.
+  void SetRoiMap(size_t encoder_idx,
+                 rtc::ArrayView<const VideoFrame::QualityRegion> regions);
   // Prepares `raw_image_` to reference image data of `buffer`, or of mapped or
   // scaled versions of `buffer`. Returns a list of buffers that got referenced
   // as a result, allowing the caller to keep references to them until after
@@ -131,6 +137,7 @@ class LibvpxVp8Encoder : public VideoEncoder {
       resolution_bitrate_limits_;
   std::vector<bool> key_frame_request_;
   std::vector<bool> send_stream_;
+  std::vector<bool> roi_map_set_;
   std::vector<int> cpu_speed_;
   std::vector<vpx_image_t> raw_images_;
   std::vector<EncodedImage> encoded_images_;
@@ -37,6 +37,7 @@
 namespace webrtc {
 
 using ::testing::_;
+using ::testing::A;
 using ::testing::AllOf;
 using ::testing::ElementsAre;
 using ::testing::ElementsAreArray;
@@ -44,6 +45,7 @@ using ::testing::Field;
 using ::testing::Invoke;
 using ::testing::NiceMock;
 using ::testing::Return;
+using ::testing::WithArg;
 using EncoderInfo = webrtc::VideoEncoder::EncoderInfo;
 using FramerateFractions =
     absl::InlinedVector<uint8_t, webrtc::kMaxTemporalStreams>;
@@ -633,6 +635,44 @@ TEST_F(TestVp8Impl, KeepsTimestampOnReencode) {
   encoder.Encode(NextInputFrame(), &delta_frame);
 }
 
+TEST_F(TestVp8Impl, PassesQualityRegionQpDeltasToRoiMap) {
+  auto* const vpx = new NiceMock<MockLibvpxInterface>();
+  LibvpxVp8Encoder encoder(CreateEnvironment(), {}, absl::WrapUnique(vpx));
+
+  ON_CALL(*vpx, img_wrap(_, _, _, _, _, _))
+      .WillByDefault(Invoke([](vpx_image_t* img, vpx_img_fmt_t fmt,
+                               unsigned int d_w, unsigned int d_h,
+                               unsigned int stride_align,
+                               unsigned char* img_data) {
+        img->fmt = fmt;
+        img->d_w = d_w;
+        img->d_h = d_h;
+        img->img_data = img_data;
+        return img;
+      }));
+  ASSERT_EQ(WEBRTC_VIDEO_CODEC_OK,
+            encoder.InitEncode(&codec_settings_,
+                               VideoEncoder::Settings(kCapabilities, 1, 1000)));
+  MockEncodedImageCallback callback;
+  encoder.RegisterEncodeCompleteCallback(&callback);
+
+  // The deltas are on the QP scale libvpx expects, only clamped to it. The
+  // skipped region is coded at the lowest quality instead.
+  std::vector<int> delta_q;
+  EXPECT_CALL(*vpx, codec_control(_, VP8E_SET_ROI_MAP, A<vpx_roi_map*>()))
+      .WillOnce(WithArg<2>([&](vpx_roi_map* roi_map) {
+        delta_q.assign(roi_map->delta_q, roi_map->delta_q + 4);
+        return VPX_CODEC_OK;
+      }));
+  VideoFrame frame = NextInputFrame();
+  frame.set_quality_regions(
+      {{.width = 0.5, .height = 0.5, .qp_delta = -10},
+       {.x = 0.5, .width = 0.5, .height = 0.5, .qp_delta = -100},
+       {.y = 0.5, .width = 0.5, .height = 0.5, .skip = true}});
+  encoder.Encode(frame, nullptr);
+  EXPECT_THAT(delta_q, ElementsAre(0, -10, -63, 63));
+}
+
 TEST(LibvpxVp8EncoderTest, GetEncoderInfoReturnsStaticInformation) {
   auto* const vpx = new NiceMock<MockLibvpxInterface>();
   LibvpxVp8Encoder encoder(CreateEnvironment(), {}, absl::WrapUnique(vpx));
@@ -134,7 +134,9 @@ bool LibvpxVp9Decoder::Configure(const Settings& settings) {
   cfg.threads = 1;
 #else
   const RenderResolution& resolution = settings.max_render_resolution();
-  if (!resolution.Valid()) {
+  if (settings.decode_threads().has_value()) {
+    cfg.threads = *settings.decode_threads();
+  } else if (!resolution.Valid()) {
     // Postpone configuring number of threads until resolution is known.
     cfg.threads = 1;
   } else {
@@ -183,6 +185,16 @@ bool LibvpxVp9Decoder::Configure(const Settings& settings) {
     return false;
   }
 
+  if (cfg.threads > 1 && settings.decode_threads().has_value()) {
+    // Row based multithreading also parallelizes streams with a single tile
+    // column, e.g. screen content, which tile threading alone can not.
+    status = vpx_codec_control(decoder_, VP9D_SET_ROW_MT, 1);
+    if (status != VPX_CODEC_OK) {
+      RTC_LOG(LS_WARNING) << "Failed to enable VP9D_SET_ROW_MT. "
+                          << vpx_codec_error(decoder_);
+    }
+  }
+
   return true;
 }
 
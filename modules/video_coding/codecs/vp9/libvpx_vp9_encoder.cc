@@ -34,6 +34,8 @@
 #include "modules/video_coding/svc/scalable_video_controller.h"
 #include "modules/video_coding/svc/scalable_video_controller_no_layering.h"
 #include "modules/video_coding/svc/svc_rate_allocator.h"
+#include "modules/video_coding/utility/active_map.h"
+#include "modules/video_coding/utility/roi_map.h"
 #include "modules/video_coding/utility/vp9_uncompressed_header_parser.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/experiments/field_trial_list.h"
@@ -257,6 +259,8 @@ LibvpxVp9Encoder::LibvpxVp9Encoder(const Environment& env,
       quality_scaler_experiment_(ParseQualityScalerConfig(env.field_trials())),
       external_ref_ctrl_(
           !env.field_trials().IsDisabled("WebRTC-Vp9ExternalRefCtrl")),
+      use_active_map_(
+          env.field_trials().IsEnabled("WebRTC-VP9ActiveMapScreenshare")),
       performance_flags_(ParsePerformanceFlagsFromTrials(env.field_trials())),
       num_steady_state_frames_(0),
       config_changed_(true),
@@ -573,6 +577,9 @@ int LibvpxVp9Encoder::InitEncode(const VideoCodec* inst,
 
   force_key_frame_ = true;
   pics_since_key_ = 0;
+  pending_update_rect_.MakeEmptyUpdate();
+  active_map_set_ = false;
+  roi_map_set_ = false;
 
   scalability_mode_ = inst->GetScalabilityMode();
   if (scalability_mode_.has_value()) {
@@ -997,6 +1004,9 @@ int LibvpxVp9Encoder::Encode(const VideoFrame& input_image,
     // All spatial layers are disabled, return without encoding anything.
     return WEBRTC_VIDEO_CODEC_OK;
   }
+  // Frames dropped before or by the encoder may have changed regions that
+  // still need to be encoded.
+  pending_update_rect_.Union(input_image.update_rect());
 
   // We only support one stream at the moment.
   if (frame_types && !frame_types->empty()) {
@@ -1260,6 +1270,17 @@ int LibvpxVp9Encoder::Encode(const VideoFrame& input_image,
                          .GetTargetRate())
           : codec_.maxFramerate;
   uint32_t duration = static_cast<uint32_t>(90000 / target_framerate_fps);
+  const bool use_roi_map = SetRoiMap(input_image.quality_regions());
+  if (use_active_map_ && codec_.mode == VideoCodecMode::kScreensharing) {
+    // Active maps are given in blocks of the full resolution frame, so they
+    // are only used without spatial layers. Both maps rely on segmentation,
+    // so a region of interest map takes precedence.
+    const bool use_active_map = !force_key_frame_ &&
+                                !pending_update_rect_.IsEmpty() &&
+                                num_spatial_layers_ == 1 && !use_roi_map;
+    SetActiveMap(use_active_map ? absl::make_optional(pending_update_rect_)
+                                : absl::nullopt);
+  }
   const vpx_codec_err_t rv = libvpx_->codec_encode(
       encoder_, raw_, timestamp_, duration, flags, VPX_DL_REALTIME);
   if (rv != VPX_CODEC_OK) {
@@ -1275,6 +1296,67 @@ int LibvpxVp9Encoder::Encode(const VideoFrame& input_image,
   return WEBRTC_VIDEO_CODEC_OK;
 }
 
+void LibvpxVp9Encoder::SetActiveMap(
+    absl::optional<VideoFrame::UpdateRect> update_rect) {
+  ActiveMap active_map = ActiveMap::FromUpdateRect(
+      raw_->d_w, raw_->d_h,
+      update_rect.value_or(
+          VideoFrame::UpdateRect{.width = static_cast<int>(raw_->d_w),
+                                 .height = static_cast<int>(raw_->d_h)}));
+  const bool restrict_blocks = !active_map.AllActive();
+  if (!restrict_blocks && !active_map_set_) {
+    return;
+  }
+  // Without a map libvpx encodes all blocks again.
+  vpx_active_map_t vpx_active_map;
+  vpx_active_map.active_map =
+      restrict_blocks ? active_map.map.data() : nullptr;
+  vpx_active_map.rows = active_map.rows;
+  vpx_active_map.cols = active_map.cols;
+  active_map_set_ = libvpx_->codec_control(encoder_, VP8E_SET_ACTIVEMAP,
+                                           &vpx_active_map) == VPX_CODEC_OK &&
+                    restrict_blocks;
+}
+
+bool LibvpxVp9Encoder::SetRoiMap(
+    rtc::ArrayView<const VideoFrame::QualityRegion> regions) {
+  // VP9 segments 8x8 blocks into at most eight segments. The quantizer deltas
+  // are on the same 0-63 scale as the QP, libvpx maps them to its internal
+  // quantizer index.
+  constexpr int kBlockSize = 8;
+  constexpr int kMaxSegments = 8;
+  constexpr int kMaxDeltaQ = 63;
+  // Region of interest maps are given in blocks of the full resolution frame,
+  // so they are only used without spatial layers.
+  absl::optional<RoiMap> roi_map;
+  if (num_spatial_layers_ == 1) {
+    roi_map = RoiMap::Create(raw_->d_w, raw_->d_h, kBlockSize, kMaxSegments,
+                             regions);
+  }
+  if (!roi_map && !roi_map_set_) {
+    return false;
+  }
+  vpx_roi_map_t vpx_roi_map = {};
+  vpx_roi_map.rows = (raw_->d_h + kBlockSize - 1) / kBlockSize;
+  vpx_roi_map.cols = (raw_->d_w + kBlockSize - 1) / kBlockSize;
+  for (int& ref_frame : vpx_roi_map.ref_frame) {
+    ref_frame = -1;
+  }
+  if (roi_map) {
+    vpx_roi_map.enabled = 1;
+    vpx_roi_map.roi_map = roi_map->segment_map.data();
+    for (size_t i = 0; i < roi_map->segments.size(); ++i) {
+      vpx_roi_map.delta_q[i] =
+          std::clamp(roi_map->segments[i].qp_delta, -kMaxDeltaQ, kMaxDeltaQ);
+      vpx_roi_map.skip[i] = roi_map->segments[i].skip ? 1 : 0;
+    }
+  }
+  roi_map_set_ = libvpx_->codec_control(encoder_, VP9E_SET_ROI_MAP,
+                                        &vpx_roi_map) == VPX_CODEC_OK &&
+                 roi_map.has_value();
+  return roi_map_set_;
+}
+
 bool LibvpxVp9Encoder::PopulateCodecSpecific(CodecSpecificInfo* codec_specific,
                                              absl::optional<int>* spatial_idx,
                                              absl::optional<int>* temporal_idx,
@@ -1781,6 +1863,11 @@ void LibvpxVp9Encoder::DeliverBufferedFrame(bool end_of_picture) {
 
     encoded_complete_callback_->OnEncodedImage(encoded_image_,
                                                &codec_specific_);
+    // Frames reference at most back to the last base layer frame, so with
+    // temporal layers the update rect covers everything changed since then.
+    if (encoded_image_.TemporalIndex().value_or(0) == 0) {
+      pending_update_rect_.MakeEmptyUpdate();
+    }
 
     if (codec_.mode == VideoCodecMode::kScreensharing) {
       const uint8_t spatial_idx = encoded_image_.SpatialIndex().value_or(0);
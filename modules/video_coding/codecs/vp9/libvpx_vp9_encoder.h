@@ -18,9 +18,12 @@
 #include <memory>
 #include <vector>
 
+#include "absl/types/optional.h"
+#include "api/array_view.h"
 #include "api/environment/environment.h"
 #include "api/fec_controller_override.h"
 #include "api/field_trials_view.h"
+#include "api/video/video_frame.h"
 #include "api/video_codecs/scalability_mode.h"
 #include "api/video_codecs/video_encoder.h"
 #include "api/video_codecs/vp9_profile.h"
@@ -97,6 +100,13 @@ class LibvpxVp9Encoder : public VideoEncoder {
 
   void DeliverBufferedFrame(bool end_of_picture);
 
+  // Restricts encoding of the next frame to the blocks touched by
+  // `update_rect`, or lifts the restriction if `update_rect` is unset.
+  void SetActiveMap(absl::optional<VideoFrame::UpdateRect> update_rect);
+  // Configures the encoder to encode the next frame with the quality of
+  // `regions`. Returns whether a region of interest map is in use.
+  bool SetRoiMap(rtc::ArrayView<const VideoFrame::QualityRegion> regions);
+
   bool DropFrame(uint8_t spatial_idx, uint32_t rtp_timestamp);
 
   // Determine maximum target for Intra frames
@@ -196,6 +206,15 @@ class LibvpxVp9Encoder : public VideoEncoder {
       const FieldTrialsView& trials);
   const bool external_ref_ctrl_;
 
+  // For screensharing, encodes only the blocks that changed according to
+  // VideoFrame::update_rect().
+  const bool use_active_map_;
+  // Union of the update rects of the frames since the last encoded base layer
+  // frame.
+  VideoFrame::UpdateRect pending_update_rect_;
+  bool active_map_set_ = false;
+  bool roi_map_set_ = false;
+
   // Flags that can affect speed vs quality tradeoff, and are configureable per
   // resolution ranges.
   struct PerformanceFlags {
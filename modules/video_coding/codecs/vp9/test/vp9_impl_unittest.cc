@@ -2453,6 +2453,47 @@ TEST(Vp9SpeedSettingsTrialsTest, DefaultPerLayerFlagsWithSvc) {
   }
 }
 
+TEST(Vp9ImplTest, PassesQualityRegionQpDeltasToRoiMap) {
+  auto* const vpx = new NiceMock<MockLibvpxInterface>();
+  LibvpxVp9Encoder encoder(CreateEnvironment(), {},
+                           absl::WrapUnique<LibvpxInterface>(vpx));
+
+  VideoCodec settings = DefaultCodecSettings();
+  vpx_image_t img;
+  ON_CALL(*vpx, img_wrap).WillByDefault(GetWrapImageFunction(&img));
+  ON_CALL(*vpx, codec_enc_config_default)
+      .WillByDefault(DoAll(WithArg<1>([](vpx_codec_enc_cfg_t* cfg) {
+                             memset(cfg, 0, sizeof(vpx_codec_enc_cfg_t));
+                           }),
+                           Return(VPX_CODEC_OK)));
+  ASSERT_EQ(WEBRTC_VIDEO_CODEC_OK, encoder.InitEncode(&settings, kSettings));
+  VideoBitrateAllocation bitrate_allocation;
+  bitrate_allocation.SetBitrate(0, 0, settings.startBitrate * 1000);
+  encoder.SetRates(VideoEncoder::RateControlParameters(bitrate_allocation,
+                                                       settings.maxFramerate));
+  MockEncodedImageCallback callback;
+  encoder.RegisterEncodeCompleteCallback(&callback);
+
+  // The deltas are on the QP scale libvpx expects, only clamped to it.
+  std::vector<int> delta_q;
+  EXPECT_CALL(*vpx, codec_control(_, VP9E_SET_ROI_MAP, A<vpx_roi_map*>()))
+      .WillOnce(WithArg<2>([&](vpx_roi_map* roi_map) {
+        delta_q.assign(roi_map->delta_q, roi_map->delta_q + 3);
+        return VPX_CODEC_OK;
+      }));
+  auto frame_generator = test::CreateSquareFrameGenerator(
+      kWidth, kHeight, test::FrameGeneratorInterface::OutputType::kI420, 10);
+  VideoFrame frame =
+      VideoFrame::Builder()
+          .set_video_frame_buffer(frame_generator->NextFrame().buffer)
+          .set_quality_regions(
+              {{.width = 0.5, .height = 0.5, .qp_delta = -10},
+               {.x = 0.5, .width = 0.5, .height = 0.5, .qp_delta = 100}})
+          .build();
+  encoder.Encode(frame, nullptr);
+  EXPECT_THAT(delta_q, ElementsAre(0, -10, 63));
+}
+
 struct SvcFrameDropConfigTestParameters {
   bool flexible_mode;
   absl::optional<ScalabilityMode> scalability_mode;
@@ -18,7 +18,11 @@
 
 namespace webrtc {
 
-VCMDecoderDatabase::VCMDecoderDatabase() {
+VCMDecoderDatabase::VCMDecoderDatabase()
+    : VCMDecoderDatabase(/*thread_budget=*/nullptr) {}
+
+VCMDecoderDatabase::VCMDecoderDatabase(DecoderThreadBudget* thread_budget)
+    : thread_budget_(thread_budget) {
   decoder_sequence_checker_.Detach();
 }
 
@@ -35,6 +39,7 @@ void VCMDecoderDatabase::DeregisterExternalDecoder(uint8_t payload_type) {
   if (current_decoder_ && current_decoder_->IsSameDecoder(it->second.get())) {
     // Release it if it was registered and in use.
     current_decoder_ = absl::nullopt;
+    thread_lease_ = DecoderThreadBudget::Lease();
   }
   decoders_.erase(it);
 }
@@ -92,6 +97,9 @@ VCMGenericDecoder* VCMDecoderDatabase::GetDecoder(
   RTC_DCHECK(decoded_frame_callback->UserReceiveCallback());
   uint8_t payload_type = frame.PayloadType();
   if (payload_type == current_payload_type_ || payload_type == 0) {
+    if (current_decoder_.has_value() && current_payload_type_.has_value()) {
+      MaybeUpdateDecodeThreads(frame);
+    }
     return current_decoder_.has_value() ? &*current_decoder_ : nullptr;
   }
   // If decoder exists - delete.
@@ -143,10 +151,56 @@ void VCMDecoderDatabase::CreateAndInitDecoder(const EncodedFrame& frame) {
   if (frame_resolution.Valid()) {
     decoder_item->second.set_max_render_resolution(frame_resolution);
   }
-  if (!current_decoder_->Configure(decoder_item->second)) {
-    current_decoder_ = absl::nullopt;
+  if (!ConfigureCurrentDecoder(decoder_item->second)) {
     RTC_LOG(LS_ERROR) << "Failed to initialize decoder.";
   }
 }
 
+void VCMDecoderDatabase::MaybeUpdateDecodeThreads(const EncodedFrame& frame) {
+  // Only a key frame can change the resolution, and the decoder can only be
+  // reconfigured at one.
+  if (thread_budget_ == nullptr ||
+      frame.FrameType() != VideoFrameType::kVideoFrameKey) {
+    return;
+  }
+  RenderResolution frame_resolution(frame.EncodedImage()._encodedWidth,
+                                    frame.EncodedImage()._encodedHeight);
+  auto decoder_item = decoder_settings_.find(*current_payload_type_);
+  if (!frame_resolution.Valid() || decoder_item == decoder_settings_.end() ||
+      frame_resolution == decoder_item->second.max_render_resolution()) {
+    return;
+  }
+  decoder_item->second.set_max_render_resolution(frame_resolution);
+  if (DecoderThreadBudget::DesiredThreads(
+          frame_resolution, decoder_item->second.number_of_cores()) ==
+      desired_decode_threads_) {
+    return;
+  }
+  if (!ConfigureCurrentDecoder(decoder_item->second)) {
+    current_payload_type_ = absl::nullopt;
+    RTC_LOG(LS_ERROR) << "Failed to reconfigure decoder for "
+                      << frame_resolution.Width() << "x"
+                      << frame_resolution.Height() << ".";
+  }
+}
+
+bool VCMDecoderDatabase::ConfigureCurrentDecoder(
+    VideoDecoder::Settings settings) {
+  if (thread_budget_ != nullptr) {
+    // Return the threads of the previous configuration before asking for new
+    // ones.
+    thread_lease_ = DecoderThreadBudget::Lease();
+    desired_decode_threads_ = DecoderThreadBudget::DesiredThreads(
+        settings.max_render_resolution(), settings.number_of_cores());
+    thread_lease_ = thread_budget_->Acquire(desired_decode_threads_);
+    settings.set_decode_threads(thread_lease_.threads());
+  }
+  if (!current_decoder_->Configure(settings)) {
+    current_decoder_ = absl::nullopt;
+    thread_lease_ = DecoderThreadBudget::Lease();
+    return false;
+  }
+  return true;
+}
+
 }  // namespace webrtc
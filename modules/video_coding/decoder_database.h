@@ -20,6 +20,7 @@
 #include "api/sequence_checker.h"
 #include "api/video/encoded_frame.h"
 #include "api/video_codecs/video_decoder.h"
+#include "modules/video_coding/decoder_thread_budget.h"
 #include "modules/video_coding/generic_decoder.h"
 
 namespace webrtc {
@@ -27,6 +28,9 @@ namespace webrtc {
 class VCMDecoderDatabase {
  public:
   VCMDecoderDatabase();
+  // If `thread_budget` is not null, decoders are configured with the number of
+  // threads granted from it for the resolution of the stream.
+  explicit VCMDecoderDatabase(DecoderThreadBudget* thread_budget);
   VCMDecoderDatabase(const VCMDecoderDatabase&) = delete;
   VCMDecoderDatabase& operator=(const VCMDecoderDatabase&) = delete;
   ~VCMDecoderDatabase() = default;
@@ -55,6 +59,14 @@ class VCMDecoderDatabase {
  private:
   void CreateAndInitDecoder(const EncodedFrame& frame)
       RTC_RUN_ON(decoder_sequence_checker_);
+  // Reconfigures the current decoder with threads for the new resolution when
+  // a key frame changes it.
+  void MaybeUpdateDecodeThreads(const EncodedFrame& frame)
+      RTC_RUN_ON(decoder_sequence_checker_);
+  // Configures `current_decoder_` with `settings` and threads leased for its
+  // resolution. Clears `current_decoder_` on failure.
+  bool ConfigureCurrentDecoder(VideoDecoder::Settings settings)
+      RTC_RUN_ON(decoder_sequence_checker_);
 
   SequenceChecker decoder_sequence_checker_;
 
@@ -66,6 +78,12 @@ class VCMDecoderDatabase {
   // Decoders keyed by payload type.
   std::map<uint8_t, std::unique_ptr<VideoDecoder>> decoders_
       RTC_GUARDED_BY(decoder_sequence_checker_);
+  DecoderThreadBudget* const thread_budget_;
+  // Threads granted to `current_decoder_`.
+  DecoderThreadBudget::Lease thread_lease_
+      RTC_GUARDED_BY(decoder_sequence_checker_);
+  // Threads asked for when `thread_lease_` was acquired.
+  int desired_decode_threads_ RTC_GUARDED_BY(decoder_sequence_checker_) = 0;
 };
 
 }  // namespace webrtc
@@ -12,15 +12,34 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "api/test/mock_video_decoder.h"
+#include "modules/video_coding/decoder_thread_budget.h"
+#include "modules/video_coding/generic_decoder.h"
+#include "modules/video_coding/timing/timing.h"
+#include "system_wrappers/include/clock.h"
+#include "test/fake_encoded_frame.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
+#include "test/scoped_key_value_config.h"
 
 namespace webrtc {
 namespace {
 
 using ::testing::NiceMock;
+using ::testing::SizeIs;
+
+class ReceiveCallback : public VCMReceiveCallback {
+ public:
+  int32_t FrameToRender(VideoFrame& frame,
+                        absl::optional<uint8_t> qp,
+                        TimeDelta decode_time,
+                        VideoContentType content_type,
+                        VideoFrameType frame_type) override {
+    return 0;
+  }
+};
 
 // Test registering and unregistering an external decoder instance.
 TEST(VCMDecoderDatabaseTest, RegisterExternalDecoder) {
@@ -80,5 +99,56 @@ TEST(VCMDecoderDatabaseTest, DeregisterReceiveCodecs) {
   EXPECT_FALSE(db.DeregisterReceiveCodec(kPayloadType2));
 }
 
+TEST(VCMDecoderDatabaseTest, ReacquiresDecodeThreadsOnResolutionChange) {
+  DecoderThreadBudget budget(/*total_threads=*/16);
+  VCMDecoderDatabase db(&budget);
+  constexpr int kPayloadType = 96;
+
+  auto decoder = std::make_unique<NiceMock<MockVideoDecoder>>();
+  std::vector<VideoDecoder::Settings> configured;
+  ON_CALL(*decoder, Configure)
+      .WillByDefault([&](const VideoDecoder::Settings& settings) {
+        configured.push_back(settings);
+        return true;
+      });
+  db.RegisterExternalDecoder(kPayloadType, std::move(decoder));
+  VideoDecoder::Settings settings;
+  settings.set_codec_type(kVideoCodecVP9);
+  settings.set_number_of_cores(16);
+  db.RegisterReceiveCodec(kPayloadType, settings);
+
+  SimulatedClock clock(Timestamp::Zero());
+  test::ScopedKeyValueConfig field_trials;
+  VCMTiming timing(&clock, field_trials);
+  VCMDecodedFrameCallback decoded_frame_callback(&timing, &clock,
+                                                 field_trials);
+  ReceiveCallback receive_callback;
+  decoded_frame_callback.SetUserReceiveCallback(&receive_callback);
+
+  std::unique_ptr<test::FakeEncodedFrame> frame =
+      test::FakeFrameBuilder().PayloadType(kPayloadType).AsLast().Build();
+  frame->_frameType = VideoFrameType::kVideoFrameKey;
+  frame->_encodedWidth = 640;
+  frame->_encodedHeight = 360;
+  ASSERT_TRUE(db.GetDecoder(*frame, &decoded_frame_callback));
+  EXPECT_EQ(budget.threads_in_use(), 1);
+
+  // Delta frames do not reconfigure the decoder.
+  frame->_frameType = VideoFrameType::kVideoFrameDelta;
+  frame->_encodedWidth = 1920;
+  frame->_encodedHeight = 1080;
+  ASSERT_TRUE(db.GetDecoder(*frame, &decoded_frame_callback));
+  EXPECT_THAT(configured, SizeIs(1));
+
+  frame->_frameType = VideoFrameType::kVideoFrameKey;
+  ASSERT_TRUE(db.GetDecoder(*frame, &decoded_frame_callback));
+  ASSERT_THAT(configured, SizeIs(2));
+  EXPECT_EQ(configured[0].decode_threads(), 1);
+  EXPECT_EQ(configured[1].decode_threads(), 4);
+  EXPECT_EQ(configured[1].max_render_resolution(),
+            RenderResolution(1920, 1080));
+  EXPECT_EQ(budget.threads_in_use(), 4);
+}
+
 }  // namespace
 }  // namespace webrtc
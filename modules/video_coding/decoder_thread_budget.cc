@@ -0,0 +1,106 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/video_coding/decoder_thread_budget.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "rtc_base/checks.h"
+#include "system_wrappers/include/cpu_info.h"
+
+namespace webrtc {
+
+namespace {
+
+// Same scaling as the VP9 decoder uses on its own: two threads for 720p.
+constexpr int64_t kPixelsPerThread = 1280 * 720 / 2;
+
+}  // namespace
+
+DecoderThreadBudget::Lease::Lease(DecoderThreadBudget* budget, int threads)
+    : budget_(budget), threads_(threads) {}
+
+DecoderThreadBudget::Lease::Lease(Lease&& other)
+    : budget_(other.budget_), threads_(other.threads_) {
+  other.budget_ = nullptr;
+  other.threads_ = 0;
+}
+
+DecoderThreadBudget::Lease& DecoderThreadBudget::Lease::operator=(
+    Lease&& other) {
+  if (this != &other) {
+    Reset();
+    budget_ = other.budget_;
+    threads_ = other.threads_;
+    other.budget_ = nullptr;
+    other.threads_ = 0;
+  }
+  return *this;
+}
+
+DecoderThreadBudget::Lease::~Lease() {
+  Reset();
+}
+
+void DecoderThreadBudget::Lease::Reset() {
+  if (budget_ != nullptr) {
+    budget_->Release(threads_);
+  }
+  budget_ = nullptr;
+  threads_ = 0;
+}
+
+DecoderThreadBudget& DecoderThreadBudget::Global() {
+  static DecoderThreadBudget* const budget = new DecoderThreadBudget(
+      static_cast<int>(CpuInfo::DetectNumberOfCores()));
+  return *budget;
+}
+
+DecoderThreadBudget::DecoderThreadBudget(int total_threads)
+    : total_threads_(std::max(1, total_threads)) {}
+
+DecoderThreadBudget::~DecoderThreadBudget() {
+  RTC_DCHECK_EQ(threads_in_use(), 0);
+}
+
+int DecoderThreadBudget::DesiredThreads(RenderResolution resolution,
+                                        int max_threads) {
+  if (!resolution.Valid()) {
+    return 1;
+  }
+  const int64_t pixels =
+      int64_t{resolution.Width()} * int64_t{resolution.Height()};
+  const int64_t threads = std::max<int64_t>(1, pixels / kPixelsPerThread);
+  return static_cast<int>(
+      std::min<int64_t>(threads, std::max(1, max_threads)));
+}
+
+DecoderThreadBudget::Lease DecoderThreadBudget::Acquire(int desired_threads) {
+  RTC_DCHECK_GT(desired_threads, 0);
+  MutexLock lock(&mutex_);
+  const int granted =
+      std::max(1, std::min(desired_threads, total_threads_ - threads_in_use_));
+  threads_in_use_ += granted;
+  return Lease(this, granted);
+}
+
+int DecoderThreadBudget::threads_in_use() const {
+  MutexLock lock(&mutex_);
+  return threads_in_use_;
+}
+
+void DecoderThreadBudget::Release(int threads) {
+  MutexLock lock(&mutex_);
+  threads_in_use_ -= threads;
+  RTC_DCHECK_GE(threads_in_use_, 0);
+}
+
+}  // namespace webrtc
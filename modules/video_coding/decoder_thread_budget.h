@@ -0,0 +1,76 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_VIDEO_CODING_DECODER_THREAD_BUDGET_H_
+#define MODULES_VIDEO_CODING_DECODER_THREAD_BUDGET_H_
+
+#include "api/video_codecs/video_decoder.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+// Budget of decoder threads shared by all receive streams of a process, so
+// that a few large streams can decode in parallel on many-core machines while
+// hundreds of small streams do not oversubscribe the cores.
+//
+// Each decoder asks for the number of threads its resolution warrants and is
+// granted what is left of the budget, but always at least one thread.
+class DecoderThreadBudget {
+ public:
+  // Threads granted to a single decoder. Returned to the budget on
+  // destruction. The budget must outlive its leases.
+  class Lease {
+   public:
+    Lease() = default;
+    Lease(Lease&& other);
+    Lease& operator=(Lease&& other);
+    ~Lease();
+
+    // Number of threads granted, or 0 for an empty lease.
+    int threads() const { return threads_; }
+
+   private:
+    friend class DecoderThreadBudget;
+    Lease(DecoderThreadBudget* budget, int threads);
+    void Reset();
+
+    DecoderThreadBudget* budget_ = nullptr;
+    int threads_ = 0;
+  };
+
+  // Process wide budget sized to the number of cores. Never destroyed.
+  static DecoderThreadBudget& Global();
+
+  explicit DecoderThreadBudget(int total_threads);
+  DecoderThreadBudget(const DecoderThreadBudget&) = delete;
+  DecoderThreadBudget& operator=(const DecoderThreadBudget&) = delete;
+  ~DecoderThreadBudget();
+
+  // Threads worth using for a stream of `resolution`: one for 360p, growing
+  // linearly with the pixel count (2 for 720p, 4 for 1080p, 18 for 4K) and
+  // capped at `max_threads`. Returns 1 if the resolution is unknown.
+  static int DesiredThreads(RenderResolution resolution, int max_threads);
+
+  Lease Acquire(int desired_threads);
+
+  int threads_in_use() const;
+
+ private:
+  void Release(int threads);
+
+  const int total_threads_;
+  mutable Mutex mutex_;
+  int threads_in_use_ RTC_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_VIDEO_CODING_DECODER_THREAD_BUDGET_H_
@@ -0,0 +1,74 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/video_coding/decoder_thread_budget.h"
+
+#include <utility>
+
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+TEST(DecoderThreadBudgetTest, DesiredThreadsScaleWithResolution) {
+  constexpr int kManyCores = 64;
+  EXPECT_EQ(DecoderThreadBudget::DesiredThreads(RenderResolution(), kManyCores),
+            1);
+  EXPECT_EQ(DecoderThreadBudget::DesiredThreads(RenderResolution(320, 180),
+                                                kManyCores),
+            1);
+  EXPECT_EQ(DecoderThreadBudget::DesiredThreads(RenderResolution(1280, 720),
+                                                kManyCores),
+            2);
+  EXPECT_EQ(DecoderThreadBudget::DesiredThreads(RenderResolution(1920, 1080),
+                                                kManyCores),
+            4);
+  EXPECT_EQ(DecoderThreadBudget::DesiredThreads(RenderResolution(3840, 2160),
+                                                kManyCores),
+            18);
+  EXPECT_EQ(DecoderThreadBudget::DesiredThreads(RenderResolution(3840, 2160),
+                                                /*max_threads=*/8),
+            8);
+}
+
+TEST(DecoderThreadBudgetTest, GrantsWhatIsLeftButAtLeastOneThread) {
+  DecoderThreadBudget budget(/*total_threads=*/8);
+
+  DecoderThreadBudget::Lease large = budget.Acquire(6);
+  EXPECT_EQ(large.threads(), 6);
+  DecoderThreadBudget::Lease medium = budget.Acquire(4);
+  EXPECT_EQ(medium.threads(), 2);
+  DecoderThreadBudget::Lease small = budget.Acquire(2);
+  EXPECT_EQ(small.threads(), 1);
+  EXPECT_EQ(budget.threads_in_use(), 9);
+}
+
+TEST(DecoderThreadBudgetTest, LeasesReturnThreadsWhenDestroyed) {
+  DecoderThreadBudget budget(/*total_threads=*/4);
+  {
+    DecoderThreadBudget::Lease lease = budget.Acquire(4);
+    EXPECT_EQ(budget.threads_in_use(), 4);
+
+    DecoderThreadBudget::Lease moved = std::move(lease);
+    EXPECT_EQ(lease.threads(), 0);
+    EXPECT_EQ(moved.threads(), 4);
+    EXPECT_EQ(budget.threads_in_use(), 4);
+
+    moved = DecoderThreadBudget::Lease();
+    EXPECT_EQ(budget.threads_in_use(), 0);
+    moved = budget.Acquire(3);
+    EXPECT_EQ(budget.threads_in_use(), 3);
+  }
+  EXPECT_EQ(budget.threads_in_use(), 0);
+  EXPECT_EQ(budget.Acquire(4).threads(), 4);
+}
+
+}  // namespace
+}  // namespace webrtc
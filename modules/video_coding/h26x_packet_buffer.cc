@@ -12,11 +12,14 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <utility>
 #include <vector>
 
 #include "api/array_view.h"
 #include "api/rtp_packet_info.h"
+#include "api/scoped_refptr.h"
+#include "api/video/encoded_image.h"
 #include "api/video/video_frame_type.h"
 #include "common_video/h264/h264_common.h"
 #include "common_video/h264/pps_parser.h"
@@ -37,6 +40,8 @@
 namespace webrtc {
 namespace {
 
+constexpr uint8_t kStartCode[] = {0, 0, 0, 1};
+
 int64_t EuclideanMod(int64_t n, int64_t div) {
   RTC_DCHECK_GT(div, 0);
   return (n %= div) < 0 ? n + div : n;
@@ -81,6 +86,62 @@ bool HasSps(const H26xPacketBuffer::Packet& packet) {
   });
 }
 
+// Copies `data` to `destination` and returns the end of the copy.
+uint8_t* Append(rtc::ArrayView<const uint8_t> data, uint8_t* destination) {
+  memcpy(destination, data.data(), data.size());
+  return destination + data.size();
+}
+
+// Writes the payload of an H.264 packet with start codes inserted to
+// `destination`, or only computes its size if `destination` is null. Returns
+// the number of bytes written.
+size_t WriteH264Bitstream(const H26xPacketBuffer::Packet& packet,
+                          uint8_t* destination) {
+  const auto& h264_header =
+      absl::get<RTPVideoHeaderH264>(packet.video_header.video_type_header);
+  size_t size = 0;
+  auto write = [&](rtc::ArrayView<const uint8_t> data) {
+    if (destination != nullptr) {
+      Append(data, destination + size);
+    }
+    size += data.size();
+  };
+
+  switch (h264_header.packetization_type) {
+    case kH264StapA: {
+      const uint8_t* payload_end =
+          packet.video_payload.cdata() + packet.video_payload.size();
+      const uint8_t* nalu_ptr = packet.video_payload.cdata() + 1;
+      while (nalu_ptr < payload_end - 1) {
+        // The first two bytes describe the length of the segment, where a
+        // segment is the nalu type plus nalu payload.
+        uint16_t segment_length = nalu_ptr[0] << 8 | nalu_ptr[1];
+        nalu_ptr += 2;
+
+        if (nalu_ptr + segment_length <= payload_end) {
+          write(kStartCode);
+          write(rtc::MakeArrayView(nalu_ptr, segment_length));
+        }
+        nalu_ptr += segment_length;
+      }
+      break;
+    }
+    case kH264FuA: {
+      if (IsFirstPacketOfFragment(h264_header)) {
+        write(kStartCode);
+      }
+      write(packet.video_payload);
+      break;
+    }
+    case kH264SingleNalu: {
+      write(kStartCode);
+      write(packet.video_payload);
+      break;
+    }
+  }
+  return size;
+}
+
 #ifdef RTC_ENABLE_H265
 bool HasVps(const H26xPacketBuffer::Packet& packet) {
   std::vector<H265::NaluIndex> nalu_indices = H265::FindNaluIndices(
@@ -254,6 +315,8 @@ bool H26xPacketBuffer::MaybeAssembleFrame(int64_t start_seq_num_unwrapped,
     height = std::max<int>(packet->video_header.height, height);
   }
 
+  OutOfBandParameterSets parameter_sets;
+  size_t frame_size = 0;
   for (int64_t seq_num = start_seq_num_unwrapped;
        seq_num <= end_sequence_number_unwrapped; ++seq_num) {
     auto& packet = GetPacket(seq_num);
@@ -277,16 +340,49 @@ bool H26xPacketBuffer::MaybeAssembleFrame(int64_t start_seq_num_unwrapped,
     // Only applies to H.264 because start code is inserted by depacktizer for
     // H.265 and out-of-band parameter sets is not supported by H.265.
     if (packet->codec() == kVideoCodecH264) {
-      if (!FixH264Packet(*packet)) {
+      if (!FixH264Packet(*packet, parameter_sets)) {
         // The buffer is not cleared actually, but a key frame request is
         // needed.
         result.buffer_cleared = true;
         return false;
       }
+      frame_size += WriteH264Bitstream(*packet, /*destination=*/nullptr);
+    } else {
+      frame_size += packet->video_payload.size();
     }
+  }
+  if (parameter_sets.sps != nullptr) {
+    frame_size += 2 * sizeof(kStartCode) + parameter_sets.sps->size +
+                  parameter_sets.pps->size;
+  }
 
+  // Write the bitstream of every packet into its final position, so that the
+  // frame needs neither per packet buffers nor another copy to be assembled.
+  rtc::scoped_refptr<EncodedImageBuffer> bitstream =
+      EncodedImageBuffer::Create(frame_size);
+  uint8_t* write_at = bitstream->data();
+  if (parameter_sets.sps != nullptr) {
+    write_at = Append(kStartCode, write_at);
+    write_at = Append(rtc::MakeArrayView(parameter_sets.sps->payload.get(),
+                                         parameter_sets.sps->size),
+                      write_at);
+    write_at = Append(kStartCode, write_at);
+    write_at = Append(rtc::MakeArrayView(parameter_sets.pps->payload.get(),
+                                         parameter_sets.pps->size),
+                      write_at);
+  }
+  for (int64_t seq_num = start_seq_num_unwrapped;
+       seq_num <= end_sequence_number_unwrapped; ++seq_num) {
+    auto& packet = GetPacket(seq_num);
+    if (packet->codec() == kVideoCodecH264) {
+      write_at += WriteH264Bitstream(*packet, write_at);
+    } else {
+      write_at = Append(packet->video_payload, write_at);
+    }
     result.packets.push_back(std::move(packet));
   }
+  RTC_DCHECK_EQ(write_at - bitstream->data(), bitstream->size());
+  result.bitstreams.push_back(std::move(bitstream));
 
   return true;
 }
@@ -368,154 +464,105 @@ void H26xPacketBuffer::InsertSpsPpsNalus(const std::vector<uint8_t>& sps,
 
 // TODO(bugs.webrtc.org/13157): Update the H264 depacketizer so we don't have to
 //                              fiddle with the payload at this point.
-bool H26xPacketBuffer::FixH264Packet(Packet& packet) {
-  constexpr uint8_t kStartCode[] = {0, 0, 0, 1};
+bool H26xPacketBuffer::FixH264Packet(Packet& packet,
+                                     OutOfBandParameterSets& parameter_sets) {
+  if (!h264_idr_only_keyframes_allowed_) {
+    return true;
+  }
 
   RTPVideoHeader& video_header = packet.video_header;
   RTPVideoHeaderH264& h264_header =
       absl::get<RTPVideoHeaderH264>(video_header.video_type_header);
 
-  rtc::CopyOnWriteBuffer result;
-
-  if (h264_idr_only_keyframes_allowed_) {
-    // Check if sps and pps insertion is needed.
-    bool prepend_sps_pps = false;
-    auto sps = sps_data_.end();
-    auto pps = pps_data_.end();
-
-    for (size_t i = 0; i < h264_header.nalus_length; ++i) {
-      const NaluInfo& nalu = h264_header.nalus[i];
-      switch (nalu.type) {
-        case H264::NaluType::kSps: {
-          SpsInfo& sps_info = sps_data_[nalu.sps_id];
-          sps_info.width = video_header.width;
-          sps_info.height = video_header.height;
-          break;
-        }
-        case H264::NaluType::kPps: {
-          pps_data_[nalu.pps_id].sps_id = nalu.sps_id;
-          break;
-        }
-        case H264::NaluType::kIdr: {
-          // If this is the first packet of an IDR, make sure we have the
-          // required SPS/PPS and also calculate how much extra space we need
-          // in the buffer to prepend the SPS/PPS to the bitstream with start
-          // codes.
-          if (video_header.is_first_packet_in_frame) {
-            if (nalu.pps_id == -1) {
-              RTC_LOG(LS_WARNING) << "No PPS id in IDR nalu.";
-              return false;
-            }
-
-            pps = pps_data_.find(nalu.pps_id);
-            if (pps == pps_data_.end()) {
-              RTC_LOG(LS_WARNING)
-                  << "No PPS with id << " << nalu.pps_id << " received";
-              return false;
-            }
-
-            sps = sps_data_.find(pps->second.sps_id);
-            if (sps == sps_data_.end()) {
-              RTC_LOG(LS_WARNING)
-                  << "No SPS with id << " << pps->second.sps_id << " received";
-              return false;
-            }
-
-            // Since the first packet of every keyframe should have its width
-            // and height set we set it here in the case of it being supplied
-            // out of band.
-            video_header.width = sps->second.width;
-            video_header.height = sps->second.height;
-
-            // If the SPS/PPS was supplied out of band then we will have saved
-            // the actual bitstream in `data`.
-            if (sps->second.payload && pps->second.payload) {
-              RTC_DCHECK_GT(sps->second.size, 0);
-              RTC_DCHECK_GT(pps->second.size, 0);
-              prepend_sps_pps = true;
-            }
-          }
-          break;
-        }
-        default:
-          break;
+  // Check if sps and pps insertion is needed.
+  bool prepend_sps_pps = false;
+  auto sps = sps_data_.end();
+  auto pps = pps_data_.end();
+
+  for (size_t i = 0; i < h264_header.nalus_length; ++i) {
+    const NaluInfo& nalu = h264_header.nalus[i];
+    switch (nalu.type) {
+      case H264::NaluType::kSps: {
+        SpsInfo& sps_info = sps_data_[nalu.sps_id];
+        sps_info.width = video_header.width;
+        sps_info.height = video_header.height;
+        break;
       }
-    }
-
-    RTC_CHECK(!prepend_sps_pps ||
-              (sps != sps_data_.end() && pps != pps_data_.end()));
-
-    // Insert SPS and PPS if they are missing.
-    if (prepend_sps_pps) {
-      // Insert SPS.
-      result.AppendData(kStartCode);
-      result.AppendData(sps->second.payload.get(), sps->second.size);
-
-      // Insert PPS.
-      result.AppendData(kStartCode);
-      result.AppendData(pps->second.payload.get(), pps->second.size);
-
-      // Update codec header to reflect the newly added SPS and PPS.
-      NaluInfo sps_info;
-      sps_info.type = H264::NaluType::kSps;
-      sps_info.sps_id = sps->first;
-      sps_info.pps_id = -1;
-      NaluInfo pps_info;
-      pps_info.type = H264::NaluType::kPps;
-      pps_info.sps_id = sps->first;
-      pps_info.pps_id = pps->first;
-      if (h264_header.nalus_length + 2 <= kMaxNalusPerPacket) {
-        h264_header.nalus[h264_header.nalus_length++] = sps_info;
-        h264_header.nalus[h264_header.nalus_length++] = pps_info;
-      } else {
-        RTC_LOG(LS_WARNING)
-            << "Not enough space in H.264 codec header to insert "
-               "SPS/PPS provided out-of-band.";
+      case H264::NaluType::kPps: {
+        pps_data_[nalu.pps_id].sps_id = nalu.sps_id;
+        break;
       }
-    }
-  }
+      case H264::NaluType::kIdr: {
+        // If this is the first packet of an IDR, make sure we have the
+        // required SPS/PPS and also check whether they have to be prepended
+        // to the bitstream with start codes.
+        if (video_header.is_first_packet_in_frame) {
+          if (nalu.pps_id == -1) {
+            RTC_LOG(LS_WARNING) << "No PPS id in IDR nalu.";
+            return false;
+          }
 
-  // Insert start code.
-  switch (h264_header.packetization_type) {
-    case kH264StapA: {
-      const uint8_t* payload_end =
-          packet.video_payload.data() + packet.video_payload.size();
-      const uint8_t* nalu_ptr = packet.video_payload.data() + 1;
-      while (nalu_ptr < payload_end - 1) {
-        // The first two bytes describe the length of the segment, where a
-        // segment is the nalu type plus nalu payload.
-        uint16_t segment_length = nalu_ptr[0] << 8 | nalu_ptr[1];
-        nalu_ptr += 2;
+          pps = pps_data_.find(nalu.pps_id);
+          if (pps == pps_data_.end()) {
+            RTC_LOG(LS_WARNING)
+                << "No PPS with id << " << nalu.pps_id << " received";
+            return false;
+          }
 
-        if (nalu_ptr + segment_length <= payload_end) {
-          result.AppendData(kStartCode);
-          result.AppendData(nalu_ptr, segment_length);
-        }
-        nalu_ptr += segment_length;
-      }
-      packet.video_payload = result;
-      return true;
-    }
+          sps = sps_data_.find(pps->second.sps_id);
+          if (sps == sps_data_.end()) {
+            RTC_LOG(LS_WARNING)
+                << "No SPS with id << " << pps->second.sps_id << " received";
+            return false;
+          }
 
-    case kH264FuA: {
-      if (IsFirstPacketOfFragment(h264_header)) {
-        result.AppendData(kStartCode);
+          // Since the first packet of every keyframe should have its width
+          // and height set we set it here in the case of it being supplied
+          // out of band.
+          video_header.width = sps->second.width;
+          video_header.height = sps->second.height;
+
+          // If the SPS/PPS was supplied out of band then we will have saved
+          // the actual bitstream in `data`.
+          if (sps->second.payload && pps->second.payload) {
+            RTC_DCHECK_GT(sps->second.size, 0);
+            RTC_DCHECK_GT(pps->second.size, 0);
+            prepend_sps_pps = true;
+          }
+        }
+        break;
       }
-      result.AppendData(packet.video_payload);
-      packet.video_payload = result;
-      return true;
+      default:
+        break;
     }
+  }
 
-    case kH264SingleNalu: {
-      result.AppendData(kStartCode);
-      result.AppendData(packet.video_payload);
-      packet.video_payload = result;
-      return true;
+  RTC_CHECK(!prepend_sps_pps ||
+            (sps != sps_data_.end() && pps != pps_data_.end()));
+
+  // Insert SPS and PPS if they are missing.
+  if (prepend_sps_pps) {
+    parameter_sets.sps = &sps->second;
+    parameter_sets.pps = &pps->second;
+
+    // Update codec header to reflect the newly added SPS and PPS.
+    NaluInfo sps_info;
+    sps_info.type = H264::NaluType::kSps;
+    sps_info.sps_id = sps->first;
+    sps_info.pps_id = -1;
+    NaluInfo pps_info;
+    pps_info.type = H264::NaluType::kPps;
+    pps_info.sps_id = sps->first;
+    pps_info.pps_id = pps->first;
+    if (h264_header.nalus_length + 2 <= kMaxNalusPerPacket) {
+      h264_header.nalus[h264_header.nalus_length++] = sps_info;
+      h264_header.nalus[h264_header.nalus_length++] = pps_info;
+    } else {
+      RTC_LOG(LS_WARNING) << "Not enough space in H.264 codec header to insert "
+                             "SPS/PPS provided out-of-band.";
     }
   }
-
-  RTC_DCHECK_NOTREACHED();
-  return false;
+  return true;
 }
 
 }  // namespace webrtc
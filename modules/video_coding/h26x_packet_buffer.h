@@ -71,6 +71,12 @@ class H26xPacketBuffer {
     std::unique_ptr<uint8_t[]> payload;
   };
 
+  // Parameter sets supplied out of band that have to be prepended to a frame.
+  struct OutOfBandParameterSets {
+    const SpsInfo* sps = nullptr;
+    const PpsInfo* pps = nullptr;
+  };
+
   static constexpr int kBufferSize = 2048;
 
   std::unique_ptr<Packet>& GetPacket(int64_t unwrapped_seq_num);
@@ -83,10 +89,10 @@ class H26xPacketBuffer {
   // received without SPS/PPS.
   void InsertSpsPpsNalus(const std::vector<uint8_t>& sps,
                          const std::vector<uint8_t>& pps);
-  // Insert start code and paramter sets for H.264 payload, also update header
-  // if parameter sets are inserted. Return false if required SPS or PPS is not
-  // found.
-  bool FixH264Packet(Packet& packet);
+  // Finds the parameter sets an H.264 payload needs to be prepended and
+  // updates the header if there are any. Return false if required SPS or PPS
+  // is not found.
+  bool FixH264Packet(Packet& packet, OutOfBandParameterSets& parameter_sets);
 
   // Indicates whether IDR frames without SPS and PPS are allowed.
   const bool h264_idr_only_keyframes_allowed_;
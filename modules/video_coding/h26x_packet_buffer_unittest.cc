@@ -356,9 +356,10 @@ H265Packet& H265Packet::SeqNum(uint16_t rtp_seq_num) {
 }
 #endif
 
-rtc::ArrayView<const uint8_t> PacketPayload(
-    const std::unique_ptr<H26xPacketBuffer::Packet>& packet) {
-  return packet->video_payload;
+rtc::ArrayView<const uint8_t> FrameBitstream(
+    const H26xPacketBuffer::InsertResult& result,
+    size_t frame_index = 0) {
+  return *result.bitstreams[frame_index];
 }
 
 std::vector<uint8_t> FlatVector(
@@ -374,13 +375,11 @@ TEST(H26xPacketBufferTest, IdrOnlyKeyframeWithSprop) {
   H26xPacketBuffer packet_buffer(/*h264_allow_idr_only_keyframes=*/true);
   packet_buffer.SetSpropParameterSets(kExampleSpropString);
 
-  auto packets =
-      packet_buffer
-          .InsertPacket(
-              H264Packet(kH264SingleNalu).Idr({1, 2, 3}, 0).Marker().Build())
-          .packets;
-  EXPECT_THAT(packets, SizeIs(1));
-  EXPECT_THAT(PacketPayload(packets[0]),
+  auto result = packet_buffer.InsertPacket(
+      H264Packet(kH264SingleNalu).Idr({1, 2, 3}, 0).Marker().Build());
+  EXPECT_THAT(result.packets, SizeIs(1));
+  ASSERT_THAT(result.bitstreams, SizeIs(1));
+  EXPECT_THAT(FrameBitstream(result),
               ElementsAreArray(FlatVector({StartCode(),
                                            kExampleSpropRawSps,
                                            StartCode(),
@@ -445,16 +444,15 @@ TEST(H26xPacketBufferTest, IdrOnlyKeyframeInTheMiddle) {
                   .packets,
               SizeIs(1));
 
-  auto packets = packet_buffer
-                     .InsertPacket(H264Packet(kH264SingleNalu)
-                                       .Idr({10, 11, 12}, 0)
-                                       .SeqNum(4)
-                                       .Time(2)
-                                       .Marker()
-                                       .Build())
-                     .packets;
-  EXPECT_THAT(packets, SizeIs(1));
-  EXPECT_THAT(PacketPayload(packets[0]),
+  auto result = packet_buffer.InsertPacket(H264Packet(kH264SingleNalu)
+                                                .Idr({10, 11, 12}, 0)
+                                                .SeqNum(4)
+                                                .Time(2)
+                                                .Marker()
+                                                .Build());
+  EXPECT_THAT(result.packets, SizeIs(1));
+  ASSERT_THAT(result.bitstreams, SizeIs(1));
+  EXPECT_THAT(FrameBitstream(result),
               ElementsAreArray(FlatVector({StartCode(),
                                            kExampleSpropRawSps,
                                            StartCode(),
@@ -542,21 +540,21 @@ TEST(H26xPacketBufferTest, SpsPpsIdrIsKeyframeIgnoresSprop) {
                                             .SeqNum(1)
                                             .Time(0)
                                             .Build()));
-  auto packets = packet_buffer
-                     .InsertPacket(H264Packet(kH264SingleNalu)
-                                       .Idr({7, 8, 9}, 0)
-                                       .SeqNum(2)
-                                       .Time(0)
-                                       .Marker()
-                                       .Build())
-                     .packets;
-  EXPECT_THAT(packets, SizeIs(3));
-  EXPECT_THAT(PacketPayload(packets[0]),
-              ElementsAreArray(FlatVector({StartCode(), {kSps, 1, 2, 3}})));
-  EXPECT_THAT(PacketPayload(packets[1]),
-              ElementsAreArray(FlatVector({StartCode(), {kPps, 4, 5, 6}})));
-  EXPECT_THAT(PacketPayload(packets[2]),
-              ElementsAreArray(FlatVector({StartCode(), {kIdr, 7, 8, 9}})));
+  auto result = packet_buffer.InsertPacket(H264Packet(kH264SingleNalu)
+                                                .Idr({7, 8, 9}, 0)
+                                                .SeqNum(2)
+                                                .Time(0)
+                                                .Marker()
+                                                .Build());
+  EXPECT_THAT(result.packets, SizeIs(3));
+  ASSERT_THAT(result.bitstreams, SizeIs(1));
+  EXPECT_THAT(FrameBitstream(result),
+              ElementsAreArray(FlatVector({StartCode(),
+                                           {kSps, 1, 2, 3},
+                                           StartCode(),
+                                           {kPps, 4, 5, 6},
+                                           StartCode(),
+                                           {kIdr, 7, 8, 9}})));
 }
 
 TEST(H26xPacketBufferTest, PpsIdrIsNotKeyframeSingleNalus) {
@@ -937,19 +935,18 @@ TEST(H26xPacketBufferTest, RtpSeqNumWrap) {
 TEST(H26xPacketBufferTest, StapAFixedBitstream) {
   H26xPacketBuffer packet_buffer(/*h264_allow_idr_only_keyframes=*/false);
 
-  auto packets = packet_buffer
-                     .InsertPacket(H264Packet(kH264StapA)
-                                       .Sps({1, 2, 3})
-                                       .Pps({4, 5, 6})
-                                       .Idr({7, 8, 9})
-                                       .SeqNum(0)
-                                       .Time(0)
-                                       .Marker()
-                                       .Build())
-                     .packets;
-
-  ASSERT_THAT(packets, SizeIs(1));
-  EXPECT_THAT(PacketPayload(packets[0]),
+  auto result = packet_buffer.InsertPacket(H264Packet(kH264StapA)
+                                                .Sps({1, 2, 3})
+                                                .Pps({4, 5, 6})
+                                                .Idr({7, 8, 9})
+                                                .SeqNum(0)
+                                                .Time(0)
+                                                .Marker()
+                                                .Build());
+
+  ASSERT_THAT(result.packets, SizeIs(1));
+  ASSERT_THAT(result.bitstreams, SizeIs(1));
+  EXPECT_THAT(FrameBitstream(result),
               ElementsAreArray(FlatVector({StartCode(),
                                            {kSps, 1, 2, 3},
                                            StartCode(),
@@ -965,22 +962,22 @@ TEST(H26xPacketBufferTest, SingleNaluFixedBitstream) {
       H264Packet(kH264SingleNalu).Sps({1, 2, 3}).SeqNum(0).Time(0).Build()));
   RTC_UNUSED(packet_buffer.InsertPacket(
       H264Packet(kH264SingleNalu).Pps({4, 5, 6}).SeqNum(1).Time(0).Build()));
-  auto packets = packet_buffer
-                     .InsertPacket(H264Packet(kH264SingleNalu)
-                                       .Idr({7, 8, 9})
-                                       .SeqNum(2)
-                                       .Time(0)
-                                       .Marker()
-                                       .Build())
-                     .packets;
-
-  ASSERT_THAT(packets, SizeIs(3));
-  EXPECT_THAT(PacketPayload(packets[0]),
-              ElementsAreArray(FlatVector({StartCode(), {kSps, 1, 2, 3}})));
-  EXPECT_THAT(PacketPayload(packets[1]),
-              ElementsAreArray(FlatVector({StartCode(), {kPps, 4, 5, 6}})));
-  EXPECT_THAT(PacketPayload(packets[2]),
-              ElementsAreArray(FlatVector({StartCode(), {kIdr, 7, 8, 9}})));
+  auto result = packet_buffer.InsertPacket(H264Packet(kH264SingleNalu)
+                                                .Idr({7, 8, 9})
+                                                .SeqNum(2)
+                                                .Time(0)
+                                                .Marker()
+                                                .Build());
+
+  ASSERT_THAT(result.packets, SizeIs(3));
+  ASSERT_THAT(result.bitstreams, SizeIs(1));
+  EXPECT_THAT(FrameBitstream(result),
+              ElementsAreArray(FlatVector({StartCode(),
+                                           {kSps, 1, 2, 3},
+                                           StartCode(),
+                                           {kPps, 4, 5, 6},
+                                           StartCode(),
+                                           {kIdr, 7, 8, 9}})));
 }
 
 TEST(H26xPacketBufferTest, StapaAndFuaFixedBitstream) {
@@ -998,25 +995,59 @@ TEST(H26xPacketBufferTest, StapaAndFuaFixedBitstream) {
                                             .Time(0)
                                             .AsFirstFragment()
                                             .Build()));
-  auto packets = packet_buffer
-                     .InsertPacket(H264Packet(kH264FuA)
-                                       .Idr({9, 9, 9})
-                                       .SeqNum(2)
-                                       .Time(0)
-                                       .Marker()
-                                       .Build())
-                     .packets;
-
-  ASSERT_THAT(packets, SizeIs(3));
-  EXPECT_THAT(
-      PacketPayload(packets[0]),
-      ElementsAreArray(FlatVector(
-          {StartCode(), {kSps, 1, 2, 3}, StartCode(), {kPps, 4, 5, 6}})));
-  EXPECT_THAT(PacketPayload(packets[1]),
-              ElementsAreArray(FlatVector({StartCode(), {8, 8, 8}})));
-  // Third is a continuation of second, so only the payload is expected.
-  EXPECT_THAT(PacketPayload(packets[2]),
-              ElementsAreArray(FlatVector({{9, 9, 9}})));
+  auto result = packet_buffer.InsertPacket(H264Packet(kH264FuA)
+                                                .Idr({9, 9, 9})
+                                                .SeqNum(2)
+                                                .Time(0)
+                                                .Marker()
+                                                .Build());
+
+  ASSERT_THAT(result.packets, SizeIs(3));
+  ASSERT_THAT(result.bitstreams, SizeIs(1));
+  // The third packet is a continuation of the second, so no start code is
+  // inserted in between.
+  EXPECT_THAT(FrameBitstream(result),
+              ElementsAreArray(FlatVector({StartCode(),
+                                           {kSps, 1, 2, 3},
+                                           StartCode(),
+                                           {kPps, 4, 5, 6},
+                                           StartCode(),
+                                           {8, 8, 8},
+                                           {9, 9, 9}})));
+}
+
+TEST(H26xPacketBufferTest, AssemblesOneBitstreamPerFrame) {
+  H26xPacketBuffer packet_buffer(/*h264_allow_idr_only_keyframes=*/false);
+
+  RTC_UNUSED(packet_buffer.InsertPacket(H264Packet(kH264StapA)
+                                            .Sps()
+                                            .Pps()
+                                            .Idr()
+                                            .SeqNum(0)
+                                            .Time(0)
+                                            .Marker()
+                                            .Build()));
+  RTC_UNUSED(packet_buffer.InsertPacket(H264Packet(kH264FuA)
+                                            .Slice({1, 1})
+                                            .SeqNum(1)
+                                            .Time(1)
+                                            .AsFirstFragment()
+                                            .Build()));
+  RTC_UNUSED(packet_buffer.InsertPacket(H264Packet(kH264SingleNalu)
+                                            .Slice({3, 3})
+                                            .SeqNum(3)
+                                            .Time(2)
+                                            .Marker()
+                                            .Build()));
+  auto result = packet_buffer.InsertPacket(
+      H264Packet(kH264FuA).Slice({2, 2}).SeqNum(2).Time(1).Marker().Build());
+
+  ASSERT_THAT(result.packets, SizeIs(3));
+  ASSERT_THAT(result.bitstreams, SizeIs(2));
+  EXPECT_THAT(FrameBitstream(result, 0),
+              ElementsAreArray(FlatVector({StartCode(), {1, 1}, {2, 2}})));
+  EXPECT_THAT(FrameBitstream(result, 1),
+              ElementsAreArray(FlatVector({StartCode(), {kSlice, 3, 3}})));
 }
 
 TEST(H26xPacketBufferTest, FullPacketBufferDoesNotBlockKeyframe) {
@@ -18,6 +18,7 @@
 
 #include "absl/base/attributes.h"
 #include "api/rtp_packet_info.h"
+#include "api/scoped_refptr.h"
 #include "api/units/timestamp.h"
 #include "api/video/encoded_image.h"
 #include "modules/rtp_rtcp/source/rtp_packet_received.h"
@@ -66,6 +67,10 @@ class PacketBuffer {
   };
   struct InsertResult {
     std::vector<std::unique_ptr<Packet>> packets;
+    // Bitstreams of the frames in `packets`, in order, if the packet buffer
+    // assembles them itself. Empty otherwise, in which case the payloads of
+    // the packets have to be assembled into frames.
+    std::vector<rtc::scoped_refptr<EncodedImageBuffer>> bitstreams;
     // Indicates if the packet buffer was cleared, which means that a key
     // frame request should be sent.
     bool buffer_cleared = false;
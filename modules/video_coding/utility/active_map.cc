@@ -0,0 +1,53 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/video_coding/utility/active_map.h"
+
+#include <algorithm>
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+// static
+ActiveMap ActiveMap::FromUpdateRect(int width,
+                                    int height,
+                                    const VideoFrame::UpdateRect& update_rect) {
+  RTC_DCHECK_GT(width, 0);
+  RTC_DCHECK_GT(height, 0);
+  ActiveMap active_map;
+  active_map.rows = (height + kBlockSize - 1) / kBlockSize;
+  active_map.cols = (width + kBlockSize - 1) / kBlockSize;
+  active_map.map.assign(active_map.rows * active_map.cols, 0);
+  if (update_rect.IsEmpty()) {
+    return active_map;
+  }
+
+  const int first_row = std::max(update_rect.offset_y, 0) / kBlockSize;
+  const int first_col = std::max(update_rect.offset_x, 0) / kBlockSize;
+  const int end_row = std::min(
+      (update_rect.offset_y + update_rect.height + kBlockSize - 1) / kBlockSize,
+      active_map.rows);
+  const int end_col = std::min(
+      (update_rect.offset_x + update_rect.width + kBlockSize - 1) / kBlockSize,
+      active_map.cols);
+  for (int row = first_row; row < end_row; ++row) {
+    std::fill_n(&active_map.map[row * active_map.cols + first_col],
+                std::max(end_col - first_col, 0), 1);
+  }
+  return active_map;
+}
+
+bool ActiveMap::AllActive() const {
+  return std::all_of(map.begin(), map.end(),
+                     [](uint8_t active) { return active != 0; });
+}
+
+}  // namespace webrtc
@@ -0,0 +1,43 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_VIDEO_CODING_UTILITY_ACTIVE_MAP_H_
+#define MODULES_VIDEO_CODING_UTILITY_ACTIVE_MAP_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "api/video/video_frame.h"
+
+namespace webrtc {
+
+// Marks which 16x16 blocks of a frame need to be encoded, in the layout of
+// vpx_active_map_t and aom_active_map_t: one byte per block, row by row, 1
+// for blocks to encode and 0 for blocks the encoder may skip.
+struct ActiveMap {
+  static constexpr int kBlockSize = 16;
+
+  // Marks the blocks touched by `update_rect` of a `width`x`height` frame as
+  // active.
+  static ActiveMap FromUpdateRect(int width,
+                                  int height,
+                                  const VideoFrame::UpdateRect& update_rect);
+
+  bool AllActive() const;
+
+  int rows = 0;
+  int cols = 0;
+  std::vector<uint8_t> map;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_VIDEO_CODING_UTILITY_ACTIVE_MAP_H_
@@ -0,0 +1,47 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/video_coding/utility/active_map.h"
+
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using ::testing::Each;
+using ::testing::ElementsAre;
+
+TEST(ActiveMapTest, RoundsFrameSizeUpToBlocks) {
+  ActiveMap active_map = ActiveMap::FromUpdateRect(
+      /*width=*/40, /*height=*/20, {.width = 40, .height = 20});
+  EXPECT_EQ(active_map.rows, 2);
+  EXPECT_EQ(active_map.cols, 3);
+  EXPECT_TRUE(active_map.AllActive());
+}
+
+TEST(ActiveMapTest, EmptyUpdateRectLeavesAllBlocksInactive) {
+  ActiveMap active_map = ActiveMap::FromUpdateRect(64, 64, {});
+  EXPECT_THAT(active_map.map, Each(0));
+  EXPECT_FALSE(active_map.AllActive());
+}
+
+TEST(ActiveMapTest, MarksBlocksTouchedByUpdateRect) {
+  // Touches the last pixel of block (0, 0) up to the first pixel of block
+  // (1, 2).
+  ActiveMap active_map = ActiveMap::FromUpdateRect(
+      64, 48, {.offset_x = 15, .offset_y = 15, .width = 18, .height = 2});
+  EXPECT_THAT(active_map.map, ElementsAre(1, 1, 1, 0,  //
+                                          1, 1, 1, 0,  //
+                                          0, 0, 0, 0));
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/video_coding/utility/roi_map.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+// static
+absl::optional<RoiMap> RoiMap::Create(
+    int width,
+    int height,
+    int block_size,
+    int max_segments,
+    rtc::ArrayView<const VideoFrame::QualityRegion> regions) {
+  RTC_DCHECK_GT(width, 0);
+  RTC_DCHECK_GT(height, 0);
+  RTC_DCHECK_GT(block_size, 0);
+  RTC_DCHECK_GE(max_segments, 2);
+  if (regions.empty()) {
+    return absl::nullopt;
+  }
+  RoiMap roi_map;
+  roi_map.rows = (height + block_size - 1) / block_size;
+  roi_map.cols = (width + block_size - 1) / block_size;
+  roi_map.segment_map.assign(roi_map.rows * roi_map.cols, 0);
+  roi_map.segments.push_back(Segment());
+
+  bool changes_blocks = false;
+  for (const VideoFrame::QualityRegion& region : regions) {
+    const Segment settings = {.qp_delta = region.qp_delta,
+                              .skip = region.skip};
+    auto it = std::find(roi_map.segments.begin(), roi_map.segments.end(),
+                        settings);
+    if (it == roi_map.segments.end()) {
+      if (static_cast<int>(roi_map.segments.size()) == max_segments) {
+        continue;
+      }
+      it = roi_map.segments.insert(it, settings);
+    }
+    const uint8_t segment_id = std::distance(roi_map.segments.begin(), it);
+
+    // Index of the first block whose center lies at or after `fraction`.
+    auto block_index = [&](double fraction, int size, int num_blocks) {
+      const int index =
+          static_cast<int>(std::ceil(fraction * size / block_size - 0.5));
+      return std::clamp(index, 0, num_blocks);
+    };
+    const int first_row = block_index(region.y, height, roi_map.rows);
+    const int end_row =
+        block_index(region.y + region.height, height, roi_map.rows);
+    const int first_col = block_index(region.x, width, roi_map.cols);
+    const int end_col =
+        block_index(region.x + region.width, width, roi_map.cols);
+    for (int row = first_row; row < end_row; ++row) {
+      for (int col = first_col; col < end_col; ++col) {
+        roi_map.segment_map[row * roi_map.cols + col] = segment_id;
+        changes_blocks |= segment_id != 0;
+      }
+    }
+  }
+  if (!changes_blocks) {
+    return absl::nullopt;
+  }
+  return roi_map;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,56 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_VIDEO_CODING_UTILITY_ROI_MAP_H_
+#define MODULES_VIDEO_CODING_UTILITY_ROI_MAP_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/array_view.h"
+#include "api/video/video_frame.h"
+
+namespace webrtc {
+
+// Segmentation of a frame derived from VideoFrame::quality_regions(), in the
+// layout of vpx_roi_map_t and aom_roi_map_t: one segment id per block, row by
+// row. Segment 0 holds the blocks outside all regions and is left unchanged.
+struct RoiMap {
+  struct Segment {
+    bool operator==(const Segment& other) const {
+      return qp_delta == other.qp_delta && skip == other.skip;
+    }
+
+    int qp_delta = 0;
+    bool skip = false;
+  };
+
+  // Assigns every `block_size` block of a `width`x`height` frame to the last
+  // region containing its center. Regions whose settings need more than
+  // `max_segments` segments in total are ignored. Returns nullopt if no block
+  // ends up in a region that changes it.
+  static absl::optional<RoiMap> Create(
+      int width,
+      int height,
+      int block_size,
+      int max_segments,
+      rtc::ArrayView<const VideoFrame::QualityRegion> regions);
+
+  int rows = 0;
+  int cols = 0;
+  std::vector<uint8_t> segment_map;
+  std::vector<Segment> segments;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_VIDEO_CODING_UTILITY_ROI_MAP_H_
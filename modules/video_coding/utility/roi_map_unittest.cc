@@ -0,0 +1,72 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/video_coding/utility/roi_map.h"
+
+#include <vector>
+
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using ::testing::ElementsAre;
+using Segment = RoiMap::Segment;
+
+TEST(RoiMapTest, ReturnsNulloptWithoutRegions) {
+  EXPECT_FALSE(RoiMap::Create(64, 64, 16, 8, {}).has_value());
+  std::vector<VideoFrame::QualityRegion> unchanged = {
+      {.width = 1.0, .height = 1.0}};
+  EXPECT_FALSE(RoiMap::Create(64, 64, 16, 8, unchanged).has_value());
+}
+
+TEST(RoiMapTest, AssignsBlocksByTheirCenter) {
+  // Covers the centers of the middle two of four blocks in each direction.
+  std::vector<VideoFrame::QualityRegion> regions = {
+      {.x = 0.2, .y = 0.2, .width = 0.6, .height = 0.6, .qp_delta = -10}};
+  absl::optional<RoiMap> roi_map = RoiMap::Create(64, 64, 16, 8, regions);
+  ASSERT_TRUE(roi_map.has_value());
+  EXPECT_EQ(roi_map->rows, 4);
+  EXPECT_EQ(roi_map->cols, 4);
+  EXPECT_THAT(roi_map->segment_map, ElementsAre(0, 0, 0, 0,  //
+                                                0, 1, 1, 0,  //
+                                                0, 1, 1, 0,  //
+                                                0, 0, 0, 0));
+  EXPECT_THAT(roi_map->segments,
+              ElementsAre(Segment(), Segment{.qp_delta = -10}));
+}
+
+TEST(RoiMapTest, LaterRegionsTakePrecedenceAndShareSegments) {
+  std::vector<VideoFrame::QualityRegion> regions = {
+      {.width = 1.0, .height = 0.5, .skip = true},
+      {.width = 0.5, .height = 1.0, .qp_delta = 5},
+      {.x = 0.5, .y = 0.5, .width = 0.5, .height = 0.5, .skip = true}};
+  absl::optional<RoiMap> roi_map = RoiMap::Create(32, 32, 16, 8, regions);
+  ASSERT_TRUE(roi_map.has_value());
+  EXPECT_THAT(roi_map->segment_map, ElementsAre(2, 1,  //
+                                                2, 1));
+  EXPECT_THAT(roi_map->segments,
+              ElementsAre(Segment(), Segment{.skip = true},
+                          Segment{.qp_delta = 5}));
+}
+
+TEST(RoiMapTest, IgnoresRegionsBeyondMaxSegments) {
+  std::vector<VideoFrame::QualityRegion> regions = {
+      {.width = 0.5, .height = 1.0, .qp_delta = -5},
+      {.x = 0.5, .width = 0.5, .height = 1.0, .qp_delta = 5}};
+  absl::optional<RoiMap> roi_map =
+      RoiMap::Create(32, 16, 16, /*max_segments=*/2, regions);
+  ASSERT_TRUE(roi_map.has_value());
+  EXPECT_THAT(roi_map->segment_map, ElementsAre(1, 0));
+}
+
+}  // namespace
+}  // namespace webrtc
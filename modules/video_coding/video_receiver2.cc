@@ -20,6 +20,7 @@
 #include "api/video_codecs/video_codec.h"
 #include "api/video_codecs/video_decoder.h"
 #include "modules/video_coding/decoder_database.h"
+#include "modules/video_coding/decoder_thread_budget.h"
 #include "modules/video_coding/generic_decoder.h"
 #include "modules/video_coding/include/video_coding_defines.h"
 #include "modules/video_coding/timing/timing.h"
@@ -29,12 +30,25 @@
 
 namespace webrtc {
 
+namespace {
+
+// Opts receive streams in to sharing the process wide decoder thread budget.
+DecoderThreadBudget* GetDecoderThreadBudget(
+    const FieldTrialsView& field_trials) {
+  if (!field_trials.IsEnabled("WebRTC-Video-DecoderThreadBudget")) {
+    return nullptr;
+  }
+  return &DecoderThreadBudget::Global();
+}
+
+}  // namespace
+
 VideoReceiver2::VideoReceiver2(Clock* clock,
                                VCMTiming* timing,
                                const FieldTrialsView& field_trials)
     : clock_(clock),
       decoded_frame_callback_(timing, clock_, field_trials),
-      codec_database_() {
+      codec_database_(GetDecoderThreadBudget(field_trials)) {
   decoder_sequence_checker_.Detach();
 }
 
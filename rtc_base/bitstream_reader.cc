@@ -107,15 +107,49 @@ uint32_t BitstreamReader::ReadNonSymmetric(uint32_t num_values) {
 }
 
 uint32_t BitstreamReader::ReadExponentialGolomb() {
-  // Count the number of leading 0.
+  set_last_read_is_verified(false);
+  if (remaining_bits_ <= 0) {
+    Invalidate();
+    return 0;
+  }
+  // Fast path for 0, which is encoded as a single '1'.
+  const int bit_position = (remaining_bits_ - 1) % 8;
+  if ((*bytes_ >> bit_position) & 0x01) {
+    --remaining_bits_;
+    if (bit_position == 0) {
+      ++bytes_;
+    }
+    return 0;
+  }
+
+  // Count the number of leading 0 a byte at a time rather than bit by bit,
+  // starting with the unread bits of the current byte.
+  const uint8_t* byte = bytes_;
+  int bits_in_byte = remaining_bits_ % 8 == 0 ? 8 : remaining_bits_ % 8;
+  int remaining_bits = remaining_bits_ - bits_in_byte;
+  uint8_t unread = *byte & ((1 << bits_in_byte) - 1);
   int zero_bit_count = 0;
-  while (ReadBit() == 0) {
-    if (++zero_bit_count >= 32) {
-      // Golob value won't fit into 32 bits of the return value. Fail the parse.
+  while (unread == 0) {
+    zero_bit_count += bits_in_byte;
+    if (zero_bit_count >= 32 || remaining_bits == 0) {
+      // Golomb value won't fit into 32 bits of the return value, or there is
+      // no terminating '1'. Fail the parse.
       Invalidate();
       return 0;
     }
+    unread = *++byte;
+    bits_in_byte = 8;
+    remaining_bits -= 8;
+  }
+  const int bits_after_one = absl::bit_width(unread) - 1;
+  zero_bit_count += bits_in_byte - 1 - bits_after_one;
+  if (zero_bit_count >= 32) {
+    Invalidate();
+    return 0;
   }
+  // Consume the zeros and the '1'.
+  bytes_ = bits_after_one == 0 ? byte + 1 : byte;
+  remaining_bits_ = remaining_bits + bits_after_one;
 
   // The bit count of the value is the number of zeros + 1.
   // However the first '1' was already read above.
@@ -0,0 +1,279 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/memory/frame_memory_pool.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "absl/base/attributes.h"
+#include "absl/base/config.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/memory/aligned_malloc.h"
+#if defined(WEBRTC_POSIX)
+#include <pthread.h>
+#endif
+
+namespace webrtc {
+
+namespace {
+
+// Every block starts with a header holding its size class and usable size,
+// so that Free() does not need to be told the size. Keeping the header as
+// large as the alignment keeps the memory handed out aligned.
+constexpr size_t kHeaderSize = FrameMemoryPool::kMaxAlignment;
+constexpr size_t kUsableSizeOffset = 8;
+constexpr int32_t kUnpooled = -1;
+
+// Smaller buffers are cheap to allocate and not worth caching. 4 KiB still
+// covers the encoded size of most delta frames.
+constexpr int kMinSizeClassLog2 = 12;
+constexpr int kSizeClassesPerPowerOfTwo = 4;
+constexpr int kThreadCacheSlotsPerClass = 2;
+
+size_t SizeClassBytes(int size_class) {
+  const int log2 = kMinSizeClassLog2 + size_class / kSizeClassesPerPowerOfTwo;
+  const size_t step = size_t{1} << (log2 - 2);
+  return (size_t{1} << log2) + step * (size_class % kSizeClassesPerPowerOfTwo);
+}
+
+void* AllocateBlock(size_t size, int32_t size_class) {
+  uint8_t* block = static_cast<uint8_t*>(
+      AlignedMalloc(size + kHeaderSize, FrameMemoryPool::kMaxAlignment));
+  memcpy(block, &size_class, sizeof(size_class));
+  memcpy(block + kUsableSizeOffset, &size, sizeof(size));
+  return block;
+}
+
+#if defined(WEBRTC_POSIX) && defined(ABSL_HAVE_THREAD_LOCAL)
+// The `FrameMemoryPool::ThreadCache` of the current thread, owned by the
+// pthread key that deletes it when the thread exits.
+ABSL_CONST_INIT thread_local void* current_thread_cache = nullptr;
+#endif
+
+}  // namespace
+
+class FrameMemoryPool::ThreadCache {
+ public:
+  void* Take(int size_class) {
+    for (void*& block : slots_[size_class]) {
+      if (block != nullptr) {
+        void* result = block;
+        block = nullptr;
+        return result;
+      }
+    }
+    return nullptr;
+  }
+
+  bool Put(void* block, int size_class) {
+    for (void*& slot : slots_[size_class]) {
+      if (slot == nullptr) {
+        slot = block;
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  std::array<std::array<void*, kThreadCacheSlotsPerClass>, kNumSizeClasses>
+      slots_ = {};
+};
+
+FrameMemoryPool& FrameMemoryPool::Global() {
+  static FrameMemoryPool* const pool = new FrameMemoryPool();
+  return *pool;
+}
+
+FrameMemoryPool::FrameMemoryPool() = default;
+
+FrameMemoryPool::ThreadCache* FrameMemoryPool::GetThreadCache() {
+#if defined(WEBRTC_POSIX)
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+  if (current_thread_cache != nullptr) {
+    return static_cast<ThreadCache*>(current_thread_cache);
+  }
+#endif
+  static const pthread_key_t thread_cache_key = [] {
+    pthread_key_t key;
+    RTC_CHECK_EQ(pthread_key_create(&key, &DestroyThreadCache), 0);
+    return key;
+  }();
+#if !defined(ABSL_HAVE_THREAD_LOCAL)
+  if (void* cache = pthread_getspecific(thread_cache_key)) {
+    return static_cast<ThreadCache*>(cache);
+  }
+#endif
+  ThreadCache* cache = new ThreadCache();
+  RTC_CHECK_EQ(pthread_setspecific(thread_cache_key, cache), 0);
+#if defined(ABSL_HAVE_THREAD_LOCAL)
+  current_thread_cache = cache;
+#endif
+  return cache;
+#else
+  // Without a hook to flush it when the thread exits, blocks are only kept in
+  // the shared free lists.
+  return nullptr;
+#endif
+}
+
+void FrameMemoryPool::DestroyThreadCache(void* cache) {
+#if defined(WEBRTC_POSIX) && defined(ABSL_HAVE_THREAD_LOCAL)
+  current_thread_cache = nullptr;
+#endif
+  // Blocks stay accounted as cached, they just move to the shared lists.
+  ThreadCache* thread_cache = static_cast<ThreadCache*>(cache);
+  for (int size_class = 0; size_class < kNumSizeClasses; ++size_class) {
+    while (void* block = thread_cache->Take(size_class)) {
+      Global().AddToFreeList(block, size_class);
+    }
+  }
+  delete thread_cache;
+}
+
+void* FrameMemoryPool::Allocate(size_t size, size_t alignment) {
+  RTC_DCHECK_GT(alignment, 0);
+  RTC_DCHECK_EQ(alignment & (alignment - 1), 0);
+  RTC_DCHECK_LE(alignment, kMaxAlignment);
+
+  const int size_class = SizeClass(size);
+  if (size_class < 0) {
+    return static_cast<uint8_t*>(AllocateBlock(size, kUnpooled)) + kHeaderSize;
+  }
+
+  ThreadCache* cache = GetThreadCache();
+  void* block = cache != nullptr ? cache->Take(size_class) : nullptr;
+  if (block == nullptr) {
+    MutexLock lock(&mutex_);
+    std::vector<void*>& free_list = free_lists_[size_class];
+    if (!free_list.empty()) {
+      block = free_list.back();
+      free_list.pop_back();
+    }
+  }
+  if (block != nullptr) {
+    Unreserve(SizeClassBytes(size_class));
+  } else {
+    block = AllocateBlock(SizeClassBytes(size_class), size_class);
+  }
+  return static_cast<uint8_t*>(block) + kHeaderSize;
+}
+
+void FrameMemoryPool::Free(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  void* block = static_cast<uint8_t*>(ptr) - kHeaderSize;
+  int32_t size_class;
+  memcpy(&size_class, block, sizeof(size_class));
+  if (size_class == kUnpooled) {
+    AlignedFree(block);
+    return;
+  }
+  RTC_DCHECK_GE(size_class, 0);
+  RTC_DCHECK_LT(size_class, kNumSizeClasses);
+  Global().Recycle(block, size_class);
+}
+
+size_t FrameMemoryPool::UsableSize(const void* ptr) {
+  RTC_DCHECK(ptr);
+  size_t size;
+  memcpy(&size,
+         static_cast<const uint8_t*>(ptr) - kHeaderSize + kUsableSizeOffset,
+         sizeof(size));
+  return size;
+}
+
+bool FrameMemoryPool::Pools(size_t size) const {
+  return SizeClass(size) >= 0;
+}
+
+int FrameMemoryPool::SizeClass(size_t size) const {
+  if (max_cached_bytes_.load(std::memory_order_relaxed) == 0 ||
+      size < SizeClassBytes(0)) {
+    return -1;
+  }
+  for (int size_class = 0; size_class < kNumSizeClasses; ++size_class) {
+    if (SizeClassBytes(size_class) >= size) {
+      return size_class;
+    }
+  }
+  return -1;
+}
+
+void FrameMemoryPool::SetMaxCachedBytes(size_t max_cached_bytes) {
+  max_cached_bytes_.store(max_cached_bytes, std::memory_order_relaxed);
+}
+
+bool FrameMemoryPool::enabled() const {
+  return max_cached_bytes_.load(std::memory_order_relaxed) > 0;
+}
+
+void FrameMemoryPool::Trim() {
+  if (ThreadCache* cache = GetThreadCache()) {
+    for (int size_class = 0; size_class < kNumSizeClasses; ++size_class) {
+      while (void* block = cache->Take(size_class)) {
+        Unreserve(SizeClassBytes(size_class));
+        AlignedFree(block);
+      }
+    }
+  }
+  std::array<std::vector<void*>, kNumSizeClasses> free_lists;
+  {
+    MutexLock lock(&mutex_);
+    free_lists.swap(free_lists_);
+  }
+  for (int size_class = 0; size_class < kNumSizeClasses; ++size_class) {
+    for (void* block : free_lists[size_class]) {
+      Unreserve(SizeClassBytes(size_class));
+      AlignedFree(block);
+    }
+  }
+}
+
+size_t FrameMemoryPool::cached_bytes() const {
+  return cached_bytes_.load(std::memory_order_relaxed);
+}
+
+void FrameMemoryPool::Recycle(void* block, int size_class) {
+  if (!TryReserve(SizeClassBytes(size_class))) {
+    AlignedFree(block);
+    return;
+  }
+  ThreadCache* cache = GetThreadCache();
+  if (cache == nullptr || !cache->Put(block, size_class)) {
+    AddToFreeList(block, size_class);
+  }
+}
+
+bool FrameMemoryPool::TryReserve(size_t size) {
+  const size_t max_cached_bytes =
+      max_cached_bytes_.load(std::memory_order_relaxed);
+  size_t cached = cached_bytes_.load(std::memory_order_relaxed);
+  do {
+    if (cached + size > max_cached_bytes) {
+      return false;
+    }
+  } while (!cached_bytes_.compare_exchange_weak(cached, cached + size,
+                                                std::memory_order_relaxed));
+  return true;
+}
+
+void FrameMemoryPool::Unreserve(size_t size) {
+  cached_bytes_.fetch_sub(size, std::memory_order_relaxed);
+}
+
+void FrameMemoryPool::AddToFreeList(void* block, int size_class) {
+  MutexLock lock(&mutex_);
+  free_lists_[size_class].push_back(block);
+}
+
+}  // namespace webrtc
@@ -0,0 +1,109 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_MEMORY_FRAME_MEMORY_POOL_H_
+#define RTC_BASE_MEMORY_FRAME_MEMORY_POOL_H_
+
+#include <stddef.h>
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+// Process wide pool for the pixel memory of video frame buffers and the
+// bitstream memory of encoded images.
+//
+// Requests are rounded up to size classes, four per power of two, so that
+// memory freed by a buffer of one resolution can be reused by a buffer of a
+// similar one, e.g. after a resolution switch or by another stream. Freed
+// blocks are first kept in a small cache of the freeing thread and then in
+// shared per class free lists. The memory kept idle across all threads is
+// bounded by SetMaxCachedBytes(); pooling is disabled while the bound is 0,
+// which is the default.
+//
+// All memory returned by Allocate() must be freed with Free(), e.g. through
+// FrameMemoryPoolDeleter, whether or not pooling is enabled.
+class FrameMemoryPool {
+ public:
+  // Largest alignment Allocate() supports.
+  static constexpr size_t kMaxAlignment = 64;
+
+  static FrameMemoryPool& Global();
+
+  FrameMemoryPool(const FrameMemoryPool&) = delete;
+  FrameMemoryPool& operator=(const FrameMemoryPool&) = delete;
+
+  // Returns at least `size` bytes aligned to `alignment`, which must be a
+  // power of two not larger than kMaxAlignment. The memory is not
+  // initialized.
+  void* Allocate(size_t size, size_t alignment);
+  static void Free(void* ptr);
+  // Bytes usable at `ptr`, returned by Allocate(): the size of its size class
+  // if it was pooled, and the size asked for otherwise.
+  static size_t UsableSize(const void* ptr);
+
+  // Whether Allocate() currently rounds `size` up to a size class and keeps
+  // the block for reuse once freed. Other sizes gain nothing from the pool.
+  bool Pools(size_t size) const;
+
+  // Lowering the bound below the memory currently cached only takes effect
+  // as cached blocks are reused or trimmed.
+  void SetMaxCachedBytes(size_t max_cached_bytes);
+  // Whether freed blocks may currently be kept for reuse.
+  bool enabled() const;
+  // Frees the idle blocks in the shared free lists and in the cache of the
+  // calling thread.
+  void Trim();
+
+  // Idle memory kept for reuse, including per thread caches.
+  size_t cached_bytes() const;
+
+ private:
+  class ThreadCache;
+  static constexpr int kNumSizeClasses = 56;
+
+  FrameMemoryPool();
+  ~FrameMemoryPool() = default;
+
+  // Returns the cache of the calling thread, created on first use, or null if
+  // threads can not have one on this platform.
+  static ThreadCache* GetThreadCache();
+  // Returns the size class Allocate() uses for `size`, or -1 if it does not
+  // pool blocks of that size.
+  int SizeClass(size_t size) const;
+  // Moves the blocks of a thread's cache to the shared free lists and deletes
+  // it. Called when the thread exits.
+  static void DestroyThreadCache(void* cache);
+  void Recycle(void* block, int size_class);
+  bool TryReserve(size_t size);
+  void Unreserve(size_t size);
+  void AddToFreeList(void* block, int size_class);
+
+  std::atomic<size_t> max_cached_bytes_{0};
+  std::atomic<size_t> cached_bytes_{0};
+  mutable Mutex mutex_;
+  std::array<std::vector<void*>, kNumSizeClasses> free_lists_
+      RTC_GUARDED_BY(mutex_);
+};
+
+// Deleter for use with unique_ptr, e.g.
+//   std::unique_ptr<uint8_t, FrameMemoryPoolDeleter> data;
+struct FrameMemoryPoolDeleter {
+  void operator()(void* ptr) const { FrameMemoryPool::Free(ptr); }
+};
+
+}  // namespace webrtc
+
+#endif  // RTC_BASE_MEMORY_FRAME_MEMORY_POOL_H_
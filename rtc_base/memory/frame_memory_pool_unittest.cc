@@ -0,0 +1,111 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/memory/frame_memory_pool.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "rtc_base/platform_thread.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr size_t kAlignment = 64;
+
+class FrameMemoryPoolTest : public ::testing::Test {
+ protected:
+  ~FrameMemoryPoolTest() override {
+    pool().SetMaxCachedBytes(0);
+    pool().Trim();
+  }
+
+  FrameMemoryPool& pool() { return FrameMemoryPool::Global(); }
+};
+
+TEST_F(FrameMemoryPoolTest, ReturnsAlignedWritableMemory) {
+  for (size_t size : {1, 100, 70'000, 1'000'000}) {
+    void* ptr = pool().Allocate(size, kAlignment);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % kAlignment, 0u);
+    memset(ptr, 0xab, size);
+    FrameMemoryPool::Free(ptr);
+  }
+}
+
+TEST_F(FrameMemoryPoolTest, DoesNotCacheWhenDisabled) {
+  pool().SetMaxCachedBytes(0);
+  EXPECT_FALSE(pool().enabled());
+  FrameMemoryPool::Free(pool().Allocate(1'000'000, kAlignment));
+  EXPECT_EQ(pool().cached_bytes(), 0u);
+}
+
+TEST_F(FrameMemoryPoolTest, ReusesBlocksOfTheSameSizeClass) {
+  pool().SetMaxCachedBytes(16 * 1024 * 1024);
+  // Both sizes round up to the 112 KiB class.
+  void* first = pool().Allocate(100 * 1024, kAlignment);
+  FrameMemoryPool::Free(first);
+  EXPECT_EQ(pool().cached_bytes(), 112u * 1024);
+
+  void* second = pool().Allocate(110 * 1024, kAlignment);
+  EXPECT_EQ(second, first);
+  EXPECT_EQ(pool().cached_bytes(), 0u);
+  FrameMemoryPool::Free(second);
+}
+
+TEST_F(FrameMemoryPoolTest, DoesNotCacheSmallBlocks) {
+  pool().SetMaxCachedBytes(16 * 1024 * 1024);
+  FrameMemoryPool::Free(pool().Allocate(1024, kAlignment));
+  EXPECT_EQ(pool().cached_bytes(), 0u);
+}
+
+TEST_F(FrameMemoryPoolTest, ReportsPooledSizesAndUsableSize) {
+  EXPECT_FALSE(pool().Pools(100 * 1024));
+  void* unpooled = pool().Allocate(100 * 1024, kAlignment);
+  EXPECT_EQ(FrameMemoryPool::UsableSize(unpooled), 100u * 1024);
+  FrameMemoryPool::Free(unpooled);
+
+  pool().SetMaxCachedBytes(16 * 1024 * 1024);
+  EXPECT_FALSE(pool().Pools(1024));
+  EXPECT_TRUE(pool().Pools(100 * 1024));
+  void* pooled = pool().Allocate(100 * 1024, kAlignment);
+  EXPECT_EQ(FrameMemoryPool::UsableSize(pooled), 112u * 1024);
+  FrameMemoryPool::Free(pooled);
+}
+
+TEST_F(FrameMemoryPoolTest, RespectsMaxCachedBytes) {
+  constexpr size_t kBlockSize = 128 * 1024;
+  pool().SetMaxCachedBytes(kBlockSize);
+  void* first = pool().Allocate(kBlockSize, kAlignment);
+  void* second = pool().Allocate(kBlockSize, kAlignment);
+  FrameMemoryPool::Free(first);
+  FrameMemoryPool::Free(second);
+  EXPECT_EQ(pool().cached_bytes(), kBlockSize);
+
+  pool().Trim();
+  EXPECT_EQ(pool().cached_bytes(), 0u);
+}
+
+TEST_F(FrameMemoryPoolTest, BlocksCachedByExitedThreadAreReused) {
+  pool().SetMaxCachedBytes(16 * 1024 * 1024);
+  void* block = pool().Allocate(256 * 1024, kAlignment);
+  rtc::PlatformThread::SpawnJoinable([block] { FrameMemoryPool::Free(block); },
+                                     "FreeingThread")
+      .Finalize();
+  EXPECT_EQ(pool().cached_bytes(), 256u * 1024);
+
+  void* reused = pool().Allocate(256 * 1024, kAlignment);
+  EXPECT_EQ(reused, block);
+  FrameMemoryPool::Free(reused);
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -0,0 +1,84 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include "rtc_tools/network_controller_replay/log_replay_runner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include "api/units/timestamp.h"
+#include "logging/rtc_event_log/rtc_event_log_parser.h"
+#include "rtc_base/platform_thread.h"
+#include "rtc_base/strings/string_builder.h"
+#include "system_wrappers/include/clock.h"
+#include "system_wrappers/include/cpu_info.h"
+
+namespace webrtc {
+namespace {
+
+LogReplayResult ReplayLog(const std::string& file_name,
+                          const NetworkControllerFactoryBuilder& builder,
+                          const LogReplayScoreConfig& config) {
+  Clock* clock = Clock::GetRealTimeClock();
+  Timestamp start_time = clock->CurrentTime();
+  LogReplayResult result;
+  result.file_name = file_name;
+
+  ParsedRtcEventLog parsed_log(
+      ParsedRtcEventLog::UnconfiguredHeaderExtensions::
+          kAttemptWebrtcDefaultConfig,
+      /*allow_incomplete_logs=*/true);
+  auto status = parsed_log.ParseFile(file_name);
+  if (!status.ok()) {
+    result.error = status.message();
+  } else {
+    result.score = ScoreNetworkControllerReplay(parsed_log, builder(), config);
+    if (!result.score)
+      result.error = "No transport feedback or target rate in log.";
+  }
+  result.processing_time = clock->CurrentTime() - start_time;
+  return result;
+}
+
+}  // namespace
+
+std::vector<LogReplayResult> ReplayLogsInParallel(
+    const std::vector<std::string>& file_names,
+    const NetworkControllerFactoryBuilder& factory_builder,
+    const LogReplayRunnerConfig& config) {
+  std::vector<LogReplayResult> results(file_names.size());
+  int num_threads = config.num_threads > 0
+                        ? config.num_threads
+                        : static_cast<int>(CpuInfo::DetectNumberOfCores());
+  num_threads = std::max(
+      1, std::min(num_threads, static_cast<int>(file_names.size())));
+
+  // Each worker claims the next unprocessed log, so long logs don't hold up
+  // a statically assigned share of the work.
+  std::atomic<size_t> next_index(0);
+  auto worker = [&] {
+    for (size_t i = next_index++; i < file_names.size(); i = next_index++) {
+      results[i] =
+          ReplayLog(file_names[i], factory_builder, config.score_config);
+    }
+  };
+
+  std::vector<rtc::PlatformThread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    rtc::StringBuilder name;
+    name << "LogReplay" << i;
+    threads.push_back(rtc::PlatformThread::SpawnJoinable(worker, name.str()));
+  }
+  // PlatformThread joins on destruction.
+  threads.clear();
+  return results;
+}
+
+}  // namespace webrtc
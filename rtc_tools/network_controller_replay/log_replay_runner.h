@@ -0,0 +1,55 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#ifndef RTC_TOOLS_NETWORK_CONTROLLER_REPLAY_LOG_REPLAY_RUNNER_H_
+#define RTC_TOOLS_NETWORK_CONTROLLER_REPLAY_LOG_REPLAY_RUNNER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/transport/network_control.h"
+#include "api/units/time_delta.h"
+#include "rtc_tools/network_controller_replay/log_replay_scorer.h"
+
+namespace webrtc {
+
+struct LogReplayResult {
+  std::string file_name;
+  // Empty if the log could be parsed and scored.
+  std::string error;
+  absl::optional<LogReplayScore> score;
+  // Wall clock time spent parsing and replaying the log.
+  TimeDelta processing_time = TimeDelta::Zero();
+};
+
+struct LogReplayRunnerConfig {
+  // Number of logs replayed concurrently. Zero means one per core.
+  int num_threads = 0;
+  LogReplayScoreConfig score_config;
+};
+
+// Creates a controller factory for one replay. It is called once per log,
+// possibly concurrently from several threads, so it must be thread safe.
+using NetworkControllerFactoryBuilder =
+    std::function<std::unique_ptr<NetworkControllerFactoryInterface>()>;
+
+// Parses and replays each of `file_names` through a controller built by
+// `factory_builder`, distributing the logs over a pool of worker threads.
+// The results are returned in the same order as `file_names`.
+std::vector<LogReplayResult> ReplayLogsInParallel(
+    const std::vector<std::string>& file_names,
+    const NetworkControllerFactoryBuilder& factory_builder,
+    const LogReplayRunnerConfig& config);
+
+}  // namespace webrtc
+
+#endif  // RTC_TOOLS_NETWORK_CONTROLLER_REPLAY_LOG_REPLAY_RUNNER_H_
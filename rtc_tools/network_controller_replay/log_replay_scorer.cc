@@ -0,0 +1,167 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include "rtc_tools/network_controller_replay/log_replay_scorer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/units/data_size.h"
+#include "api/units/timestamp.h"
+#include "rtc_base/strings/string_builder.h"
+#include "rtc_tools/rtc_event_log_visualizer/log_simulation.h"
+
+namespace webrtc {
+namespace {
+
+struct TargetRateSample {
+  Timestamp at_time;
+  DataRate target_rate;
+};
+
+struct ScoreBin {
+  int64_t acked_bytes = 0;
+  TimeDelta queuing_delay_sum = TimeDelta::Zero();
+  int queuing_delay_count = 0;
+};
+
+TimeDelta Percentile(const std::vector<TimeDelta>& sorted, double fraction) {
+  if (sorted.empty())
+    return TimeDelta::Zero();
+  size_t index = static_cast<size_t>(fraction * sorted.size());
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+}  // namespace
+
+absl::optional<LogReplayScore> ScoreNetworkControllerReplay(
+    const ParsedRtcEventLog& parsed_log,
+    std::unique_ptr<NetworkControllerFactoryInterface> factory,
+    const LogReplayScoreConfig& config) {
+  std::vector<TargetRateSample> targets;
+  LogBasedNetworkControllerSimulation simulation(
+      std::move(factory),
+      [&](const NetworkControlUpdate& update, Timestamp at_time) {
+        if (update.target_rate) {
+          targets.push_back({at_time, update.target_rate->target_rate});
+        }
+      });
+  simulation.ProcessEventsInLog(parsed_log);
+  if (targets.empty())
+    return absl::nullopt;
+
+  const Timestamp begin = targets.front().at_time;
+  const Timestamp end = parsed_log.last_timestamp();
+  if (end <= begin)
+    return absl::nullopt;
+
+  // The send and receive clocks are not synchronized, so the queuing delay is
+  // estimated relative to the smallest observed one-way delay.
+  std::vector<LoggedPacketInfo> packets = parsed_log.GetOutgoingPacketInfos();
+  TimeDelta min_one_way_delay = TimeDelta::PlusInfinity();
+  for (const LoggedPacketInfo& packet : packets) {
+    if (packet.reported_recv_time.IsFinite()) {
+      min_one_way_delay =
+          std::min(min_one_way_delay,
+                   packet.reported_recv_time - packet.log_packet_time);
+    }
+  }
+  if (min_one_way_delay.IsInfinite())
+    return absl::nullopt;
+
+  const TimeDelta bin_duration = config.bin_duration;
+  std::vector<ScoreBin> bins((end - begin).us() / bin_duration.us() + 1);
+  std::vector<TimeDelta> queuing_delays;
+  for (const LoggedPacketInfo& packet : packets) {
+    if (!packet.reported_recv_time.IsFinite() ||
+        packet.log_packet_time < begin || packet.log_packet_time > end) {
+      continue;
+    }
+    TimeDelta queuing_delay = packet.reported_recv_time -
+                              packet.log_packet_time - min_one_way_delay;
+    ScoreBin& bin =
+        bins[(packet.log_packet_time - begin).us() / bin_duration.us()];
+    bin.acked_bytes += packet.size + packet.overhead;
+    bin.queuing_delay_sum += queuing_delay;
+    ++bin.queuing_delay_count;
+    queuing_delays.push_back(queuing_delay);
+  }
+
+  // Sample the simulated target rate, which is a step function, at the middle
+  // of each bin and compare it with what the logged network delivered.
+  DataRate target_sum = DataRate::Zero();
+  DataRate acked_sum = DataRate::Zero();
+  DataRate used_sum = DataRate::Zero();
+  DataRate congested_target_sum = DataRate::Zero();
+  int congested_bins = 0;
+  int overshooting_bins = 0;
+  size_t target_index = 0;
+  for (size_t i = 0; i < bins.size(); ++i) {
+    Timestamp bin_center = begin + bin_duration * i + bin_duration / 2;
+    while (target_index + 1 < targets.size() &&
+           targets[target_index + 1].at_time <= bin_center) {
+      ++target_index;
+    }
+    DataRate target_rate = targets[target_index].target_rate;
+    DataRate acked_rate = DataSize::Bytes(bins[i].acked_bytes) / bin_duration;
+    target_sum += target_rate;
+    acked_sum += acked_rate;
+    used_sum += std::min(target_rate, acked_rate);
+    if (bins[i].queuing_delay_count > 0 &&
+        bins[i].queuing_delay_sum / bins[i].queuing_delay_count >
+            config.congestion_delay_threshold) {
+      ++congested_bins;
+      congested_target_sum += target_rate;
+      if (target_rate > acked_rate)
+        ++overshooting_bins;
+    }
+  }
+
+  std::sort(queuing_delays.begin(), queuing_delays.end());
+  LogReplayScore score;
+  score.duration = end - begin;
+  score.num_target_rate_updates = static_cast<int>(targets.size());
+  score.mean_target_rate = target_sum / bins.size();
+  score.mean_acked_rate = acked_sum / bins.size();
+  if (!acked_sum.IsZero())
+    score.utilization = used_sum / acked_sum;
+  if (congested_bins > 0) {
+    score.congested_overshoot =
+        static_cast<double>(overshooting_bins) / congested_bins;
+    score.congested_target_rate = congested_target_sum / congested_bins;
+  }
+  score.queuing_delay_p50 = Percentile(queuing_delays, 0.5);
+  score.queuing_delay_p95 = Percentile(queuing_delays, 0.95);
+  return score;
+}
+
+std::string LogReplayScoreCsvHeader() {
+  return "duration_s,num_target_rate_updates,mean_target_rate_kbps,"
+         "mean_acked_rate_kbps,utilization,congested_overshoot,"
+         "congested_target_rate_kbps,queuing_delay_p50_ms,"
+         "queuing_delay_p95_ms";
+}
+
+std::string LogReplayScoreToCsv(const LogReplayScore& score) {
+  rtc::StringBuilder sb;
+  sb << score.duration.seconds<double>() << ","
+     << score.num_target_rate_updates << ","
+     << score.mean_target_rate.kbps<double>() << ","
+     << score.mean_acked_rate.kbps<double>() << "," << score.utilization
+     << "," << score.congested_overshoot << ","
+     << score.congested_target_rate.kbps<double>() << ","
+     << score.queuing_delay_p50.ms<double>() << ","
+     << score.queuing_delay_p95.ms<double>();
+  return sb.Release();
+}
+
+}  // namespace webrtc
@@ -0,0 +1,73 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#ifndef RTC_TOOLS_NETWORK_CONTROLLER_REPLAY_LOG_REPLAY_SCORER_H_
+#define RTC_TOOLS_NETWORK_CONTROLLER_REPLAY_LOG_REPLAY_SCORER_H_
+
+#include <memory>
+#include <string>
+
+#include "api/transport/network_control.h"
+#include "api/units/data_rate.h"
+#include "api/units/time_delta.h"
+#include "logging/rtc_event_log/rtc_event_log_parser.h"
+
+namespace webrtc {
+
+struct LogReplayScoreConfig {
+  // Size of the bins used to compare the simulated target rate with the
+  // throughput that was acknowledged through transport feedback in the log.
+  TimeDelta bin_duration = TimeDelta::Millis(250);
+  // Bins where the mean logged queuing delay exceeds this threshold are
+  // considered congested.
+  TimeDelta congestion_delay_threshold = TimeDelta::Millis(100);
+};
+
+// Scores produced by replaying a single RTC event log through a network
+// controller. Since the network can't react to the replayed controller, the
+// throughput and delay observed in the log are used as a reference for what
+// the path could sustain.
+struct LogReplayScore {
+  // Duration between the first simulated target rate and the end of the log.
+  TimeDelta duration = TimeDelta::Zero();
+  int num_target_rate_updates = 0;
+  // Time weighted mean of the simulated target rate.
+  DataRate mean_target_rate = DataRate::Zero();
+  // Mean throughput acknowledged by transport feedback in the log.
+  DataRate mean_acked_rate = DataRate::Zero();
+  // Fraction of the acknowledged throughput that the simulated target rate
+  // would have used, in the range [0, 1].
+  double utilization = 0.0;
+  // Fraction of the congested bins in which the simulated target rate exceeded
+  // the acknowledged throughput.
+  double congested_overshoot = 0.0;
+  // Mean simulated target rate in congested bins.
+  DataRate congested_target_rate = DataRate::Zero();
+  // Percentiles of the logged queuing delay, i.e. the one-way delay from the
+  // transport feedback relative to the smallest one-way delay in the log.
+  TimeDelta queuing_delay_p50 = TimeDelta::Zero();
+  TimeDelta queuing_delay_p95 = TimeDelta::Zero();
+};
+
+// Replays the outgoing traffic in `parsed_log` through a controller created
+// by `factory` and scores the resulting target rates. Returns nullopt if the
+// log contains no transport feedback or if the controller never produced a
+// target rate.
+absl::optional<LogReplayScore> ScoreNetworkControllerReplay(
+    const ParsedRtcEventLog& parsed_log,
+    std::unique_ptr<NetworkControllerFactoryInterface> factory,
+    const LogReplayScoreConfig& config = LogReplayScoreConfig());
+
+// Returns a comma separated header matching `LogReplayScoreToCsv`.
+std::string LogReplayScoreCsvHeader();
+std::string LogReplayScoreToCsv(const LogReplayScore& score);
+
+}  // namespace webrtc
+
+#endif  // RTC_TOOLS_NETWORK_CONTROLLER_REPLAY_LOG_REPLAY_SCORER_H_
@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_tools/network_controller_replay/log_replay_scorer.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/transport/goog_cc_factory.h"
+#include "logging/rtc_event_log/rtc_event_log_parser.h"
+#include "rtc_tools/network_controller_replay/log_replay_runner.h"
+#include "test/gtest.h"
+#include "test/testsupport/file_utils.h"
+
+namespace webrtc {
+namespace {
+
+std::string TestLogPath() {
+  return test::ResourcePath("rtc_event_log/rtc_event_log_500kbps", "binarypb");
+}
+
+TEST(LogReplayScorerTest, ScoresGoogCcOnLog) {
+  ParsedRtcEventLog parsed_log;
+  ASSERT_TRUE(parsed_log.ParseFile(TestLogPath()).ok());
+
+  absl::optional<LogReplayScore> score = ScoreNetworkControllerReplay(
+      parsed_log, std::make_unique<GoogCcNetworkControllerFactory>());
+  ASSERT_TRUE(score.has_value());
+  EXPECT_GT(score->duration, TimeDelta::Zero());
+  EXPECT_GT(score->num_target_rate_updates, 0);
+  EXPECT_GT(score->mean_target_rate, DataRate::Zero());
+  EXPECT_GT(score->mean_acked_rate, DataRate::Zero());
+  EXPECT_GE(score->utilization, 0.0);
+  EXPECT_LE(score->utilization, 1.0);
+  EXPECT_GE(score->congested_overshoot, 0.0);
+  EXPECT_LE(score->congested_overshoot, 1.0);
+  EXPECT_GE(score->queuing_delay_p50, TimeDelta::Zero());
+  EXPECT_LE(score->queuing_delay_p50, score->queuing_delay_p95);
+}
+
+TEST(LogReplayScorerTest, CsvRowMatchesHeader) {
+  LogReplayScore score;
+  auto count_columns = [](const std::string& line) {
+    return std::count(line.begin(), line.end(), ',') + 1;
+  };
+  EXPECT_EQ(count_columns(LogReplayScoreCsvHeader()),
+            count_columns(LogReplayScoreToCsv(score)));
+}
+
+TEST(LogReplayRunnerTest, ReplaysLogsInParallelInInputOrder) {
+  std::vector<std::string> file_names = {TestLogPath(), "does_not_exist",
+                                         TestLogPath()};
+  LogReplayRunnerConfig config;
+  config.num_threads = 2;
+  std::vector<LogReplayResult> results = ReplayLogsInParallel(
+      file_names,
+      [] { return std::make_unique<GoogCcNetworkControllerFactory>(); },
+      config);
+
+  ASSERT_EQ(results.size(), 3u);
+  for (size_t i = 0; i < results.size(); ++i)
+    EXPECT_EQ(results[i].file_name, file_names[i]);
+  ASSERT_TRUE(results[0].score.has_value());
+  EXPECT_FALSE(results[1].score.has_value());
+  EXPECT_FALSE(results[1].error.empty());
+  ASSERT_TRUE(results[2].score.has_value());
+  EXPECT_EQ(results[0].score->mean_target_rate,
+            results[2].score->mean_target_rate);
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -0,0 +1,147 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/flags/usage.h"
+#include "api/transport/goog_cc_factory.h"
+#include "modules/congestion_controller/pcc/pcc_factory.h"
+#include "rtc_base/logging.h"
+#include "rtc_tools/network_controller_replay/log_replay_runner.h"
+#include "system_wrappers/include/field_trial.h"
+
+ABSL_FLAG(std::string,
+          controller,
+          "goog_cc",
+          "Network controller to replay the logs through, goog_cc or pcc.");
+
+ABSL_FLAG(int,
+          threads,
+          0,
+          "Number of logs to replay concurrently. 0 means one per core.");
+
+ABSL_FLAG(std::string,
+          log_list,
+          "",
+          "Optional file with one event log path per line, replayed in "
+          "addition to the logs given on the command line.");
+
+ABSL_FLAG(std::string,
+          output,
+          "",
+          "File to write the CSV scores to. Defaults to stdout.");
+
+ABSL_FLAG(
+    std::string,
+    force_fieldtrials,
+    "",
+    "Field trials control experimental feature code which can be forced. "
+    "E.g. running with --force_fieldtrials=WebRTC-FooFeature/Enabled/"
+    " will assign the group Enabled to field trial WebRTC-FooFeature. Multiple "
+    "trials are separated by \"/\"");
+
+// Replays outgoing traffic in RTC event logs through a network controller and
+// prints one line of scores per log, making it possible to compare controller
+// changes against recorded traffic without a network.
+int main(int argc, char* argv[]) {
+  absl::SetProgramUsageMessage(
+      "A tool for scoring network controllers on WebRTC event logs.\n"
+      "Example usage:\n"
+      "./network_controller_replay --controller=goog_cc "
+      "--force_fieldtrials=WebRTC-Bwe-Foo/Enabled/ <logfile> [<logfile>...]\n");
+  std::vector<char*> args = absl::ParseCommandLine(argc, argv);
+
+  // Print RTC_LOG warnings and errors even in release builds.
+  if (rtc::LogMessage::GetLogToDebug() > rtc::LS_WARNING) {
+    rtc::LogMessage::LogToDebug(rtc::LS_WARNING);
+  }
+  rtc::LogMessage::SetLogToStderr(true);
+
+  // InitFieldTrialsFromString stores the char*, so the char array must outlive
+  // the application.
+  const std::string field_trials = absl::GetFlag(FLAGS_force_fieldtrials);
+  webrtc::field_trial::InitFieldTrialsFromString(field_trials.c_str());
+
+  std::vector<std::string> file_names(args.begin() + 1, args.end());
+  const std::string log_list = absl::GetFlag(FLAGS_log_list);
+  if (!log_list.empty()) {
+    std::ifstream list_stream(log_list);
+    if (!list_stream.is_open()) {
+      std::cerr << "Failed to open " << log_list << std::endl;
+      return 1;
+    }
+    std::string line;
+    while (std::getline(list_stream, line)) {
+      if (!line.empty())
+        file_names.push_back(line);
+    }
+  }
+  if (file_names.empty()) {
+    std::cerr << absl::ProgramUsageMessage();
+    return 1;
+  }
+
+  const std::string controller = absl::GetFlag(FLAGS_controller);
+  webrtc::NetworkControllerFactoryBuilder factory_builder;
+  if (controller == "goog_cc") {
+    factory_builder = [] {
+      return std::make_unique<webrtc::GoogCcNetworkControllerFactory>();
+    };
+  } else if (controller == "pcc") {
+    factory_builder = [] {
+      return std::make_unique<webrtc::PccNetworkControllerFactory>();
+    };
+  } else {
+    std::cerr << "Unknown controller '" << controller << "'." << std::endl;
+    return 1;
+  }
+
+  webrtc::LogReplayRunnerConfig config;
+  config.num_threads = absl::GetFlag(FLAGS_threads);
+  std::vector<webrtc::LogReplayResult> results =
+      webrtc::ReplayLogsInParallel(file_names, factory_builder, config);
+
+  FILE* output = stdout;
+  const std::string output_file = absl::GetFlag(FLAGS_output);
+  if (!output_file.empty()) {
+    output = fopen(output_file.c_str(), "w");
+    if (!output) {
+      std::cerr << "Failed to open " << output_file << std::endl;
+      return 1;
+    }
+  }
+
+  int failures = 0;
+  fprintf(output, "file,processing_time_ms,%s\n",
+          webrtc::LogReplayScoreCsvHeader().c_str());
+  for (const webrtc::LogReplayResult& result : results) {
+    if (!result.score) {
+      ++failures;
+      RTC_LOG(LS_WARNING) << "Skipping " << result.file_name << ": "
+                          << result.error;
+      continue;
+    }
+    fprintf(output, "%s,%lld,%s\n", result.file_name.c_str(),
+            static_cast<long long>(result.processing_time.ms()),  // NOLINT
+            webrtc::LogReplayScoreToCsv(*result.score).c_str());
+  }
+  if (output != stdout)
+    fclose(output);
+
+  return failures == static_cast<int>(results.size()) ? 1 : 0;
+}
@@ -0,0 +1,282 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include "test/scenario/network_controller_benchmark.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "api/test/network_emulation/create_cross_traffic.h"
+#include "api/test/network_emulation/cross_traffic.h"
+#include "api/units/data_rate.h"
+#include "api/units/data_size.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/cpu_time.h"
+#include "rtc_base/random.h"
+#include "test/scenario/scenario.h"
+
+namespace webrtc {
+namespace test {
+namespace {
+
+constexpr TimeDelta kSampleInterval = TimeDelta::Millis(100);
+constexpr DataRate kMaxRate = DataRate::KilobitsPerSec(5000);
+
+NetworkSimulationConfig Link(DataRate bandwidth, TimeDelta delay) {
+  NetworkSimulationConfig config;
+  config.bandwidth = bandwidth;
+  config.delay = delay;
+  // Roughly 250 ms of buffering at 1 Mbps with 1200 byte packets.
+  config.packet_queue_length_limit = 25;
+  return config;
+}
+
+NetworkBenchmarkTrace StepTrace(absl::string_view name,
+                                DataRate first,
+                                DataRate second) {
+  NetworkBenchmarkTrace trace;
+  trace.name = std::string(name);
+  trace.initial_link = Link(first, TimeDelta::Millis(50));
+  trace.link_changes.push_back(
+      {TimeDelta::Seconds(20), Link(second, TimeDelta::Millis(50))});
+  trace.link_changes.push_back(
+      {TimeDelta::Seconds(40), Link(first, TimeDelta::Millis(50))});
+  return trace;
+}
+
+// Synthetic cellular-like trace: capacity and delay perform a bounded random
+// walk with a new value every 500 ms. Uses a fixed seed so that every run sees
+// the same link.
+NetworkBenchmarkTrace CellularTrace() {
+  NetworkBenchmarkTrace trace;
+  trace.name = "cellular";
+  Random random(0x5eed);
+  double kbps = 1500;
+  double delay_ms = 60;
+  trace.initial_link =
+      Link(DataRate::KilobitsPerSec(kbps), TimeDelta::Millis(delay_ms));
+  for (TimeDelta at = TimeDelta::Millis(500); at < trace.duration;
+       at += TimeDelta::Millis(500)) {
+    kbps = std::clamp(kbps * (1 + random.Gaussian(0, 0.15)), 200.0, 4000.0);
+    delay_ms = std::clamp(delay_ms + random.Gaussian(0, 10), 30.0, 150.0);
+    trace.link_changes.push_back(
+        {at, Link(DataRate::KilobitsPerSec(kbps),
+                  TimeDelta::Millis(static_cast<int64_t>(delay_ms)))});
+  }
+  return trace;
+}
+
+}  // namespace
+
+NetworkBenchmarkTrace::NetworkBenchmarkTrace() = default;
+NetworkBenchmarkTrace::NetworkBenchmarkTrace(const NetworkBenchmarkTrace&) =
+    default;
+NetworkBenchmarkTrace::~NetworkBenchmarkTrace() = default;
+
+NetworkControllerBenchmarkResult::NetworkControllerBenchmarkResult() = default;
+NetworkControllerBenchmarkResult::NetworkControllerBenchmarkResult(
+    const NetworkControllerBenchmarkResult&) = default;
+NetworkControllerBenchmarkResult::~NetworkControllerBenchmarkResult() = default;
+
+std::vector<NetworkBenchmarkTrace> NetworkBenchmarkTraces() {
+  std::vector<NetworkBenchmarkTrace> traces;
+  traces.push_back(StepTrace("step_down", DataRate::KilobitsPerSec(2500),
+                             DataRate::KilobitsPerSec(500)));
+  traces.push_back(StepTrace("step_up", DataRate::KilobitsPerSec(500),
+                             DataRate::KilobitsPerSec(2500)));
+  traces.push_back(CellularTrace());
+
+  NetworkBenchmarkTrace tcp;
+  tcp.name = "competing_tcp";
+  tcp.initial_link =
+      Link(DataRate::KilobitsPerSec(2000), TimeDelta::Millis(50));
+  tcp.tcp_cross_traffic.push_back(
+      {TimeDelta::Seconds(20), TimeDelta::Seconds(20)});
+  traces.push_back(tcp);
+
+  NetworkBenchmarkTrace lossy;
+  lossy.name = "random_loss";
+  lossy.initial_link =
+      Link(DataRate::KilobitsPerSec(1500), TimeDelta::Millis(50));
+  lossy.initial_link.loss_rate = 0.02;
+  traces.push_back(lossy);
+  return traces;
+}
+
+class CpuTimingNetworkControllerFactory::Controller
+    : public NetworkControllerInterface {
+ public:
+  Controller(std::unique_ptr<NetworkControllerInterface> controller,
+             CpuTimingNetworkControllerFactory* factory)
+      : controller_(std::move(controller)), factory_(factory) {}
+
+  NetworkControlUpdate OnNetworkAvailability(NetworkAvailability msg) override {
+    return controller_->OnNetworkAvailability(msg);
+  }
+  NetworkControlUpdate OnNetworkRouteChange(NetworkRouteChange msg) override {
+    return controller_->OnNetworkRouteChange(msg);
+  }
+  NetworkControlUpdate OnProcessInterval(ProcessInterval msg) override {
+    return controller_->OnProcessInterval(msg);
+  }
+  NetworkControlUpdate OnRemoteBitrateReport(RemoteBitrateReport msg) override {
+    return controller_->OnRemoteBitrateReport(msg);
+  }
+  NetworkControlUpdate OnRoundTripTimeUpdate(RoundTripTimeUpdate msg) override {
+    return controller_->OnRoundTripTimeUpdate(msg);
+  }
+  NetworkControlUpdate OnSentPacket(SentPacket msg) override {
+    return controller_->OnSentPacket(msg);
+  }
+  NetworkControlUpdate OnReceivedPacket(ReceivedPacket msg) override {
+    return controller_->OnReceivedPacket(msg);
+  }
+  NetworkControlUpdate OnStreamsConfig(StreamsConfig msg) override {
+    return controller_->OnStreamsConfig(msg);
+  }
+  NetworkControlUpdate OnTargetRateConstraints(
+      TargetRateConstraints msg) override {
+    return controller_->OnTargetRateConstraints(msg);
+  }
+  NetworkControlUpdate OnTransportLossReport(TransportLossReport msg) override {
+    return controller_->OnTransportLossReport(msg);
+  }
+  NetworkControlUpdate OnTransportPacketsFeedback(
+      TransportPacketsFeedback msg) override {
+    int64_t start_ns = rtc::GetThreadCpuTimeNanos();
+    NetworkControlUpdate update =
+        controller_->OnTransportPacketsFeedback(std::move(msg));
+    factory_->feedback_cpu_time_ns_.fetch_add(
+        rtc::GetThreadCpuTimeNanos() - start_ns, std::memory_order_relaxed);
+    factory_->feedback_count_.fetch_add(1, std::memory_order_relaxed);
+    return update;
+  }
+  NetworkControlUpdate OnNetworkStateEstimate(
+      NetworkStateEstimate msg) override {
+    return controller_->OnNetworkStateEstimate(msg);
+  }
+
+ private:
+  const std::unique_ptr<NetworkControllerInterface> controller_;
+  CpuTimingNetworkControllerFactory* const factory_;
+};
+
+CpuTimingNetworkControllerFactory::CpuTimingNetworkControllerFactory(
+    NetworkControllerFactoryInterface* factory)
+    : factory_(factory) {
+  RTC_DCHECK(factory_);
+}
+
+CpuTimingNetworkControllerFactory::~CpuTimingNetworkControllerFactory() =
+    default;
+
+std::unique_ptr<NetworkControllerInterface>
+CpuTimingNetworkControllerFactory::Create(NetworkControllerConfig config) {
+  return std::make_unique<Controller>(factory_->Create(config), this);
+}
+
+TimeDelta CpuTimingNetworkControllerFactory::GetProcessInterval() const {
+  return factory_->GetProcessInterval();
+}
+
+TimeDelta CpuTimingNetworkControllerFactory::feedback_cpu_time() const {
+  return TimeDelta::Micros(feedback_cpu_time_ns_.load() / 1000);
+}
+
+int64_t CpuTimingNetworkControllerFactory::feedback_count() const {
+  return feedback_count_.load();
+}
+
+NetworkControllerBenchmarkResult RunNetworkControllerBenchmark(
+    NetworkControllerFactoryInterface* factory,
+    const NetworkBenchmarkTrace& trace) {
+  CpuTimingNetworkControllerFactory timing_factory(factory);
+  NetworkControllerBenchmarkResult result;
+  NetworkSimulationConfig current_link = trace.initial_link;
+  double capacity_bits = 0;
+  std::vector<CrossTrafficGenerator*> tcp_generators(
+      trace.tcp_cross_traffic.size(), nullptr);
+  Scenario s;
+
+  CallClientConfig client_config;
+  client_config.transport.cc_factory = &timing_factory;
+  client_config.transport.rates.max_rate = kMaxRate;
+  auto* caller = s.CreateClient("caller", client_config);
+  auto* callee = s.CreateClient("callee", CallClientConfig());
+
+  SimulationNode* send_net = s.CreateMutableSimulationNode(trace.initial_link);
+  SimulationNode* ret_net =
+      s.CreateMutableSimulationNode([&](NetworkSimulationConfig* c) {
+        c->delay = trace.initial_link.delay;
+      });
+  auto* route =
+      s.CreateRoutes(caller, {send_net->node()}, callee, {ret_net->node()});
+  auto* video = s.CreateVideoStream(route->forward(), [](VideoStreamConfig* c) {
+    c->encoder.max_data_rate = kMaxRate;
+  });
+
+  for (const auto& change : trace.link_changes) {
+    s.At(change.at, [&, link = change.link] {
+      current_link = link;
+      send_net->UpdateConfig([&](NetworkSimulationConfig* c) { *c = link; });
+      ret_net->UpdateConfig(
+          [&](NetworkSimulationConfig* c) { c->delay = link.delay; });
+    });
+  }
+  for (size_t i = 0; i < trace.tcp_cross_traffic.size(); ++i) {
+    const auto& span = trace.tcp_cross_traffic[i];
+    s.At(span.start, [&, i] {
+      tcp_generators[i] = s.net()->StartCrossTraffic(CreateFakeTcpCrossTraffic(
+          s.net()->CreateRoute({send_net->node()}),
+          s.net()->CreateRoute({ret_net->node()}), FakeTcpConfig()));
+    });
+    s.At(span.start + span.duration,
+         [&, i] { s.net()->StopCrossTraffic(tcp_generators[i]); });
+  }
+
+  s.Every(kSampleInterval, [&] {
+    capacity_bits += (current_link.bandwidth * kSampleInterval).bits<double>();
+    result.target_rate_kbps.AddSample(caller->target_rate().kbps<double>());
+    int64_t rtt_ms = caller->GetStats().rtt_ms;
+    if (rtt_ms >= 0) {
+      TimeDelta queuing_delay =
+          TimeDelta::Millis(rtt_ms) - 2 * current_link.delay;
+      result.queuing_delay_ms.AddSample(
+          std::max(queuing_delay, TimeDelta::Zero()).ms<double>());
+    }
+  });
+
+  s.RunFor(trace.duration);
+
+  VideoReceiveStreamInterface::Stats receive_stats;
+  callee->SendTask([&] { receive_stats = video->receive()->GetStats(); });
+  const RtpReceiveStats& rtp_stats = receive_stats.rtp_stats;
+  if (capacity_bits > 0) {
+    result.utilization =
+        DataSize::Bytes(rtp_stats.packet_counter.TotalBytes()).bits<double>() /
+        capacity_bits;
+  }
+  const int64_t expected_packets =
+      rtp_stats.packet_counter.packets + rtp_stats.packets_lost;
+  if (expected_packets > 0) {
+    result.loss_ratio =
+        static_cast<double>(std::max(rtp_stats.packets_lost, 0)) /
+        expected_packets;
+  }
+  result.feedback_count = timing_factory.feedback_count();
+  if (result.feedback_count > 0) {
+    result.cpu_time_per_feedback =
+        timing_factory.feedback_cpu_time() / result.feedback_count;
+  }
+  return result;
+}
+
+}  // namespace test
+}  // namespace webrtc
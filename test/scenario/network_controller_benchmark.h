@@ -0,0 +1,109 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#ifndef TEST_SCENARIO_NETWORK_CONTROLLER_BENCHMARK_H_
+#define TEST_SCENARIO_NETWORK_CONTROLLER_BENCHMARK_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "api/numerics/samples_stats_counter.h"
+#include "api/transport/network_control.h"
+#include "api/units/time_delta.h"
+#include "test/scenario/scenario_config.h"
+
+namespace webrtc {
+namespace test {
+
+// A network trace used to benchmark bandwidth estimation. The bottleneck link
+// starts out as `initial_link` and is reconfigured at the given offsets. TCP
+// cross traffic competing for the bottleneck is started and stopped according
+// to `tcp_cross_traffic`.
+struct NetworkBenchmarkTrace {
+  struct LinkChange {
+    TimeDelta at;
+    NetworkSimulationConfig link;
+  };
+  struct CrossTrafficSpan {
+    TimeDelta start;
+    TimeDelta duration;
+  };
+
+  NetworkBenchmarkTrace();
+  NetworkBenchmarkTrace(const NetworkBenchmarkTrace&);
+  ~NetworkBenchmarkTrace();
+
+  std::string name;
+  TimeDelta duration = TimeDelta::Seconds(60);
+  NetworkSimulationConfig initial_link;
+  // Must be ordered by `at`.
+  std::vector<LinkChange> link_changes;
+  std::vector<CrossTrafficSpan> tcp_cross_traffic;
+};
+
+// Returns the fixed catalogue of traces the benchmark runs. The catalogue is
+// deterministic so that results are comparable across revisions.
+std::vector<NetworkBenchmarkTrace> NetworkBenchmarkTraces();
+
+struct NetworkControllerBenchmarkResult {
+  NetworkControllerBenchmarkResult();
+  NetworkControllerBenchmarkResult(const NetworkControllerBenchmarkResult&);
+  ~NetworkControllerBenchmarkResult();
+
+  // Media bytes delivered to the receiver divided by the bottleneck capacity
+  // integrated over the run.
+  double utilization = 0;
+  // Fraction of media packets lost.
+  double loss_ratio = 0;
+  // Sampled target rate, in kbps.
+  SamplesStatsCounter target_rate_kbps;
+  // Sampled round trip time above the propagation delay of the trace, in ms.
+  SamplesStatsCounter queuing_delay_ms;
+  // Thread CPU time spent in OnTransportPacketsFeedback per feedback message.
+  TimeDelta cpu_time_per_feedback = TimeDelta::Zero();
+  int64_t feedback_count = 0;
+};
+
+// Wraps another factory and accounts the thread CPU time spent by the created
+// controllers handling transport feedback.
+class CpuTimingNetworkControllerFactory
+    : public NetworkControllerFactoryInterface {
+ public:
+  explicit CpuTimingNetworkControllerFactory(
+      NetworkControllerFactoryInterface* factory);
+  ~CpuTimingNetworkControllerFactory() override;
+
+  std::unique_ptr<NetworkControllerInterface> Create(
+      NetworkControllerConfig config) override;
+  TimeDelta GetProcessInterval() const override;
+
+  TimeDelta feedback_cpu_time() const;
+  int64_t feedback_count() const;
+
+ private:
+  class Controller;
+
+  NetworkControllerFactoryInterface* const factory_;
+  std::atomic<int64_t> feedback_cpu_time_ns_{0};
+  std::atomic<int64_t> feedback_count_{0};
+};
+
+// Runs a single video call over `trace` using network controllers created by
+// `factory` in simulated time and returns the collected metrics.
+NetworkControllerBenchmarkResult RunNetworkControllerBenchmark(
+    NetworkControllerFactoryInterface* factory,
+    const NetworkBenchmarkTrace& trace);
+
+}  // namespace test
+}  // namespace webrtc
+
+#endif  // TEST_SCENARIO_NETWORK_CONTROLLER_BENCHMARK_H_
@@ -0,0 +1,107 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "api/test/metrics/global_metrics_logger_and_exporter.h"
+#include "api/test/metrics/metric.h"
+#include "api/transport/goog_cc_factory.h"
+#include "modules/congestion_controller/pcc/pcc_factory.h"
+#include "rtc_base/checks.h"
+#include "test/gtest.h"
+#include "test/scenario/network_controller_benchmark.h"
+
+namespace webrtc {
+namespace test {
+namespace {
+
+enum class Controller { kGoogCc, kPcc };
+
+std::string ControllerName(Controller controller) {
+  switch (controller) {
+    case Controller::kGoogCc:
+      return "goog_cc";
+    case Controller::kPcc:
+      return "pcc";
+  }
+  RTC_CHECK_NOTREACHED();
+}
+
+std::unique_ptr<NetworkControllerFactoryInterface> CreateFactory(
+    Controller controller) {
+  switch (controller) {
+    case Controller::kGoogCc:
+      return std::make_unique<GoogCcNetworkControllerFactory>();
+    case Controller::kPcc:
+      return std::make_unique<PccNetworkControllerFactory>();
+  }
+  RTC_CHECK_NOTREACHED();
+}
+
+class NetworkControllerPerfTest
+    : public ::testing::TestWithParam<std::tuple<Controller, int>> {
+ protected:
+  Controller controller() const { return std::get<0>(GetParam()); }
+  const NetworkBenchmarkTrace& trace() const {
+    static const std::vector<NetworkBenchmarkTrace>* const kTraces =
+        new std::vector<NetworkBenchmarkTrace>(NetworkBenchmarkTraces());
+    return kTraces->at(std::get<1>(GetParam()));
+  }
+};
+
+TEST_P(NetworkControllerPerfTest, RunTrace) {
+  std::unique_ptr<NetworkControllerFactoryInterface> factory =
+      CreateFactory(controller());
+  NetworkControllerBenchmarkResult result =
+      RunNetworkControllerBenchmark(factory.get(), trace());
+
+  const std::string test_case =
+      ControllerName(controller()) + "/" + trace().name;
+  MetricsLogger* logger = GetGlobalMetricsLogger();
+  logger->LogSingleValueMetric("utilization", test_case,
+                               100 * result.utilization, Unit::kPercent,
+                               ImprovementDirection::kBiggerIsBetter);
+  logger->LogSingleValueMetric("loss", test_case, 100 * result.loss_ratio,
+                               Unit::kPercent,
+                               ImprovementDirection::kSmallerIsBetter);
+  logger->LogMetric("target_rate", test_case, result.target_rate_kbps,
+                    Unit::kKilobitsPerSecond,
+                    ImprovementDirection::kNeitherIsBetter);
+  logger->LogMetric("queuing_delay", test_case, result.queuing_delay_ms,
+                    Unit::kMilliseconds,
+                    ImprovementDirection::kSmallerIsBetter);
+  logger->LogSingleValueMetric(
+      "cpu_time_per_feedback", test_case,
+      result.cpu_time_per_feedback.us<double>() / 1000, Unit::kMilliseconds,
+      ImprovementDirection::kSmallerIsBetter);
+  logger->LogSingleValueMetric("feedback_count", test_case,
+                               result.feedback_count, Unit::kCount,
+                               ImprovementDirection::kNeitherIsBetter);
+
+  EXPECT_GT(result.feedback_count, 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    All,
+    NetworkControllerPerfTest,
+    ::testing::Combine(
+        ::testing::Values(Controller::kGoogCc, Controller::kPcc),
+        ::testing::Range(0, static_cast<int>(NetworkBenchmarkTraces().size()))),
+    [](const ::testing::TestParamInfo<NetworkControllerPerfTest::ParamType>&
+           info) {
+      return ControllerName(std::get<0>(info.param)) + "_" +
+             NetworkBenchmarkTraces()[std::get<1>(info.param)].name;
+    });
+
+}  // namespace
+}  // namespace test
+}  // namespace webrtc
@@ -780,7 +780,8 @@ class Decoder : public DecodedImageCallback {
       : env_(env),
         decoder_factory_(decoder_factory),
         analyzer_(analyzer),
-        pacer_(decoder_settings.pacing_settings) {
+        pacer_(decoder_settings.pacing_settings),
+        decode_threads_(decoder_settings.decode_threads) {
     RTC_CHECK(analyzer_) << "Analyzer must be provided";
 
     if (decoder_settings.decoder_input_base_path) {
@@ -806,7 +807,8 @@ class Decoder : public DecodedImageCallback {
 
       VideoDecoder::Settings ds;
       ds.set_codec_type(*codec_type_);
-      ds.set_number_of_cores(1);
+      ds.set_number_of_cores(decode_threads_.value_or(1));
+      ds.set_decode_threads(decode_threads_);
       ds.set_max_render_resolution({1280, 720});
       bool result = decoder_->Configure(ds);
       RTC_CHECK(result) << "Failed to configure decoder";
@@ -871,6 +873,7 @@ class Decoder : public DecodedImageCallback {
   std::unique_ptr<VideoDecoder> decoder_;
   VideoCodecAnalyzer* const analyzer_;
   Pacer pacer_;
+  const absl::optional<int> decode_threads_;
   LimitedTaskQueue task_queue_;
   std::unique_ptr<TesterIvfWriter> ivf_writer_;
   std::unique_ptr<TesterY4mWriter> y4m_writer_;
@@ -163,6 +163,10 @@ class VideoCodecTester {
 
   struct DecoderSettings {
     PacingSettings pacing_settings;
+    // Number of threads the decoder may use. Also passed as the number of
+    // cores, which decoders without explicit thread control derive their
+    // threading from. If not set, decoders run single threaded.
+    absl::optional<int> decode_threads;
     absl::optional<std::string> decoder_input_base_path;
     absl::optional<std::string> decoder_output_base_path;
   };
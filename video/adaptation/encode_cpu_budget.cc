@@ -0,0 +1,145 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/adaptation/encode_cpu_budget.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "rtc_base/checks.h"
+#include "video/frame_load_accumulator.h"
+
+namespace webrtc {
+
+struct EncodeCpuBudget::Stream::State {
+  // Counted by OnEncodeCpuTime() and moved into `frames` on updates. The two
+  // counters are not updated together, so an update may take the CPU time of
+  // a frame without the frame, which only skews a single interval.
+  std::atomic<int> pending_frames{0};
+  std::atomic<int64_t> pending_cpu_time_us{0};
+  // Input frames and the CPU time spent encoding them.
+  FrameLoadAccumulator frames;
+};
+
+EncodeCpuBudget::Stream::Stream(EncodeCpuBudget* budget, State* state)
+    : budget_(budget), state_(state) {}
+
+EncodeCpuBudget::Stream::~Stream() {
+  budget_->Unregister(state_);
+}
+
+void EncodeCpuBudget::Stream::OnEncodeCpuTime(TimeDelta cpu_time) {
+  state_->pending_cpu_time_us.fetch_add(cpu_time.us(),
+                                        std::memory_order_relaxed);
+  state_->pending_frames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EncodeCpuBudget::Stream::Reset() {
+  MutexLock lock(&budget_->mutex_);
+  state_->pending_frames.store(0, std::memory_order_relaxed);
+  state_->pending_cpu_time_us.store(0, std::memory_order_relaxed);
+  state_->frames.Reset();
+}
+
+absl::optional<double> EncodeCpuBudget::Stream::load() const {
+  MutexLock lock(&budget_->mutex_);
+  budget_->MaybeUpdate();
+  return state_->frames.load();
+}
+
+absl::optional<double> EncodeCpuBudget::Stream::usage() const {
+  MutexLock lock(&budget_->mutex_);
+  budget_->MaybeUpdate();
+  const absl::optional<double> load = state_->frames.load();
+  if (!load) {
+    return absl::nullopt;
+  }
+  const double others = budget_->LoadLocked() - *load;
+  const double allowance =
+      std::max(budget_->capacity_ / budget_->streams_.size(),
+               budget_->capacity_ - others);
+  if (allowance <= 0.0) {
+    return absl::nullopt;
+  }
+  return *load / allowance;
+}
+
+EncodeCpuBudget& EncodeCpuBudget::Global() {
+  static EncodeCpuBudget* const budget = new EncodeCpuBudget(
+      Clock::GetRealTimeClock(), {.capacity = DefaultFrameLoadCapacity()});
+  return *budget;
+}
+
+EncodeCpuBudget::EncodeCpuBudget(Clock* clock, Config config)
+    : clock_(clock),
+      config_(config),
+      capacity_(config.capacity),
+      last_update_(clock_->CurrentTime()) {}
+
+EncodeCpuBudget::~EncodeCpuBudget() {
+  RTC_DCHECK(streams_.empty());
+}
+
+std::unique_ptr<EncodeCpuBudget::Stream> EncodeCpuBudget::RegisterStream() {
+  auto state = std::make_unique<Stream::State>();
+  Stream::State* state_ptr = state.get();
+  MutexLock lock(&mutex_);
+  streams_.push_back(std::move(state));
+  return absl::WrapUnique(new Stream(this, state_ptr));
+}
+
+void EncodeCpuBudget::SetCapacity(double capacity) {
+  MutexLock lock(&mutex_);
+  capacity_ = capacity;
+}
+
+double EncodeCpuBudget::load() const {
+  MutexLock lock(&mutex_);
+  MaybeUpdate();
+  return LoadLocked();
+}
+
+void EncodeCpuBudget::Unregister(Stream::State* state) {
+  MutexLock lock(&mutex_);
+  streams_.remove_if([state](const std::unique_ptr<Stream::State>& s) {
+    return s.get() == state;
+  });
+}
+
+void EncodeCpuBudget::MaybeUpdate() const {
+  const Timestamp now = clock_->CurrentTime();
+  const TimeDelta elapsed = now - last_update_;
+  if (elapsed < config_.update_interval) {
+    return;
+  }
+  last_update_ = now;
+  for (const std::unique_ptr<Stream::State>& state : streams_) {
+    const int frames =
+        state->pending_frames.exchange(0, std::memory_order_relaxed);
+    const int64_t cpu_time_us =
+        state->pending_cpu_time_us.exchange(0, std::memory_order_relaxed);
+    state->frames.OnFramesProcessed(frames, TimeDelta::Micros(cpu_time_us));
+    state->frames.Update(elapsed);
+  }
+}
+
+double EncodeCpuBudget::LoadLocked() const {
+  double load = 0.0;
+  for (const std::unique_ptr<Stream::State>& state : streams_) {
+    load += state->frames.load().value_or(0.0);
+  }
+  return load;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,115 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VIDEO_ADAPTATION_ENCODE_CPU_BUDGET_H_
+#define VIDEO_ADAPTATION_ENCODE_CPU_BUDGET_H_
+
+#include <atomic>
+#include <list>
+#include <memory>
+
+#include "absl/types/optional.h"
+#include "api/units/time_delta.h"
+#include "api/units/timestamp.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+#include "system_wrappers/include/clock.h"
+
+namespace webrtc {
+
+// Tells each send stream how much of the CPU time available for encoding it
+// uses, as input to its OveruseFrameDetector.
+//
+// A stream may use whatever the other streams leave of the capacity, and at
+// least an equal share of it. Its usage is its CPU time per second relative to
+// that allowance, so when the process runs out of budget the streams using the
+// most CPU are the first to exceed their allowance, while streams below their
+// equal share are unaffected. The budget itself never limits a stream; each
+// stream adapts on its own. Unlike wall clock encode time, CPU time does not
+// grow when the encoder thread waits for a core, so the usage stays stable on
+// busy machines.
+class EncodeCpuBudget {
+ public:
+  struct Config {
+    // CPU time encoding can use per second, e.g. 2.0 for two cores.
+    double capacity = 1.0;
+    // How often load estimates are updated.
+    TimeDelta update_interval = TimeDelta::Seconds(1);
+  };
+
+  // Registration of a send stream. Unregisters on destruction. Methods may be
+  // called from any thread.
+  class Stream {
+   public:
+    ~Stream();
+
+    Stream(const Stream&) = delete;
+    Stream& operator=(const Stream&) = delete;
+
+    // Called with the CPU time spent encoding an input frame. Does not take
+    // the lock of the budget, so that streams encoding on different threads
+    // do not contend on every frame; the time is picked up by the next
+    // update.
+    void OnEncodeCpuTime(TimeDelta cpu_time);
+    // Forgets the load estimate of this stream, e.g. after a resolution
+    // change.
+    void Reset();
+
+    // Estimated CPU seconds per second used by this stream. Unset until the
+    // first estimate.
+    absl::optional<double> load() const;
+    // `load()` relative to the allowance of this stream, 1.0 meaning that the
+    // whole allowance is used.
+    absl::optional<double> usage() const;
+
+   private:
+    friend class EncodeCpuBudget;
+    struct State;
+
+    Stream(EncodeCpuBudget* budget, State* state);
+
+    EncodeCpuBudget* const budget_;
+    State* const state_;
+  };
+
+  // Budget shared by all send streams that opt in with the field trial
+  // "WebRTC-CpuOveruse-CpuTime", with DefaultFrameLoadCapacity().
+  static EncodeCpuBudget& Global();
+
+  EncodeCpuBudget(Clock* clock, Config config);
+  ~EncodeCpuBudget();
+
+  EncodeCpuBudget(const EncodeCpuBudget&) = delete;
+  EncodeCpuBudget& operator=(const EncodeCpuBudget&) = delete;
+
+  std::unique_ptr<Stream> RegisterStream();
+
+  void SetCapacity(double capacity);
+
+  // Estimated CPU seconds per second used by all streams.
+  double load() const;
+
+ private:
+  void Unregister(Stream::State* state);
+  // Updates the load estimates if `update_interval` has passed.
+  void MaybeUpdate() const RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  double LoadLocked() const RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  Clock* const clock_;
+  const Config config_;
+  mutable Mutex mutex_;
+  double capacity_ RTC_GUARDED_BY(mutex_);
+  mutable Timestamp last_update_ RTC_GUARDED_BY(mutex_);
+  std::list<std::unique_ptr<Stream::State>> streams_ RTC_GUARDED_BY(mutex_);
+};
+
+}  // namespace webrtc
+
+#endif  // VIDEO_ADAPTATION_ENCODE_CPU_BUDGET_H_
@@ -0,0 +1,119 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/adaptation/encode_cpu_budget.h"
+
+#include <memory>
+
+#include "absl/types/optional.h"
+#include "system_wrappers/include/clock.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using ::testing::DoubleNear;
+using ::testing::Optional;
+
+constexpr TimeDelta kFrameInterval = TimeDelta::Millis(40);
+
+class EncodeCpuBudgetTest : public ::testing::Test {
+ protected:
+  EncodeCpuBudgetTest()
+      : clock_(Timestamp::Seconds(1000)), budget_(&clock_, {.capacity = 1.0}) {}
+
+  // Encodes 25 fps on `stream` for `duration`, spending `cpu_time` per frame.
+  void Run(TimeDelta duration,
+           EncodeCpuBudget::Stream& stream,
+           TimeDelta cpu_time) {
+    for (TimeDelta t = TimeDelta::Zero(); t < duration; t += kFrameInterval) {
+      clock_.AdvanceTime(kFrameInterval);
+      stream.OnEncodeCpuTime(cpu_time);
+    }
+  }
+
+  SimulatedClock clock_;
+  EncodeCpuBudget budget_;
+};
+
+TEST_F(EncodeCpuBudgetTest, HasNoEstimateBeforeFirstUpdate) {
+  auto stream = budget_.RegisterStream();
+  stream->OnEncodeCpuTime(TimeDelta::Millis(10));
+  EXPECT_EQ(stream->load(), absl::nullopt);
+  EXPECT_EQ(stream->usage(), absl::nullopt);
+}
+
+TEST_F(EncodeCpuBudgetTest, EstimatesLoadFromCpuTime) {
+  auto stream = budget_.RegisterStream();
+  Run(TimeDelta::Seconds(3), *stream, TimeDelta::Millis(10));
+
+  EXPECT_THAT(stream->load(), Optional(DoubleNear(0.25, 0.02)));
+  EXPECT_THAT(stream->usage(), Optional(DoubleNear(0.25, 0.02)));
+  EXPECT_NEAR(budget_.load(), 0.25, 0.02);
+}
+
+TEST_F(EncodeCpuBudgetTest, StreamMayUseWhatOthersLeave) {
+  auto light = budget_.RegisterStream();
+  auto heavy = budget_.RegisterStream();
+  for (int i = 0; i < 3 * 25; ++i) {
+    clock_.AdvanceTime(kFrameInterval);
+    light->OnEncodeCpuTime(TimeDelta::Millis(4));
+    heavy->OnEncodeCpuTime(TimeDelta::Millis(20));
+  }
+
+  // The light stream uses 0.1 and leaves 0.9 of the capacity to the heavy one,
+  // which uses 0.5 of it.
+  EXPECT_THAT(heavy->usage(), Optional(DoubleNear(0.5 / 0.9, 0.03)));
+  // The light stream is measured against its equal share.
+  EXPECT_THAT(light->usage(), Optional(DoubleNear(0.1 / 0.5, 0.03)));
+}
+
+TEST_F(EncodeCpuBudgetTest, HeaviestStreamExceedsItsAllowanceFirst) {
+  budget_.SetCapacity(0.4);
+  auto light = budget_.RegisterStream();
+  auto heavy = budget_.RegisterStream();
+  for (int i = 0; i < 3 * 25; ++i) {
+    clock_.AdvanceTime(kFrameInterval);
+    light->OnEncodeCpuTime(TimeDelta::Millis(4));
+    heavy->OnEncodeCpuTime(TimeDelta::Millis(20));
+  }
+
+  EXPECT_THAT(heavy->usage(), Optional(DoubleNear(0.5 / 0.3, 0.1)));
+  EXPECT_THAT(light->usage(), Optional(DoubleNear(0.1 / 0.2, 0.05)));
+}
+
+TEST_F(EncodeCpuBudgetTest, ResetForgetsEstimate) {
+  auto stream = budget_.RegisterStream();
+  Run(TimeDelta::Seconds(2), *stream, TimeDelta::Millis(10));
+  ASSERT_TRUE(stream->load());
+
+  stream->Reset();
+  EXPECT_EQ(stream->load(), absl::nullopt);
+  Run(TimeDelta::Seconds(1), *stream, TimeDelta::Millis(20));
+  EXPECT_THAT(stream->load(), Optional(DoubleNear(0.5, 0.03)));
+}
+
+TEST_F(EncodeCpuBudgetTest, UnregisteredStreamNoLongerAddsLoad) {
+  auto first = budget_.RegisterStream();
+  auto second = budget_.RegisterStream();
+  for (int i = 0; i < 2 * 25; ++i) {
+    clock_.AdvanceTime(kFrameInterval);
+    first->OnEncodeCpuTime(TimeDelta::Millis(10));
+    second->OnEncodeCpuTime(TimeDelta::Millis(10));
+  }
+  ASSERT_NEAR(budget_.load(), 0.5, 0.03);
+
+  second = nullptr;
+  EXPECT_NEAR(budget_.load(), 0.25, 0.02);
+}
+
+}  // namespace
+}  // namespace webrtc
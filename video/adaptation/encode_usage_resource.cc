@@ -85,6 +85,16 @@ void EncodeUsageResource::OnEncodeCompleted(
                                encode_duration_us);
 }
 
+void EncodeUsageResource::OnEncodeCpuTimeMeasured(TimeDelta cpu_time) {
+  RTC_DCHECK_RUN_ON(encoder_queue());
+  overuse_detector_->FrameEncodeCpuTimeMeasured(cpu_time);
+}
+
+bool EncodeUsageResource::MeasuresCpuTime() const {
+  RTC_DCHECK_RUN_ON(encoder_queue());
+  return overuse_detector_->MeasuresCpuTime();
+}
+
 void EncodeUsageResource::AdaptUp() {
   RTC_DCHECK_RUN_ON(encoder_queue());
   OnResourceUsageStateMeasured(ResourceUsageState::kUnderuse);
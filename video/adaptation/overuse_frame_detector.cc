@@ -155,6 +155,8 @@ class SendProcessingUsage1 : public OveruseFrameDetector::ProcessingUsage {
     return encode_duration_us;
   }
 
+  void FrameEncodeCpuTimeMeasured(TimeDelta /* cpu_time */) override {}
+
   int Value() override {
     if (count_ < static_cast<uint32_t>(options_.min_frame_samples)) {
       return static_cast<int>(InitialUsageInPercent() + 0.5f);
@@ -268,6 +270,8 @@ class SendProcessingUsage2 : public OveruseFrameDetector::ProcessingUsage {
     return encode_duration_us;
   }
 
+  void FrameEncodeCpuTimeMeasured(TimeDelta /* cpu_time */) override {}
+
  private:
   void AddSample(double encode_time, double diff_time) {
     RTC_CHECK_GE(diff_time, 0.0);
@@ -330,6 +334,55 @@ class SendProcessingUsage2 : public OveruseFrameDetector::ProcessingUsage {
   double load_estimate_;
 };
 
+// Estimates the load from the CPU time spent encoding, as the larger of the
+// fraction of a core used by the encoding thread and the used share of the
+// allowance of the stream in `budget`. The wall clock encode time is only
+// passed through for stats.
+class CpuTimeProcessingUsage : public OveruseFrameDetector::ProcessingUsage {
+ public:
+  CpuTimeProcessingUsage(const CpuOveruseOptions& options,
+                         EncodeCpuBudget* budget)
+      : options_(options), stream_(budget->RegisterStream()) {}
+  ~CpuTimeProcessingUsage() override = default;
+
+  void Reset() override { stream_->Reset(); }
+
+  void SetMaxSampleDiffMs(float /* diff_ms */) override {}
+
+  void FrameCaptured(const VideoFrame& frame,
+                     int64_t time_when_first_seen_us,
+                     int64_t last_capture_time_us) override {}
+
+  absl::optional<int> FrameSent(
+      uint32_t /* timestamp */,
+      int64_t /* time_sent_in_us */,
+      int64_t /* capture_time_us */,
+      absl::optional<int> encode_duration_us) override {
+    return encode_duration_us;
+  }
+
+  void FrameEncodeCpuTimeMeasured(TimeDelta cpu_time) override {
+    stream_->OnEncodeCpuTime(cpu_time);
+  }
+
+  int Value() override {
+    absl::optional<double> load = stream_->load();
+    absl::optional<double> usage = stream_->usage();
+    if (!load || !usage) {
+      // Start in between the underuse and overuse threshold.
+      return static_cast<int>((options_.low_encode_usage_threshold_percent +
+                               options_.high_encode_usage_threshold_percent) /
+                                  2.0 +
+                              0.5);
+    }
+    return static_cast<int>(100.0 * std::max(*load, *usage) + 0.5);
+  }
+
+ private:
+  const CpuOveruseOptions options_;
+  const std::unique_ptr<EncodeCpuBudget::Stream> stream_;
+};
+
 // Class used for manual testing of overuse, enabled via field trial flag.
 class OverdoseInjector : public OveruseFrameDetector::ProcessingUsage {
  public:
@@ -375,6 +428,10 @@ class OverdoseInjector : public OveruseFrameDetector::ProcessingUsage {
                              encode_duration_us);
   }
 
+  void FrameEncodeCpuTimeMeasured(TimeDelta cpu_time) override {
+    usage_->FrameEncodeCpuTimeMeasured(cpu_time);
+  }
+
   int Value() override {
     int64_t now_ms = rtc::TimeMillis();
     if (last_toggling_ms_ == -1) {
@@ -433,9 +490,12 @@ class OverdoseInjector : public OveruseFrameDetector::ProcessingUsage {
 
 std::unique_ptr<OveruseFrameDetector::ProcessingUsage>
 OveruseFrameDetector::CreateProcessingUsage(const FieldTrialsView& field_trials,
-                                            const CpuOveruseOptions& options) {
+                                            const CpuOveruseOptions& options,
+                                            EncodeCpuBudget* cpu_budget) {
   std::unique_ptr<ProcessingUsage> instance;
-  if (options.filter_time_ms > 0) {
+  if (cpu_budget != nullptr) {
+    instance = std::make_unique<CpuTimeProcessingUsage>(options, cpu_budget);
+  } else if (options.filter_time_ms > 0) {
     instance = std::make_unique<SendProcessingUsage2>(options);
   } else {
     instance = std::make_unique<SendProcessingUsage1>(options);
@@ -470,6 +530,12 @@ OveruseFrameDetector::CreateProcessingUsage(const FieldTrialsView& field_trials,
 OveruseFrameDetector::OveruseFrameDetector(
     const Environment& env,
     CpuOveruseMetricsObserver* metrics_observer)
+    : OveruseFrameDetector(env, metrics_observer, /*cpu_budget=*/nullptr) {}
+
+OveruseFrameDetector::OveruseFrameDetector(
+    const Environment& env,
+    CpuOveruseMetricsObserver* metrics_observer,
+    EncodeCpuBudget* cpu_budget)
     : env_(env),
       metrics_observer_(metrics_observer),
       num_process_times_(0),
@@ -482,10 +548,17 @@ OveruseFrameDetector::OveruseFrameDetector(
       num_overuse_detections_(0),
       last_rampup_time_ms_(-1),
       in_quick_rampup_(false),
-      current_rampup_delay_ms_(kStandardRampUpDelayMs) {
+      current_rampup_delay_ms_(kStandardRampUpDelayMs),
+      cpu_budget_(cpu_budget) {
   task_checker_.Detach();
   ParseFieldTrial({&filter_time_constant_},
                   env_.field_trials().Lookup("WebRTC-CpuLoadEstimator"));
+  FieldTrialFlag use_cpu_time("Enabled");
+  ParseFieldTrial({&use_cpu_time},
+                  env_.field_trials().Lookup("WebRTC-CpuOveruse-CpuTime"));
+  if (cpu_budget_ == nullptr && use_cpu_time) {
+    cpu_budget_ = &EncodeCpuBudget::Global();
+  }
 }
 
 OveruseFrameDetector::~OveruseFrameDetector() {}
@@ -582,6 +655,15 @@ void OveruseFrameDetector::FrameSent(uint32_t timestamp,
   }
 }
 
+void OveruseFrameDetector::FrameEncodeCpuTimeMeasured(TimeDelta cpu_time) {
+  RTC_DCHECK_RUN_ON(&task_checker_);
+  usage_->FrameEncodeCpuTimeMeasured(cpu_time);
+}
+
+bool OveruseFrameDetector::MeasuresCpuTime() const {
+  return cpu_budget_ != nullptr;
+}
+
 void OveruseFrameDetector::CheckForOveruse(
     OveruseFrameDetectorObserverInterface* observer) {
   RTC_DCHECK_RUN_ON(&task_checker_);
@@ -648,7 +730,7 @@ void OveruseFrameDetector::SetOptions(const CpuOveruseOptions& options) {
   }
   // Force reset with next frame.
   num_pixels_ = 0;
-  usage_ = CreateProcessingUsage(env_.field_trials(), options);
+  usage_ = CreateProcessingUsage(env_.field_trials(), options, cpu_budget_);
 }
 
 bool OveruseFrameDetector::IsOverusing(int usage_percent) {
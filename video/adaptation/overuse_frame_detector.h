@@ -19,11 +19,13 @@
 #include "api/field_trials_view.h"
 #include "api/sequence_checker.h"
 #include "api/task_queue/task_queue_base.h"
+#include "api/units/time_delta.h"
 #include "rtc_base/experiments/field_trial_parser.h"
 #include "rtc_base/numerics/exp_filter.h"
 #include "rtc_base/system/no_unique_address.h"
 #include "rtc_base/task_utils/repeating_task.h"
 #include "rtc_base/thread_annotations.h"
+#include "video/adaptation/encode_cpu_budget.h"
 #include "video/video_stream_encoder_observer.h"
 
 namespace webrtc {
@@ -72,10 +74,18 @@ class OveruseFrameDetectorObserverInterface {
 // be created and destroyed on an arbitrary thread.
 // OveruseFrameDetector::StartCheckForOveruse  must be called to periodically
 // check for overuse.
+//
+// With the field trial "WebRTC-CpuOveruse-CpuTime/Enabled/", or if
+// `cpu_budget` is set, the load is estimated from the CPU time spent encoding
+// instead of the wall clock encode time, and shared with the other streams
+// through an EncodeCpuBudget.
 class OveruseFrameDetector {
  public:
   OveruseFrameDetector(const Environment& env,
                        CpuOveruseMetricsObserver* metrics_observer);
+  OveruseFrameDetector(const Environment& env,
+                       CpuOveruseMetricsObserver* metrics_observer,
+                       EncodeCpuBudget* cpu_budget);
   virtual ~OveruseFrameDetector();
 
   OveruseFrameDetector(const OveruseFrameDetector&) = delete;
@@ -107,6 +117,12 @@ class OveruseFrameDetector {
                  int64_t capture_time_us,
                  absl::optional<int> encode_duration_us);
 
+  // Called with the CPU time the encoding thread spent on an input frame.
+  void FrameEncodeCpuTimeMeasured(TimeDelta cpu_time);
+  // True if the load is estimated from CPU time, i.e. if
+  // FrameEncodeCpuTimeMeasured() needs to be called.
+  bool MeasuresCpuTime() const;
+
   // Interface for cpu load estimation. Intended for internal use only.
   class ProcessingUsage {
    public:
@@ -123,6 +139,7 @@ class OveruseFrameDetector {
         // And these two by the new estimator.
         int64_t capture_time_us,
         absl::optional<int> encode_duration_us) = 0;
+    virtual void FrameEncodeCpuTimeMeasured(TimeDelta cpu_time) = 0;
 
     virtual int Value() = 0;
     virtual ~ProcessingUsage() = default;
@@ -147,7 +164,8 @@ class OveruseFrameDetector {
 
   static std::unique_ptr<ProcessingUsage> CreateProcessingUsage(
       const FieldTrialsView& field_trials,
-      const CpuOveruseOptions& options);
+      const CpuOveruseOptions& options,
+      EncodeCpuBudget* cpu_budget);
 
   const Environment env_;
   RTC_NO_UNIQUE_ADDRESS SequenceChecker task_checker_;
@@ -176,6 +194,9 @@ class OveruseFrameDetector {
 
   // If set by field trial, overrides CpuOveruseOptions::filter_time_ms.
   FieldTrialOptional<TimeDelta> filter_time_constant_{"tau"};
+  // Budget to share encode CPU time with, if estimating the load from CPU
+  // time.
+  EncodeCpuBudget* cpu_budget_ = nullptr;
 };
 
 }  // namespace webrtc
@@ -22,8 +22,10 @@
 #include "rtc_base/fake_clock.h"
 #include "rtc_base/random.h"
 #include "rtc_base/task_queue_for_test.h"
+#include "system_wrappers/include/clock.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
+#include "video/adaptation/encode_cpu_budget.h"
 
 namespace webrtc {
 
@@ -65,6 +67,10 @@ class OveruseFrameDetectorUnderTest : public OveruseFrameDetector {
       const Environment& env,
       CpuOveruseMetricsObserver* metrics_observer)
       : OveruseFrameDetector(env, metrics_observer) {}
+  OveruseFrameDetectorUnderTest(const Environment& env,
+                                CpuOveruseMetricsObserver* metrics_observer,
+                                EncodeCpuBudget* cpu_budget)
+      : OveruseFrameDetector(env, metrics_observer, cpu_budget) {}
   ~OveruseFrameDetectorUnderTest() {}
 
   using OveruseFrameDetector::CheckForOveruse;
@@ -1019,4 +1025,80 @@ TEST_F(OveruseFrameDetectorTest2, NoOveruseForSimulcast) {
   EXPECT_LE(UsagePercent(), 45);
 }
 
+TEST_F(OveruseFrameDetectorTest, DoesNotMeasureCpuTimeByDefault) {
+  EXPECT_FALSE(overuse_detector_->MeasuresCpuTime());
+}
+
+// With an EncodeCpuBudget the load is estimated from the CPU time spent
+// encoding rather than from the wall clock encode time.
+class OveruseFrameDetectorCpuTimeTest : public ::testing::Test,
+                                        public CpuOveruseMetricsObserver {
+ protected:
+  OveruseFrameDetectorCpuTimeTest()
+      : budget_clock_(Timestamp::Seconds(1000)),
+        budget_(&budget_clock_, {.capacity = 1.0}),
+        overuse_detector_(CreateEnvironment(), this, &budget_) {
+    options_.min_process_count = 0;
+  }
+
+  void OnEncodedFrameTimeMeasured(int encode_time_ms,
+                                  int encode_usage_percent) override {
+    encode_usage_percent_ = encode_usage_percent;
+  }
+
+  // Encodes `num_frames` 30 fps frames that take `wall_time_us` to encode, of
+  // which `cpu_time_us` is spent on the CPU.
+  void EncodeFrames(int num_frames, int wall_time_us, int cpu_time_us) {
+    VideoFrame frame =
+        VideoFrame::Builder()
+            .set_video_frame_buffer(I420Buffer::Create(kWidth, kHeight))
+            .set_timestamp_us(0)
+            .build();
+    for (int i = 0; i < num_frames; ++i) {
+      int64_t capture_time_us = rtc::TimeMicros();
+      overuse_detector_.FrameCaptured(frame, capture_time_us);
+      overuse_detector_.FrameEncodeCpuTimeMeasured(
+          TimeDelta::Micros(cpu_time_us));
+      overuse_detector_.FrameSent(0, 0, capture_time_us, wall_time_us);
+      clock_.AdvanceTime(TimeDelta::Micros(kFrameIntervalUs));
+      budget_clock_.AdvanceTime(TimeDelta::Micros(kFrameIntervalUs));
+    }
+  }
+
+  CpuOveruseOptions options_;
+  rtc::ScopedFakeClock clock_;
+  SimulatedClock budget_clock_;
+  EncodeCpuBudget budget_;
+  MockCpuOveruseObserver mock_observer_;
+  OveruseFrameDetectorUnderTest overuse_detector_;
+  int encode_usage_percent_ = -1;
+};
+
+TEST_F(OveruseFrameDetectorCpuTimeTest, MeasuresCpuTime) {
+  EXPECT_TRUE(overuse_detector_.MeasuresCpuTime());
+}
+
+TEST_F(OveruseFrameDetectorCpuTimeTest, IgnoresTimeWaitingForCpu) {
+  overuse_detector_.SetOptions(options_);
+  EXPECT_CALL(mock_observer_, AdaptDown()).Times(0);
+  for (int i = 0; i < 4; ++i) {
+    EncodeFrames(150, /*wall_time_us=*/32'000, /*cpu_time_us=*/5'000);
+    overuse_detector_.CheckForOveruse(&mock_observer_);
+  }
+  // 5 ms / 33 ms.
+  EXPECT_NEAR(encode_usage_percent_, 15, 2);
+}
+
+TEST_F(OveruseFrameDetectorCpuTimeTest, TriggersOveruseWhenBudgetIsExceeded) {
+  budget_.SetCapacity(0.1);
+  overuse_detector_.SetOptions(options_);
+  EXPECT_CALL(mock_observer_, AdaptDown()).Times(1);
+  for (int i = 0; i < options_.high_threshold_consecutive_count; ++i) {
+    EncodeFrames(150, /*wall_time_us=*/5'000, /*cpu_time_us=*/5'000);
+    overuse_detector_.CheckForOveruse(&mock_observer_);
+  }
+  // 15% of a core used of a 10% budget.
+  EXPECT_NEAR(encode_usage_percent_, 150, 10);
+}
+
 }  // namespace webrtc
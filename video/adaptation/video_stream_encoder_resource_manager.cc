@@ -521,6 +521,17 @@ void VideoStreamEncoderResourceManager::OnEncodeCompleted(
       encoded_image, time_sent_in_us, frame_size.bytes());
 }
 
+void VideoStreamEncoderResourceManager::OnEncodeCpuTimeMeasured(
+    TimeDelta cpu_time) {
+  RTC_DCHECK_RUN_ON(encoder_queue_);
+  encode_usage_resource_->OnEncodeCpuTimeMeasured(cpu_time);
+}
+
+bool VideoStreamEncoderResourceManager::MeasuresEncodeCpuTime() const {
+  RTC_DCHECK_RUN_ON(encoder_queue_);
+  return encode_usage_resource_->MeasuresCpuTime();
+}
+
 void VideoStreamEncoderResourceManager::OnFrameDropped(
     EncodedImageCallback::DropReason reason) {
   RTC_DCHECK_RUN_ON(encoder_queue_);
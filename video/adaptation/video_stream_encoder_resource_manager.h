@@ -25,6 +25,7 @@
 #include "api/rtp_parameters.h"
 #include "api/scoped_refptr.h"
 #include "api/task_queue/task_queue_base.h"
+#include "api/units/time_delta.h"
 #include "api/video/video_adaptation_counters.h"
 #include "api/video/video_adaptation_reason.h"
 #include "api/video/video_frame.h"
@@ -123,6 +124,9 @@ class VideoStreamEncoderResourceManager
                          int64_t time_sent_in_us,
                          absl::optional<int> encode_duration_us,
                          DataSize frame_size);
+  void OnEncodeCpuTimeMeasured(TimeDelta cpu_time);
+  // True if OnEncodeCpuTimeMeasured() should be called for encoded frames.
+  bool MeasuresEncodeCpuTime() const;
   void OnFrameDropped(EncodedImageCallback::DropReason reason);
 
   // Resources need to be mapped to an AdaptReason (kCpu or kQuality) in order
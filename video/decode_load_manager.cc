@@ -0,0 +1,272 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/decode_load_manager.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "video/frame_load_accumulator.h"
+
+namespace webrtc {
+
+namespace {
+
+// Dependency descriptors allow temporal ids up to 7.
+constexpr int kMaxTemporalLayers = 8;
+
+int LayerIndex(absl::optional<int> temporal_index) {
+  return std::clamp(temporal_index.value_or(0), 0, kMaxTemporalLayers - 1);
+}
+
+}  // namespace
+
+struct DecodeLoadManager::Stream::State {
+  // Number of temporal layers decoded under the current limit, or -1 if
+  // paused.
+  int level() const {
+    if (limit.paused) {
+      return -1;
+    }
+    return limit.max_temporal_layer.value_or(num_layers - 1);
+  }
+
+  DecodeLimit LimitForLevel(int level) const {
+    if (level < 0) {
+      return {.paused = true};
+    }
+    if (level >= num_layers - 1) {
+      return {};
+    }
+    return {.max_temporal_layer = level};
+  }
+
+  // Layers that were never decoded are assumed to be as expensive as the
+  // closest layer that was.
+  TimeDelta DecodeTimePerFrame(int layer) const {
+    for (int i = layer; i >= 0; --i) {
+      if (layers[i].time_per_frame()) {
+        return *layers[i].time_per_frame();
+      }
+    }
+    for (int i = layer + 1; i < num_layers; ++i) {
+      if (layers[i].time_per_frame()) {
+        return *layers[i].time_per_frame();
+      }
+    }
+    return TimeDelta::Zero();
+  }
+
+  // Decode time per second when decoding layers 0 to `level`.
+  double LoadAtLevel(int level) const {
+    double load = 0.0;
+    for (int i = 0; i <= level && i < num_layers; ++i) {
+      load += layers[i].frame_rate() * DecodeTimePerFrame(i).seconds<double>();
+    }
+    return load;
+  }
+
+  const uint32_t remote_ssrc;
+  const Priority priority;
+  int num_layers = 1;
+  // Frames released and decoded per temporal layer.
+  std::array<FrameLoadAccumulator, kMaxTemporalLayers> layers;
+  DecodeLimit limit;
+};
+
+DecodeLoadManager::Stream::Stream(DecodeLoadManager* manager, State* state)
+    : manager_(manager), state_(state) {}
+
+DecodeLoadManager::Stream::~Stream() {
+  manager_->Unregister(state_);
+}
+
+bool DecodeLoadManager::Stream::OnFrameReleased(
+    absl::optional<int> temporal_index) {
+  manager_->MaybeUpdate();
+  const int layer = LayerIndex(temporal_index);
+  MutexLock lock(&manager_->mutex_);
+  state_->layers[layer].OnFrame();
+  state_->num_layers = std::max(state_->num_layers, layer + 1);
+  return layer <= state_->level();
+}
+
+void DecodeLoadManager::Stream::OnFrameDecoded(
+    absl::optional<int> temporal_index,
+    TimeDelta decode_time) {
+  {
+    MutexLock lock(&manager_->mutex_);
+    state_->layers[LayerIndex(temporal_index)].OnFrameProcessed(decode_time);
+  }
+  manager_->MaybeUpdate();
+}
+
+DecodeLoadManager::DecodeLimit DecodeLoadManager::Stream::limit() const {
+  MutexLock lock(&manager_->mutex_);
+  return state_->limit;
+}
+
+DecodeLoadManager& DecodeLoadManager::Global() {
+  static DecodeLoadManager* const manager = new DecodeLoadManager(
+      Clock::GetRealTimeClock(), {.capacity = DefaultFrameLoadCapacity()});
+  return *manager;
+}
+
+DecodeLoadManager::DecodeLoadManager(Clock* clock, Config config)
+    : clock_(clock),
+      config_(config),
+      capacity_(config.capacity),
+      last_update_(clock_->CurrentTime()) {
+  RTC_DCHECK_GT(config_.restore_fraction, 0.0);
+  RTC_DCHECK_LE(config_.restore_fraction, 1.0);
+}
+
+DecodeLoadManager::~DecodeLoadManager() {
+  RTC_DCHECK(streams_.empty());
+}
+
+std::unique_ptr<DecodeLoadManager::Stream> DecodeLoadManager::RegisterStream(
+    uint32_t remote_ssrc,
+    Priority priority) {
+  auto state = std::make_unique<Stream::State>(
+      Stream::State{.remote_ssrc = remote_ssrc, .priority = priority});
+  Stream::State* state_ptr = state.get();
+  MutexLock lock(&mutex_);
+  streams_.push_back(std::move(state));
+  return absl::WrapUnique(new Stream(this, state_ptr));
+}
+
+void DecodeLoadManager::SetCapacity(double capacity) {
+  MutexLock lock(&mutex_);
+  capacity_ = capacity;
+}
+
+void DecodeLoadManager::SetObserver(Observer* observer) {
+  MutexLock lock(&mutex_);
+  observer_ = observer;
+}
+
+double DecodeLoadManager::load() const {
+  MutexLock lock(&mutex_);
+  return LoadLocked();
+}
+
+void DecodeLoadManager::Unregister(Stream::State* state) {
+  MutexLock lock(&mutex_);
+  streams_.remove_if([state](const std::unique_ptr<Stream::State>& s) {
+    return s.get() == state;
+  });
+}
+
+void DecodeLoadManager::MaybeUpdate() {
+  std::vector<LimitChange> changes;
+  Observer* observer;
+  {
+    MutexLock lock(&mutex_);
+    const Timestamp now = clock_->CurrentTime();
+    const TimeDelta elapsed = now - last_update_;
+    if (elapsed < config_.update_interval) {
+      return;
+    }
+    last_update_ = now;
+    for (const std::unique_ptr<Stream::State>& state : streams_) {
+      for (FrameLoadAccumulator& layer : state->layers) {
+        layer.Update(elapsed);
+      }
+    }
+    UpdateLimits(changes);
+    observer = observer_;
+  }
+  if (observer == nullptr) {
+    return;
+  }
+  for (const LimitChange& change : changes) {
+    observer->OnDecodeLimitChanged(change.remote_ssrc, change.limit);
+  }
+}
+
+void DecodeLoadManager::UpdateLimits(std::vector<LimitChange>& changes) {
+  double load = LoadLocked();
+  if (load > capacity_) {
+    // Degrade the lowest priority streams first, thinning those that decode
+    // the most layers and, among equals, the most recently registered.
+    while (load > capacity_) {
+      Stream::State* victim = nullptr;
+      for (const std::unique_ptr<Stream::State>& state : streams_) {
+        const int min_level = state->priority == Priority::kHigh ? 0 : -1;
+        if (state->level() <= min_level) {
+          continue;
+        }
+        if (victim == nullptr || state->priority < victim->priority ||
+            (state->priority == victim->priority &&
+             state->level() >= victim->level())) {
+          victim = state.get();
+        }
+      }
+      if (victim == nullptr) {
+        return;
+      }
+      const int level = victim->level();
+      load -= victim->LoadAtLevel(level) - victim->LoadAtLevel(level - 1);
+      SetLevel(*victim, level - 1, changes);
+    }
+    return;
+  }
+
+  // Restore one layer per update, to the highest priority stream that
+  // decodes the fewest layers.
+  Stream::State* candidate = nullptr;
+  for (const std::unique_ptr<Stream::State>& state : streams_) {
+    if (state->level() >= state->num_layers - 1) {
+      continue;
+    }
+    if (candidate == nullptr || state->priority > candidate->priority ||
+        (state->priority == candidate->priority &&
+         state->level() < candidate->level())) {
+      candidate = state.get();
+    }
+  }
+  if (candidate == nullptr) {
+    return;
+  }
+  const int level = candidate->level();
+  const double restored_load = load + candidate->LoadAtLevel(level + 1) -
+                               candidate->LoadAtLevel(level);
+  if (restored_load <= capacity_ * config_.restore_fraction) {
+    SetLevel(*candidate, level + 1, changes);
+  }
+}
+
+void DecodeLoadManager::SetLevel(Stream::State& state,
+                                 int level,
+                                 std::vector<LimitChange>& changes) {
+  state.limit = state.LimitForLevel(level);
+  RTC_LOG(LS_INFO) << "Decode load " << LoadLocked() << " of capacity "
+                   << capacity_ << ", stream " << state.remote_ssrc << " "
+                   << (state.limit.paused
+                           ? "paused"
+                           : "decodes up to temporal layer " +
+                                 std::to_string(level));
+  changes.push_back({state.remote_ssrc, state.limit});
+}
+
+double DecodeLoadManager::LoadLocked() const {
+  double load = 0.0;
+  for (const std::unique_ptr<Stream::State>& state : streams_) {
+    load += state->LoadAtLevel(state->level());
+  }
+  return load;
+}
+
+}  // namespace webrtc
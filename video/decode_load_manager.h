@@ -0,0 +1,165 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VIDEO_DECODE_LOAD_MANAGER_H_
+#define VIDEO_DECODE_LOAD_MANAGER_H_
+
+#include <stdint.h>
+
+#include <array>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/priority.h"
+#include "api/units/time_delta.h"
+#include "api/units/timestamp.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+#include "system_wrappers/include/clock.h"
+
+namespace webrtc {
+
+// Shares the decode capacity of a process between video receive streams.
+//
+// Every stream reports the temporal layer of each temporal unit that leaves
+// its frame buffer and the time spent decoding it. From this the manager
+// estimates the decode load of each stream per temporal layer. When the total
+// load exceeds the capacity, the streams with the lowest priority are told to
+// drop their upper temporal layers, one layer at a time, and finally to stop
+// decoding altogether. Streams with Priority::kHigh are thinned but never
+// paused. Layers are restored, highest priority first, once doing so keeps the
+// load below `restore_fraction` of the capacity.
+//
+// The manager does not talk to senders. An Observer can be set to learn about
+// limit changes, e.g. to ask an SFU to stop forwarding layers that are dropped
+// anyway.
+class DecodeLoadManager {
+ public:
+  struct Config {
+    // Decode time the process can afford per second, e.g. 2.0 for two cores.
+    double capacity = 1.0;
+    // Fraction of the capacity that the load must stay below after a layer
+    // is restored.
+    double restore_fraction = 0.8;
+    // How often load estimates and limits are updated.
+    TimeDelta update_interval = TimeDelta::Seconds(1);
+  };
+
+  // What a stream may decode.
+  struct DecodeLimit {
+    bool operator==(const DecodeLimit& other) const {
+      return max_temporal_layer == other.max_temporal_layer &&
+             paused == other.paused;
+    }
+    bool operator!=(const DecodeLimit& other) const {
+      return !(*this == other);
+    }
+
+    // Temporal units of higher temporal layers are dropped. Unset if all
+    // layers are decoded. Once a layer is restored, its temporal units are
+    // still dropped until one no longer references a dropped one.
+    absl::optional<int> max_temporal_layer;
+    // Nothing is decoded. Decoding has to restart from a keyframe once the
+    // stream is resumed.
+    bool paused = false;
+  };
+
+  class Observer {
+   public:
+    virtual ~Observer() = default;
+
+    // Called on the thread that reported the load which triggered the change,
+    // without holding any lock of the manager.
+    virtual void OnDecodeLimitChanged(uint32_t remote_ssrc,
+                                      DecodeLimit limit) = 0;
+  };
+
+  // Registration of a receive stream. Unregisters on destruction. Methods may
+  // be called from any thread.
+  class Stream {
+   public:
+    ~Stream();
+
+    Stream(const Stream&) = delete;
+    Stream& operator=(const Stream&) = delete;
+
+    // Called for every temporal unit leaving the frame buffer, whether it is
+    // decoded or dropped. Returns false if the temporal unit should be dropped
+    // under the current limit.
+    bool OnFrameReleased(absl::optional<int> temporal_index);
+    // Called with the time it took to decode a temporal unit.
+    void OnFrameDecoded(absl::optional<int> temporal_index,
+                        TimeDelta decode_time);
+
+    DecodeLimit limit() const;
+
+   private:
+    friend class DecodeLoadManager;
+    struct State;
+
+    Stream(DecodeLoadManager* manager, State* state);
+
+    DecodeLoadManager* const manager_;
+    State* const state_;
+  };
+
+  // Manager shared by all receive streams that opt in with the field trial
+  // "WebRTC-Video-DecodeLoadManager", with DefaultFrameLoadCapacity().
+  static DecodeLoadManager& Global();
+
+  DecodeLoadManager(Clock* clock, Config config);
+  ~DecodeLoadManager();
+
+  DecodeLoadManager(const DecodeLoadManager&) = delete;
+  DecodeLoadManager& operator=(const DecodeLoadManager&) = delete;
+
+  std::unique_ptr<Stream> RegisterStream(uint32_t remote_ssrc,
+                                         Priority priority);
+
+  void SetCapacity(double capacity);
+  // `observer` must outlive the manager or be reset before it is destroyed.
+  void SetObserver(Observer* observer);
+
+  // Estimated decode time per second under the current limits.
+  double load() const;
+
+ private:
+  struct LimitChange {
+    uint32_t remote_ssrc;
+    DecodeLimit limit;
+  };
+
+  void Unregister(Stream::State* state);
+  // Updates the load estimates and limits if `update_interval` has passed and
+  // notifies the observer about changed limits.
+  void MaybeUpdate();
+  void UpdateLimits(std::vector<LimitChange>& changes)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void SetLevel(Stream::State& state,
+                int level,
+                std::vector<LimitChange>& changes)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  double LoadLocked() const RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  Clock* const clock_;
+  const Config config_;
+  mutable Mutex mutex_;
+  double capacity_ RTC_GUARDED_BY(mutex_);
+  Observer* observer_ RTC_GUARDED_BY(mutex_) = nullptr;
+  Timestamp last_update_ RTC_GUARDED_BY(mutex_);
+  // In registration order.
+  std::list<std::unique_ptr<Stream::State>> streams_ RTC_GUARDED_BY(mutex_);
+};
+
+}  // namespace webrtc
+
+#endif  // VIDEO_DECODE_LOAD_MANAGER_H_
@@ -0,0 +1,159 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/decode_load_manager.h"
+
+#include <memory>
+#include <vector>
+
+#include "system_wrappers/include/clock.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using DecodeLimit = DecodeLoadManager::DecodeLimit;
+using ::testing::_;
+using ::testing::Eq;
+
+constexpr uint32_t kLowSsrc = 1;
+constexpr uint32_t kHighSsrc = 2;
+// 25 fps alternating between two temporal layers. Decoding every frame costs
+// half a core.
+constexpr TimeDelta kFrameInterval = TimeDelta::Millis(40);
+constexpr TimeDelta kDecodeTime = TimeDelta::Millis(20);
+
+class MockObserver : public DecodeLoadManager::Observer {
+ public:
+  MOCK_METHOD(void,
+              OnDecodeLimitChanged,
+              (uint32_t remote_ssrc, DecodeLimit limit),
+              (override));
+};
+
+class DecodeLoadManagerTest : public ::testing::Test {
+ protected:
+  DecodeLoadManagerTest()
+      : clock_(Timestamp::Seconds(1000)),
+        manager_(&clock_, {.capacity = 0.8}) {}
+
+  // Feeds every stream the same L1T2 stream for `duration`.
+  void Run(TimeDelta duration,
+           const std::vector<DecodeLoadManager::Stream*>& streams) {
+    for (TimeDelta t = TimeDelta::Zero(); t < duration; t += kFrameInterval) {
+      clock_.AdvanceTime(kFrameInterval);
+      const int temporal_index = frame_count_++ % 2;
+      for (DecodeLoadManager::Stream* stream : streams) {
+        if (stream->OnFrameReleased(temporal_index)) {
+          stream->OnFrameDecoded(temporal_index, kDecodeTime);
+        }
+      }
+    }
+  }
+
+  SimulatedClock clock_;
+  DecodeLoadManager manager_;
+  int frame_count_ = 0;
+};
+
+TEST_F(DecodeLoadManagerTest, DecodesEverythingBelowCapacity) {
+  auto stream = manager_.RegisterStream(kLowSsrc, Priority::kLow);
+  Run(TimeDelta::Seconds(3), {stream.get()});
+
+  EXPECT_EQ(stream->limit(), DecodeLimit());
+  EXPECT_NEAR(manager_.load(), 0.5, 0.05);
+}
+
+TEST_F(DecodeLoadManagerTest, ThinsLowestPriorityStreamFirst) {
+  auto high = manager_.RegisterStream(kHighSsrc, Priority::kHigh);
+  auto low = manager_.RegisterStream(kLowSsrc, Priority::kLow);
+  Run(TimeDelta::Seconds(3), {high.get(), low.get()});
+
+  EXPECT_EQ(high->limit(), DecodeLimit());
+  EXPECT_EQ(low->limit(), DecodeLimit{.max_temporal_layer = 0});
+  EXPECT_FALSE(low->OnFrameReleased(1));
+  EXPECT_TRUE(low->OnFrameReleased(0));
+  EXPECT_LE(manager_.load(), 0.8);
+}
+
+TEST_F(DecodeLoadManagerTest, PausesLowPriorityStreamBeforeThinningHighOne) {
+  manager_.SetCapacity(0.3);
+  auto high = manager_.RegisterStream(kHighSsrc, Priority::kHigh);
+  auto low = manager_.RegisterStream(kLowSsrc, Priority::kLow);
+  Run(TimeDelta::Seconds(3), {high.get(), low.get()});
+
+  EXPECT_EQ(high->limit(), DecodeLimit{.max_temporal_layer = 0});
+  EXPECT_EQ(low->limit(), DecodeLimit{.paused = true});
+  EXPECT_FALSE(low->OnFrameReleased(0));
+}
+
+TEST_F(DecodeLoadManagerTest, NeverPausesHighPriorityStream) {
+  manager_.SetCapacity(0.1);
+  auto high = manager_.RegisterStream(kHighSsrc, Priority::kHigh);
+  Run(TimeDelta::Seconds(3), {high.get()});
+
+  EXPECT_EQ(high->limit(), DecodeLimit{.max_temporal_layer = 0});
+}
+
+TEST_F(DecodeLoadManagerTest, RestoresLayersOnlyWithHeadroom) {
+  auto high = manager_.RegisterStream(kHighSsrc, Priority::kHigh);
+  auto low = manager_.RegisterStream(kLowSsrc, Priority::kLow);
+  Run(TimeDelta::Seconds(2), {high.get(), low.get()});
+  ASSERT_EQ(low->limit(), DecodeLimit{.max_temporal_layer = 0});
+
+  // Restoring the layer would bring the load back above the capacity.
+  Run(TimeDelta::Seconds(5), {high.get(), low.get()});
+  EXPECT_EQ(low->limit(), DecodeLimit{.max_temporal_layer = 0});
+
+  manager_.SetCapacity(2.0);
+  Run(TimeDelta::Seconds(2), {high.get(), low.get()});
+  EXPECT_EQ(low->limit(), DecodeLimit());
+}
+
+TEST_F(DecodeLoadManagerTest, ResumesPausedStreamOneLayerAtATime) {
+  manager_.SetCapacity(0.2);
+  auto low = manager_.RegisterStream(kLowSsrc, Priority::kLow);
+  Run(TimeDelta::Seconds(3), {low.get()});
+  ASSERT_EQ(low->limit(), DecodeLimit{.paused = true});
+
+  manager_.SetCapacity(2.0);
+  Run(TimeDelta::Seconds(1), {low.get()});
+  EXPECT_EQ(low->limit(), DecodeLimit{.max_temporal_layer = 0});
+  Run(TimeDelta::Seconds(1), {low.get()});
+  EXPECT_EQ(low->limit(), DecodeLimit());
+}
+
+TEST_F(DecodeLoadManagerTest, NotifiesObserverAboutChangedLimits) {
+  MockObserver observer;
+  manager_.SetObserver(&observer);
+  auto high = manager_.RegisterStream(kHighSsrc, Priority::kHigh);
+  auto low = manager_.RegisterStream(kLowSsrc, Priority::kLow);
+
+  EXPECT_CALL(observer, OnDecodeLimitChanged(kHighSsrc, _)).Times(0);
+  EXPECT_CALL(observer, OnDecodeLimitChanged(
+                            kLowSsrc, Eq(DecodeLimit{.max_temporal_layer = 0})))
+      .Times(1);
+  Run(TimeDelta::Seconds(3), {high.get(), low.get()});
+  manager_.SetObserver(nullptr);
+}
+
+TEST_F(DecodeLoadManagerTest, UnregisteredStreamNoLongerAddsLoad) {
+  auto high = manager_.RegisterStream(kHighSsrc, Priority::kHigh);
+  auto low = manager_.RegisterStream(kLowSsrc, Priority::kLow);
+  Run(TimeDelta::Seconds(2), {high.get(), low.get()});
+  ASSERT_GT(manager_.load(), 0.5);
+
+  low = nullptr;
+  EXPECT_NEAR(manager_.load(), 0.5, 0.05);
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -0,0 +1,45 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/frame_load_accumulator.h"
+
+#include "rtc_base/checks.h"
+#include "system_wrappers/include/cpu_info.h"
+
+namespace webrtc {
+
+void FrameLoadAccumulator::Update(TimeDelta elapsed) {
+  RTC_DCHECK_GT(elapsed, TimeDelta::Zero());
+  frame_rate_ = frames_ / elapsed.seconds<double>();
+  if (frames_processed_ > 0) {
+    const TimeDelta mean = processing_time_ / frames_processed_;
+    time_per_frame_ = time_per_frame_ ? (*time_per_frame_ + mean) / 2 : mean;
+  }
+  frames_ = 0;
+  frames_processed_ = 0;
+  processing_time_ = TimeDelta::Zero();
+}
+
+void FrameLoadAccumulator::Reset() {
+  *this = FrameLoadAccumulator();
+}
+
+absl::optional<double> FrameLoadAccumulator::load() const {
+  if (!time_per_frame_) {
+    return absl::nullopt;
+  }
+  return frame_rate_ * time_per_frame_->seconds<double>();
+}
+
+double DefaultFrameLoadCapacity() {
+  return 0.75 * CpuInfo::DetectNumberOfCores();
+}
+
+}  // namespace webrtc
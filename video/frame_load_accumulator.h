@@ -0,0 +1,75 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VIDEO_FRAME_LOAD_ACCUMULATOR_H_
+#define VIDEO_FRAME_LOAD_ACCUMULATOR_H_
+
+#include "absl/types/optional.h"
+#include "api/units/time_delta.h"
+
+namespace webrtc {
+
+// Estimates the load of processing a sequence of frames, e.g. the decode time
+// per second of a temporal layer, from what is counted between updates.
+//
+// The frame rate counts all frames, while the time per frame is averaged over
+// the frames that were actually processed. Frames that are dropped unprocessed
+// thus still count towards the load they would cause. The time per frame is
+// smoothed over updates, the frame rate is not.
+//
+// Not thread safe.
+class FrameLoadAccumulator {
+ public:
+  // Called for every frame, whether it is processed or not.
+  void OnFrame() { ++frames_; }
+  // Called with the time spent processing a frame.
+  void OnFrameProcessed(TimeDelta time) {
+    ++frames_processed_;
+    processing_time_ += time;
+  }
+  // Same as `frames` calls to both of the above, with the processing times
+  // adding up to `time`.
+  void OnFramesProcessed(int frames, TimeDelta time) {
+    frames_ += frames;
+    frames_processed_ += frames;
+    processing_time_ += time;
+  }
+
+  // Turns what was counted during the `elapsed` time since the last update
+  // into estimates.
+  void Update(TimeDelta elapsed);
+  // Forgets the estimates and what was counted since the last update.
+  void Reset();
+
+  // Frames per second. Zero until the first update.
+  double frame_rate() const { return frame_rate_; }
+  // Unset until a processed frame was counted in an update.
+  absl::optional<TimeDelta> time_per_frame() const { return time_per_frame_; }
+  // Processing time per second. Unset until `time_per_frame()` is set.
+  absl::optional<double> load() const;
+
+ private:
+  // Counted since the last update.
+  int frames_ = 0;
+  int frames_processed_ = 0;
+  TimeDelta processing_time_ = TimeDelta::Zero();
+
+  double frame_rate_ = 0.0;
+  absl::optional<TimeDelta> time_per_frame_;
+};
+
+// Processing time per second that video encoding or decoding may use by
+// default: three quarters of the CPU cores, leaving room for the rest of the
+// process.
+double DefaultFrameLoadCapacity();
+
+}  // namespace webrtc
+
+#endif  // VIDEO_FRAME_LOAD_ACCUMULATOR_H_
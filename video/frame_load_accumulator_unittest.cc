@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/frame_load_accumulator.h"
+
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using ::testing::DoubleEq;
+using ::testing::Optional;
+
+TEST(FrameLoadAccumulatorTest, HasNoEstimateBeforeFirstUpdate) {
+  FrameLoadAccumulator accumulator;
+  accumulator.OnFrame();
+  accumulator.OnFrameProcessed(TimeDelta::Millis(10));
+  EXPECT_EQ(accumulator.frame_rate(), 0.0);
+  EXPECT_EQ(accumulator.time_per_frame(), absl::nullopt);
+  EXPECT_EQ(accumulator.load(), absl::nullopt);
+}
+
+TEST(FrameLoadAccumulatorTest, EstimatesLoadIncludingUnprocessedFrames) {
+  FrameLoadAccumulator accumulator;
+  for (int i = 0; i < 20; ++i) {
+    accumulator.OnFrame();
+    if (i % 2 == 0) {
+      accumulator.OnFrameProcessed(TimeDelta::Millis(10));
+    }
+  }
+  accumulator.Update(TimeDelta::Seconds(2));
+
+  EXPECT_EQ(accumulator.frame_rate(), 10.0);
+  EXPECT_EQ(accumulator.time_per_frame(), TimeDelta::Millis(10));
+  EXPECT_THAT(accumulator.load(), Optional(DoubleEq(0.1)));
+}
+
+TEST(FrameLoadAccumulatorTest, CountsProcessedFramesInBulk) {
+  FrameLoadAccumulator accumulator;
+  accumulator.OnFramesProcessed(10, TimeDelta::Millis(100));
+  accumulator.Update(TimeDelta::Seconds(1));
+
+  EXPECT_EQ(accumulator.frame_rate(), 10.0);
+  EXPECT_EQ(accumulator.time_per_frame(), TimeDelta::Millis(10));
+}
+
+TEST(FrameLoadAccumulatorTest, SmoothesTimePerFrameButNotFrameRate) {
+  FrameLoadAccumulator accumulator;
+  accumulator.OnFrame();
+  accumulator.OnFrameProcessed(TimeDelta::Millis(10));
+  accumulator.Update(TimeDelta::Seconds(1));
+  for (int i = 0; i < 3; ++i) {
+    accumulator.OnFrame();
+    accumulator.OnFrameProcessed(TimeDelta::Millis(30));
+  }
+  accumulator.Update(TimeDelta::Seconds(1));
+
+  EXPECT_EQ(accumulator.frame_rate(), 3.0);
+  EXPECT_EQ(accumulator.time_per_frame(), TimeDelta::Millis(20));
+}
+
+TEST(FrameLoadAccumulatorTest, KeepsTimePerFrameWithoutProcessedFrames) {
+  FrameLoadAccumulator accumulator;
+  accumulator.OnFrame();
+  accumulator.OnFrameProcessed(TimeDelta::Millis(10));
+  accumulator.Update(TimeDelta::Seconds(1));
+  accumulator.OnFrame();
+  accumulator.OnFrame();
+  accumulator.Update(TimeDelta::Seconds(1));
+
+  EXPECT_EQ(accumulator.time_per_frame(), TimeDelta::Millis(10));
+  EXPECT_THAT(accumulator.load(), Optional(DoubleEq(0.02)));
+}
+
+TEST(FrameLoadAccumulatorTest, ResetForgetsEstimates) {
+  FrameLoadAccumulator accumulator;
+  accumulator.OnFrame();
+  accumulator.OnFrameProcessed(TimeDelta::Millis(10));
+  accumulator.Update(TimeDelta::Seconds(1));
+  accumulator.OnFrame();
+
+  accumulator.Reset();
+  EXPECT_EQ(accumulator.load(), absl::nullopt);
+  accumulator.Update(TimeDelta::Seconds(1));
+  EXPECT_EQ(accumulator.frame_rate(), 0.0);
+  EXPECT_EQ(accumulator.load(), absl::nullopt);
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -0,0 +1,180 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/frame_preprocessor.h"
+
+#include <utility>
+
+#include "absl/algorithm/container.h"
+#include "api/scoped_refptr.h"
+#include "api/sequence_checker.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/trace_event.h"
+
+namespace webrtc {
+
+FramePreprocessor::FramePreprocessor(TaskQueueFactory& task_queue_factory,
+                                     rtc::VideoSinkInterface<VideoFrame>* sink)
+    : sink_(sink),
+      queue_(task_queue_factory.CreateTaskQueue(
+          "FramePreprocessor",
+          TaskQueueFactory::Priority::NORMAL)) {
+  RTC_DCHECK(sink_);
+}
+
+FramePreprocessor::~FramePreprocessor() {
+  Stop();
+}
+
+void FramePreprocessor::SetEncoderFormats(
+    bool supports_native_handle,
+    const PixelFormats& preferred_pixel_formats) {
+  MutexLock lock(&mutex_);
+  encoder_formats_ =
+      EncoderFormats{.supports_native_handle = supports_native_handle,
+                     .preferred_pixel_formats = preferred_pixel_formats};
+}
+
+void FramePreprocessor::SetEncodedResolution(int width, int height) {
+  MutexLock lock(&mutex_);
+  encoded_width_ = width;
+  encoded_height_ = height;
+}
+
+void FramePreprocessor::Stop() {
+  {
+    MutexLock lock(&mutex_);
+    stopped_ = true;
+    waiting_frame_.reset();
+  }
+  if (queue_) {
+    // Delete the queue before invalidating its pointer, which a running
+    // `Convert` checks.
+    queue_.get_deleter()(queue_.get());
+    queue_.release();
+  }
+}
+
+void FramePreprocessor::OnFrame(const VideoFrame& frame) {
+  bool waiting = false;
+  bool discarded = false;
+  {
+    MutexLock lock(&mutex_);
+    if (stopped_) {
+      return;
+    }
+    if (converting_) {
+      // Wait behind the ongoing conversion to keep the frames in order.
+      waiting = true;
+      discarded = waiting_frame_.has_value();
+      waiting_frame_ = frame;
+    } else if (NeedsConversion(frame)) {
+      converting_ = true;
+      queue_->PostTask([this, frame] { Convert(frame); });
+      return;
+    }
+  }
+  // `sink_` is called outside the lock. This does not race with `Convert`,
+  // which is only running while `converting_` is set.
+  if (discarded) {
+    sink_->OnDiscardedFrame();
+  } else if (!waiting) {
+    sink_->OnFrame(frame);
+  }
+}
+
+void FramePreprocessor::OnDiscardedFrame() {
+  sink_->OnDiscardedFrame();
+}
+
+void FramePreprocessor::OnConstraintsChanged(
+    const VideoTrackSourceConstraints& constraints) {
+  sink_->OnConstraintsChanged(constraints);
+}
+
+bool FramePreprocessor::NeedsConversion(const VideoFrame& frame) const {
+  if (!encoder_formats_) {
+    return false;
+  }
+  const VideoFrameBuffer::Type type = frame.video_frame_buffer()->type();
+  switch (type) {
+    case VideoFrameBuffer::Type::kI420:
+      return false;
+    case VideoFrameBuffer::Type::kNative:
+      if (encoder_formats_->supports_native_handle) {
+        return false;
+      }
+      // Converting a native buffer at full resolution costs more than
+      // scaling it first, which VideoStreamEncoder does for frames larger
+      // than the encoded resolution.
+      return encoded_width_ == 0 || (frame.width() <= encoded_width_ &&
+                                     frame.height() <= encoded_height_);
+    case VideoFrameBuffer::Type::kNV12:
+      return !absl::c_linear_search(encoder_formats_->preferred_pixel_formats,
+                                    type);
+    default:
+      // Converting to I420 would drop the alpha, chroma resolution or bit
+      // depth of other formats, which the encoder may be configured for even
+      // without listing them, e.g. VP9 profile 2 for I010.
+      return false;
+  }
+}
+
+void FramePreprocessor::Convert(VideoFrame frame) {
+  RTC_DCHECK_RUN_ON(queue_.get());
+  while (true) {
+    bool needs_conversion;
+    PixelFormats preferred_pixel_formats;
+    {
+      MutexLock lock(&mutex_);
+      needs_conversion = NeedsConversion(frame);
+      if (encoder_formats_) {
+        preferred_pixel_formats = encoder_formats_->preferred_pixel_formats;
+      }
+    }
+
+    if (needs_conversion) {
+      TRACE_EVENT0("webrtc", "FramePreprocessor::Convert");
+      rtc::scoped_refptr<VideoFrameBuffer> buffer = frame.video_frame_buffer();
+      // Prefer mapping a native buffer over converting it, like the encoders
+      // do.
+      rtc::scoped_refptr<VideoFrameBuffer> converted;
+      if (buffer->type() == VideoFrameBuffer::Type::kNative) {
+        converted = buffer->GetMappedFrameBuffer(preferred_pixel_formats);
+      }
+      if (!converted ||
+          !absl::c_linear_search(preferred_pixel_formats, converted->type())) {
+        converted = buffer->ToI420();
+      }
+      if (converted) {
+        frame.set_video_frame_buffer(converted);
+        sink_->OnFrame(frame);
+      } else {
+        RTC_LOG(LS_ERROR) << "Failed to convert "
+                          << VideoFrameBufferTypeToString(buffer->type())
+                          << " frame, dropping it.";
+        sink_->OnDiscardedFrame();
+      }
+    } else {
+      sink_->OnFrame(frame);
+    }
+
+    MutexLock lock(&mutex_);
+    if (stopped_ || !waiting_frame_) {
+      converting_ = false;
+      return;
+    }
+    frame = *std::move(waiting_frame_);
+    waiting_frame_.reset();
+  }
+}
+
+}  // namespace webrtc
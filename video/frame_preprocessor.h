@@ -0,0 +1,99 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VIDEO_FRAME_PREPROCESSOR_H_
+#define VIDEO_FRAME_PREPROCESSOR_H_
+
+#include <memory>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/types/optional.h"
+#include "api/task_queue/task_queue_base.h"
+#include "api/task_queue/task_queue_factory.h"
+#include "api/video/video_frame.h"
+#include "api/video/video_frame_buffer.h"
+#include "api/video/video_sink_interface.h"
+#include "api/video_codecs/video_encoder.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+// Converts frames to a pixel format the encoder accepts before they are
+// posted to the encoder queue. Without it, encoders convert e.g. native or
+// NV12 buffers to I420 inside VideoEncoder::Encode. Converting on a separate
+// queue instead lets the conversion of a frame overlap with the encoding of
+// the previous one.
+//
+// At most one frame is converted at a time. A frame arriving meanwhile waits
+// for the conversion to finish and replaces any frame already waiting, which
+// is discarded, so the added latency is bounded by one conversion.
+//
+// Only native and NV12 buffers are converted, since converting other formats
+// to I420 could lose information the encoder uses. Frames are passed through
+// unchanged until the encoder formats are set, and whenever their buffer
+// already is in a format the encoder accepts. Native frames larger than the
+// encoded resolution are passed through as well, since VideoStreamEncoder
+// scales them natively before they are converted.
+class FramePreprocessor : public rtc::VideoSinkInterface<VideoFrame> {
+ public:
+  using PixelFormats =
+      absl::InlinedVector<VideoFrameBuffer::Type, kMaxPreferredPixelFormats>;
+
+  FramePreprocessor(TaskQueueFactory& task_queue_factory,
+                    rtc::VideoSinkInterface<VideoFrame>* sink);
+  ~FramePreprocessor() override;
+
+  // Sets what the encoder takes without conversion, as reported in
+  // VideoEncoder::EncoderInfo. May be called from any thread.
+  void SetEncoderFormats(bool supports_native_handle,
+                         const PixelFormats& preferred_pixel_formats);
+  // Sets the resolution of the largest encoded layer. May be called from any
+  // thread.
+  void SetEncodedResolution(int width, int height);
+
+  // Waits for an ongoing conversion to finish and drops all frames arriving
+  // later. Must be called before `sink` is destroyed, after detaching from the
+  // source.
+  void Stop();
+
+  // rtc::VideoSinkInterface<VideoFrame> implementation.
+  void OnFrame(const VideoFrame& frame) override;
+  void OnDiscardedFrame() override;
+  void OnConstraintsChanged(
+      const VideoTrackSourceConstraints& constraints) override;
+
+ private:
+  struct EncoderFormats {
+    bool supports_native_handle = false;
+    PixelFormats preferred_pixel_formats;
+  };
+
+  bool NeedsConversion(const VideoFrame& frame) const
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Converts `frame` and the frames waiting behind it. Runs on `queue_`.
+  void Convert(VideoFrame frame);
+
+  rtc::VideoSinkInterface<VideoFrame>* const sink_;
+  mutable Mutex mutex_;
+  absl::optional<EncoderFormats> encoder_formats_ RTC_GUARDED_BY(mutex_);
+  // Zero until set.
+  int encoded_width_ RTC_GUARDED_BY(mutex_) = 0;
+  int encoded_height_ RTC_GUARDED_BY(mutex_) = 0;
+  bool converting_ RTC_GUARDED_BY(mutex_) = false;
+  bool stopped_ RTC_GUARDED_BY(mutex_) = false;
+  absl::optional<VideoFrame> waiting_frame_ RTC_GUARDED_BY(mutex_);
+  // Last, so that it is deleted first.
+  std::unique_ptr<TaskQueueBase, TaskQueueDeleter> queue_;
+};
+
+}  // namespace webrtc
+
+#endif  // VIDEO_FRAME_PREPROCESSOR_H_
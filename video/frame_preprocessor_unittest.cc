@@ -0,0 +1,220 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/frame_preprocessor.h"
+
+#include <memory>
+#include <vector>
+
+#include "api/task_queue/default_task_queue_factory.h"
+#include "api/units/time_delta.h"
+#include "api/video/i010_buffer.h"
+#include "api/video/i420_buffer.h"
+#include "api/video/nv12_buffer.h"
+#include "rtc_base/event.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "test/gmock.h"
+#include "test/fake_texture_frame.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using ::testing::ElementsAre;
+
+constexpr TimeDelta kTimeout = TimeDelta::Seconds(5);
+
+class FrameSink : public rtc::VideoSinkInterface<VideoFrame> {
+ public:
+  void OnFrame(const VideoFrame& frame) override {
+    MutexLock lock(&mutex_);
+    frames_.push_back(frame);
+    frame_event_.Set();
+  }
+  void OnDiscardedFrame() override {
+    MutexLock lock(&mutex_);
+    ++discarded_frames_;
+  }
+
+  // Returns the received frames once there are at least `num_frames` of them,
+  // or none on timeout.
+  std::vector<VideoFrame> WaitForFrames(size_t num_frames) {
+    while (true) {
+      {
+        MutexLock lock(&mutex_);
+        if (frames_.size() >= num_frames) {
+          return frames_;
+        }
+      }
+      if (!frame_event_.Wait(kTimeout)) {
+        return {};
+      }
+    }
+  }
+
+  int discarded_frames() {
+    MutexLock lock(&mutex_);
+    return discarded_frames_;
+  }
+
+ private:
+  Mutex mutex_;
+  rtc::Event frame_event_;
+  std::vector<VideoFrame> frames_ RTC_GUARDED_BY(mutex_);
+  int discarded_frames_ RTC_GUARDED_BY(mutex_) = 0;
+};
+
+VideoFrame CreateNv12Frame(int64_t timestamp_us) {
+  return VideoFrame::Builder()
+      .set_video_frame_buffer(NV12Buffer::Create(64, 48))
+      .set_timestamp_us(timestamp_us)
+      .build();
+}
+
+VideoFrame CreateI420Frame(int64_t timestamp_us) {
+  return VideoFrame::Builder()
+      .set_video_frame_buffer(I420Buffer::Create(64, 48))
+      .set_timestamp_us(timestamp_us)
+      .build();
+}
+
+VideoFrameBuffer::Type BufferType(const VideoFrame& frame) {
+  return frame.video_frame_buffer()->type();
+}
+
+class FramePreprocessorTest : public ::testing::Test {
+ protected:
+  FramePreprocessorTest()
+      : task_queue_factory_(CreateDefaultTaskQueueFactory()),
+        preprocessor_(*task_queue_factory_, &sink_) {}
+
+  std::unique_ptr<TaskQueueFactory> task_queue_factory_;
+  FrameSink sink_;
+  FramePreprocessor preprocessor_;
+};
+
+TEST_F(FramePreprocessorTest, PassesFramesThroughUntilFormatsAreKnown) {
+  preprocessor_.OnFrame(CreateNv12Frame(1));
+
+  std::vector<VideoFrame> frames = sink_.WaitForFrames(1);
+  ASSERT_EQ(frames.size(), 1u);
+  EXPECT_EQ(BufferType(frames[0]), VideoFrameBuffer::Type::kNV12);
+}
+
+TEST_F(FramePreprocessorTest, ConvertsToI420ForI420OnlyEncoder) {
+  preprocessor_.SetEncoderFormats(/*supports_native_handle=*/false, {});
+  preprocessor_.OnFrame(CreateNv12Frame(1));
+
+  std::vector<VideoFrame> frames = sink_.WaitForFrames(1);
+  ASSERT_EQ(frames.size(), 1u);
+  EXPECT_EQ(BufferType(frames[0]), VideoFrameBuffer::Type::kI420);
+  EXPECT_EQ(frames[0].timestamp_us(), 1);
+  EXPECT_EQ(frames[0].width(), 64);
+  EXPECT_EQ(frames[0].height(), 48);
+}
+
+TEST_F(FramePreprocessorTest, KeepsPreferredFormat) {
+  preprocessor_.SetEncoderFormats(
+      /*supports_native_handle=*/false,
+      {VideoFrameBuffer::Type::kI420, VideoFrameBuffer::Type::kNV12});
+  preprocessor_.OnFrame(CreateNv12Frame(1));
+  preprocessor_.OnFrame(CreateI420Frame(2));
+
+  std::vector<VideoFrame> frames = sink_.WaitForFrames(2);
+  ASSERT_EQ(frames.size(), 2u);
+  EXPECT_EQ(BufferType(frames[0]), VideoFrameBuffer::Type::kNV12);
+  EXPECT_EQ(BufferType(frames[1]), VideoFrameBuffer::Type::kI420);
+}
+
+TEST_F(FramePreprocessorTest, PassesThroughHighBitDepthFrames) {
+  // Like VP9 profile 2, which takes I010 frames without listing them.
+  preprocessor_.SetEncoderFormats(/*supports_native_handle=*/false,
+                                  {VideoFrameBuffer::Type::kI420});
+  preprocessor_.OnFrame(VideoFrame::Builder()
+                            .set_video_frame_buffer(I010Buffer::Create(64, 48))
+                            .set_timestamp_us(1)
+                            .build());
+  preprocessor_.SetEncoderFormats(/*supports_native_handle=*/false, {});
+  preprocessor_.OnFrame(VideoFrame::Builder()
+                            .set_video_frame_buffer(I010Buffer::Create(64, 48))
+                            .set_timestamp_us(2)
+                            .build());
+
+  std::vector<VideoFrame> frames = sink_.WaitForFrames(2);
+  ASSERT_EQ(frames.size(), 2u);
+  EXPECT_EQ(BufferType(frames[0]), VideoFrameBuffer::Type::kI010);
+  EXPECT_EQ(BufferType(frames[1]), VideoFrameBuffer::Type::kI010);
+}
+
+TEST_F(FramePreprocessorTest, ConvertsNativeFrameAtEncodedResolution) {
+  preprocessor_.SetEncoderFormats(/*supports_native_handle=*/false, {});
+  preprocessor_.SetEncodedResolution(64, 48);
+  preprocessor_.OnFrame(test::FakeNativeBuffer::CreateFrame(
+      64, 48, /*timestamp=*/0, /*render_time_ms=*/1, kVideoRotation_0));
+
+  std::vector<VideoFrame> frames = sink_.WaitForFrames(1);
+  ASSERT_EQ(frames.size(), 1u);
+  EXPECT_EQ(BufferType(frames[0]), VideoFrameBuffer::Type::kI420);
+}
+
+TEST_F(FramePreprocessorTest, PassesThroughNativeFrameThatIsDownscaled) {
+  preprocessor_.SetEncoderFormats(/*supports_native_handle=*/false, {});
+  preprocessor_.SetEncodedResolution(32, 24);
+  preprocessor_.OnFrame(test::FakeNativeBuffer::CreateFrame(
+      64, 48, /*timestamp=*/0, /*render_time_ms=*/1, kVideoRotation_0));
+  // Other buffer types are still converted.
+  preprocessor_.OnFrame(CreateNv12Frame(2));
+
+  std::vector<VideoFrame> frames = sink_.WaitForFrames(2);
+  ASSERT_EQ(frames.size(), 2u);
+  EXPECT_EQ(BufferType(frames[0]), VideoFrameBuffer::Type::kNative);
+  EXPECT_EQ(BufferType(frames[1]), VideoFrameBuffer::Type::kI420);
+}
+
+TEST_F(FramePreprocessorTest, DeliversFramesInOrder) {
+  preprocessor_.SetEncoderFormats(/*supports_native_handle=*/false, {});
+  preprocessor_.OnFrame(CreateNv12Frame(1));
+  preprocessor_.OnFrame(CreateI420Frame(2));
+
+  // The second frame either waits behind the conversion of the first one or
+  // is passed through after it.
+  std::vector<VideoFrame> frames = sink_.WaitForFrames(2);
+  ASSERT_EQ(frames.size(), 2u);
+  EXPECT_EQ(frames[0].timestamp_us(), 1);
+  EXPECT_EQ(frames[1].timestamp_us(), 2);
+}
+
+TEST_F(FramePreprocessorTest, KeepsAtMostOneFrameWaiting) {
+  preprocessor_.SetEncoderFormats(/*supports_native_handle=*/false, {});
+  constexpr int kNumFrames = 50;
+  for (int i = 1; i <= kNumFrames; ++i) {
+    preprocessor_.OnFrame(CreateNv12Frame(i));
+  }
+  preprocessor_.Stop();
+
+  // Every frame was either delivered or discarded, except the frame in
+  // conversion and the waiting frame, which Stop() may have dropped.
+  std::vector<VideoFrame> frames = sink_.WaitForFrames(0);
+  EXPECT_GE(frames.size() + sink_.discarded_frames(), kNumFrames - 2u);
+  EXPECT_LE(frames.size() + sink_.discarded_frames(), kNumFrames + 0u);
+  for (size_t i = 1; i < frames.size(); ++i) {
+    EXPECT_LT(frames[i - 1].timestamp_us(), frames[i].timestamp_us());
+  }
+}
+
+TEST_F(FramePreprocessorTest, DropsFramesAfterStop) {
+  preprocessor_.Stop();
+  preprocessor_.OnFrame(CreateI420Frame(1));
+
+  EXPECT_THAT(sink_.WaitForFrames(0), ElementsAre());
+}
+
+}  // namespace
+}  // namespace webrtc
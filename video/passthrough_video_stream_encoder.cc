@@ -0,0 +1,274 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/passthrough_video_stream_encoder.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "absl/types/optional.h"
+#include "api/task_queue/task_queue_factory.h"
+#include "api/video/encoded_image.h"
+#include "media/base/media_channel.h"
+#include "modules/video_coding/svc/scalability_mode_util.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/event.h"
+#include "rtc_base/experiments/min_video_bitrate_experiment.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/trace_event.h"
+
+namespace webrtc {
+namespace {
+
+// Used for streams without a configured max bitrate, as a relayed stream is
+// not limited by the resolution it is encoded at.
+constexpr int kDefaultMaxBitrateBps = 2'500'000;
+
+// The streams an encoder would report for `config`, with the resolution left
+// unknown since it is up to the source.
+std::vector<VideoStream> CreateStreams(const VideoEncoderConfig& config) {
+  std::vector<VideoStream> streams = config.simulcast_layers;
+  streams.resize(std::max<size_t>(config.number_of_streams, 1));
+  for (VideoStream& stream : streams) {
+    if (stream.max_bitrate_bps <= 0) {
+      stream.max_bitrate_bps =
+          streams.size() == 1 && config.max_bitrate_bps > 0
+              ? config.max_bitrate_bps
+              : kDefaultMaxBitrateBps;
+    }
+    if (stream.min_bitrate_bps <= 0) {
+      stream.min_bitrate_bps =
+          std::min(kDefaultMinVideoBitrateBps, stream.max_bitrate_bps);
+    }
+    if (stream.target_bitrate_bps <= 0) {
+      stream.target_bitrate_bps = stream.max_bitrate_bps;
+    }
+    if (stream.scalability_mode && !stream.num_temporal_layers) {
+      stream.num_temporal_layers =
+          ScalabilityModeToNumTemporalLayers(*stream.scalability_mode);
+    }
+  }
+  // Like the encoder, apply the priority of the whole configuration to the
+  // first stream.
+  streams[0].bitrate_priority = config.bitrate_priority;
+  return streams;
+}
+
+bool IsSvc(const std::vector<VideoStream>& streams) {
+  return streams.size() == 1 && streams[0].scalability_mode &&
+         ScalabilityModeToNumSpatialLayers(*streams[0].scalability_mode) > 1;
+}
+
+}  // namespace
+
+PassthroughVideoStreamEncoder::PassthroughVideoStreamEncoder(
+    const Environment& env,
+    EncodedVideoSource* source,
+    VideoStreamEncoderObserver* observer)
+    : source_(source),
+      observer_(observer),
+      worker_queue_(TaskQueueBase::Current()),
+      queue_(env.task_queue_factory().CreateTaskQueue(
+          "PassthroughEncoderQueue",
+          TaskQueueFactory::Priority::NORMAL)) {
+  RTC_DCHECK(source_);
+  RTC_DCHECK(observer_);
+  RTC_DCHECK(worker_queue_);
+  // Until configured, the source is expected to send a single stream.
+  waiting_for_key_frame_[0] = true;
+}
+
+PassthroughVideoStreamEncoder::~PassthroughVideoStreamEncoder() {
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  RTC_DCHECK(!source_connected_)
+      << "Must call ::Stop() before destruction.";
+}
+
+void PassthroughVideoStreamEncoder::AddAdaptationResource(
+    rtc::scoped_refptr<Resource> resource) {}
+
+void PassthroughVideoStreamEncoder::RemoveAdaptationResource(
+    rtc::scoped_refptr<Resource> resource) {}
+
+std::vector<rtc::scoped_refptr<Resource>>
+PassthroughVideoStreamEncoder::GetAdaptationResources() {
+  return {};
+}
+
+void PassthroughVideoStreamEncoder::SetSource(
+    rtc::VideoSourceInterface<VideoFrame>* source,
+    const DegradationPreference& degradation_preference) {}
+
+void PassthroughVideoStreamEncoder::SetSink(EncoderSink* sink,
+                                            bool rotation_applied) {
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  // Set the sink before connecting the source, so the first frames are not
+  // lost.
+  queue_->PostTask([this, sink] {
+    RTC_DCHECK_RUN_ON(queue_.get());
+    sink_ = sink;
+  });
+  if (sink && !source_connected_) {
+    source_->SetSink(this);
+    source_connected_ = true;
+  }
+}
+
+void PassthroughVideoStreamEncoder::SetStartBitrate(int start_bitrate_bps) {}
+
+void PassthroughVideoStreamEncoder::SendKeyFrame(
+    const std::vector<VideoFrameType>& layers) {
+  // There is no way to ask for specific layers, so one request serves all.
+  source_->RequestKeyFrame();
+}
+
+void PassthroughVideoStreamEncoder::OnLossNotification(
+    const VideoEncoder::LossNotification& loss_notification) {}
+
+void PassthroughVideoStreamEncoder::OnBitrateUpdated(
+    DataRate target_bitrate,
+    DataRate stable_target_bitrate,
+    DataRate link_allocation,
+    uint8_t fraction_lost,
+    int64_t round_trip_time_ms,
+    double cwnd_reduce_ratio) {
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  source_->OnTargetBitrateChanged(target_bitrate);
+  queue_->PostTask([this, paused = target_bitrate.IsZero()] {
+    RTC_DCHECK_RUN_ON(queue_.get());
+    if (paused == paused_) {
+      return;
+    }
+    RTC_LOG(LS_INFO) << "Passthrough video stream "
+                     << (paused ? "paused." : "resumed.");
+    paused_ = paused;
+    if (!paused) {
+      // Frames were dropped while paused, so the receivers need a key frame.
+      for (size_t i = 0; i < num_streams_; ++i) {
+        waiting_for_key_frame_[i] = true;
+      }
+      key_frame_requested_ = true;
+      source_->RequestKeyFrame();
+    }
+  });
+}
+
+void PassthroughVideoStreamEncoder::SetFecControllerOverride(
+    FecControllerOverride* fec_controller_override) {}
+
+void PassthroughVideoStreamEncoder::ConfigureEncoder(
+    VideoEncoderConfig config,
+    size_t max_data_payload_length) {
+  ConfigureEncoder(std::move(config), max_data_payload_length, nullptr);
+}
+
+void PassthroughVideoStreamEncoder::ConfigureEncoder(
+    VideoEncoderConfig config,
+    size_t max_data_payload_length,
+    SetParametersCallback callback) {
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  queue_->PostTask([this, config = std::move(config)] {
+    RTC_DCHECK_RUN_ON(queue_.get());
+    std::vector<VideoStream> streams = CreateStreams(config);
+    // Streams that are added start at a key frame, and removed streams are
+    // no longer waited for.
+    const size_t num_streams =
+        std::min<size_t>(streams.size(), kMaxSimulcastStreams);
+    for (size_t i = num_streams_; i < num_streams; ++i) {
+      waiting_for_key_frame_[i] = true;
+    }
+    for (size_t i = num_streams; i < num_streams_; ++i) {
+      waiting_for_key_frame_[i] = false;
+    }
+    num_streams_ = num_streams;
+    key_frame_requested_ = key_frame_requested_ && waiting_for_key_frame_.any();
+    observer_->OnEncoderReconfigured(config, streams);
+    static const std::string kImplementationName = "Passthrough";
+    observer_->OnEncoderImplementationChanged(
+        {.name = kImplementationName, .is_hardware_accelerated = false});
+    if (sink_) {
+      const bool is_svc = IsSvc(streams);
+      sink_->OnEncoderConfigurationChanged(std::move(streams), is_svc,
+                                           config.content_type,
+                                           config.min_transmit_bitrate_bps);
+    }
+  });
+  // The source is not reconfigured, so there is nothing that can fail.
+  webrtc::InvokeSetParametersCallback(callback, RTCError::OK());
+}
+
+void PassthroughVideoStreamEncoder::Stop() {
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  if (source_connected_) {
+    source_->SetSink(nullptr);
+    source_connected_ = false;
+  }
+  rtc::Event shutdown_event;
+  queue_->PostTask([this, &shutdown_event] {
+    RTC_DCHECK_RUN_ON(queue_.get());
+    sink_ = nullptr;
+    shutdown_event.Set();
+  });
+  shutdown_event.Wait(rtc::Event::kForever);
+}
+
+EncodedImageCallback::Result PassthroughVideoStreamEncoder::OnEncodedImage(
+    const EncodedImage& encoded_image,
+    const CodecSpecificInfo* codec_specific_info) {
+  // The encoded data is reference counted, so the copies are cheap.
+  queue_->PostTask(
+      [this, encoded_image,
+       codec_specific_info = codec_specific_info
+                                 ? absl::make_optional(*codec_specific_info)
+                                 : absl::nullopt] {
+        RTC_DCHECK_RUN_ON(queue_.get());
+        SendFrame(encoded_image,
+                  codec_specific_info ? &*codec_specific_info : nullptr);
+      });
+  return Result(Result::OK);
+}
+
+void PassthroughVideoStreamEncoder::SendFrame(
+    const EncodedImage& encoded_image,
+    const CodecSpecificInfo* codec_specific_info) {
+  if (!sink_) {
+    return;
+  }
+  if (paused_) {
+    observer_->OnFrameDropped(
+        VideoStreamEncoderObserver::DropReason::kMediaOptimization);
+    return;
+  }
+  const int simulcast_index = encoded_image.SimulcastIndex().value_or(0);
+  if (simulcast_index >= kMaxSimulcastStreams) {
+    RTC_LOG(LS_WARNING) << "Dropping frame of unsupported simulcast index "
+                        << simulcast_index << ".";
+    return;
+  }
+  if (waiting_for_key_frame_[simulcast_index]) {
+    if (encoded_image.FrameType() != VideoFrameType::kVideoFrameKey) {
+      // Request a key frame with the first frame that can not be sent. The
+      // RTCP feedback of the receivers repeats it if needed.
+      if (!std::exchange(key_frame_requested_, true)) {
+        source_->RequestKeyFrame();
+      }
+      return;
+    }
+    waiting_for_key_frame_[simulcast_index] = false;
+    key_frame_requested_ = waiting_for_key_frame_.any();
+  }
+
+  TRACE_EVENT0("webrtc", "PassthroughVideoStreamEncoder::SendFrame");
+  observer_->OnSendEncodedImage(encoded_image, codec_specific_info);
+  sink_->OnEncodedImage(encoded_image, codec_specific_info);
+}
+
+}  // namespace webrtc
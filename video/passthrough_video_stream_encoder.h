@@ -0,0 +1,119 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VIDEO_PASSTHROUGH_VIDEO_STREAM_ENCODER_H_
+#define VIDEO_PASSTHROUGH_VIDEO_STREAM_ENCODER_H_
+
+#include <bitset>
+#include <memory>
+#include <vector>
+
+#include "api/adaptation/resource.h"
+#include "api/environment/environment.h"
+#include "api/fec_controller_override.h"
+#include "api/rtp_sender_interface.h"
+#include "api/scoped_refptr.h"
+#include "api/sequence_checker.h"
+#include "api/task_queue/task_queue_base.h"
+#include "api/units/data_rate.h"
+#include "api/video/encoded_video_source.h"
+#include "api/video/video_codec_constants.h"
+#include "api/video_codecs/video_encoder.h"
+#include "rtc_base/thread_annotations.h"
+#include "video/config/video_encoder_config.h"
+#include "video/video_stream_encoder_interface.h"
+#include "video/video_stream_encoder_observer.h"
+
+namespace webrtc {
+
+// VideoStreamEncoderInterface of a video send stream that sends the frames of
+// an EncodedVideoSource instead of encoding frames, see
+// VideoSendStream::Config::encoded_source.
+//
+// Frames are passed on with their CodecSpecificInfo, so the RTP sender writes
+// the dependency descriptor of the source. Each simulcast stream starts at a
+// key frame, and again when the stream resumes after being paused by a zero
+// target bitrate; delta frames before that are dropped and a key frame is
+// requested from the source. The frame source set with SetSource is not used,
+// and there is nothing to adapt.
+class PassthroughVideoStreamEncoder : public VideoStreamEncoderInterface,
+                                      private EncodedImageCallback {
+ public:
+  // Must be created on the worker queue, where it is used except for
+  // SendKeyFrame and OnLossNotification.
+  PassthroughVideoStreamEncoder(const Environment& env,
+                                EncodedVideoSource* source,
+                                VideoStreamEncoderObserver* observer);
+  ~PassthroughVideoStreamEncoder() override;
+
+  PassthroughVideoStreamEncoder(const PassthroughVideoStreamEncoder&) = delete;
+  PassthroughVideoStreamEncoder& operator=(
+      const PassthroughVideoStreamEncoder&) = delete;
+
+  // VideoStreamEncoderInterface implementation.
+  void AddAdaptationResource(rtc::scoped_refptr<Resource> resource) override;
+  void RemoveAdaptationResource(rtc::scoped_refptr<Resource> resource) override;
+  std::vector<rtc::scoped_refptr<Resource>> GetAdaptationResources() override;
+  void SetSource(rtc::VideoSourceInterface<VideoFrame>* source,
+                 const DegradationPreference& degradation_preference) override;
+  void SetSink(EncoderSink* sink, bool rotation_applied) override;
+  void SetStartBitrate(int start_bitrate_bps) override;
+  void SendKeyFrame(const std::vector<VideoFrameType>& layers = {}) override;
+  void OnLossNotification(
+      const VideoEncoder::LossNotification& loss_notification) override;
+  void OnBitrateUpdated(DataRate target_bitrate,
+                        DataRate stable_target_bitrate,
+                        DataRate link_allocation,
+                        uint8_t fraction_lost,
+                        int64_t round_trip_time_ms,
+                        double cwnd_reduce_ratio) override;
+  void SetFecControllerOverride(
+      FecControllerOverride* fec_controller_override) override;
+  void ConfigureEncoder(VideoEncoderConfig config,
+                        size_t max_data_payload_length) override;
+  void ConfigureEncoder(VideoEncoderConfig config,
+                        size_t max_data_payload_length,
+                        SetParametersCallback callback) override;
+  void Stop() override;
+
+ private:
+  // EncodedImageCallback implementation, for frames of `source_`.
+  Result OnEncodedImage(const EncodedImage& encoded_image,
+                        const CodecSpecificInfo* codec_specific_info) override;
+
+  void SendFrame(const EncodedImage& encoded_image,
+                 const CodecSpecificInfo* codec_specific_info)
+      RTC_RUN_ON(queue_);
+
+  EncodedVideoSource* const source_;
+  VideoStreamEncoderObserver* const observer_;
+  TaskQueueBase* const worker_queue_;
+
+  bool source_connected_ RTC_GUARDED_BY(worker_queue_) = false;
+
+  // State of delivery to `sink_`, which is called on `queue_` like the sink of
+  // an encoder.
+  EncoderSink* sink_ RTC_GUARDED_BY(queue_) = nullptr;
+  bool paused_ RTC_GUARDED_BY(queue_) = false;
+  // Number of streams in the last configuration.
+  size_t num_streams_ RTC_GUARDED_BY(queue_) = 1;
+  // Streams, out of the first `num_streams_`, whose next frame to send must be
+  // a key frame.
+  std::bitset<kMaxSimulcastStreams> waiting_for_key_frame_
+      RTC_GUARDED_BY(queue_);
+  bool key_frame_requested_ RTC_GUARDED_BY(queue_) = false;
+
+  // Destroyed first, so pending tasks do not outlive the members they use.
+  std::unique_ptr<TaskQueueBase, TaskQueueDeleter> queue_;
+};
+
+}  // namespace webrtc
+
+#endif  // VIDEO_PASSTHROUGH_VIDEO_STREAM_ENCODER_H_
@@ -0,0 +1,208 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/passthrough_video_stream_encoder.h"
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "api/environment/environment.h"
+#include "api/environment/environment_factory.h"
+#include "api/units/data_rate.h"
+#include "api/video/encoded_image.h"
+#include "api/video_codecs/scalability_mode.h"
+#include "call/adaptation/test/fake_frame_rate_provider.h"
+#include "common_video/generic_frame_descriptor/generic_frame_info.h"
+#include "modules/video_coding/include/video_codec_interface.h"
+#include "rtc_base/thread.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::NiceMock;
+
+class FakeEncodedVideoSource : public EncodedVideoSource {
+ public:
+  void SetSink(EncodedImageCallback* sink) override { sink_ = sink; }
+  void RequestKeyFrame() override { ++key_frame_requests_; }
+  void OnTargetBitrateChanged(DataRate target_bitrate) override {
+    target_bitrate_ = target_bitrate;
+  }
+
+  void SendFrame(VideoFrameType frame_type,
+                 const CodecSpecificInfo* codec_specific_info = nullptr,
+                 int simulcast_index = 0) {
+    EncodedImage image;
+    image.SetFrameType(frame_type);
+    image.SetSimulcastIndex(simulcast_index);
+    ASSERT_TRUE(sink_);
+    sink_->OnEncodedImage(image, codec_specific_info);
+  }
+
+  EncodedImageCallback* sink() const { return sink_; }
+  int key_frame_requests() const { return key_frame_requests_.load(); }
+  DataRate target_bitrate() const { return target_bitrate_; }
+
+ private:
+  EncodedImageCallback* sink_ = nullptr;
+  // Requested from the encoder queue.
+  std::atomic<int> key_frame_requests_{0};
+  DataRate target_bitrate_ = DataRate::Zero();
+};
+
+// Records what is sent. Read once the encoder is stopped, which waits for its
+// queue.
+class FakeEncoderSink : public VideoStreamEncoderInterface::EncoderSink {
+ public:
+  struct Config {
+    std::vector<VideoStream> streams;
+    bool is_svc;
+  };
+
+  Result OnEncodedImage(const EncodedImage& encoded_image,
+                        const CodecSpecificInfo* codec_specific_info) override {
+    frame_types.push_back(encoded_image.FrameType());
+    if (codec_specific_info && codec_specific_info->template_structure) {
+      ++frames_with_structure;
+    }
+    return Result(Result::OK);
+  }
+  void OnEncoderConfigurationChanged(
+      std::vector<VideoStream> streams,
+      bool is_svc,
+      VideoEncoderConfig::ContentType content_type,
+      int min_transmit_bitrate_bps) override {
+    configs.push_back({.streams = std::move(streams), .is_svc = is_svc});
+  }
+  void OnBitrateAllocationUpdated(
+      const VideoBitrateAllocation& allocation) override {}
+  void OnVideoLayersAllocationUpdated(
+      VideoLayersAllocation allocation) override {}
+
+  std::vector<VideoFrameType> frame_types;
+  int frames_with_structure = 0;
+  std::vector<Config> configs;
+};
+
+class PassthroughVideoStreamEncoderTest : public ::testing::Test {
+ protected:
+  PassthroughVideoStreamEncoderTest()
+      : env_(CreateEnvironment()),
+        encoder_(std::make_unique<PassthroughVideoStreamEncoder>(env_,
+                                                                 &source_,
+                                                                 &observer_)) {
+    encoder_->SetSink(&sink_, /*rotation_applied=*/false);
+  }
+
+  void SetTargetBitrate(DataRate target_bitrate) {
+    encoder_->OnBitrateUpdated(target_bitrate, target_bitrate, target_bitrate,
+                               0, 0, 0);
+  }
+
+  rtc::AutoThread main_thread_;
+  const Environment env_;
+  FakeEncodedVideoSource source_;
+  FakeEncoderSink sink_;
+  NiceMock<MockVideoStreamEncoderObserver> observer_;
+  std::unique_ptr<PassthroughVideoStreamEncoder> encoder_;
+};
+
+TEST_F(PassthroughVideoStreamEncoderTest, ForwardsFramesStartingAtKeyFrame) {
+  ASSERT_TRUE(source_.sink());
+  CodecSpecificInfo codec_specific_info;
+  codec_specific_info.template_structure.emplace();
+  codec_specific_info.generic_frame_info = GenericFrameInfo();
+
+  source_.SendFrame(VideoFrameType::kVideoFrameDelta);
+  source_.SendFrame(VideoFrameType::kVideoFrameDelta);
+  source_.SendFrame(VideoFrameType::kVideoFrameKey, &codec_specific_info);
+  source_.SendFrame(VideoFrameType::kVideoFrameDelta);
+  encoder_->Stop();
+
+  EXPECT_THAT(sink_.frame_types, ElementsAre(VideoFrameType::kVideoFrameKey,
+                                             VideoFrameType::kVideoFrameDelta));
+  EXPECT_EQ(sink_.frames_with_structure, 1);
+  EXPECT_EQ(source_.key_frame_requests(), 1);
+  EXPECT_FALSE(source_.sink());
+}
+
+TEST_F(PassthroughVideoStreamEncoderTest, RelaysKeyFrameRequests) {
+  source_.SendFrame(VideoFrameType::kVideoFrameKey);
+  encoder_->SendKeyFrame();
+  encoder_->SendKeyFrame({VideoFrameType::kVideoFrameKey});
+  encoder_->Stop();
+
+  EXPECT_EQ(source_.key_frame_requests(), 2);
+}
+
+TEST_F(PassthroughVideoStreamEncoderTest, ResumesAtKeyFrameAfterPause) {
+  SetTargetBitrate(DataRate::KilobitsPerSec(300));
+  EXPECT_EQ(source_.target_bitrate(), DataRate::KilobitsPerSec(300));
+  source_.SendFrame(VideoFrameType::kVideoFrameKey);
+  SetTargetBitrate(DataRate::Zero());
+  source_.SendFrame(VideoFrameType::kVideoFrameDelta);
+  SetTargetBitrate(DataRate::KilobitsPerSec(300));
+  source_.SendFrame(VideoFrameType::kVideoFrameDelta);
+  source_.SendFrame(VideoFrameType::kVideoFrameKey);
+  encoder_->Stop();
+
+  EXPECT_THAT(sink_.frame_types, ElementsAre(VideoFrameType::kVideoFrameKey,
+                                             VideoFrameType::kVideoFrameKey));
+  EXPECT_EQ(source_.key_frame_requests(), 1);
+}
+
+TEST_F(PassthroughVideoStreamEncoderTest, WaitsForKeyFrameOfAddedStream) {
+  source_.SendFrame(VideoFrameType::kVideoFrameKey);
+  VideoEncoderConfig config;
+  config.codec_type = kVideoCodecVP8;
+  config.number_of_streams = 2;
+  encoder_->ConfigureEncoder(std::move(config), 1200);
+  source_.SendFrame(VideoFrameType::kVideoFrameDelta, nullptr,
+                    /*simulcast_index=*/0);
+  source_.SendFrame(VideoFrameType::kVideoFrameDelta, nullptr,
+                    /*simulcast_index=*/1);
+  source_.SendFrame(VideoFrameType::kVideoFrameKey, nullptr,
+                    /*simulcast_index=*/1);
+  encoder_->Stop();
+
+  EXPECT_THAT(sink_.frame_types, ElementsAre(VideoFrameType::kVideoFrameKey,
+                                             VideoFrameType::kVideoFrameDelta,
+                                             VideoFrameType::kVideoFrameKey));
+  EXPECT_EQ(source_.key_frame_requests(), 1);
+}
+
+TEST_F(PassthroughVideoStreamEncoderTest, ReportsConfiguredStreams) {
+  VideoEncoderConfig config;
+  config.codec_type = kVideoCodecVP9;
+  config.number_of_streams = 1;
+  config.max_bitrate_bps = 1'000'000;
+  config.simulcast_layers.resize(1);
+  config.simulcast_layers[0].scalability_mode = ScalabilityMode::kL3T3;
+  bool configured = false;
+  encoder_->ConfigureEncoder(std::move(config), 1200,
+                             [&](RTCError error) { configured = error.ok(); });
+  encoder_->Stop();
+
+  EXPECT_TRUE(configured);
+  ASSERT_EQ(sink_.configs.size(), 1u);
+  EXPECT_TRUE(sink_.configs[0].is_svc);
+  ASSERT_EQ(sink_.configs[0].streams.size(), 1u);
+  EXPECT_EQ(sink_.configs[0].streams[0].max_bitrate_bps, 1'000'000);
+  EXPECT_EQ(sink_.configs[0].streams[0].num_temporal_layers, 3u);
+  EXPECT_GT(sink_.configs[0].streams[0].bitrate_priority.value_or(0), 0);
+}
+
+}  // namespace
+}  // namespace webrtc
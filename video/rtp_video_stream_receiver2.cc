@@ -654,6 +654,9 @@ bool RtpVideoStreamReceiver2::OnReceivedPayloadData(
   }
 
   if (packet->codec() == kVideoCodecH264 && !h26x_packet_buffer_) {
+    // Without the H26x packet buffer the payload is copied here to insert
+    // start codes, and again when the frame is assembled. The H26x packet
+    // buffer writes each payload to its place in the frame only once.
     video_coding::H264SpsPpsTracker::FixedBitstream fixed =
         tracker_.CopyAndFixBitstream(
             rtc::MakeArrayView(codec_payload.cdata(), codec_payload.size()),
@@ -763,6 +766,7 @@ void RtpVideoStreamReceiver2::OnInsertedPacket(
   int64_t max_recv_time;
   std::vector<rtc::ArrayView<const uint8_t>> payloads;
   RtpPacketInfos::vector_type packet_infos;
+  size_t num_frames = 0;
 
   bool frame_boundary = true;
   for (auto& packet : result.packets) {
@@ -783,7 +787,9 @@ void RtpVideoStreamReceiver2::OnInsertedPacket(
       min_recv_time = std::min(min_recv_time, packet_info.receive_time().ms());
       max_recv_time = std::max(max_recv_time, packet_info.receive_time().ms());
     }
-    payloads.emplace_back(packet->video_payload);
+    if (result.bitstreams.empty()) {
+      payloads.emplace_back(packet->video_payload);
+    }
     packet_infos.push_back(packet_info);
 
     frame_boundary = packet->is_last_packet_in_frame();
@@ -792,8 +798,12 @@ void RtpVideoStreamReceiver2::OnInsertedPacket(
       RTC_CHECK(depacketizer_it != payload_type_map_.end());
       RTC_CHECK(depacketizer_it->second);
 
+      // The packet buffer may have assembled the frame already.
       rtc::scoped_refptr<EncodedImageBuffer> bitstream =
-          depacketizer_it->second->AssembleFrame(payloads);
+          result.bitstreams.empty()
+              ? depacketizer_it->second->AssembleFrame(payloads)
+              : std::move(result.bitstreams[num_frames]);
+      ++num_frames;
       if (!bitstream) {
         // Failed to assemble a frame. Discard and continue.
         continue;
@@ -0,0 +1,1137 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/shared_video_stream_encoder.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/algorithm/container.h"
+#include "absl/types/optional.h"
+#include "api/adaptation/resource.h"
+#include "api/environment/environment_factory.h"
+#include "api/make_ref_counted.h"
+#include "api/ref_counted_base.h"
+#include "api/rtc_event_log/rtc_event_log.h"
+#include "api/rtp_parameters.h"
+#include "api/task_queue/task_queue_base.h"
+#include "api/units/data_rate.h"
+#include "api/units/time_delta.h"
+#include "api/units/timestamp.h"
+#include "api/video/encoded_image.h"
+#include "api/video/video_bitrate_allocation.h"
+#include "api/video/video_layers_allocation.h"
+#include "api/video_codecs/video_codec.h"
+#include "media/base/media_channel.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/logging.h"
+#include "video/config/video_encoder_config.h"
+
+namespace webrtc {
+namespace {
+
+// A key frame request is considered lost if no key frame was encoded this long
+// after it, and later requests are forwarded again.
+constexpr TimeDelta kKeyFrameRequestTimeout = TimeDelta::Millis(500);
+
+struct BitrateUpdate {
+  DataRate target_bitrate = DataRate::Zero();
+  DataRate stable_target_bitrate = DataRate::Zero();
+  DataRate link_allocation = DataRate::Zero();
+  uint8_t fraction_lost = 0;
+  int64_t round_trip_time_ms = 0;
+  double cwnd_reduce_ratio = 0;
+};
+
+bool SameParams(const SharedVideoStreamEncoderRegistry::EncoderParams& a,
+                const SharedVideoStreamEncoderRegistry::EncoderParams& b) {
+  return a.num_cpu_cores == b.num_cpu_cores &&
+         a.settings.experiment_cpu_load_estimator ==
+             b.settings.experiment_cpu_load_estimator &&
+         a.settings.encoder_factory == b.settings.encoder_factory &&
+         a.settings.bitrate_allocator_factory ==
+             b.settings.bitrate_allocator_factory &&
+         a.settings.capabilities.loss_notification ==
+             b.settings.capabilities.loss_notification &&
+         a.bitrate_allocation_callback_type ==
+             b.bitrate_allocation_callback_type &&
+         a.metronome == b.metronome;
+}
+
+// Whether encoders created with `a` behave like ones created with `b`.
+bool SameEnvironment(const Environment& a, const Environment& b) {
+  return &a.field_trials() == &b.field_trials() && &a.clock() == &b.clock() &&
+         &a.task_queue_factory() == &b.task_queue_factory();
+}
+
+// The environment of a shared encoder, copied from the stream that starts it
+// except for the event log, which belongs to the call of that stream.
+Environment CreateSharedEnvironment(const Environment& env) {
+  EnvironmentFactory factory(env);
+  factory.Set(std::make_unique<RtcEventLogNull>());
+  return factory.Create();
+}
+
+bool SameStream(const VideoStream& a, const VideoStream& b) {
+  return a.ToString() == b.ToString() &&
+         a.scalability_mode == b.scalability_mode &&
+         a.requested_resolution == b.requested_resolution;
+}
+
+bool SameEncoderSpecificSettings(const VideoEncoderConfig& a,
+                                 const VideoEncoderConfig& b) {
+  if (a.encoder_specific_settings == b.encoder_specific_settings) {
+    return true;
+  }
+  if (!a.encoder_specific_settings || !b.encoder_specific_settings) {
+    return false;
+  }
+  // The settings are created anew for every configuration, so compare what
+  // they write into a codec.
+  VideoCodec codec_a;
+  VideoCodec codec_b;
+  codec_a.codecType = a.codec_type;
+  codec_b.codecType = b.codec_type;
+  a.encoder_specific_settings->FillEncoderSpecificSettings(&codec_a);
+  b.encoder_specific_settings->FillEncoderSpecificSettings(&codec_b);
+  switch (a.codec_type) {
+    case kVideoCodecVP8:
+      return *codec_a.VP8() == *codec_b.VP8();
+    case kVideoCodecVP9:
+      return codec_a.VP9() == codec_b.VP9();
+    case kVideoCodecAV1:
+      return codec_a.AV1() == codec_b.AV1();
+    default:
+      return false;
+  }
+}
+
+// Whether an encoder configured with `a` produces what one configured with `b`
+// would.
+bool SameConfig(const VideoEncoderConfig& a, const VideoEncoderConfig& b) {
+  return a.codec_type == b.codec_type && a.video_format == b.video_format &&
+         a.video_stream_factory == b.video_stream_factory &&
+         a.spatial_layers == b.spatial_layers &&
+         a.content_type == b.content_type &&
+         a.frame_drop_enabled == b.frame_drop_enabled &&
+         a.min_transmit_bitrate_bps == b.min_transmit_bitrate_bps &&
+         a.max_bitrate_bps == b.max_bitrate_bps &&
+         a.bitrate_priority == b.bitrate_priority &&
+         absl::c_equal(a.simulcast_layers, b.simulcast_layers, SameStream) &&
+         a.number_of_streams == b.number_of_streams &&
+         a.legacy_conference_mode == b.legacy_conference_mode &&
+         a.is_quality_scaling_allowed == b.is_quality_scaling_allowed &&
+         a.max_qp == b.max_qp && SameEncoderSpecificSettings(a, b);
+}
+
+}  // namespace
+
+// The VideoStreamEncoderInterface handed to one send stream. Its state is kept
+// on the worker queue and read by the registry when it moves the stream
+// between shared encoders.
+class SharedVideoStreamEncoderRegistry::Subscriber
+    : public VideoStreamEncoderInterface {
+ public:
+  Subscriber(SharedVideoStreamEncoderRegistry& registry,
+             const Environment& env,
+             EncoderParams params,
+             VideoStreamEncoderObserver* observer,
+             EncoderFactory create_encoder)
+      : registry(registry),
+        env(env),
+        worker_queue(TaskQueueBase::Current()),
+        params(std::move(params)),
+        observer(observer),
+        create_encoder(std::move(create_encoder)) {
+    RTC_DCHECK(worker_queue);
+  }
+
+  ~Subscriber() override {
+    RTC_DCHECK_RUN_ON(worker_queue);
+    if (!stopped) {
+      Stop();
+    }
+  }
+
+  // VideoStreamEncoderInterface implementation.
+  void AddAdaptationResource(rtc::scoped_refptr<Resource> resource) override;
+  void RemoveAdaptationResource(rtc::scoped_refptr<Resource> resource) override;
+  std::vector<rtc::scoped_refptr<Resource>> GetAdaptationResources() override;
+  void SetSource(rtc::VideoSourceInterface<VideoFrame>* source,
+                 const DegradationPreference& degradation_preference) override;
+  void SetSink(EncoderSink* sink, bool rotation_applied) override;
+  void SetStartBitrate(int start_bitrate_bps) override;
+  void SendKeyFrame(const std::vector<VideoFrameType>& layers) override;
+  void OnLossNotification(
+      const VideoEncoder::LossNotification& loss_notification) override;
+  void OnBitrateUpdated(DataRate target_bitrate,
+                        DataRate stable_target_bitrate,
+                        DataRate link_allocation,
+                        uint8_t fraction_lost,
+                        int64_t round_trip_time_ms,
+                        double cwnd_reduce_ratio) override;
+  void SetFecControllerOverride(
+      FecControllerOverride* fec_controller_override) override;
+  void ConfigureEncoder(VideoEncoderConfig config,
+                        size_t max_data_payload_length) override;
+  void ConfigureEncoder(VideoEncoderConfig config,
+                        size_t max_data_payload_length,
+                        SetParametersCallback callback) override;
+  void Stop() override;
+
+  // Whether the stream has everything an encoder is started with.
+  bool ready() const {
+    RTC_DCHECK_RUN_ON(worker_queue);
+    return !stopped && source && sink && config;
+  }
+  rtc::scoped_refptr<Group> group() const {
+    MutexLock lock(&group_mutex);
+    return group_;
+  }
+  void set_group(rtc::scoped_refptr<Group> group) {
+    MutexLock lock(&group_mutex);
+    group_ = std::move(group);
+  }
+
+  SharedVideoStreamEncoderRegistry& registry;
+  const Environment env;
+  TaskQueueBase* const worker_queue;
+  const EncoderParams params;
+  VideoStreamEncoderObserver* const observer;
+  EncoderFactory create_encoder RTC_GUARDED_BY(worker_queue);
+
+  rtc::VideoSourceInterface<VideoFrame>* source RTC_GUARDED_BY(worker_queue) =
+      nullptr;
+  DegradationPreference degradation_preference RTC_GUARDED_BY(worker_queue) =
+      DegradationPreference::DISABLED;
+  EncoderSink* sink RTC_GUARDED_BY(worker_queue) = nullptr;
+  bool rotation_applied RTC_GUARDED_BY(worker_queue) = false;
+  int start_bitrate_bps RTC_GUARDED_BY(worker_queue) = 0;
+  absl::optional<VideoEncoderConfig> config RTC_GUARDED_BY(worker_queue);
+  size_t max_data_payload_length RTC_GUARDED_BY(worker_queue) = 0;
+  std::vector<rtc::scoped_refptr<Resource>> resources
+      RTC_GUARDED_BY(worker_queue);
+  BitrateUpdate bitrate RTC_GUARDED_BY(worker_queue);
+  bool stopped RTC_GUARDED_BY(worker_queue) = false;
+
+ private:
+  // Also read from the network thread for key frame requests.
+  mutable Mutex group_mutex;
+  rtc::scoped_refptr<Group> group_ RTC_GUARDED_BY(group_mutex);
+};
+
+// A shared VideoStreamEncoder and the streams subscribed to it. Forwards what
+// the encoder produces to all of them.
+class SharedVideoStreamEncoderRegistry::Group
+    : public rtc::RefCountedBase,
+      public VideoStreamEncoderInterface::EncoderSink,
+      public VideoStreamEncoderObserver,
+      public EncoderSwitchRequestCallback {
+ public:
+  // Creates the encoder for `subscriber` and configures it, calling `callback`
+  // once the configuration is applied.
+  Group(Subscriber& subscriber, SetParametersCallback callback);
+
+  // Whether `subscriber` would configure the encoder the way it is.
+  bool Matches(const Subscriber& subscriber) const;
+  // Whether the encoder can be reconfigured for `subscriber`, which must
+  // already be subscribed.
+  bool CanReconfigure(const Subscriber& subscriber) const;
+  // Reconfigures the encoder for its only subscriber.
+  void Reconfigure(Subscriber& subscriber, SetParametersCallback callback);
+  // `subscriber` gets encoded images starting with the next key frame.
+  void Add(Subscriber& subscriber);
+  // After returning, nothing is delivered to `subscriber` anymore and the
+  // encoder no longer adapts to its resources.
+  void Remove(Subscriber& subscriber);
+  size_t num_subscribers() const;
+  // Stops the encoder once the last subscriber was removed.
+  void Stop();
+
+  // Resources are counted, since the streams of one call share its resources.
+  void AddAdaptationResource(rtc::scoped_refptr<Resource> resource);
+  void RemoveAdaptationResource(rtc::scoped_refptr<Resource> resource);
+  void RequestKeyFrame(const std::vector<VideoFrameType>& layers);
+  void OnLossNotification(
+      const Subscriber& subscriber,
+      const VideoEncoder::LossNotification& loss_notification);
+  void UpdateBitrate();
+
+  // VideoStreamEncoderInterface::EncoderSink implementation.
+  Result OnEncodedImage(const EncodedImage& encoded_image,
+                        const CodecSpecificInfo* codec_specific_info) override;
+  void OnDroppedFrame(EncodedImageCallback::DropReason reason) override;
+  void OnEncoderConfigurationChanged(
+      std::vector<VideoStream> streams,
+      bool is_svc,
+      VideoEncoderConfig::ContentType content_type,
+      int min_transmit_bitrate_bps) override;
+  void OnBitrateAllocationUpdated(
+      const VideoBitrateAllocation& allocation) override;
+  void OnVideoLayersAllocationUpdated(
+      VideoLayersAllocation allocation) override;
+
+  // VideoStreamEncoderObserver implementation.
+  void OnEncodedFrameTimeMeasured(int encode_duration_ms,
+                                  int encode_usage_percent) override;
+  void OnIncomingFrame(int width, int height) override;
+  void OnSendEncodedImage(const EncodedImage& encoded_image,
+                          const CodecSpecificInfo* codec_info) override;
+  void OnEncoderImplementationChanged(
+      EncoderImplementation implementation) override;
+  void OnFrameDropped(VideoStreamEncoderObserver::DropReason reason) override;
+  void OnEncoderReconfigured(const VideoEncoderConfig& encoder_config,
+                             const std::vector<VideoStream>& streams) override;
+  void OnAdaptationChanged(
+      VideoAdaptationReason reason,
+      const VideoAdaptationCounters& cpu_steps,
+      const VideoAdaptationCounters& quality_steps) override;
+  void ClearAdaptationStats() override;
+  void UpdateAdaptationSettings(AdaptationSettings cpu_settings,
+                                AdaptationSettings quality_settings) override;
+  void OnMinPixelLimitReached() override;
+  void OnInitialQualityResolutionAdaptDown() override;
+  void OnSuspendChange(bool is_suspended) override;
+  void OnBitrateAllocationUpdated(
+      const VideoCodec& codec,
+      const VideoBitrateAllocation& allocation) override;
+  void OnEncoderInternalScalerUpdate(bool is_scaled) override;
+  int GetInputFrameRate() const override;
+
+  // EncoderSwitchRequestCallback implementation.
+  void RequestEncoderFallback() override;
+  void RequestEncoderSwitch(const SdpVideoFormat& format,
+                            bool allow_default_fallback) override;
+
+ private:
+  struct Member {
+    Subscriber* subscriber;
+    EncoderSink* sink;
+    VideoStreamEncoderObserver* observer;
+    EncoderSwitchRequestCallback* switch_callback;
+    // Set for subscribers that joined a running encoder. They are sent the
+    // latest configuration along with the first key frame they get.
+    bool waiting_for_key_frame;
+  };
+  struct ConfigurationChange {
+    std::vector<VideoStream> streams;
+    bool is_svc;
+    VideoEncoderConfig::ContentType content_type;
+    int min_transmit_bitrate_bps;
+  };
+  struct Reconfiguration {
+    VideoEncoderConfig encoder_config;
+    std::vector<VideoStream> streams;
+  };
+  struct Implementation {
+    std::string name;
+    bool is_hardware_accelerated;
+  };
+  // What a subscriber that joined a running encoder is sent before its first
+  // key frame.
+  struct CatchUpState {
+    absl::optional<ConfigurationChange> configuration;
+    absl::optional<VideoBitrateAllocation> bitrate_allocation;
+    absl::optional<VideoLayersAllocation> layers_allocation;
+  };
+  struct Delivery {
+    EncoderSink* sink;
+    absl::optional<CatchUpState> catch_up;
+  };
+  struct ResourceUse {
+    rtc::scoped_refptr<Resource> resource;
+    int num_subscribers;
+  };
+
+  ~Group() override;
+
+  VideoStreamEncoderInterface* encoder() const;
+  void AddMember(Subscriber& subscriber, bool waiting_for_key_frame);
+  CatchUpState GetCatchUpState() const RTC_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  static void CatchUp(EncoderSink& sink, const CatchUpState& state);
+
+  const Environment env_;
+  TaskQueueBase* const worker_queue_;
+  const EncoderParams params_;
+
+  // What the encoder is configured with.
+  rtc::VideoSourceInterface<VideoFrame>* source_ RTC_GUARDED_BY(worker_queue_);
+  DegradationPreference degradation_preference_ RTC_GUARDED_BY(worker_queue_);
+  const bool rotation_applied_;
+  VideoEncoderConfig config_ RTC_GUARDED_BY(worker_queue_);
+  size_t max_data_payload_length_ RTC_GUARDED_BY(worker_queue_);
+  BitrateUpdate bitrate_ RTC_GUARDED_BY(worker_queue_);
+  std::vector<ResourceUse> resources_ RTC_GUARDED_BY(worker_queue_);
+
+  // Held while encoded images are delivered to the sinks, which is done
+  // without holding `mutex_`, so that Remove() can wait for a delivery to the
+  // leaving subscriber to finish.
+  Mutex delivery_mutex_ RTC_ACQUIRED_BEFORE(mutex_);
+  // Reused for every encoded image.
+  std::vector<Delivery> deliveries_ RTC_GUARDED_BY(delivery_mutex_);
+
+  mutable Mutex mutex_;
+  // Only reset on the worker queue, where it is used without holding `mutex_`.
+  std::unique_ptr<VideoStreamEncoderInterface> encoder_ RTC_GUARDED_BY(mutex_);
+  std::vector<Member> members_ RTC_GUARDED_BY(mutex_);
+  absl::optional<Timestamp> key_frame_requested_at_ RTC_GUARDED_BY(mutex_);
+  // Replayed to subscribers joining later.
+  absl::optional<ConfigurationChange> configuration_ RTC_GUARDED_BY(mutex_);
+  absl::optional<VideoBitrateAllocation> bitrate_allocation_
+      RTC_GUARDED_BY(mutex_);
+  absl::optional<VideoLayersAllocation> layers_allocation_
+      RTC_GUARDED_BY(mutex_);
+  absl::optional<Reconfiguration> reconfiguration_ RTC_GUARDED_BY(mutex_);
+  absl::optional<Implementation> implementation_ RTC_GUARDED_BY(mutex_);
+  absl::optional<std::pair<AdaptationSettings, AdaptationSettings>>
+      adaptation_settings_ RTC_GUARDED_BY(mutex_);
+};
+
+void SharedVideoStreamEncoderRegistry::Subscriber::AddAdaptationResource(
+    rtc::scoped_refptr<Resource> resource) {
+  RTC_DCHECK_RUN_ON(worker_queue);
+  resources.push_back(resource);
+  if (rtc::scoped_refptr<Group> current = group()) {
+    current->AddAdaptationResource(resource);
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Subscriber::RemoveAdaptationResource(
+    rtc::scoped_refptr<Resource> resource) {
+  RTC_DCHECK_RUN_ON(worker_queue);
+  auto it = absl::c_find(resources, resource);
+  if (it == resources.end()) {
+    return;
+  }
+  resources.erase(it);
+  if (rtc::scoped_refptr<Group> current = group()) {
+    current->RemoveAdaptationResource(resource);
+  }
+}
+
+std::vector<rtc::scoped_refptr<Resource>>
+SharedVideoStreamEncoderRegistry::Subscriber::GetAdaptationResources() {
+  RTC_DCHECK_RUN_ON(worker_queue);
+  return resources;
+}
+
+void SharedVideoStreamEncoderRegistry::Subscriber::SetSource(
+    rtc::VideoSourceInterface<VideoFrame>* new_source,
+    const DegradationPreference& new_degradation_preference) {
+  RTC_DCHECK_RUN_ON(worker_queue);
+  source = new_source;
+  degradation_preference = new_degradation_preference;
+  registry.Update(*this, nullptr);
+}
+
+void SharedVideoStreamEncoderRegistry::Subscriber::SetSink(
+    EncoderSink* new_sink,
+    bool new_rotation_applied) {
+  RTC_DCHECK_RUN_ON(worker_queue);
+  // The shared encoder remembers the sink of every subscriber.
+  registry.Leave(*this);
+  sink = new_sink;
+  rotation_applied = new_rotation_applied;
+  registry.Update(*this, nullptr);
+}
+
+void SharedVideoStreamEncoderRegistry::Subscriber::SetStartBitrate(
+    int start_bitrate) {
+  RTC_DCHECK_RUN_ON(worker_queue);
+  // Only used when the stream starts a shared encoder.
+  start_bitrate_bps = start_bitrate;
+}
+
+void SharedVideoStreamEncoderRegistry::Subscriber::SendKeyFrame(
+    const std::vector<VideoFrameType>& layers) {
+  if (rtc::scoped_refptr<Group> current = group()) {
+    current->RequestKeyFrame(layers);
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Subscriber::OnLossNotification(
+    const VideoEncoder::LossNotification& loss_notification) {
+  if (rtc::scoped_refptr<Group> current = group()) {
+    current->OnLossNotification(*this, loss_notification);
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Subscriber::OnBitrateUpdated(
+    DataRate target_bitrate,
+    DataRate stable_target_bitrate,
+    DataRate link_allocation,
+    uint8_t fraction_lost,
+    int64_t round_trip_time_ms,
+    double cwnd_reduce_ratio) {
+  RTC_DCHECK_RUN_ON(worker_queue);
+  bitrate = {.target_bitrate = target_bitrate,
+             .stable_target_bitrate = stable_target_bitrate,
+             .link_allocation = link_allocation,
+             .fraction_lost = fraction_lost,
+             .round_trip_time_ms = round_trip_time_ms,
+             .cwnd_reduce_ratio = cwnd_reduce_ratio};
+  if (rtc::scoped_refptr<Group> current = group()) {
+    current->UpdateBitrate();
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Subscriber::SetFecControllerOverride(
+    FecControllerOverride* fec_controller_override) {
+  // The override belongs to the RTP sender of one stream, which may leave the
+  // shared encoder before it is destroyed. Encoders work without one.
+}
+
+void SharedVideoStreamEncoderRegistry::Subscriber::ConfigureEncoder(
+    VideoEncoderConfig new_config,
+    size_t new_max_data_payload_length) {
+  ConfigureEncoder(std::move(new_config), new_max_data_payload_length,
+                   nullptr);
+}
+
+void SharedVideoStreamEncoderRegistry::Subscriber::ConfigureEncoder(
+    VideoEncoderConfig new_config,
+    size_t new_max_data_payload_length,
+    SetParametersCallback callback) {
+  RTC_DCHECK_RUN_ON(worker_queue);
+  config = std::move(new_config);
+  max_data_payload_length = new_max_data_payload_length;
+  registry.Update(*this, std::move(callback));
+}
+
+void SharedVideoStreamEncoderRegistry::Subscriber::Stop() {
+  RTC_DCHECK_RUN_ON(worker_queue);
+  stopped = true;
+  registry.Leave(*this);
+}
+
+SharedVideoStreamEncoderRegistry::Group::Group(Subscriber& subscriber,
+                                               SetParametersCallback callback)
+    : env_(CreateSharedEnvironment(subscriber.env)),
+      worker_queue_(subscriber.worker_queue),
+      params_(subscriber.params),
+      rotation_applied_(subscriber.rotation_applied) {
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  RTC_DCHECK_RUN_ON(subscriber.worker_queue);
+  RTC_DCHECK(subscriber.ready());
+  source_ = subscriber.source;
+  degradation_preference_ = subscriber.degradation_preference;
+  config_ = subscriber.config->Copy();
+  max_data_payload_length_ = subscriber.max_data_payload_length;
+
+  EncoderParams params = subscriber.params;
+  params.settings.encoder_switch_request_callback = this;
+  {
+    MutexLock lock(&mutex_);
+    encoder_ = subscriber.create_encoder(env_, params, this);
+  }
+  encoder()->SetSink(this, rotation_applied_);
+  encoder()->SetStartBitrate(subscriber.start_bitrate_bps);
+  encoder()->SetSource(source_, degradation_preference_);
+  for (const rtc::scoped_refptr<Resource>& resource : subscriber.resources) {
+    AddAdaptationResource(resource);
+  }
+  encoder()->ConfigureEncoder(config_.Copy(), max_data_payload_length_,
+                              std::move(callback));
+  AddMember(subscriber, /*waiting_for_key_frame=*/false);
+  UpdateBitrate();
+}
+
+SharedVideoStreamEncoderRegistry::Group::~Group() {
+  RTC_DCHECK(!encoder_);
+}
+
+bool SharedVideoStreamEncoderRegistry::Group::Matches(
+    const Subscriber& subscriber) const {
+  if (subscriber.worker_queue != worker_queue_) {
+    return false;
+  }
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  RTC_DCHECK_RUN_ON(subscriber.worker_queue);
+  return subscriber.ready() && subscriber.source == source_ &&
+         subscriber.degradation_preference == degradation_preference_ &&
+         subscriber.rotation_applied == rotation_applied_ &&
+         subscriber.max_data_payload_length == max_data_payload_length_ &&
+         SameEnvironment(subscriber.env, env_) &&
+         SameParams(subscriber.params, params_) &&
+         SameConfig(*subscriber.config, config_);
+}
+
+bool SharedVideoStreamEncoderRegistry::Group::CanReconfigure(
+    const Subscriber& subscriber) const {
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  RTC_DCHECK_RUN_ON(subscriber.worker_queue);
+  return subscriber.ready() && num_subscribers() == 1 &&
+         subscriber.rotation_applied == rotation_applied_ &&
+         SameParams(subscriber.params, params_);
+}
+
+void SharedVideoStreamEncoderRegistry::Group::Reconfigure(
+    Subscriber& subscriber,
+    SetParametersCallback callback) {
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  RTC_DCHECK_RUN_ON(subscriber.worker_queue);
+  RTC_DCHECK(CanReconfigure(subscriber));
+  if (subscriber.source != source_ ||
+      subscriber.degradation_preference != degradation_preference_) {
+    source_ = subscriber.source;
+    degradation_preference_ = subscriber.degradation_preference;
+    encoder()->SetSource(source_, degradation_preference_);
+  }
+  config_ = subscriber.config->Copy();
+  max_data_payload_length_ = subscriber.max_data_payload_length;
+  encoder()->ConfigureEncoder(config_.Copy(), max_data_payload_length_,
+                              std::move(callback));
+}
+
+void SharedVideoStreamEncoderRegistry::Group::Add(Subscriber& subscriber) {
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  RTC_DCHECK_RUN_ON(subscriber.worker_queue);
+  for (const rtc::scoped_refptr<Resource>& resource : subscriber.resources) {
+    AddAdaptationResource(resource);
+  }
+  AddMember(subscriber, /*waiting_for_key_frame=*/true);
+  UpdateBitrate();
+  RequestKeyFrame({});
+}
+
+void SharedVideoStreamEncoderRegistry::Group::AddMember(
+    Subscriber& subscriber,
+    bool waiting_for_key_frame) {
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  RTC_DCHECK_RUN_ON(subscriber.worker_queue);
+  MutexLock lock(&mutex_);
+  members_.push_back(
+      {.subscriber = &subscriber,
+       .sink = subscriber.sink,
+       .observer = subscriber.observer,
+       .switch_callback = subscriber.params.settings
+                              .encoder_switch_request_callback,
+       .waiting_for_key_frame = waiting_for_key_frame});
+  // Bring the stats of the new subscriber up to date.
+  VideoStreamEncoderObserver* observer = subscriber.observer;
+  if (reconfiguration_) {
+    observer->OnEncoderReconfigured(reconfiguration_->encoder_config,
+                                    reconfiguration_->streams);
+  }
+  if (implementation_) {
+    observer->OnEncoderImplementationChanged(
+        {.name = implementation_->name,
+         .is_hardware_accelerated = implementation_->is_hardware_accelerated});
+  }
+  if (adaptation_settings_) {
+    observer->UpdateAdaptationSettings(adaptation_settings_->first,
+                                       adaptation_settings_->second);
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::Remove(Subscriber& subscriber) {
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  RTC_DCHECK_RUN_ON(subscriber.worker_queue);
+  {
+    MutexLock delivery_lock(&delivery_mutex_);
+    MutexLock lock(&mutex_);
+    auto it = absl::c_find_if(members_, [&](const Member& member) {
+      return member.subscriber == &subscriber;
+    });
+    RTC_DCHECK(it != members_.end());
+    members_.erase(it);
+  }
+  for (const rtc::scoped_refptr<Resource>& resource : subscriber.resources) {
+    RemoveAdaptationResource(resource);
+  }
+  UpdateBitrate();
+}
+
+size_t SharedVideoStreamEncoderRegistry::Group::num_subscribers() const {
+  MutexLock lock(&mutex_);
+  return members_.size();
+}
+
+void SharedVideoStreamEncoderRegistry::Group::Stop() {
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  std::unique_ptr<VideoStreamEncoderInterface> encoder;
+  {
+    MutexLock lock(&mutex_);
+    RTC_DCHECK(members_.empty());
+    encoder = std::move(encoder_);
+  }
+  // Delivers to this group until stopped, so it is done without the lock.
+  encoder->Stop();
+}
+
+VideoStreamEncoderInterface* SharedVideoStreamEncoderRegistry::Group::encoder()
+    const {
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  MutexLock lock(&mutex_);
+  return encoder_.get();
+}
+
+void SharedVideoStreamEncoderRegistry::Group::AddAdaptationResource(
+    rtc::scoped_refptr<Resource> resource) {
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  auto it = absl::c_find_if(resources_, [&](const ResourceUse& use) {
+    return use.resource == resource;
+  });
+  if (it != resources_.end()) {
+    ++it->num_subscribers;
+    return;
+  }
+  resources_.push_back({.resource = resource, .num_subscribers = 1});
+  encoder()->AddAdaptationResource(std::move(resource));
+}
+
+void SharedVideoStreamEncoderRegistry::Group::RemoveAdaptationResource(
+    rtc::scoped_refptr<Resource> resource) {
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  auto it = absl::c_find_if(resources_, [&](const ResourceUse& use) {
+    return use.resource == resource;
+  });
+  RTC_DCHECK(it != resources_.end());
+  if (it == resources_.end() || --it->num_subscribers > 0) {
+    return;
+  }
+  resources_.erase(it);
+  encoder()->RemoveAdaptationResource(std::move(resource));
+}
+
+void SharedVideoStreamEncoderRegistry::Group::RequestKeyFrame(
+    const std::vector<VideoFrameType>& layers) {
+  MutexLock lock(&mutex_);
+  if (!encoder_) {
+    return;
+  }
+  const Timestamp now = env_.clock().CurrentTime();
+  if (key_frame_requested_at_ &&
+      now - *key_frame_requested_at_ < kKeyFrameRequestTimeout) {
+    // The key frame already requested serves this request too.
+    return;
+  }
+  // Requests for specific layers are forwarded but do not hold back others.
+  if (layers.empty()) {
+    key_frame_requested_at_ = now;
+  }
+  encoder_->SendKeyFrame(layers);
+}
+
+void SharedVideoStreamEncoderRegistry::Group::OnLossNotification(
+    const Subscriber& subscriber,
+    const VideoEncoder::LossNotification& loss_notification) {
+  MutexLock lock(&mutex_);
+  // Loss of one receiver should not make the encoder protect all of them.
+  if (encoder_ && members_.size() == 1 &&
+      members_.front().subscriber == &subscriber) {
+    encoder_->OnLossNotification(loss_notification);
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::UpdateBitrate() {
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  absl::optional<BitrateUpdate> lowest;
+  {
+    MutexLock lock(&mutex_);
+    for (const Member& member : members_) {
+      RTC_DCHECK_RUN_ON(member.subscriber->worker_queue);
+      const BitrateUpdate& bitrate = member.subscriber->bitrate;
+      // Paused streams do not hold back the others.
+      if (bitrate.target_bitrate.IsZero()) {
+        continue;
+      }
+      if (!lowest || bitrate.target_bitrate < lowest->target_bitrate) {
+        lowest = bitrate;
+      }
+    }
+  }
+  const BitrateUpdate update = lowest.value_or(BitrateUpdate());
+  if (update.target_bitrate == bitrate_.target_bitrate &&
+      update.stable_target_bitrate == bitrate_.stable_target_bitrate &&
+      update.link_allocation == bitrate_.link_allocation &&
+      update.fraction_lost == bitrate_.fraction_lost &&
+      update.round_trip_time_ms == bitrate_.round_trip_time_ms &&
+      update.cwnd_reduce_ratio == bitrate_.cwnd_reduce_ratio) {
+    return;
+  }
+  bitrate_ = update;
+  encoder()->OnBitrateUpdated(update.target_bitrate,
+                              update.stable_target_bitrate,
+                              update.link_allocation, update.fraction_lost,
+                              update.round_trip_time_ms,
+                              update.cwnd_reduce_ratio);
+}
+
+SharedVideoStreamEncoderRegistry::Group::CatchUpState
+SharedVideoStreamEncoderRegistry::Group::GetCatchUpState() const {
+  return {.configuration = configuration_,
+          .bitrate_allocation = bitrate_allocation_,
+          .layers_allocation = layers_allocation_};
+}
+
+void SharedVideoStreamEncoderRegistry::Group::CatchUp(
+    EncoderSink& sink,
+    const CatchUpState& state) {
+  if (state.configuration) {
+    sink.OnEncoderConfigurationChanged(
+        state.configuration->streams, state.configuration->is_svc,
+        state.configuration->content_type,
+        state.configuration->min_transmit_bitrate_bps);
+  }
+  if (state.bitrate_allocation) {
+    sink.OnBitrateAllocationUpdated(*state.bitrate_allocation);
+  }
+  if (state.layers_allocation) {
+    sink.OnVideoLayersAllocationUpdated(*state.layers_allocation);
+  }
+}
+
+EncodedImageCallback::Result
+SharedVideoStreamEncoderRegistry::Group::OnEncodedImage(
+    const EncodedImage& encoded_image,
+    const CodecSpecificInfo* codec_specific_info) {
+  const bool key_frame =
+      encoded_image.FrameType() == VideoFrameType::kVideoFrameKey;
+  MutexLock delivery_lock(&delivery_mutex_);
+  deliveries_.clear();
+  {
+    MutexLock lock(&mutex_);
+    if (key_frame) {
+      key_frame_requested_at_ = absl::nullopt;
+    }
+    for (Member& member : members_) {
+      if (!member.waiting_for_key_frame) {
+        deliveries_.push_back({.sink = member.sink});
+      } else if (key_frame) {
+        member.waiting_for_key_frame = false;
+        deliveries_.push_back(
+            {.sink = member.sink, .catch_up = GetCatchUpState()});
+      }
+    }
+  }
+  // Packetizing for every subscriber takes a while, during which key frame
+  // requests and stats updates should not wait.
+  Result result(Result::ERROR_SEND_FAILED);
+  for (const Delivery& delivery : deliveries_) {
+    if (delivery.catch_up) {
+      CatchUp(*delivery.sink, *delivery.catch_up);
+    }
+    Result sink_result =
+        delivery.sink->OnEncodedImage(encoded_image, codec_specific_info);
+    if (sink_result.error == Result::OK) {
+      result = sink_result;
+    }
+  }
+  return result;
+}
+
+void SharedVideoStreamEncoderRegistry::Group::OnDroppedFrame(
+    EncodedImageCallback::DropReason reason) {
+  MutexLock lock(&mutex_);
+  for (const Member& member : members_) {
+    member.sink->OnDroppedFrame(reason);
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::OnEncoderConfigurationChanged(
+    std::vector<VideoStream> streams,
+    bool is_svc,
+    VideoEncoderConfig::ContentType content_type,
+    int min_transmit_bitrate_bps) {
+  MutexLock lock(&mutex_);
+  configuration_ =
+      ConfigurationChange{.streams = streams,
+                          .is_svc = is_svc,
+                          .content_type = content_type,
+                          .min_transmit_bitrate_bps = min_transmit_bitrate_bps};
+  for (const Member& member : members_) {
+    if (!member.waiting_for_key_frame) {
+      member.sink->OnEncoderConfigurationChanged(
+          streams, is_svc, content_type, min_transmit_bitrate_bps);
+    }
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::OnBitrateAllocationUpdated(
+    const VideoBitrateAllocation& allocation) {
+  MutexLock lock(&mutex_);
+  bitrate_allocation_ = allocation;
+  for (const Member& member : members_) {
+    if (!member.waiting_for_key_frame) {
+      member.sink->OnBitrateAllocationUpdated(allocation);
+    }
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::OnVideoLayersAllocationUpdated(
+    VideoLayersAllocation allocation) {
+  MutexLock lock(&mutex_);
+  layers_allocation_ = allocation;
+  for (const Member& member : members_) {
+    if (!member.waiting_for_key_frame) {
+      member.sink->OnVideoLayersAllocationUpdated(allocation);
+    }
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::OnEncodedFrameTimeMeasured(
+    int encode_duration_ms,
+    int encode_usage_percent) {
+  MutexLock lock(&mutex_);
+  for (const Member& member : members_) {
+    member.observer->OnEncodedFrameTimeMeasured(encode_duration_ms,
+                                                encode_usage_percent);
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::OnIncomingFrame(int width,
+                                                              int height) {
+  MutexLock lock(&mutex_);
+  for (const Member& member : members_) {
+    member.observer->OnIncomingFrame(width, height);
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::OnSendEncodedImage(
+    const EncodedImage& encoded_image,
+    const CodecSpecificInfo* codec_info) {
+  MutexLock lock(&mutex_);
+  for (const Member& member : members_) {
+    member.observer->OnSendEncodedImage(encoded_image, codec_info);
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::OnEncoderImplementationChanged(
+    EncoderImplementation implementation) {
+  MutexLock lock(&mutex_);
+  implementation_ = Implementation{
+      .name = implementation.name,
+      .is_hardware_accelerated = implementation.is_hardware_accelerated};
+  for (const Member& member : members_) {
+    member.observer->OnEncoderImplementationChanged(implementation);
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::OnFrameDropped(
+    VideoStreamEncoderObserver::DropReason reason) {
+  MutexLock lock(&mutex_);
+  for (const Member& member : members_) {
+    member.observer->OnFrameDropped(reason);
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::OnEncoderReconfigured(
+    const VideoEncoderConfig& encoder_config,
+    const std::vector<VideoStream>& streams) {
+  MutexLock lock(&mutex_);
+  reconfiguration_ = Reconfiguration{
+      .encoder_config = encoder_config.Copy(), .streams = streams};
+  for (const Member& member : members_) {
+    member.observer->OnEncoderReconfigured(encoder_config, streams);
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::OnAdaptationChanged(
+    VideoAdaptationReason reason,
+    const VideoAdaptationCounters& cpu_steps,
+    const VideoAdaptationCounters& quality_steps) {
+  MutexLock lock(&mutex_);
+  for (const Member& member : members_) {
+    member.observer->OnAdaptationChanged(reason, cpu_steps, quality_steps);
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::ClearAdaptationStats() {
+  MutexLock lock(&mutex_);
+  for (const Member& member : members_) {
+    member.observer->ClearAdaptationStats();
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::UpdateAdaptationSettings(
+    AdaptationSettings cpu_settings,
+    AdaptationSettings quality_settings) {
+  MutexLock lock(&mutex_);
+  adaptation_settings_.emplace(cpu_settings, quality_settings);
+  for (const Member& member : members_) {
+    member.observer->UpdateAdaptationSettings(cpu_settings, quality_settings);
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::OnMinPixelLimitReached() {
+  MutexLock lock(&mutex_);
+  for (const Member& member : members_) {
+    member.observer->OnMinPixelLimitReached();
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::
+    OnInitialQualityResolutionAdaptDown() {
+  MutexLock lock(&mutex_);
+  for (const Member& member : members_) {
+    member.observer->OnInitialQualityResolutionAdaptDown();
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::OnSuspendChange(
+    bool is_suspended) {
+  MutexLock lock(&mutex_);
+  for (const Member& member : members_) {
+    member.observer->OnSuspendChange(is_suspended);
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::OnBitrateAllocationUpdated(
+    const VideoCodec& codec,
+    const VideoBitrateAllocation& allocation) {
+  MutexLock lock(&mutex_);
+  for (const Member& member : members_) {
+    member.observer->OnBitrateAllocationUpdated(codec, allocation);
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::OnEncoderInternalScalerUpdate(
+    bool is_scaled) {
+  MutexLock lock(&mutex_);
+  for (const Member& member : members_) {
+    member.observer->OnEncoderInternalScalerUpdate(is_scaled);
+  }
+}
+
+int SharedVideoStreamEncoderRegistry::Group::GetInputFrameRate() const {
+  MutexLock lock(&mutex_);
+  // All subscribers see the same input.
+  return members_.empty() ? 0 : members_.front().observer->GetInputFrameRate();
+}
+
+void SharedVideoStreamEncoderRegistry::Group::RequestEncoderFallback() {
+  MutexLock lock(&mutex_);
+  for (const Member& member : members_) {
+    if (member.switch_callback) {
+      member.switch_callback->RequestEncoderFallback();
+    }
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Group::RequestEncoderSwitch(
+    const SdpVideoFormat& format,
+    bool allow_default_fallback) {
+  MutexLock lock(&mutex_);
+  for (const Member& member : members_) {
+    if (member.switch_callback) {
+      member.switch_callback->RequestEncoderSwitch(format,
+                                                   allow_default_fallback);
+    }
+  }
+}
+
+SharedVideoStreamEncoderRegistry& SharedVideoStreamEncoderRegistry::Global() {
+  static SharedVideoStreamEncoderRegistry* const registry =
+      new SharedVideoStreamEncoderRegistry();
+  return *registry;
+}
+
+SharedVideoStreamEncoderRegistry::SharedVideoStreamEncoderRegistry() = default;
+
+SharedVideoStreamEncoderRegistry::~SharedVideoStreamEncoderRegistry() {
+  RTC_DCHECK(groups_.empty());
+}
+
+std::unique_ptr<VideoStreamEncoderInterface>
+SharedVideoStreamEncoderRegistry::CreateEncoder(
+    const Environment& env,
+    EncoderParams params,
+    VideoStreamEncoderObserver* observer,
+    EncoderFactory create_encoder) {
+  return std::make_unique<Subscriber>(*this, env, std::move(params), observer,
+                                      std::move(create_encoder));
+}
+
+size_t SharedVideoStreamEncoderRegistry::num_encoders() const {
+  MutexLock lock(&mutex_);
+  return groups_.size();
+}
+
+void SharedVideoStreamEncoderRegistry::Update(Subscriber& subscriber,
+                                              SetParametersCallback callback) {
+  RTC_DCHECK_RUN_ON(subscriber.worker_queue);
+  rtc::scoped_refptr<Group> current = subscriber.group();
+  rtc::scoped_refptr<Group> next;
+  rtc::scoped_refptr<Group> emptied;
+  {
+    MutexLock lock(&mutex_);
+    rtc::scoped_refptr<Group> match;
+    if (current && current->Matches(subscriber)) {
+      match = current;
+    } else if (subscriber.ready()) {
+      auto it = absl::c_find_if(
+          groups_, [&](const rtc::scoped_refptr<Group>& group) {
+            return group->Matches(subscriber);
+          });
+      if (it != groups_.end()) {
+        match = *it;
+      }
+    }
+
+    if (match == current && current) {
+      next = current;
+    } else if (!match && current && current->CanReconfigure(subscriber)) {
+      // Reconfiguring is cheaper than replacing the encoder.
+      current->Reconfigure(subscriber, std::exchange(callback, nullptr));
+      next = current;
+    } else {
+      if (current) {
+        current->Remove(subscriber);
+        if (current->num_subscribers() == 0) {
+          groups_.erase(absl::c_find(groups_, current));
+          emptied = current;
+        }
+      }
+      if (match) {
+        match->Add(subscriber);
+        next = match;
+      } else if (subscriber.ready()) {
+        next = rtc::make_ref_counted<Group>(subscriber,
+                                            std::exchange(callback, nullptr));
+        groups_.push_back(next);
+        RTC_LOG(LS_INFO) << "Started shared video encoder, "
+                         << groups_.size() << " running.";
+      }
+    }
+  }
+  subscriber.set_group(next);
+  if (emptied) {
+    emptied->Stop();
+  }
+  // Nothing was reconfigured, or the configuration is already applied.
+  if (callback) {
+    webrtc::InvokeSetParametersCallback(callback, RTCError::OK());
+  }
+}
+
+void SharedVideoStreamEncoderRegistry::Leave(Subscriber& subscriber) {
+  RTC_DCHECK_RUN_ON(subscriber.worker_queue);
+  rtc::scoped_refptr<Group> current = subscriber.group();
+  if (!current) {
+    return;
+  }
+  bool emptied = false;
+  {
+    MutexLock lock(&mutex_);
+    current->Remove(subscriber);
+    if (current->num_subscribers() == 0) {
+      groups_.erase(absl::c_find(groups_, current));
+      emptied = true;
+    }
+  }
+  subscriber.set_group(nullptr);
+  if (emptied) {
+    current->Stop();
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,112 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef VIDEO_SHARED_VIDEO_STREAM_ENCODER_H_
+#define VIDEO_SHARED_VIDEO_STREAM_ENCODER_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/functional/any_invocable.h"
+#include "api/environment/environment.h"
+#include "api/metronome/metronome.h"
+#include "api/scoped_refptr.h"
+#include "api/video/video_stream_encoder_settings.h"
+#include "rtc_base/synchronization/mutex.h"
+#include "rtc_base/thread_annotations.h"
+#include "video/video_stream_encoder.h"
+#include "video/video_stream_encoder_interface.h"
+#include "video/video_stream_encoder_observer.h"
+
+namespace webrtc {
+
+// Lets video send streams that send the same source with compatible codec
+// settings share one VideoStreamEncoder, e.g. when a server sends one capture
+// to many peer connections. Each stream gets a VideoStreamEncoderInterface of
+// its own that subscribes to a shared encoder once source, sink and encoder
+// configuration are set, and moves to another one when they change.
+//
+// Streams share an encoder if they were created on the same worker queue with
+// equal EncoderParams and the same field trials, clock and task queue factory,
+// and have the same source, degradation preference, rotation handling, encoder
+// configuration and max payload length. Every
+// subscriber receives the same encoded images, which its RTP sender packetizes
+// with its own RTP state. A stream joining an encoder that is already running
+// gets nothing until the next key frame, which it requests.
+//
+// The shared encoder targets the lowest bitrate of its subscribers that are not
+// paused. Key frame requests arriving while one is pending are served by the
+// same key frame. Loss notifications are only forwarded while a stream has the
+// encoder for itself, and FEC controller overrides are not used. The encoder
+// adapts to the resources of its current subscribers.
+class SharedVideoStreamEncoderRegistry {
+ public:
+  // What an encoder is created from besides the configuration. The encoder
+  // switch request callback does not need to match; requests are forwarded to
+  // the callbacks of all subscribers.
+  struct EncoderParams {
+    int num_cpu_cores = 1;
+    VideoStreamEncoderSettings settings{VideoEncoder::Capabilities(false)};
+    VideoStreamEncoder::BitrateAllocationCallbackType
+        bitrate_allocation_callback_type = VideoStreamEncoder::
+            BitrateAllocationCallbackType::kVideoBitrateAllocation;
+    Metronome* metronome = nullptr;
+  };
+
+  // Creates the shared encoder. It reports to `observer`, which forwards to the
+  // observers of all subscribers.
+  using EncoderFactory =
+      absl::AnyInvocable<std::unique_ptr<VideoStreamEncoderInterface>(
+          const Environment& env,
+          const EncoderParams& params,
+          VideoStreamEncoderObserver* observer)>;
+
+  // Registry shared by all video send streams that opt in with the field trial
+  // "WebRTC-Video-SharedEncoder".
+  static SharedVideoStreamEncoderRegistry& Global();
+
+  SharedVideoStreamEncoderRegistry();
+  ~SharedVideoStreamEncoderRegistry();
+
+  SharedVideoStreamEncoderRegistry(const SharedVideoStreamEncoderRegistry&) =
+      delete;
+  SharedVideoStreamEncoderRegistry& operator=(
+      const SharedVideoStreamEncoderRegistry&) = delete;
+
+  // Returns the encoder of one stream. It must be used on the current task
+  // queue, except for SendKeyFrame and OnLossNotification, and be stopped
+  // before it is destroyed. `create_encoder` is used if the stream is the
+  // first one of a shared encoder.
+  std::unique_ptr<VideoStreamEncoderInterface> CreateEncoder(
+      const Environment& env,
+      EncoderParams params,
+      VideoStreamEncoderObserver* observer,
+      EncoderFactory create_encoder);
+
+  // Number of encoders currently shared, for tests.
+  size_t num_encoders() const;
+
+ private:
+  class Group;
+  class Subscriber;
+
+  // Moves `subscriber` to the encoder matching its current state, creating
+  // one if needed, or detaches it if it is not ready to encode. `callback`, if
+  // set, is called once the configuration is applied.
+  void Update(Subscriber& subscriber, SetParametersCallback callback);
+  void Leave(Subscriber& subscriber);
+
+  mutable Mutex mutex_;
+  std::vector<rtc::scoped_refptr<Group>> groups_ RTC_GUARDED_BY(mutex_);
+};
+
+}  // namespace webrtc
+
+#endif  // VIDEO_SHARED_VIDEO_STREAM_ENCODER_H_
@@ -0,0 +1,400 @@
+/*
+ *  Copyright (c) 2024 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "video/shared_video_stream_encoder.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "api/environment/environment.h"
+#include "api/environment/environment_factory.h"
+#include "api/units/data_rate.h"
+#include "api/units/time_delta.h"
+#include "api/video/encoded_image.h"
+#include "call/adaptation/test/fake_frame_rate_provider.h"
+#include "call/adaptation/test/fake_resource.h"
+#include "rtc_base/thread.h"
+#include "system_wrappers/include/clock.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+#include "test/scoped_key_value_config.h"
+#include "video/config/video_encoder_config.h"
+#include "video/test/mock_video_stream_encoder.h"
+
+namespace webrtc {
+namespace {
+
+using ::testing::_;
+using ::testing::AnyNumber;
+using ::testing::InSequence;
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::testing::SaveArg;
+
+class MockEncoderSink : public VideoStreamEncoderInterface::EncoderSink {
+ public:
+  MOCK_METHOD(Result,
+              OnEncodedImage,
+              (const EncodedImage&, const CodecSpecificInfo*),
+              (override));
+  MOCK_METHOD(void,
+              OnEncoderConfigurationChanged,
+              (std::vector<VideoStream>,
+               bool,
+               VideoEncoderConfig::ContentType,
+               int),
+              (override));
+  MOCK_METHOD(void,
+              OnBitrateAllocationUpdated,
+              (const VideoBitrateAllocation&),
+              (override));
+  MOCK_METHOD(void,
+              OnVideoLayersAllocationUpdated,
+              (VideoLayersAllocation),
+              (override));
+};
+
+class FakeSource : public rtc::VideoSourceInterface<VideoFrame> {
+ public:
+  void AddOrUpdateSink(rtc::VideoSinkInterface<VideoFrame>* sink,
+                       const rtc::VideoSinkWants& wants) override {}
+  void RemoveSink(rtc::VideoSinkInterface<VideoFrame>* sink) override {}
+};
+
+VideoEncoderConfig CreateConfig(int max_bitrate_bps = 1'000'000) {
+  VideoEncoderConfig config;
+  config.codec_type = kVideoCodecVP8;
+  config.number_of_streams = 1;
+  config.max_bitrate_bps = max_bitrate_bps;
+  // Not initialized by VideoEncoderConfig.
+  config.max_qp = 56;
+  config.simulcast_layers.resize(1);
+  return config;
+}
+
+EncodedImage CreateImage(VideoFrameType frame_type) {
+  EncodedImage image;
+  image.SetFrameType(frame_type);
+  return image;
+}
+
+class SharedVideoStreamEncoderTest : public ::testing::Test {
+ protected:
+  // One send stream using a shared encoder.
+  struct Stream {
+    NiceMock<MockEncoderSink> sink;
+    NiceMock<MockVideoStreamEncoderObserver> observer;
+    std::unique_ptr<VideoStreamEncoderInterface> encoder;
+  };
+
+  SharedVideoStreamEncoderTest()
+      : clock_(Timestamp::Seconds(1000)), env_(CreateEnvironment(&clock_)) {}
+
+  std::unique_ptr<Stream> CreateStream() { return CreateStream(env_); }
+  std::unique_ptr<Stream> CreateStream(const Environment& env) {
+    auto stream = std::make_unique<Stream>();
+    stream->encoder = registry_.CreateEncoder(
+        env, SharedVideoStreamEncoderRegistry::EncoderParams(),
+        &stream->observer,
+        [this](const Environment& env,
+               const SharedVideoStreamEncoderRegistry::EncoderParams& params,
+               VideoStreamEncoderObserver* observer) {
+          auto encoder = std::make_unique<NiceMock<MockVideoStreamEncoder>>();
+          ON_CALL(*encoder, SetSink).WillByDefault(SaveArg<0>(&shared_sink_));
+          encoders_.push_back(encoder.get());
+          encoder_envs_.push_back(env);
+          return encoder;
+        });
+    ON_CALL(stream->sink, OnEncodedImage)
+        .WillByDefault(::testing::Return(
+            EncodedImageCallback::Result(EncodedImageCallback::Result::OK)));
+    return stream;
+  }
+
+  // Starts `stream` the way VideoSendStreamImpl does.
+  void Start(Stream& stream, VideoEncoderConfig config = CreateConfig()) {
+    stream.encoder->SetSink(&stream.sink, /*rotation_applied=*/false);
+    stream.encoder->SetStartBitrate(300'000);
+    stream.encoder->ConfigureEncoder(std::move(config), 1200);
+    stream.encoder->SetSource(&source_, DegradationPreference::BALANCED);
+  }
+
+  void Stop(Stream& stream) { stream.encoder->Stop(); }
+
+  rtc::AutoThread main_thread_;
+  SimulatedClock clock_;
+  const Environment env_;
+  FakeSource source_;
+  SharedVideoStreamEncoderRegistry registry_;
+  std::vector<MockVideoStreamEncoder*> encoders_;
+  std::vector<Environment> encoder_envs_;
+  VideoStreamEncoderInterface::EncoderSink* shared_sink_ = nullptr;
+};
+
+TEST_F(SharedVideoStreamEncoderTest, CompatibleStreamsShareEncoder) {
+  auto first = CreateStream();
+  auto second = CreateStream();
+  Start(*first);
+  Start(*second);
+
+  EXPECT_EQ(encoders_.size(), 1u);
+  EXPECT_EQ(registry_.num_encoders(), 1u);
+  Stop(*first);
+  Stop(*second);
+  EXPECT_EQ(registry_.num_encoders(), 0u);
+}
+
+TEST_F(SharedVideoStreamEncoderTest, DifferentConfigsUseSeparateEncoders) {
+  auto first = CreateStream();
+  auto second = CreateStream();
+  Start(*first, CreateConfig(/*max_bitrate_bps=*/1'000'000));
+  Start(*second, CreateConfig(/*max_bitrate_bps=*/500'000));
+
+  EXPECT_EQ(encoders_.size(), 2u);
+  Stop(*first);
+  Stop(*second);
+}
+
+TEST_F(SharedVideoStreamEncoderTest, JoiningStreamStartsAtKeyFrame) {
+  auto first = CreateStream();
+  auto second = CreateStream();
+  Start(*first);
+  ASSERT_TRUE(shared_sink_);
+  EXPECT_CALL(*encoders_[0], SendKeyFrame);
+  Start(*second);
+
+  EXPECT_CALL(first->sink, OnEncodedImage).Times(2);
+  EXPECT_CALL(second->sink, OnEncodedImage).Times(1);
+  shared_sink_->OnEncodedImage(CreateImage(VideoFrameType::kVideoFrameDelta),
+                               nullptr);
+  shared_sink_->OnEncodedImage(CreateImage(VideoFrameType::kVideoFrameKey),
+                               nullptr);
+  Stop(*first);
+  Stop(*second);
+}
+
+TEST_F(SharedVideoStreamEncoderTest, CoalescesKeyFrameRequests) {
+  auto first = CreateStream();
+  auto second = CreateStream();
+  Start(*first);
+  Start(*second);
+  ASSERT_EQ(encoders_.size(), 1u);
+
+  // The request of the joining stream is pending.
+  EXPECT_CALL(*encoders_[0], SendKeyFrame).Times(0);
+  first->encoder->SendKeyFrame({});
+  second->encoder->SendKeyFrame({});
+  ::testing::Mock::VerifyAndClearExpectations(encoders_[0]);
+
+  // Requests are forwarded again once the key frame was encoded.
+  shared_sink_->OnEncodedImage(CreateImage(VideoFrameType::kVideoFrameKey),
+                               nullptr);
+  EXPECT_CALL(*encoders_[0], SendKeyFrame).Times(1);
+  first->encoder->SendKeyFrame({});
+  second->encoder->SendKeyFrame({});
+  ::testing::Mock::VerifyAndClearExpectations(encoders_[0]);
+
+  // Or when the pending request seems lost.
+  clock_.AdvanceTime(TimeDelta::Seconds(1));
+  EXPECT_CALL(*encoders_[0], SendKeyFrame).Times(1);
+  second->encoder->SendKeyFrame({});
+  Stop(*first);
+  Stop(*second);
+}
+
+TEST_F(SharedVideoStreamEncoderTest, EncodesAtLowestBitrateOfActiveStreams) {
+  auto first = CreateStream();
+  auto second = CreateStream();
+  auto paused = CreateStream();
+  Start(*first);
+  Start(*second);
+  Start(*paused);
+  ASSERT_EQ(encoders_.size(), 1u);
+
+  EXPECT_CALL(*encoders_[0], OnBitrateUpdated).Times(AnyNumber());
+  EXPECT_CALL(*encoders_[0],
+              OnBitrateUpdated(DataRate::KilobitsPerSec(500), _, _, _, _, _));
+  first->encoder->OnBitrateUpdated(
+      DataRate::KilobitsPerSec(800), DataRate::KilobitsPerSec(800),
+      DataRate::KilobitsPerSec(800), 0, 0, 0);
+  second->encoder->OnBitrateUpdated(
+      DataRate::KilobitsPerSec(500), DataRate::KilobitsPerSec(500),
+      DataRate::KilobitsPerSec(500), 0, 0, 0);
+  paused->encoder->OnBitrateUpdated(DataRate::Zero(), DataRate::Zero(),
+                                    DataRate::Zero(), 0, 0, 0);
+  ::testing::Mock::VerifyAndClearExpectations(encoders_[0]);
+
+  EXPECT_CALL(*encoders_[0], OnBitrateUpdated).Times(AnyNumber());
+  EXPECT_CALL(*encoders_[0],
+              OnBitrateUpdated(DataRate::KilobitsPerSec(800), _, _, _, _, _));
+  Stop(*second);
+  Stop(*first);
+  Stop(*paused);
+}
+
+TEST_F(SharedVideoStreamEncoderTest, StopsEncoderWithLastStream) {
+  auto first = CreateStream();
+  auto second = CreateStream();
+  Start(*first);
+  Start(*second);
+  ASSERT_EQ(encoders_.size(), 1u);
+
+  EXPECT_CALL(*encoders_[0], Stop).Times(0);
+  Stop(*first);
+  ::testing::Mock::VerifyAndClearExpectations(encoders_[0]);
+
+  EXPECT_CALL(first->sink, OnEncodedImage).Times(0);
+  EXPECT_CALL(second->sink, OnEncodedImage);
+  shared_sink_->OnEncodedImage(CreateImage(VideoFrameType::kVideoFrameKey),
+                               nullptr);
+
+  EXPECT_CALL(*encoders_[0], Stop);
+  Stop(*second);
+}
+
+TEST_F(SharedVideoStreamEncoderTest, ReconfiguresEncoderOfSingleStream) {
+  auto stream = CreateStream();
+  Start(*stream);
+  ASSERT_EQ(encoders_.size(), 1u);
+
+  EXPECT_CALL(*encoders_[0], MockedConfigureEncoder(_, 1200));
+  stream->encoder->ConfigureEncoder(CreateConfig(/*max_bitrate_bps=*/500'000),
+                                    1200);
+  EXPECT_EQ(encoders_.size(), 1u);
+  Stop(*stream);
+}
+
+TEST_F(SharedVideoStreamEncoderTest, ReconfiguredStreamLeavesSharedEncoder) {
+  auto first = CreateStream();
+  auto second = CreateStream();
+  Start(*first);
+  Start(*second);
+  ASSERT_EQ(encoders_.size(), 1u);
+
+  second->encoder->ConfigureEncoder(CreateConfig(/*max_bitrate_bps=*/500'000),
+                                    1200);
+  EXPECT_EQ(encoders_.size(), 2u);
+  EXPECT_EQ(registry_.num_encoders(), 2u);
+  Stop(*first);
+  Stop(*second);
+}
+
+TEST_F(SharedVideoStreamEncoderTest, RemovesResourcesOfLeavingStream) {
+  rtc::scoped_refptr<FakeResource> call_resource =
+      FakeResource::Create("CallResource");
+  rtc::scoped_refptr<FakeResource> stream_resource =
+      FakeResource::Create("StreamResource");
+  auto first = CreateStream();
+  auto second = CreateStream();
+  first->encoder->AddAdaptationResource(call_resource);
+  second->encoder->AddAdaptationResource(call_resource);
+  second->encoder->AddAdaptationResource(stream_resource);
+  Start(*first);
+  ASSERT_EQ(encoders_.size(), 1u);
+
+  // Resources shared by the streams of a call are added once.
+  EXPECT_CALL(*encoders_[0], AddAdaptationResource).Times(0);
+  EXPECT_CALL(*encoders_[0], AddAdaptationResource(
+                                 rtc::scoped_refptr<Resource>(stream_resource)));
+  Start(*second);
+  ::testing::Mock::VerifyAndClearExpectations(encoders_[0]);
+
+  EXPECT_CALL(*encoders_[0], RemoveAdaptationResource).Times(0);
+  EXPECT_CALL(*encoders_[0], RemoveAdaptationResource(
+                                 rtc::scoped_refptr<Resource>(stream_resource)));
+  Stop(*second);
+  ::testing::Mock::VerifyAndClearExpectations(encoders_[0]);
+
+  {
+    InSequence s;
+    EXPECT_CALL(*encoders_[0], RemoveAdaptationResource(
+                                   rtc::scoped_refptr<Resource>(call_resource)));
+    EXPECT_CALL(*encoders_[0], Stop);
+  }
+  Stop(*first);
+}
+
+TEST_F(SharedVideoStreamEncoderTest, StreamRemovesResourceFromSharedEncoder) {
+  rtc::scoped_refptr<FakeResource> resource = FakeResource::Create("Resource");
+  auto stream = CreateStream();
+  Start(*stream);
+  ASSERT_EQ(encoders_.size(), 1u);
+  stream->encoder->AddAdaptationResource(resource);
+
+  EXPECT_CALL(*encoders_[0], RemoveAdaptationResource(
+                                 rtc::scoped_refptr<Resource>(resource)));
+  stream->encoder->RemoveAdaptationResource(resource);
+  EXPECT_THAT(stream->encoder->GetAdaptationResources(), ::testing::IsEmpty());
+  Stop(*stream);
+}
+
+TEST_F(SharedVideoStreamEncoderTest, DeliversEncodedImagesWithoutGroupLock) {
+  auto first = CreateStream();
+  auto second = CreateStream();
+  Start(*first);
+  Start(*second);
+  ASSERT_EQ(encoders_.size(), 1u);
+  shared_sink_->OnEncodedImage(CreateImage(VideoFrameType::kVideoFrameKey),
+                               nullptr);
+
+  // Sinks may request key frames while handling an encoded image, e.g. when
+  // the frame can not be sent.
+  EXPECT_CALL(first->sink, OnEncodedImage)
+      .WillOnce(Invoke([&](const EncodedImage&, const CodecSpecificInfo*) {
+        first->encoder->SendKeyFrame({});
+        return EncodedImageCallback::Result(
+            EncodedImageCallback::Result::ERROR_SEND_FAILED);
+      }));
+  EXPECT_CALL(second->sink, OnEncodedImage)
+      .WillOnce(Return(
+          EncodedImageCallback::Result(EncodedImageCallback::Result::OK)));
+  EXPECT_CALL(*encoders_[0], SendKeyFrame);
+  EXPECT_EQ(shared_sink_
+                ->OnEncodedImage(CreateImage(VideoFrameType::kVideoFrameDelta),
+                                 nullptr)
+                .error,
+            EncodedImageCallback::Result::OK);
+  Stop(*first);
+  Stop(*second);
+}
+
+TEST_F(SharedVideoStreamEncoderTest, StreamsWithOtherFieldTrialsDoNotShare) {
+  test::ScopedKeyValueConfig field_trials("WebRTC-Video-Other/Enabled/");
+  const Environment other_env = CreateEnvironment(&clock_, &field_trials);
+  auto first = CreateStream();
+  auto second = CreateStream(other_env);
+  Start(*first);
+  Start(*second);
+
+  EXPECT_EQ(encoders_.size(), 2u);
+  Stop(*first);
+  Stop(*second);
+}
+
+TEST_F(SharedVideoStreamEncoderTest, SharedEncoderDoesNotUseEventLogOfFirstStream) {
+  auto first = CreateStream();
+  auto second = CreateStream();
+  Start(*first);
+  Start(*second);
+  ASSERT_EQ(encoder_envs_.size(), 1u);
+
+  // The encoder shares the utilities of the streams, except for the event log
+  // of the call that started it.
+  EXPECT_EQ(&encoder_envs_[0].field_trials(), &env_.field_trials());
+  EXPECT_EQ(&encoder_envs_[0].clock(), &env_.clock());
+  EXPECT_NE(&encoder_envs_[0].event_log(), &env_.event_log());
+  Stop(*first);
+  Stop(*second);
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -23,6 +23,10 @@ class MockVideoStreamEncoder : public VideoStreamEncoderInterface {
               AddAdaptationResource,
               (rtc::scoped_refptr<Resource>),
               (override));
+  MOCK_METHOD(void,
+              RemoveAdaptationResource,
+              (rtc::scoped_refptr<Resource>),
+              (override));
   MOCK_METHOD(std::vector<rtc::scoped_refptr<Resource>>,
               GetAdaptationResources,
               (),
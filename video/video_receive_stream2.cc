@@ -124,6 +124,16 @@ RenderResolution InitialDecoderResolution(const FieldTrialsView& field_trials) {
   return RenderResolution(320, 180);
 }
 
+std::unique_ptr<DecodeLoadManager::Stream> RegisterWithDecodeLoadManager(
+    const FieldTrialsView& field_trials,
+    uint32_t remote_ssrc,
+    Priority priority) {
+  if (!field_trials.IsEnabled("WebRTC-Video-DecodeLoadManager")) {
+    return nullptr;
+  }
+  return DecodeLoadManager::Global().RegisterStream(remote_ssrc, priority);
+}
+
 // Video decoder class to be used for unknown codecs. Doesn't support decoding
 // but logs messages to LS_ERROR.
 class NullVideoDecoder : public webrtc::VideoDecoder {
@@ -215,6 +225,9 @@ VideoReceiveStream2::VideoReceiveStream2(
                                  env_.field_trials(),
                                  &env_.event_log()),
       rtp_stream_sync_(call->worker_thread(), this),
+      decode_load_(RegisterWithDecodeLoadManager(env_.field_trials(),
+                                                 remote_ssrc(),
+                                                 config_.decode_priority)),
       max_wait_for_keyframe_(DetermineMaxWaitForFrame(
           TimeDelta::Millis(config_.rtp.nack.rtp_history_ms),
           true)),
@@ -250,7 +263,7 @@ VideoReceiveStream2::VideoReceiveStream2(
   buffer_ = std::make_unique<VideoStreamBufferController>(
       &env_.clock(), call_->worker_thread(), timing_.get(), &stats_proxy_, this,
       max_wait_for_keyframe_, max_wait_for_frame_, std::move(scheduler),
-      env_.field_trials());
+      env_.field_trials(), decode_load_.get());
 
   if (!config_.rtp.rtx_associated_payload_types.empty()) {
     rtx_receive_stream_ = std::make_unique<RtxReceiveStream>(
@@ -839,6 +852,14 @@ void VideoReceiveStream2::OnDecodableFrameTimeout(TimeDelta wait) {
   buffer_->StartNextDecode(keyframe_required_);
 }
 
+void VideoReceiveStream2::OnKeyFrameRequired() {
+  RTC_DCHECK_RUN_ON(&packet_sequence_checker_);
+  Timestamp now = env_.clock().CurrentTime();
+  if (!IsReceivingKeyFrame(now)) {
+    RequestKeyFrame(now);
+  }
+}
+
 VideoReceiveStream2::DecodeFrameResult
 VideoReceiveStream2::HandleEncodedFrameOnDecodeQueue(
     std::unique_ptr<EncodedFrame> frame,
@@ -860,7 +881,13 @@ VideoReceiveStream2::HandleEncodedFrameOnDecodeQueue(
   }
 
   int64_t frame_id = frame->Id();
+  const absl::optional<int> temporal_index = frame->TemporalIndex();
+  const Timestamp decode_start = env_.clock().CurrentTime();
   int decode_result = DecodeAndMaybeDispatchEncodedFrame(std::move(frame));
+  if (decode_load_) {
+    decode_load_->OnFrameDecoded(temporal_index,
+                                 env_.clock().CurrentTime() - decode_start);
+  }
   if (decode_result == WEBRTC_VIDEO_CODEC_OK ||
       decode_result == WEBRTC_VIDEO_CODEC_OK_REQUEST_KEYFRAME) {
     keyframe_required = false;
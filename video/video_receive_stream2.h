@@ -33,6 +33,7 @@
 #include "modules/video_coding/video_receiver2.h"
 #include "rtc_base/system/no_unique_address.h"
 #include "rtc_base/thread_annotations.h"
+#include "video/decode_load_manager.h"
 #include "video/receive_statistics_proxy.h"
 #include "video/rtp_streams_synchronizer2.h"
 #include "video/rtp_video_stream_receiver2.h"
@@ -201,6 +202,8 @@ class VideoReceiveStream2
   void OnEncodedFrame(std::unique_ptr<EncodedFrame> frame) override;
   // Called on packet sequence.
   void OnDecodableFrameTimeout(TimeDelta wait) override;
+  // Called on packet sequence.
+  void OnKeyFrameRequired() override;
 
   void CreateAndRegisterExternalDecoder(const Decoder& decoder);
 
@@ -277,6 +280,8 @@ class VideoReceiveStream2
   std::unique_ptr<VideoStreamDecoder> video_stream_decoder_;
   RtpStreamsSynchronizer rtp_stream_sync_;
 
+  // Set if the decode load of the process is managed, must outlive `buffer_`.
+  const std::unique_ptr<DecodeLoadManager::Stream> decode_load_;
   std::unique_ptr<VideoStreamBufferController> buffer_;
 
   // `receiver_controller_` is valid from when RegisterWithTransport is invoked
@@ -12,6 +12,7 @@
 #include <stdio.h>
 
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <map>
 #include <memory>
@@ -52,6 +53,7 @@
 #include "call/bitrate_allocator.h"
 #include "call/rtp_config.h"
 #include "call/rtp_transport_controller_send_interface.h"
+#include "call/utility_bitrate_allocation_policy.h"
 #include "call/video_send_stream.h"
 #include "media/base/media_constants.h"
 #include "media/base/sdp_video_format_utils.h"
@@ -76,8 +78,10 @@
 #include "video/config/video_encoder_config.h"
 #include "video/encoder_rtcp_feedback.h"
 #include "video/frame_cadence_adapter.h"
+#include "video/passthrough_video_stream_encoder.h"
 #include "video/send_delay_stats.h"
 #include "video/send_statistics_proxy.h"
+#include "video/shared_video_stream_encoder.h"
 #include "video/video_stream_encoder.h"
 #include "video/video_stream_encoder_interface.h"
 
@@ -181,6 +185,29 @@ int CalculateMaxPadBitrateBps(const std::vector<VideoStream>& streams,
   return pad_up_to_bitrate_bps;
 }
 
+// Returns one point per active stream, at the bitrate where it and the streams
+// below it reach their target bitrate, with the logarithm of its resolution as
+// utility.
+std::vector<BitrateUtilityPoint> CalculateUtilityCurve(
+    const std::vector<VideoStream>& streams) {
+  std::vector<BitrateUtilityPoint> utility_curve;
+  uint32_t bitrate_bps = 0;
+  for (const VideoStream& stream : streams) {
+    if (!stream.active || stream.width == 0 || stream.height == 0) {
+      continue;
+    }
+    bitrate_bps += stream.target_bitrate_bps;
+    if (!utility_curve.empty() &&
+        bitrate_bps <= utility_curve.back().bitrate_bps) {
+      continue;
+    }
+    utility_curve.push_back(
+        {bitrate_bps, std::log(static_cast<double>(stream.width) *
+                               stream.height)});
+  }
+  return utility_curve;
+}
+
 absl::optional<AlrExperimentSettings> GetAlrSettings(
     const FieldTrialsView& field_trials,
     VideoEncoderConfig::ContentType content_type) {
@@ -343,7 +370,7 @@ RtpSenderObservers CreateObservers(RtcpRttStats* call_stats,
 std::unique_ptr<VideoStreamEncoderInterface> CreateVideoStreamEncoder(
     const Environment& env,
     int num_cpu_cores,
-    SendStatisticsProxy* stats_proxy,
+    VideoStreamEncoderObserver* stats_proxy,
     const VideoStreamEncoderSettings& encoder_settings,
     VideoStreamEncoder::BitrateAllocationCallbackType
         bitrate_allocation_callback_type,
@@ -363,6 +390,59 @@ std::unique_ptr<VideoStreamEncoderInterface> CreateVideoStreamEncoder(
       encoder_selector);
 }
 
+// Creates an encoder shared with other streams sending the same source with a
+// compatible configuration, if enabled by field trial.
+std::unique_ptr<VideoStreamEncoderInterface>
+MaybeCreateSharedVideoStreamEncoder(
+    const Environment& env,
+    int num_cpu_cores,
+    SendStatisticsProxy* stats_proxy,
+    const VideoStreamEncoderSettings& encoder_settings,
+    VideoStreamEncoder::BitrateAllocationCallbackType
+        bitrate_allocation_callback_type,
+    Metronome* metronome,
+    webrtc::VideoEncoderFactory::EncoderSelectorInterface* encoder_selector) {
+  // The encoder selector belongs to the stream and can not be shared.
+  if (encoder_selector ||
+      !env.field_trials().IsEnabled("WebRTC-Video-SharedEncoder")) {
+    return CreateVideoStreamEncoder(env, num_cpu_cores, stats_proxy,
+                                    encoder_settings,
+                                    bitrate_allocation_callback_type, metronome,
+                                    encoder_selector);
+  }
+  return SharedVideoStreamEncoderRegistry::Global().CreateEncoder(
+      env,
+      {.num_cpu_cores = num_cpu_cores,
+       .settings = encoder_settings,
+       .bitrate_allocation_callback_type = bitrate_allocation_callback_type,
+       .metronome = metronome},
+      stats_proxy,
+      [](const Environment& env,
+         const SharedVideoStreamEncoderRegistry::EncoderParams& params,
+         VideoStreamEncoderObserver* observer) {
+        return CreateVideoStreamEncoder(
+            env, params.num_cpu_cores, observer, params.settings,
+            params.bitrate_allocation_callback_type, params.metronome,
+            /*encoder_selector=*/nullptr);
+      });
+}
+
+std::unique_ptr<VideoStreamEncoderInterface> CreateStreamEncoder(
+    const Environment& env,
+    int num_cpu_cores,
+    SendStatisticsProxy* stats_proxy,
+    const VideoSendStream::Config& config,
+    Metronome* metronome) {
+  if (config.encoded_source) {
+    return std::make_unique<PassthroughVideoStreamEncoder>(
+        env, config.encoded_source, stats_proxy);
+  }
+  return MaybeCreateSharedVideoStreamEncoder(
+      env, num_cpu_cores, stats_proxy, config.encoder_settings,
+      GetBitrateAllocationCallbackType(config, env.field_trials()), metronome,
+      config.encoder_selector);
+}
+
 bool HasActiveEncodings(const VideoEncoderConfig& config) {
   for (const VideoStream& stream : config.simulcast_layers) {
     if (stream.active) {
@@ -409,15 +489,11 @@ VideoSendStreamImpl::VideoSendStreamImpl(
       video_stream_encoder_(
           video_stream_encoder_for_test
               ? std::move(video_stream_encoder_for_test)
-              : CreateVideoStreamEncoder(
-                    env_,
-                    num_cpu_cores,
-                    &stats_proxy_,
-                    config_.encoder_settings,
-                    GetBitrateAllocationCallbackType(config_,
-                                                     env_.field_trials()),
-                    metronome,
-                    config_.encoder_selector)),
+              : CreateStreamEncoder(env_,
+                                    num_cpu_cores,
+                                    &stats_proxy_,
+                                    config_,
+                                    metronome)),
       encoder_feedback_(
           &env_.clock(),
           SupportsPerLayerPictureLossIndication(
@@ -455,6 +531,8 @@ VideoSendStreamImpl::VideoSendStreamImpl(
           GetInitialEncoderMaxBitrate(encoder_config.max_bitrate_bps)),
       encoder_target_rate_bps_(0),
       encoder_bitrate_priority_(encoder_config.bitrate_priority),
+      report_utility_curve_(
+          env_.field_trials().IsEnabled(kUtilityBitrateAllocationFieldTrial)),
       encoder_av1_priority_bitrate_override_bps_(
           GetEncoderPriorityBitrate(config_.rtp.payload_name,
                                     env_.field_trials())),
@@ -781,7 +859,8 @@ MediaStreamAllocationConfig VideoSendStreamImpl::GetAllocationConfig() const {
       static_cast<uint32_t>(disable_padding_ ? 0 : max_padding_bitrate_),
       encoder_av1_priority_bitrate_override_bps_,
       !config_.suspend_below_min_bitrate,
-      encoder_bitrate_priority_};
+      encoder_bitrate_priority_,
+      encoder_utility_curve_};
 }
 
 void VideoSendStreamImpl::OnEncoderConfigurationChanged(
@@ -825,6 +904,9 @@ void VideoSendStreamImpl::OnEncoderConfigurationChanged(
     encoder_max_bitrate_bps_ =
         std::max(static_cast<uint32_t>(encoder_min_bitrate_bps_),
                  encoder_max_bitrate_bps_);
+    if (report_utility_curve_) {
+      encoder_utility_curve_ = CalculateUtilityCurve(streams);
+    }
 
     // TODO(bugs.webrtc.org/10266): Query the VideoBitrateAllocator instead.
     max_padding_bitrate_ = CalculateMaxPadBitrateBps(
@@ -847,6 +847,51 @@ TEST_F(VideoSendStreamImplTest,
   vss_impl->Stop();
 }
 
+TEST_F(VideoSendStreamImplTest, ReportsUtilityCurveWhenEnabled) {
+  test::ScopedKeyValueConfig utility_experiment(
+      field_trials_, "WebRTC-Bwe-UtilityBasedAllocation/Enabled/");
+  config_.rtp.ssrcs.emplace_back(1);
+  config_.rtp.ssrcs.emplace_back(2);
+  VideoStream qvga_stream;
+  qvga_stream.width = 320;
+  qvga_stream.height = 180;
+  qvga_stream.min_bitrate_bps = 30000;
+  qvga_stream.target_bitrate_bps = 150000;
+  qvga_stream.max_bitrate_bps = 200000;
+  qvga_stream.bitrate_priority = 1;
+  VideoStream vga_stream = qvga_stream;
+  vga_stream.width = 640;
+  vga_stream.height = 360;
+  vga_stream.target_bitrate_bps = 500000;
+  vga_stream.max_bitrate_bps = 700000;
+
+  auto vss_impl = CreateVideoSendStreamImpl(TestVideoEncoderConfig());
+  std::vector<MediaStreamAllocationConfig> configs;
+  EXPECT_CALL(bitrate_allocator_, AddObserver(vss_impl.get(), _))
+      .WillRepeatedly(Invoke(
+          [&](BitrateAllocatorObserver*, MediaStreamAllocationConfig config) {
+            configs.push_back(config);
+          }));
+  vss_impl->Start();
+  encoder_queue_->PostTask([&] {
+    static_cast<VideoStreamEncoderInterface::EncoderSink*>(vss_impl.get())
+        ->OnEncoderConfigurationChanged(
+            std::vector<VideoStream>{qvga_stream, vga_stream}, false,
+            VideoEncoderConfig::ContentType::kRealtimeVideo,
+            /*min_transmit_bitrate_bps=*/0);
+  });
+  time_controller_.AdvanceTime(TimeDelta::Zero());
+
+  ASSERT_EQ(configs.size(), 2u);
+  EXPECT_TRUE(configs[0].utility_curve.empty());
+  ASSERT_EQ(configs[1].utility_curve.size(), 2u);
+  EXPECT_EQ(configs[1].utility_curve[0].bitrate_bps, 150000u);
+  EXPECT_EQ(configs[1].utility_curve[1].bitrate_bps, 650000u);
+  EXPECT_GT(configs[1].utility_curve[1].utility,
+            configs[1].utility_curve[0].utility);
+  vss_impl->Stop();
+}
+
 TEST_F(VideoSendStreamImplTest, CallsVideoStreamEncoderOnBitrateUpdate) {
   const bool kSuspend = false;
   config_.suspend_below_min_bitrate = kSuspend;
@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <set>
 #include <utility>
 
 #include "absl/base/attributes.h"
@@ -95,12 +96,14 @@ VideoStreamBufferController::VideoStreamBufferController(
     TimeDelta max_wait_for_keyframe,
     TimeDelta max_wait_for_frame,
     std::unique_ptr<FrameDecodeScheduler> frame_decode_scheduler,
-    const FieldTrialsView& field_trials)
+    const FieldTrialsView& field_trials,
+    DecodeLoadManager::Stream* decode_load)
     : field_trials_(field_trials),
       clock_(clock),
       stats_proxy_(stats_proxy),
       receiver_(receiver),
       timing_(timing),
+      decode_load_(decode_load),
       frame_decode_scheduler_(std::move(frame_decode_scheduler)),
       jitter_estimator_(clock_, field_trials),
       buffer_(std::make_unique<FrameBuffer>(kMaxFramesBuffered,
@@ -145,6 +148,7 @@ void VideoStreamBufferController::Clear() {
   stats_proxy_->OnDroppedFrames(buffer_->CurrentSize());
   buffer_ = std::make_unique<FrameBuffer>(kMaxFramesBuffered, kMaxFramesHistory,
                                           field_trials_);
+  dropped_frame_ids_.clear();
   frame_decode_scheduler_->CancelOutstanding();
 }
 
@@ -216,8 +220,11 @@ void VideoStreamBufferController::OnFrameReady(
   Timestamp min_receive_time = MinReceiveTime(first_frame);
   Timestamp max_receive_time = ReceiveTime(first_frame);
 
-  if (first_frame.is_keyframe())
+  if (first_frame.is_keyframe()) {
     keyframe_required_ = false;
+    decode_chain_broken_ = false;
+    dropped_frame_ids_.clear();
+  }
 
   // Gracefully handle bad RTP timestamps and render time issues.
   if (FrameHasBadRenderTiming(render_time, now) ||
@@ -311,9 +318,55 @@ void VideoStreamBufferController::FrameReadyForDecode(uint32_t rtp_timestamp,
     RTC_DCHECK_NOTREACHED();
     return;
   }
+  if (decode_load_) {
+    // A temporal unit of a layer that was just restored is only decoded once
+    // it no longer references one that was dropped, i.e. at a switch point.
+    const bool within_limit =
+        decode_load_->OnFrameReleased(frames.front()->TemporalIndex());
+    if (!within_limit || ReferencesDroppedFrame(frames)) {
+      DropForDecodeLoad(frames);
+      return;
+    }
+  }
   OnFrameReady(std::move(frames), render_time);
 }
 
+bool VideoStreamBufferController::ReferencesDroppedFrame(
+    const absl::InlinedVector<std::unique_ptr<EncodedFrame>, 4>& frames) const
+    RTC_RUN_ON(&worker_sequence_checker_) {
+  for (const std::unique_ptr<EncodedFrame>& frame : frames) {
+    for (size_t i = 0; i < frame->num_references; ++i) {
+      if (dropped_frame_ids_.find(frame->references[i]) !=
+          dropped_frame_ids_.end()) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void VideoStreamBufferController::DropForDecodeLoad(
+    const absl::InlinedVector<std::unique_ptr<EncodedFrame>, 4>& frames)
+    RTC_RUN_ON(&worker_sequence_checker_) {
+  // Lower temporal layers never reference higher ones, so only dropping a
+  // base layer temporal unit affects all temporal units that follow.
+  if (frames.front()->TemporalIndex().value_or(0) == 0) {
+    decode_chain_broken_ = true;
+  }
+  // Frames older than the frame buffer history can't be referenced anyway.
+  dropped_frame_ids_.erase(
+      dropped_frame_ids_.begin(),
+      dropped_frame_ids_.lower_bound(frames.back()->Id() - kMaxFramesHistory));
+  for (const std::unique_ptr<EncodedFrame>& frame : frames) {
+    dropped_frame_ids_.insert(frame->Id());
+  }
+  // The stream is alive even though nothing reaches the decoder, avoid
+  // timeouts and the keyframe requests they cause.
+  timeout_tracker_.OnEncodedFrameReleased();
+  stats_proxy_->OnDroppedFrames(frames.size());
+  MaybeScheduleFrameForRelease();
+}
+
 void VideoStreamBufferController::UpdateDroppedFrames()
     RTC_RUN_ON(&worker_sequence_checker_) {
   const int dropped_frames = buffer_->GetTotalNumberOfDroppedFrames() -
@@ -391,6 +444,19 @@ void VideoStreamBufferController::MaybeScheduleFrameForRelease()
     return;
   }
 
+  if (decode_chain_broken_ && !keyframe_required_ &&
+      !decode_load_->limit().paused) {
+    // Decoding resumes after a pause. Ask for a keyframe right away unless
+    // one is already buffered, rather than waiting for the timeout to do so.
+    keyframe_required_ = true;
+    timeout_tracker_.SetWaitingForKeyframe();
+    ForceKeyFrameReleaseImmediately();
+    if (keyframe_required_) {
+      receiver_->OnKeyFrameRequired();
+    }
+    return;
+  }
+
   if (keyframe_required_) {
     return ForceKeyFrameReleaseImmediately();
   }
@@ -12,6 +12,7 @@
 #define VIDEO_VIDEO_STREAM_BUFFER_CONTROLLER_H_
 
 #include <memory>
+#include <set>
 
 #include "api/field_trials_view.h"
 #include "api/task_queue/task_queue_base.h"
@@ -22,6 +23,7 @@
 #include "modules/video_coding/timing/jitter_estimator.h"
 #include "modules/video_coding/timing/timing.h"
 #include "system_wrappers/include/clock.h"
+#include "video/decode_load_manager.h"
 #include "video/decode_synchronizer.h"
 #include "video/video_receive_stream_timeout_tracker.h"
 
@@ -33,6 +35,9 @@ class FrameSchedulingReceiver {
 
   virtual void OnEncodedFrame(std::unique_ptr<EncodedFrame> frame) = 0;
   virtual void OnDecodableFrameTimeout(TimeDelta wait_time) = 0;
+  // Called when decoding can only continue from a keyframe, e.g. when a
+  // stream resumes after frames were dropped to reduce the decode load.
+  virtual void OnKeyFrameRequired() = 0;
 };
 
 class VideoStreamBufferControllerStatsObserver {
@@ -74,7 +79,8 @@ class VideoStreamBufferController {
       TimeDelta max_wait_for_keyframe,
       TimeDelta max_wait_for_frame,
       std::unique_ptr<FrameDecodeScheduler> frame_decode_scheduler,
-      const FieldTrialsView& field_trials);
+      const FieldTrialsView& field_trials,
+      DecodeLoadManager::Stream* decode_load = nullptr);
   virtual ~VideoStreamBufferController() = default;
 
   void Stop();
@@ -93,6 +99,12 @@ class VideoStreamBufferController {
       Timestamp render_time);
   void OnTimeout(TimeDelta delay);
   void FrameReadyForDecode(uint32_t rtp_timestamp, Timestamp render_time);
+  bool ReferencesDroppedFrame(
+      const absl::InlinedVector<std::unique_ptr<EncodedFrame>, 4>& frames)
+      const RTC_RUN_ON(&worker_sequence_checker_);
+  void DropForDecodeLoad(
+      const absl::InlinedVector<std::unique_ptr<EncodedFrame>, 4>& frames)
+      RTC_RUN_ON(&worker_sequence_checker_);
   void UpdateDroppedFrames() RTC_RUN_ON(&worker_sequence_checker_);
   void UpdateFrameBufferTimings(Timestamp min_receive_time, Timestamp now);
   void UpdateTimingFrameInfo();
@@ -106,6 +118,7 @@ class VideoStreamBufferController {
   VideoStreamBufferControllerStatsObserver* const stats_proxy_;
   FrameSchedulingReceiver* const receiver_;
   VCMTiming* const timing_;
+  DecodeLoadManager::Stream* const decode_load_;
   const std::unique_ptr<FrameDecodeScheduler> frame_decode_scheduler_
       RTC_GUARDED_BY(&worker_sequence_checker_);
 
@@ -113,6 +126,13 @@ class VideoStreamBufferController {
   InterFrameDelayVariationCalculator ifdv_calculator_
       RTC_GUARDED_BY(&worker_sequence_checker_);
   bool keyframe_required_ RTC_GUARDED_BY(&worker_sequence_checker_) = false;
+  // Set when a temporal unit that later ones may depend on was dropped to
+  // reduce the decode load. Decoding has to resume with a keyframe.
+  bool decode_chain_broken_ RTC_GUARDED_BY(&worker_sequence_checker_) = false;
+  // Ids of the frames dropped to reduce the decode load since the last
+  // keyframe. Frames referencing them can't be decoded.
+  std::set<int64_t> dropped_frame_ids_
+      RTC_GUARDED_BY(&worker_sequence_checker_);
   std::unique_ptr<FrameBuffer> buffer_
       RTC_GUARDED_BY(&worker_sequence_checker_);
   FrameDecodeTiming decode_timing_ RTC_GUARDED_BY(&worker_sequence_checker_);
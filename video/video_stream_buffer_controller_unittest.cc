@@ -22,6 +22,7 @@
 #include "absl/types/optional.h"
 #include "absl/types/variant.h"
 #include "api/metronome/test/fake_metronome.h"
+#include "api/priority.h"
 #include "api/units/frequency.h"
 #include "api/units/time_delta.h"
 #include "api/units/timestamp.h"
@@ -33,6 +34,7 @@
 #include "test/gtest.h"
 #include "test/scoped_key_value_config.h"
 #include "test/time_controller/simulated_time_controller.h"
+#include "video/decode_load_manager.h"
 #include "video/decode_synchronizer.h"
 #include "video/task_queue_frame_decode_scheduler.h"
 
@@ -180,6 +182,8 @@ class VideoStreamBufferControllerFixture
     SetWaitResult(wait_time);
   }
 
+  void OnKeyFrameRequired() override { ++keyframe_requests_; }
+
   using WaitResult =
       absl::variant<std::unique_ptr<EncodedFrame>, TimeDelta /*wait_time*/>;
 
@@ -221,6 +225,19 @@ class VideoStreamBufferControllerFixture
   void ResetLastResult() { wait_result_.reset(); }
 
   int dropped_frames() const { return dropped_frames_; }
+  int keyframe_requests() const { return keyframe_requests_; }
+
+  // Recreates `buffer_` to drop frames according to `decode_load`.
+  void SetDecodeLoad(DecodeLoadManager::Stream* decode_load) {
+    buffer_->Stop();
+    buffer_ = std::make_unique<VideoStreamBufferController>(
+        clock_, time_controller_.GetMainThread(), &timing_, &stats_callback_,
+        this, kMaxWaitForKeyframe, kMaxWaitForFrame,
+        sync_decoding_ ? decode_sync_.CreateSynchronizedFrameScheduler()
+                       : std::make_unique<TaskQueueFrameDecodeScheduler>(
+                             clock_, time_controller_.GetMainThread()),
+        field_trials_, decode_load);
+  }
 
  protected:
   const bool sync_decoding_;
@@ -245,6 +262,7 @@ class VideoStreamBufferControllerFixture
   }
 
   uint32_t dropped_frames_ = 0;
+  int keyframe_requests_ = 0;
   absl::optional<WaitResult> wait_result_;
 };
 
@@ -804,6 +822,176 @@ TEST_P(VideoStreamBufferControllerTest,
   EXPECT_THAT(WaitForFrameOrTimeout(kFps30Delay), Frame(test::WithId(10)));
 }
 
+TEST_P(VideoStreamBufferControllerTest, DropsTemporalLayersThinnedByLoad) {
+  // Two frames per second that take 10 ms to decode exceed the capacity, so
+  // the upper temporal layer gets dropped.
+  DecodeLoadManager decode_load(clock_, {.capacity = 0.01});
+  auto stream = decode_load.RegisterStream(/*remote_ssrc=*/1, Priority::kHigh);
+  for (int temporal_index : {0, 1}) {
+    stream->OnFrameReleased(temporal_index);
+    stream->OnFrameDecoded(temporal_index, TimeDelta::Millis(10));
+  }
+  time_controller_.AdvanceTime(TimeDelta::Seconds(1));
+  stream->OnFrameReleased(0);
+  ASSERT_THAT(stream->limit().max_temporal_layer, Optional(0));
+  SetDecodeLoad(stream.get());
+
+  StartNextDecodeForceKeyframe();
+  buffer_->InsertFrame(test::FakeFrameBuilder().Id(0).Time(0).AsLast().Build());
+  EXPECT_THAT(WaitForFrameOrTimeout(TimeDelta::Zero()), Frame(test::WithId(0)));
+
+  StartNextDecode();
+  auto upper_layer_frame = test::FakeFrameBuilder()
+                               .Id(1)
+                               .Time(kFps30Rtp)
+                               .AsLast()
+                               .Refs({0})
+                               .Build();
+  upper_layer_frame->SetTemporalIndex(1);
+  buffer_->InsertFrame(std::move(upper_layer_frame));
+  auto base_layer_frame = test::FakeFrameBuilder()
+                              .Id(2)
+                              .Time(2 * kFps30Rtp)
+                              .AsLast()
+                              .Refs({0})
+                              .Build();
+  base_layer_frame->SetTemporalIndex(0);
+  buffer_->InsertFrame(std::move(base_layer_frame));
+
+  EXPECT_THAT(WaitForFrameOrTimeout(kFps30Delay * 3), Frame(test::WithId(2)));
+  EXPECT_EQ(dropped_frames(), 1);
+
+  buffer_->Stop();
+  buffer_ = nullptr;
+}
+
+TEST_P(VideoStreamBufferControllerTest,
+       RestoresTemporalLayerOnceReferencesWereDecoded) {
+  DecodeLoadManager decode_load(clock_, {.capacity = 0.01});
+  auto stream = decode_load.RegisterStream(/*remote_ssrc=*/1, Priority::kHigh);
+  for (int temporal_index : {0, 1}) {
+    stream->OnFrameReleased(temporal_index);
+    stream->OnFrameDecoded(temporal_index, TimeDelta::Millis(10));
+  }
+  time_controller_.AdvanceTime(TimeDelta::Seconds(1));
+  stream->OnFrameReleased(0);
+  ASSERT_THAT(stream->limit().max_temporal_layer, Optional(0));
+  SetDecodeLoad(stream.get());
+
+  StartNextDecodeForceKeyframe();
+  buffer_->InsertFrame(test::FakeFrameBuilder().Id(0).Time(0).AsLast().Build());
+  EXPECT_THAT(WaitForFrameOrTimeout(TimeDelta::Zero()), Frame(test::WithId(0)));
+
+  StartNextDecode();
+  auto frame = test::FakeFrameBuilder()
+                   .Id(1)
+                   .Time(kFps30Rtp)
+                   .AsLast()
+                   .Refs({0})
+                   .Build();
+  frame->SetTemporalIndex(1);
+  buffer_->InsertFrame(std::move(frame));
+  EXPECT_THAT(WaitForFrameOrTimeout(kFps30Delay * 2), Eq(absl::nullopt));
+  EXPECT_EQ(dropped_frames(), 1);
+
+  // Restore the upper temporal layer.
+  decode_load.SetCapacity(1.0);
+  time_controller_.AdvanceTime(TimeDelta::Seconds(1));
+  stream->OnFrameReleased(0);
+  ASSERT_EQ(stream->limit(), DecodeLoadManager::DecodeLimit());
+
+  // Frame 2 references the dropped frame 1 and can't be decoded.
+  frame = test::FakeFrameBuilder()
+              .Id(2)
+              .Time(kFps30Rtp * 32)
+              .AsLast()
+              .Refs({1})
+              .Build();
+  frame->SetTemporalIndex(1);
+  buffer_->InsertFrame(std::move(frame));
+  EXPECT_THAT(WaitForFrameOrTimeout(kFps30Delay * 2), Eq(absl::nullopt));
+  EXPECT_EQ(dropped_frames(), 2);
+
+  frame = test::FakeFrameBuilder()
+              .Id(3)
+              .Time(kFps30Rtp * 33)
+              .AsLast()
+              .Refs({0})
+              .Build();
+  frame->SetTemporalIndex(0);
+  buffer_->InsertFrame(std::move(frame));
+  EXPECT_THAT(WaitForFrameOrTimeout(kFps30Delay * 2), Frame(test::WithId(3)));
+
+  // Frame 4 only references decoded frames.
+  StartNextDecode();
+  frame = test::FakeFrameBuilder()
+              .Id(4)
+              .Time(kFps30Rtp * 34)
+              .AsLast()
+              .Refs({3})
+              .Build();
+  frame->SetTemporalIndex(1);
+  buffer_->InsertFrame(std::move(frame));
+  EXPECT_THAT(WaitForFrameOrTimeout(kFps30Delay * 2), Frame(test::WithId(4)));
+  EXPECT_EQ(dropped_frames(), 2);
+  EXPECT_EQ(keyframe_requests(), 0);
+
+  buffer_->Stop();
+  buffer_ = nullptr;
+}
+
+TEST_P(VideoStreamBufferControllerTest, RequestsKeyFrameWhenResumed) {
+  // The load exceeds the capacity even when decoding the base layer only, so
+  // the stream gets paused.
+  DecodeLoadManager decode_load(clock_, {.capacity = 0.001});
+  auto stream = decode_load.RegisterStream(/*remote_ssrc=*/1, Priority::kLow);
+  for (int temporal_index : {0, 1}) {
+    stream->OnFrameReleased(temporal_index);
+    stream->OnFrameDecoded(temporal_index, TimeDelta::Millis(10));
+  }
+  time_controller_.AdvanceTime(TimeDelta::Seconds(1));
+  stream->OnFrameReleased(0);
+  ASSERT_TRUE(stream->limit().paused);
+  SetDecodeLoad(stream.get());
+
+  StartNextDecodeForceKeyframe();
+  buffer_->InsertFrame(test::FakeFrameBuilder().Id(0).Time(0).AsLast().Build());
+  EXPECT_THAT(WaitForFrameOrTimeout(TimeDelta::Zero()), Frame(test::WithId(0)));
+
+  StartNextDecode();
+  buffer_->InsertFrame(test::FakeFrameBuilder()
+                           .Id(1)
+                           .Time(kFps30Rtp)
+                           .AsLast()
+                           .Refs({0})
+                           .Build());
+  EXPECT_THAT(WaitForFrameOrTimeout(kFps30Delay * 2), Eq(absl::nullopt));
+  EXPECT_EQ(dropped_frames(), 1);
+
+  // Resume the base layer.
+  decode_load.SetCapacity(1.0);
+  time_controller_.AdvanceTime(TimeDelta::Seconds(1));
+  stream->OnFrameReleased(0);
+  ASSERT_FALSE(stream->limit().paused);
+
+  buffer_->InsertFrame(test::FakeFrameBuilder()
+                           .Id(2)
+                           .Time(kFps30Rtp * 32)
+                           .AsLast()
+                           .Refs({1})
+                           .Build());
+  EXPECT_THAT(WaitForFrameOrTimeout(TimeDelta::Zero()), Eq(absl::nullopt));
+  EXPECT_EQ(keyframe_requests(), 1);
+
+  buffer_->InsertFrame(
+      test::FakeFrameBuilder().Id(3).Time(kFps30Rtp * 33).AsLast().Build());
+  EXPECT_THAT(WaitForFrameOrTimeout(TimeDelta::Zero()), Frame(test::WithId(3)));
+  EXPECT_EQ(keyframe_requests(), 1);
+
+  buffer_->Stop();
+  buffer_ = nullptr;
+}
+
 INSTANTIATE_TEST_SUITE_P(VideoStreamBufferController,
                          VideoStreamBufferControllerTest,
                          ::testing::Combine(::testing::Bool(),
@@ -42,6 +42,7 @@
 #include "modules/video_coding/utility/vp8_constants.h"
 #include "rtc_base/arraysize.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/cpu_time.h"
 #include "rtc_base/event.h"
 #include "rtc_base/experiments/encoder_info_settings.h"
 #include "rtc_base/experiments/rate_control_settings.h"
@@ -74,6 +75,9 @@ constexpr char kFrameDropperFieldTrial[] = "WebRTC-FrameDropper";
 constexpr char kSwitchEncoderOnInitializationFailuresFieldTrial[] =
     "WebRTC-SwitchEncoderOnInitializationFailures";
 
+constexpr char kPipelinedFrameConversionFieldTrial[] =
+    "WebRTC-Video-PipelinedFrameConversion";
+
 const size_t kDefaultPayloadSize = 1440;
 
 const int64_t kParameterUpdateIntervalMs = 1000;
@@ -558,6 +562,33 @@ absl::optional<VideoSourceRestrictions> MergeRestrictions(
   return return_value;
 }
 
+// Maps `regions`, in fractions of a `width`x`height` frame, to fractions of
+// its `crop_width`x`crop_height` part at `offset_x`,`offset_y`. Parts of the
+// regions outside the crop are dropped.
+std::vector<VideoFrame::QualityRegion> CropQualityRegions(
+    std::vector<VideoFrame::QualityRegion> regions,
+    int width,
+    int height,
+    int offset_x,
+    int offset_y,
+    int crop_width,
+    int crop_height) {
+  auto crop = [](double fraction, int size, int offset, int crop_size) {
+    return std::clamp((fraction * size - offset) / crop_size, 0.0, 1.0);
+  };
+  for (VideoFrame::QualityRegion& region : regions) {
+    const double left = crop(region.x, width, offset_x, crop_width);
+    const double top = crop(region.y, height, offset_y, crop_height);
+    region.width =
+        crop(region.x + region.width, width, offset_x, crop_width) - left;
+    region.height =
+        crop(region.y + region.height, height, offset_y, crop_height) - top;
+    region.x = left;
+    region.y = top;
+  }
+  return regions;
+}
+
 }  //  namespace
 
 VideoStreamEncoder::EncoderRateSettings::EncoderRateSettings()
@@ -672,6 +703,11 @@ VideoStreamEncoder::VideoStreamEncoder(
                             : encoder_selector_from_factory_.get()),
       encoder_stats_observer_(encoder_stats_observer),
       frame_cadence_adapter_(std::move(frame_cadence_adapter)),
+      frame_preprocessor_(
+          env_.field_trials().IsEnabled(kPipelinedFrameConversionFieldTrial)
+              ? std::make_unique<FramePreprocessor>(
+                    env_.task_queue_factory(), frame_cadence_adapter_.get())
+              : nullptr),
       delta_ntp_internal_ms_(env_.clock().CurrentNtpInMilliseconds() -
                              env_.clock().TimeInMilliseconds()),
       last_frame_log_ms_(env_.clock().TimeInMilliseconds()),
@@ -693,8 +729,12 @@ VideoStreamEncoder::VideoStreamEncoder(
                                std::move(overuse_detector),
                                degradation_preference_manager_.get(),
                                env_.field_trials()),
-      video_source_sink_controller_(/*sink=*/frame_cadence_adapter_.get(),
-                                    /*source=*/nullptr),
+      video_source_sink_controller_(
+          /*sink=*/frame_preprocessor_
+              ? static_cast<rtc::VideoSinkInterface<VideoFrame>*>(
+                    frame_preprocessor_.get())
+              : frame_cadence_adapter_.get(),
+          /*source=*/nullptr),
       default_limits_allowed_(!env_.field_trials().IsEnabled(
           "WebRTC-DefaultBitrateLimitsKillSwitch")),
       qp_parsing_allowed_(
@@ -754,6 +794,10 @@ VideoStreamEncoder::~VideoStreamEncoder() {
 void VideoStreamEncoder::Stop() {
   RTC_DCHECK_RUN_ON(worker_queue_);
   video_source_sink_controller_.SetSource(nullptr);
+  if (frame_preprocessor_) {
+    // Let an ongoing conversion finish before the cadence adapter goes away.
+    frame_preprocessor_->Stop();
+  }
 
   rtc::Event shutdown_event;
   absl::Cleanup shutdown = [&shutdown_event] { shutdown_event.Set(); };
@@ -814,6 +858,21 @@ void VideoStreamEncoder::AddAdaptationResource(
   });
 }
 
+void VideoStreamEncoder::RemoveAdaptationResource(
+    rtc::scoped_refptr<Resource> resource) {
+  RTC_DCHECK_RUN_ON(worker_queue_);
+  encoder_queue_->PostTask([this, resource = std::move(resource)] {
+    RTC_DCHECK_RUN_ON(encoder_queue_.get());
+    // Resources are already removed if the encoder was stopped.
+    auto it = absl::c_find(additional_resources_, resource);
+    if (it == additional_resources_.end()) {
+      return;
+    }
+    additional_resources_.erase(it);
+    stream_resource_manager_.RemoveResource(resource);
+  });
+}
+
 std::vector<rtc::scoped_refptr<Resource>>
 VideoStreamEncoder::GetAdaptationResources() {
   RTC_DCHECK_RUN_ON(worker_queue_);
@@ -1286,6 +1345,10 @@ void VideoStreamEncoder::ReconfigureEncoder() {
   }
 
   send_codec_ = codec;
+  if (frame_preprocessor_) {
+    frame_preprocessor_->SetEncodedResolution(send_codec_.width,
+                                              send_codec_.height);
+  }
 
   // Keep the same encoder, as long as the video_format is unchanged.
   // Encoder creation block is split in two since EncoderInfo needed to start
@@ -1922,6 +1985,10 @@ void VideoStreamEncoder::EncodeVideoFrame(const VideoFrame& video_frame,
     // a long time when we expect that the scaler should work.
     stream_resource_manager_.ConfigureQualityScaler(info);
     stream_resource_manager_.ConfigureBandwidthQualityScaler(info);
+    if (frame_preprocessor_) {
+      frame_preprocessor_->SetEncoderFormats(info.supports_native_handle,
+                                             info.preferred_pixel_formats);
+    }
 
     RTC_LOG(LS_INFO) << "[VSE] Encoder info changed to " << info.ToString();
   }
@@ -1965,6 +2032,13 @@ void VideoStreamEncoder::EncodeVideoFrame(const VideoFrame& video_frame,
       update_rect.offset_y -= offset_y;
       update_rect.Intersect(
           VideoFrame::UpdateRect{0, 0, cropped_width, cropped_height});
+      // Scaling keeps the quality regions in place, cropping moves them.
+      if (!video_frame.quality_regions().empty()) {
+        out_frame.set_quality_regions(CropQualityRegions(
+            video_frame.quality_regions(), video_frame.width(),
+            video_frame.height(), offset_x, offset_y, cropped_width,
+            cropped_height));
+      }
 
     } else {
       // The difference is large, scale it.
@@ -2026,8 +2100,25 @@ void VideoStreamEncoder::EncodeVideoFrame(const VideoFrame& video_frame,
 
   frame_encode_metadata_writer_.OnEncodeStarted(out_frame);
 
+  // Reading the thread CPU time is a system call, only do it if the load is
+  // estimated from it.
+  const int64_t encode_start_cpu_time_ns =
+      stream_resource_manager_.MeasuresEncodeCpuTime()
+          ? rtc::GetThreadCpuTimeNanos()
+          : -1;
   const int32_t encode_status = encoder_->Encode(out_frame, &next_frame_types_);
   was_encode_called_since_last_initialization_ = true;
+  if (encode_start_cpu_time_ns >= 0) {
+    const int64_t encode_end_cpu_time_ns = rtc::GetThreadCpuTimeNanos();
+    // Only covers work done on this thread, which is all of it for the
+    // software encoders unless they are configured with worker threads.
+    const int64_t encode_cpu_time_ns =
+        encode_end_cpu_time_ns - encode_start_cpu_time_ns;
+    if (encode_end_cpu_time_ns >= 0 && encode_cpu_time_ns >= 0) {
+      stream_resource_manager_.OnEncodeCpuTimeMeasured(TimeDelta::Micros(
+          encode_cpu_time_ns / rtc::kNumNanosecsPerMicrosec));
+    }
+  }
 
   if (encode_status < 0) {
     if (encode_status == WEBRTC_VIDEO_CODEC_ENCODER_FAILURE) {
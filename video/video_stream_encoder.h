@@ -47,6 +47,7 @@
 #include "video/encoder_bitrate_adjuster.h"
 #include "video/frame_cadence_adapter.h"
 #include "video/frame_encode_metadata_writer.h"
+#include "video/frame_preprocessor.h"
 #include "video/video_source_sink_controller.h"
 #include "video/video_stream_encoder_interface.h"
 #include "video/video_stream_encoder_observer.h"
@@ -90,6 +91,7 @@ class VideoStreamEncoder : public VideoStreamEncoderInterface,
   VideoStreamEncoder& operator=(const VideoStreamEncoder&) = delete;
 
   void AddAdaptationResource(rtc::scoped_refptr<Resource> resource) override;
+  void RemoveAdaptationResource(rtc::scoped_refptr<Resource> resource) override;
   std::vector<rtc::scoped_refptr<Resource>> GetAdaptationResources() override;
 
   void SetSource(rtc::VideoSourceInterface<VideoFrame>* source,
@@ -294,6 +296,10 @@ class VideoStreamEncoder : public VideoStreamEncoderInterface,
   // forwards them to our OnFrame method.
   std::unique_ptr<FrameCadenceAdapterInterface> frame_cadence_adapter_
       RTC_GUARDED_BY(encoder_queue_) RTC_PT_GUARDED_BY(encoder_queue_);
+  // Converts frames ahead of the cadence adapter when the field trial
+  // "WebRTC-Video-PipelinedFrameConversion" is enabled, so that converting a
+  // frame overlaps with encoding the previous one. Thread-safe.
+  const std::unique_ptr<FramePreprocessor> frame_preprocessor_;
 
   VideoEncoderConfig encoder_config_ RTC_GUARDED_BY(encoder_queue_);
   std::unique_ptr<VideoEncoder> encoder_ RTC_GUARDED_BY(encoder_queue_)
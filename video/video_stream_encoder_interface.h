@@ -68,6 +68,10 @@ class VideoStreamEncoderInterface {
   // is moved to Call this method could be deleted altogether in favor of
   // Call-level APIs only.
   virtual void AddAdaptationResource(rtc::scoped_refptr<Resource> resource) = 0;
+  // Stops adapting to a resource added with AddAdaptationResource(). Does
+  // nothing if it was not added.
+  virtual void RemoveAdaptationResource(
+      rtc::scoped_refptr<Resource> resource) = 0;
   virtual std::vector<rtc::scoped_refptr<Resource>>
   GetAdaptationResources() = 0;
 
@@ -1168,6 +1168,11 @@ class VideoStreamEncoderTest : public ::testing::Test {
       return last_update_rect_;
     }
 
+    std::vector<VideoFrame::QualityRegion> GetLastQualityRegions() const {
+      MutexLock lock(&local_mutex_);
+      return last_quality_regions_;
+    }
+
     const std::vector<VideoFrameType>& LastFrameTypes() const {
       MutexLock lock(&local_mutex_);
       return last_frame_types_;
@@ -1267,6 +1272,7 @@ class VideoStreamEncoderTest : public ::testing::Test {
         last_input_width_ = input_image.width();
         last_input_height_ = input_image.height();
         last_update_rect_ = input_image.update_rect();
+        last_quality_regions_ = input_image.quality_regions();
         last_frame_types_ = *frame_types;
         last_input_pixel_format_ = input_image.video_frame_buffer()->type();
       }
@@ -1374,6 +1380,8 @@ class VideoStreamEncoderTest : public ::testing::Test {
         last_rate_control_settings_;
     VideoFrame::UpdateRect last_update_rect_ RTC_GUARDED_BY(local_mutex_) = {
         0, 0, 0, 0};
+    std::vector<VideoFrame::QualityRegion> last_quality_regions_
+        RTC_GUARDED_BY(local_mutex_);
     std::vector<VideoFrameType> last_frame_types_;
     bool expect_null_frame_ = false;
     EncodedImageCallback* encoded_image_callback_ RTC_GUARDED_BY(local_mutex_) =
@@ -1810,6 +1818,37 @@ TEST_F(VideoStreamEncoderTest,
   video_stream_encoder_->Stop();
 }
 
+TEST_F(VideoStreamEncoderTest, MapsQualityRegionsToCroppedFrame) {
+  video_encoder_config_.video_stream_factory =
+      rtc::make_ref_counted<CroppingVideoStreamFactory>();
+  video_stream_encoder_->ConfigureEncoder(std::move(video_encoder_config_),
+                                          kMaxPayloadLength);
+  video_stream_encoder_->OnBitrateUpdatedAndWaitForManagedResources(
+      kTargetBitrate, kTargetBitrate, kTargetBitrate, 0, 0, 0);
+
+  // Cropped by 3 pixels in each dimension, 2 of them on the top and left.
+  const int kWidth = codec_width_ + 3;
+  const int kHeight = codec_height_ + 3;
+  VideoFrame::QualityRegion region;
+  region.width = 0.5;
+  region.height = 0.5;
+  region.qp_delta = -10;
+  VideoFrame frame = CreateFrame(1, kWidth, kHeight);
+  frame.set_quality_regions({region});
+  video_source_.IncomingCapturedFrame(frame);
+  WaitForEncodedFrame(1);
+
+  std::vector<VideoFrame::QualityRegion> regions =
+      fake_encoder_.GetLastQualityRegions();
+  ASSERT_EQ(regions.size(), 1u);
+  EXPECT_EQ(regions[0].x, 0.0);
+  EXPECT_EQ(regions[0].y, 0.0);
+  EXPECT_DOUBLE_EQ(regions[0].width, (0.5 * kWidth - 2) / codec_width_);
+  EXPECT_DOUBLE_EQ(regions[0].height, (0.5 * kHeight - 2) / codec_height_);
+  EXPECT_EQ(regions[0].qp_delta, -10);
+  video_stream_encoder_->Stop();
+}
+
 TEST_F(VideoStreamEncoderTest, NonI420FramesShouldNotBeConvertedToI420) {
   video_stream_encoder_->OnBitrateUpdatedAndWaitForManagedResources(
       kTargetBitrate, kTargetBitrate, kTargetBitrate, 0, 0, 0);